@@ -1178,6 +1178,7 @@ void QCPAxis::setTickVector(const QVector<double> &vec)
 {
   // don't check whether mTickVector != vec here, because it takes longer than we would save
   mTickVector = vec;
+  mTickParameterHash.clear();
   mCachedMarginValid = false;
 }
 
@@ -1196,6 +1197,7 @@ void QCPAxis::setTickVectorLabels(const QVector<QString> &vec)
 {
   // don't check whether mTickVectorLabels != vec here, because it takes longer than we would save
   mTickVectorLabels = vec;
+  mTickParameterHash.clear();
   mCachedMarginValid = false;
 }
 
@@ -1257,6 +1259,7 @@ void QCPAxis::setTickLengthOut(int outside)
 void QCPAxis::setSubTickCount(int count)
 {
   mSubTickCount = count;
+  mTickParameterHash.clear(); // the count also serves as fallback for automatic sub ticks, so it isn't fully represented in the hash
 }
 
 /*!
@@ -1855,6 +1858,22 @@ QList<QCPAbstractItem*> QCPAxis::items() const
   return result;
 }
 
+/*!
+  Discards the tick, sub tick and tick label vectors that were generated during the last replot,
+  so they are generated again during the next replot.
+  
+  If ticks and tick labels are generated automatically (\ref setAutoTicks, \ref
+  setAutoTickLabels), the vectors are only regenerated when one of the axis parameters they depend
+  on changes, e.g. the range or the number format. Subclasses that reimplement \ref
+  generateAutoTicks and depend on additional parameters of their own must call this function when
+  those parameters change.
+*/
+void QCPAxis::invalidateTickCache()
+{
+  mTickParameterHash.clear();
+  mCachedMarginValid = false;
+}
+
 /*!
   Transforms a margin side to the logically corresponding axis type. (QCP::msLeft to
   QCPAxis::atLeft, QCP::msRight to QCPAxis::atRight, etc.)
@@ -1894,12 +1913,49 @@ QCPAxis::AxisType QCPAxis::opposite(QCPAxis::AxisType type)
   \ref setAutoTicks is set to true, appropriate tick values are determined automatically via \ref
   generateAutoTicks. If it's set to false, the signal ticksRequest is emitted, which can be used to
   provide external tick positions. Then the sub tick vectors and tick label vectors are created.
+  
+  Fully automatic tick and tick label vectors are kept until one of the parameters in \ref
+  generateTickParameterHash changes, or \ref invalidateTickCache is called.
+  
+  If the plotting hint \ref QCP::phSmallMultiples is set, fully automatic tick and tick label
+  vectors are shared among all axes of the plot that have identical tick parameters (see \ref
+  generateTickParameterHash), so they are only generated once per replot.
 */
 void QCPAxis::setupTickVectors()
 {
   if (!mParentPlot) return;
   if ((!mTicks && !mTickLabels && !mGrid->visible()) || mRange.size() <= 0) return;
   
+  // if ticks and labels are fully automatic, reuse the vectors of the last call if none of the
+  // parameters they depend on have changed (e.g. only the plottable data changed):
+  QByteArray newTickParameterHash;
+  bool shareTicks = false;
+  if (mAutoTicks && mAutoTickLabels)
+  {
+    newTickParameterHash = generateTickParameterHash();
+    if (newTickParameterHash == mTickParameterHash)
+      return;
+    // in small multiples mode, adopt the vectors of another axis with identical parameters from this replot, if there is one:
+    shareTicks = mParentPlot->plottingHints().testFlag(QCP::phSmallMultiples);
+    if (shareTicks)
+    {
+      QHash<QByteArray, SharedTicks>::const_iterator it = mParentPlot->mSharedTicks.constFind(newTickParameterHash);
+      if (it != mParentPlot->mSharedTicks.constEnd())
+      {
+        mTickStep = it.value().tickStep;
+        mSubTickCount = it.value().subTickCount;
+        mLowestVisibleTick = it.value().lowestVisibleTick;
+        mHighestVisibleTick = it.value().highestVisibleTick;
+        mTickVector = it.value().tickVector;
+        mSubTickVector = it.value().subTickVector;
+        mTickVectorLabels = it.value().tickVectorLabels;
+        mTickParameterHash = newTickParameterHash;
+        return;
+      }
+    }
+  }
+  mTickParameterHash = newTickParameterHash;
+  
   // fill tick vectors, either by auto generating or by notifying user to fill the vectors himself
   if (mAutoTicks)
   {
@@ -1977,6 +2033,18 @@ void QCPAxis::setupTickVectors()
     if (mTickVectorLabels.size() < mTickVector.size())
       mTickVectorLabels.resize(mTickVector.size());
   }
+  
+  if (shareTicks)
+  {
+    SharedTicks &shared = mParentPlot->mSharedTicks[mTickParameterHash];
+    shared.tickStep = mTickStep;
+    shared.subTickCount = mSubTickCount;
+    shared.lowestVisibleTick = mLowestVisibleTick;
+    shared.highestVisibleTick = mHighestVisibleTick;
+    shared.tickVector = mTickVector;
+    shared.subTickVector = mSubTickVector;
+    shared.tickVectorLabels = mTickVectorLabels;
+  }
 }
 
 /*! \internal
@@ -1987,6 +2055,10 @@ void QCPAxis::setupTickVectors()
  
   If the scale is logarithmic, \ref setAutoTickCount is ignored, and one tick is generated at every
   power of the current logarithm base, set via \ref setScaleLogBase.
+  
+  The generated ticks are reused in following replots as long as the axis parameters they depend
+  on don't change (see \ref setupTickVectors). If a reimplementation depends on other parameters,
+  call \ref invalidateTickCache whenever they change.
 */
 void QCPAxis::generateAutoTicks()
 {
@@ -2263,6 +2335,47 @@ void QCPAxis::visibleTickBounds(int &lowIndex, int &highIndex) const
     highIndex = lowIndex-1;
 }
 
+/*! \internal
+  
+  Returns a byte array that identifies all parameters the automatically generated tick, sub tick
+  and tick label vectors depend on. This is used by \ref setupTickVectors to determine whether the
+  vectors of the previous call can be reused.
+  
+  The tick step and sub tick count are only included if they aren't determined automatically,
+  because in that case, they are a result of the tick generation rather than a parameter. The
+  length of the axis in pixels is included, so reimplementations of \ref generateAutoTicks may take
+  it into account. The class name is included, so axes of subclasses with different tick
+  generation don't share their ticks with other axes in small multiples mode.
+  
+  Parameters that aren't part of the hash must discard the reusable vectors with \ref
+  invalidateTickCache when they change.
+*/
+QByteArray QCPAxis::generateTickParameterHash() const
+{
+  QByteArray result(metaObject()->className());
+  result.append(' ');
+  result.append(QByteArray::number(mRange.lower, 'g', 17)+' '+QByteArray::number(mRange.upper, 'g', 17)+' ');
+  result.append(QByteArray::number((int)mScaleType)+' '+QByteArray::number(mScaleLogBase, 'g', 17)+' ');
+  result.append(QByteArray::number((int)mAutoTickStep)+' '+QByteArray::number((int)mAutoSubTicks)+' '+QByteArray::number(mAutoTickCount)+' ');
+  if (!mAutoTickStep)
+    result.append(QByteArray::number(mTickStep, 'g', 17)+' ');
+  if (!mAutoSubTicks)
+    result.append(QByteArray::number(mSubTickCount)+' ');
+  result.append(QByteArray::number((int)mTickLabelType)+' ');
+  if (mTickLabelType == ltNumber)
+  {
+    result.append(QByteArray(1, mNumberFormatChar.toLatin1())+QByteArray::number(mNumberPrecision)+' ');
+  } else
+  {
+    result.append(mDateTimeFormat.toUtf8()+' ');
+    result.append(QByteArray::number((int)mDateTimeSpec)+' ');
+  }
+  result.append(mParentPlot->locale().name().toLatin1()+' ');
+  if (mAxisRect)
+    result.append(QByteArray::number(mOrientation == Qt::Horizontal ? mAxisRect->width() : mAxisRect->height()));
+  return result;
+}
+
 /*! \internal
   
   A log function with the base mScaleLogBase, used mostly for coordinate transforms in logarithmic
@@ -2466,6 +2579,8 @@ QCPAxisPainterPrivate::QCPAxisPainterPrivate(QCustomPlot *parentPlot) :
   mParentPlot(parentPlot),
   mLabelCache(16) // cache at most 16 (tick) labels
 {
+  mGlyphAtlas.ascent = 0;
+  mGlyphAtlas.height = 0;
 }
 
 QCPAxisPainterPrivate::~QCPAxisPainterPrivate()
@@ -2671,6 +2786,10 @@ void QCPAxisPainterPrivate::draw(QCPPainter *painter)
   
   Returns the size ("margin" in QCPAxisRect context, so measured perpendicular to the axis backbone
   direction) needed to fit the axis.
+  
+  If the plotting hint \ref QCP::phSmallMultiples is set, the extent of the tick labels is shared
+  among all axis painters of the plot that show the same labels with the same label parameters
+  (see \ref generateLabelParameterHash), so the labels are only measured once per replot.
 */
 int QCPAxisPainterPrivate::size() const
 {
@@ -2686,8 +2805,26 @@ int QCPAxisPainterPrivate::size() const
     QSize tickLabelsSize(0, 0);
     if (!tickLabels.isEmpty())
     {
-      for (int i=0; i<tickLabels.size(); ++i)
-        getMaxTickLabelSize(tickLabelFont, tickLabels.at(i), &tickLabelsSize);
+      if (mParentPlot->plottingHints().testFlag(QCP::phSmallMultiples))
+      {
+        QByteArray extentKey = generateLabelParameterHash();
+        for (int i=0; i<tickLabels.size(); ++i)
+          extentKey.append('\n'+tickLabels.at(i).toUtf8());
+        QHash<QByteArray, QSize>::const_iterator it = mParentPlot->mSharedTickLabelExtents.constFind(extentKey);
+        if (it != mParentPlot->mSharedTickLabelExtents.constEnd())
+        {
+          tickLabelsSize = it.value();
+        } else
+        {
+          for (int i=0; i<tickLabels.size(); ++i)
+            getMaxTickLabelSize(tickLabelFont, tickLabels.at(i), &tickLabelsSize);
+          mParentPlot->mSharedTickLabelExtents.insert(extentKey, tickLabelsSize);
+        }
+      } else
+      {
+        for (int i=0; i<tickLabels.size(); ++i)
+          getMaxTickLabelSize(tickLabelFont, tickLabels.at(i), &tickLabelsSize);
+      }
       result += QCPAxis::orientation(type) == Qt::Horizontal ? tickLabelsSize.height() : tickLabelsSize.width();
     result += tickLabelPadding;
     }
@@ -2714,6 +2851,7 @@ int QCPAxisPainterPrivate::size() const
 void QCPAxisPainterPrivate::clearCache()
 {
   mLabelCache.clear();
+  mGlyphAtlas = GlyphAtlas();
 }
 
 /*! \internal
@@ -2767,11 +2905,33 @@ void QCPAxisPainterPrivate::placeTickLabel(QCPPainter *painter, double position,
     case QCPAxis::atTop:    labelAnchor = QPointF(position, axisRect.top()-distanceToAxis-offset); break;
     case QCPAxis::atBottom: labelAnchor = QPointF(position, axisRect.bottom()+distanceToAxis+offset); break;
   }
-  if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && !painter->modes().testFlag(QCPPainter::pmNoCaching)) // label caching enabled
+  bool cachingEnabled = mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && !painter->modes().testFlag(QCPPainter::pmNoCaching);
+  if (cachingEnabled && isGlyphComposable(text)) // compose label from cached glyphs, so labels never seen before don't need text layout
+  {
+    updateGlyphAtlas(painter->font(), painter->pen().color(), text);
+    TickLabelData labelData = getGlyphLabelData(painter->font(), text);
+    QPointF finalPosition = labelAnchor + getTickLabelDrawOffset(labelData);
+    // if label would be partly clipped by widget border on sides, don't draw it (only for outside tick labels):
+    bool labelClippedByBorder = false;
+    if (tickLabelSide == QCPAxis::lsOutside)
+    {
+      if (QCPAxis::orientation(type) == Qt::Horizontal)
+        labelClippedByBorder = finalPosition.x()+(labelData.rotatedTotalBounds.width()+labelData.rotatedTotalBounds.left()) > viewportRect.right() || finalPosition.x()+labelData.rotatedTotalBounds.left() < viewportRect.left();
+      else
+        labelClippedByBorder = finalPosition.y()+(labelData.rotatedTotalBounds.height()+labelData.rotatedTotalBounds.top()) > viewportRect.bottom() || finalPosition.y()+labelData.rotatedTotalBounds.top() < viewportRect.top();
+    }
+    if (!labelClippedByBorder)
+    {
+      drawGlyphLabel(painter, finalPosition.x(), finalPosition.y(), text);
+      finalSize = labelData.rotatedTotalBounds.size();
+    }
+  } else if (cachingEnabled) // label caching enabled
   {
     CachedLabel *cachedLabel = mLabelCache.take(text); // attempt to get label from cache
+    QCPReplotProfile *profile = mParentPlot->currentReplotProfile();
     if (!cachedLabel)  // no cached label existed, create it
     {
+      if (profile) ++profile->cacheMisses;
       cachedLabel = new CachedLabel;
       TickLabelData labelData = getTickLabelData(painter->font(), text);
       cachedLabel->offset = getTickLabelDrawOffset(labelData)+labelData.rotatedTotalBounds.topLeft();
@@ -2780,7 +2940,8 @@ void QCPAxisPainterPrivate::placeTickLabel(QCPPainter *painter, double position,
       QCPPainter cachePainter(&cachedLabel->pixmap);
       cachePainter.setPen(painter->pen());
       drawTickLabel(&cachePainter, -labelData.rotatedTotalBounds.topLeft().x(), -labelData.rotatedTotalBounds.topLeft().y(), labelData);
-    }
+    } else if (profile)
+      ++profile->cacheHits;
     // if label would be partly clipped by widget border on sides, don't draw it (only for outside tick labels):
     bool labelClippedByBorder = false;
     if (tickLabelSide == QCPAxis::lsOutside)
@@ -3045,7 +3206,11 @@ void QCPAxisPainterPrivate::getMaxTickLabelSize(const QFont &font, const QString
 {
   // note: this function must return the same tick label sizes as the placeTickLabel function.
   QSize finalSize;
-  if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && mLabelCache.contains(text)) // label caching enabled and have cached label
+  bool cachingEnabled = mParentPlot->plottingHints().testFlag(QCP::phCacheLabels);
+  if (cachingEnabled && isGlyphComposable(text)) // label is composed of cached glyphs, measure from glyph advances
+  {
+    finalSize = getGlyphLabelData(font, text).rotatedTotalBounds.size();
+  } else if (cachingEnabled && mLabelCache.contains(text)) // label caching enabled and have cached label
   {
     const CachedLabel *cachedLabel = mLabelCache.object(text);
     finalSize = cachedLabel->pixmap.size();
@@ -3061,3 +3226,157 @@ void QCPAxisPainterPrivate::getMaxTickLabelSize(const QFont &font, const QString
   if (finalSize.height() > tickLabelsSize->height())
     tickLabelsSize->setHeight(finalSize.height());
 }
+
+/*! \internal
+  
+  Returns whether the tick label \a text can be composed of individually cached glyphs (see \ref
+  updateGlyphAtlas), instead of being rendered as a whole.
+  
+  This is the case for labels consisting only of digits, signs, separators and spaces, such as
+  typical number and date/time labels. For these characters, fonts usually have uniform advances
+  and no kerning, so the composed label looks identical to the one rendered as a whole. Labels that
+  require beautiful decimal powers (see \ref getTickLabelData) are not composable.
+  
+  Rotated tick labels (\ref QCPAxis::setTickLabelRotation) are never composable, because unrotated
+  glyph sprites drawn with a rotated painter would be resampled and look different from rotated
+  text. They are rendered as a whole and cached like other labels instead.
+*/
+bool QCPAxisPainterPrivate::isGlyphComposable(const QString &text) const
+{
+  if (text.isEmpty() || !qFuzzyIsNull(tickLabelRotation))
+    return false;
+  if (substituteExponent && text.contains(QLatin1Char('e')))
+    return false;
+  for (int i=0; i<text.size(); ++i)
+  {
+    switch (text.at(i).unicode())
+    {
+      case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7': case '8': case '9':
+      case '.': case ',': case ':': case ';': case '-': case '+': case '/': case ' ':
+      case 0x2212: // minus sign, used by some locales
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+/*! \internal
+  
+  Returns the tick label data of the glyph composable \a text (see \ref isGlyphComposable), as it
+  will be drawn by \ref drawGlyphLabel. The bounds are determined from the glyph advances of \a
+  font, which are taken from the glyph atlas if available, so no text layout is necessary. The
+  height is the line height QFontMetrics::boundingRect returns for single line text, so the bounds
+  match the ones of \ref getTickLabelData.
+*/
+QCPAxisPainterPrivate::TickLabelData QCPAxisPainterPrivate::getGlyphLabelData(const QFont &font, const QString &text) const
+{
+  TickLabelData result;
+  result.basePart = text;
+  result.baseFont = font;
+  if (result.baseFont.pointSizeF() > 0) // same correction as in getTickLabelData
+    result.baseFont.setPointSizeF(result.baseFont.pointSizeF()+0.05);
+  
+  int width = 0;
+  int height = 0;
+  if (mGlyphAtlas.font == font && mGlyphAtlas.height > 0)
+  {
+    height = mGlyphAtlas.height;
+    for (int i=0; i<text.size(); ++i)
+    {
+      QHash<QChar, int>::const_iterator it = mGlyphAtlas.advances.constFind(text.at(i));
+      width += it != mGlyphAtlas.advances.constEnd() ? it.value() : QFontMetrics(result.baseFont).width(text.at(i));
+    }
+  } else
+  {
+    QFontMetrics metrics(result.baseFont);
+    height = metrics.boundingRect(0, 0, 0, 0, Qt::TextDontClip, QString(QLatin1Char('0'))).height();
+    for (int i=0; i<text.size(); ++i)
+      width += metrics.width(text.at(i));
+  }
+  result.totalBounds = QRect(0, 0, width, height);
+  result.rotatedTotalBounds = result.totalBounds; // composable labels are never rotated
+  return result;
+}
+
+/*! \internal
+  
+  Makes sure the glyph atlas contains sprites of all characters in \a text, rendered with \a font
+  and \a color. If the font or color differs from the ones the atlas was built for, the atlas is
+  rebuilt.
+  
+  The atlas is a single pixmap holding the sprites side by side. Since composable labels only use a
+  small set of characters (see \ref isGlyphComposable), new sprites are only needed during the
+  first few replots, after which all labels are composed from existing sprites.
+*/
+void QCPAxisPainterPrivate::updateGlyphAtlas(const QFont &font, const QColor &color, const QString &text)
+{
+  if (mGlyphAtlas.font != font || mGlyphAtlas.color != color || mGlyphAtlas.height == 0)
+  {
+    mGlyphAtlas = GlyphAtlas();
+    mGlyphAtlas.font = font;
+    mGlyphAtlas.color = color;
+    mGlyphAtlas.ascent = 0;
+    mGlyphAtlas.height = 0;
+  }
+  
+  QString missing;
+  for (int i=0; i<text.size(); ++i)
+  {
+    if (!mGlyphAtlas.glyphRects.contains(text.at(i)) && !missing.contains(text.at(i)))
+      missing.append(text.at(i));
+  }
+  if (missing.isEmpty())
+    return;
+  
+  QFont glyphFont = font;
+  if (glyphFont.pointSizeF() > 0) // same correction as in getTickLabelData
+    glyphFont.setPointSizeF(glyphFont.pointSizeF()+0.05);
+  QFontMetrics metrics(glyphFont);
+  const int padding = 2; // space around each sprite, for glyphs reaching beyond their advance
+  mGlyphAtlas.ascent = metrics.ascent();
+  mGlyphAtlas.height = metrics.boundingRect(0, 0, 0, 0, Qt::TextDontClip, QString(QLatin1Char('0'))).height(); // same line height as labels rendered as a whole
+  
+  int oldWidth = mGlyphAtlas.pixmap.isNull() ? 0 : mGlyphAtlas.pixmap.width();
+  int newWidth = oldWidth;
+  for (int i=0; i<missing.size(); ++i)
+    newWidth += metrics.width(missing.at(i))+2*padding;
+  QPixmap newPixmap(newWidth, mGlyphAtlas.height);
+  newPixmap.fill(Qt::transparent);
+  QCPPainter atlasPainter(&newPixmap);
+  if (oldWidth > 0)
+    atlasPainter.drawPixmap(0, 0, mGlyphAtlas.pixmap);
+  atlasPainter.setFont(glyphFont);
+  atlasPainter.setPen(color);
+  int x = oldWidth;
+  for (int i=0; i<missing.size(); ++i)
+  {
+    const QChar c = missing.at(i);
+    int advance = metrics.width(c);
+    atlasPainter.drawText(QPointF(x+padding, mGlyphAtlas.ascent), QString(c));
+    mGlyphAtlas.glyphRects.insert(c, QRect(x, 0, advance+2*padding, mGlyphAtlas.height));
+    mGlyphAtlas.advances.insert(c, advance);
+    x += advance+2*padding;
+  }
+  atlasPainter.end();
+  mGlyphAtlas.pixmap = newPixmap;
+}
+
+/*! \internal
+  
+  Draws the glyph composable tick label \a text (see \ref isGlyphComposable) with \a painter, with
+  the top left corner of the label at the pixel position \a x and \a y. The label is composed of
+  sprites from the glyph atlas, which must have been prepared with \ref updateGlyphAtlas.
+*/
+void QCPAxisPainterPrivate::drawGlyphLabel(QCPPainter *painter, double x, double y, const QString &text) const
+{
+  const int padding = 2; // must match the padding in updateGlyphAtlas
+  double penX = x;
+  for (int i=0; i<text.size(); ++i)
+  {
+    const QRect sprite = mGlyphAtlas.glyphRects.value(text.at(i));
+    painter->drawPixmap(QPointF(penX-padding, y), mGlyphAtlas.pixmap, sprite);
+    penX += mGlyphAtlas.advances.value(text.at(i));
+  }
+}
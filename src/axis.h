@@ -328,6 +328,7 @@ public:
   QList<QCPAbstractPlottable*> plottables() const;
   QList<QCPGraph*> graphs() const;
   QList<QCPAbstractItem*> items() const;
+  void invalidateTickCache();
   
   static AxisType marginSideToAxisType(QCP::MarginSide side);
   static Qt::Orientation orientation(AxisType type) { return type==atBottom||type==atTop ? Qt::Horizontal : Qt::Vertical; }
@@ -342,6 +343,15 @@ signals:
   void selectableChanged(const QCPAxis::SelectableParts &parts);
 
 protected:
+  struct SharedTicks
+  {
+    double tickStep;
+    int subTickCount;
+    int lowestVisibleTick, highestVisibleTick;
+    QVector<double> tickVector, subTickVector;
+    QVector<QString> tickVectorLabels;
+  };
+  
   // property members:
   // axis base:
   AxisType mAxisType;
@@ -391,6 +401,7 @@ protected:
   QVector<double> mTickVector;
   QVector<QString> mTickVectorLabels;
   QVector<double> mSubTickVector;
+  QByteArray mTickParameterHash;
   bool mCachedMarginValid;
   int mCachedMargin;
   
@@ -410,6 +421,7 @@ protected:
   
   // non-virtual methods:
   void visibleTickBounds(int &lowIndex, int &highIndex) const;
+  QByteArray generateTickParameterHash() const;
   double baseLog(double value) const;
   double basePow(double value) const;
   QPen getBasePen() const;
@@ -484,9 +496,19 @@ protected:
     QRect baseBounds, expBounds, totalBounds, rotatedTotalBounds;
     QFont baseFont, expFont;
   };
+  struct GlyphAtlas
+  {
+    QFont font;
+    QColor color;
+    QPixmap pixmap;
+    QHash<QChar, QRect> glyphRects; // sprite of each glyph inside pixmap, including padding
+    QHash<QChar, int> advances;
+    int ascent, height;
+  };
   QCustomPlot *mParentPlot;
   QByteArray mLabelParameterHash; // to determine whether mLabelCache needs to be cleared due to changed parameters
   QCache<QString, CachedLabel> mLabelCache;
+  GlyphAtlas mGlyphAtlas;
   QRect mAxisSelectionBox, mTickLabelsSelectionBox, mLabelSelectionBox;
   
   virtual QByteArray generateLabelParameterHash() const;
@@ -496,6 +518,10 @@ protected:
   virtual TickLabelData getTickLabelData(const QFont &font, const QString &text) const;
   virtual QPointF getTickLabelDrawOffset(const TickLabelData &labelData) const;
   virtual void getMaxTickLabelSize(const QFont &font, const QString &text, QSize *tickLabelsSize) const;
+  bool isGlyphComposable(const QString &text) const;
+  TickLabelData getGlyphLabelData(const QFont &font, const QString &text) const;
+  void updateGlyphAtlas(const QFont &font, const QColor &color, const QString &text);
+  void drawGlyphLabel(QCPPainter *painter, double x, double y, const QString &text) const;
 };
 
 #endif // QCP_AXIS_H
@@ -0,0 +1,469 @@
+/***************************************************************************
+**                                                                        **
+**  QCustomPlot, an easy to use, modern plotting widget for Qt            **
+**  Copyright (C) 2011-2015 Emanuel Eichhammer                            **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Emanuel Eichhammer                                   **
+**  Website/Contact: http://www.qcustomplot.com/                          **
+**             Date: 25.04.15                                             **
+**          Version: 1.3.1                                                **
+****************************************************************************/
+
+#include "batchexporter.h"
+
+#include "core.h"
+#include "painter.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPBatchExportTask
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPBatchExportTask
+  \brief A single file export job of a QCPBatchExporter
+  
+  \internal
+  
+  This is a helper class for \ref QCPBatchExporter. It holds the already rendered content of one
+  export (either an \a image for rastered formats or a recorded \a picture for PDF) and encodes
+  and writes it to \a fileName when it's run by the thread pool of the exporter.
+*/
+
+/*!
+  Creates a new, empty export task that reports back to \a exporter when it's finished.
+*/
+QCPBatchExportTask::QCPBatchExportTask(QCPBatchExporter *exporter) :
+  exporter(exporter),
+  quality(-1)
+{
+  setAutoDelete(true);
+}
+
+/*!
+  Encodes and writes the content of this task to the file. This is called in a worker thread of
+  the thread pool.
+*/
+void QCPBatchExportTask::run()
+{
+  bool success;
+  if (!image.isNull())
+    success = image.save(fileName, format.constData(), quality);
+  else
+    success = QCPBatchExporter::writePdf(fileName, picture, pdfSize, pdfCreator, pdfTitle);
+  // release the rendered content before reporting back, so the memory of finished tasks isn't held while the exporter accepts new ones:
+  image = QImage();
+  picture = QPicture();
+  exporter->taskFinished(fileName, success);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPBatchExporter
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPBatchExporter
+  \brief Exports many plots or many frames of a plot to files, using multiple threads
+  
+  When a large number of image or PDF files need to be created, e.g. one file per data set or one
+  file per frame of an animation, the time spent encoding and writing the files (PNG compression,
+  PDF generation) is often larger than the time needed to actually draw the plot. QCPBatchExporter
+  moves this work to a thread pool, so it is performed on all available cores while the calling
+  thread already draws the next plot.
+  
+  Use it like the \ref QCustomPlot::savePng "save..." methods of QCustomPlot: Change the plot, then
+  call one of the \a add methods (\ref addPng, \ref addJpg, \ref addBmp, \ref addRastered or \ref
+  addPdf). The plot is drawn immediately, so it may be changed again (or deleted) as soon as the
+  method returns. The file is then written in the background. Call \ref waitForFinished to wait
+  until all files are written.
+  
+  Since QCustomPlot is a QWidget, drawing the plot itself must happen in the GUI thread, and thus
+  the \a add methods must be called from there. This is also the reason why multiple plots can't
+  be drawn at the same time. Only the steps that don't access the plot are parallelized.
+  
+  To limit the memory used by rendered but not yet written files, at most \ref maxPendingCount
+  exports are held at the same time. If this number is reached, the \a add methods block until a
+  worker thread has finished a file.
+  
+  The number of successfully written and failed files is available via \ref exportedCount and
+  \ref failedCount, the achieved throughput in files per second via \ref throughput. Additionally,
+  the signal \ref fileExported is emitted for every file. It is emitted in the thread the exporter
+  lives in (usually the GUI thread), once control returns to its event loop.
+*/
+
+/* start of documentation of signals */
+
+/*! \fn void QCPBatchExporter::fileExported(const QString &fileName, bool success)
+  
+  This signal is emitted when the export of \a fileName has finished. \a success is false if the
+  file couldn't be written.
+  
+  The worker thread that wrote the file posts the signal to the thread of the exporter, so it's
+  emitted by the event loop of that thread, or at the latest by \ref waitForFinished.
+*/
+
+/* end of documentation of signals */
+
+/*!
+  Creates a batch exporter with its own thread pool. The number of threads defaults to the number
+  of cores of the system (QThread::idealThreadCount), see \ref setMaxThreadCount.
+*/
+QCPBatchExporter::QCPBatchExporter(QObject *parent) :
+  QObject(parent),
+  mMaxPendingCount(qMax(2, 2*QThread::idealThreadCount())),
+  mThreadPool(new QThreadPool(this)),
+  mPendingCount(0),
+  mExportedCount(0),
+  mFailedCount(0),
+  mTimerRunning(false),
+  mElapsedMsec(0)
+{
+}
+
+/*!
+  Waits until all pending exports are finished, before destroying the exporter.
+*/
+QCPBatchExporter::~QCPBatchExporter()
+{
+  waitForFinished();
+}
+
+/* undocumented getter */
+int QCPBatchExporter::maxThreadCount() const
+{
+  return mThreadPool->maxThreadCount();
+}
+
+/*!
+  Sets the maximum number of worker threads that encode and write files concurrently. The default
+  is the number of cores of the system.
+  
+  \see setMaxPendingCount
+*/
+void QCPBatchExporter::setMaxThreadCount(int count)
+{
+  if (count < 1)
+  {
+    qDebug() << Q_FUNC_INFO << "thread count must be at least one:" << count;
+    count = 1;
+  }
+  mThreadPool->setMaxThreadCount(count);
+}
+
+/*!
+  Sets the maximum number of exports that may be rendered but not yet written. If this number is
+  reached, the \a add methods block until a file is finished. This limits the memory consumption
+  of the rendered images and recorded PDF pages.
+  
+  The default is twice the number of cores of the system, so the worker threads always have a
+  file to work on while the next plot is drawn.
+  
+  \see setMaxThreadCount
+*/
+void QCPBatchExporter::setMaxPendingCount(int count)
+{
+  if (count < 1)
+  {
+    qDebug() << Q_FUNC_INFO << "pending count must be at least one:" << count;
+    count = 1;
+  }
+  QMutexLocker locker(&mMutex);
+  mMaxPendingCount = count;
+  mPendingDecreased.wakeAll();
+}
+
+/*!
+  Draws \a plot into a PDF page and writes it to \a fileName in the background.
+  
+  The parameters have the same meaning as for \ref QCustomPlot::savePdf. Also the resolution set
+  with \ref QCustomPlot::setVectorResolution is taken into account.
+  
+  Returns false if the page couldn't be drawn, e.g. because Qt was built without printer support.
+  Whether the file was written successfully is reported by \ref fileExported and \ref failedCount.
+  
+  \see addPng, addRastered
+*/
+bool QCPBatchExporter::addPdf(QCustomPlot *plot, const QString &fileName, bool noCosmeticPen, int width, int height, const QString &pdfCreator, const QString &pdfTitle)
+{
+#ifdef QT_NO_PRINTER
+  Q_UNUSED(plot)
+  Q_UNUSED(fileName)
+  Q_UNUSED(noCosmeticPen)
+  Q_UNUSED(width)
+  Q_UNUSED(height)
+  Q_UNUSED(pdfCreator)
+  Q_UNUSED(pdfTitle)
+  qDebug() << Q_FUNC_INFO << "Qt was built without printer support (QT_NO_PRINTER). PDF not created.";
+  return false;
+#else
+  if (!plot)
+  {
+    qDebug() << Q_FUNC_INFO << "passed plot is zero";
+    return false;
+  }
+  QSize size(plot->width(), plot->height());
+  if (width != 0 && height != 0)
+    size = QSize(width, height);
+  
+  // record the drawing commands, replaying them on the printer is done by the worker thread:
+  QCPBatchExportTask *task = new QCPBatchExportTask(this);
+  QRect oldViewport = plot->viewport();
+  plot->setViewport(QRect(QPoint(0, 0), size));
+  QCPPainter painter;
+  bool success = painter.begin(&task->picture);
+  if (success)
+  {
+    plot->drawVectorExport(&painter, noCosmeticPen);
+    painter.end();
+  }
+  plot->setViewport(oldViewport);
+  if (!success)
+  {
+    delete task;
+    return false;
+  }
+  
+  task->fileName = fileName;
+  task->pdfSize = size;
+  task->pdfCreator = pdfCreator;
+  task->pdfTitle = pdfTitle;
+  enqueue(task);
+  return true;
+#endif // QT_NO_PRINTER
+}
+
+/*!
+  Draws \a plot into an image and writes it to \a fileName as PNG in the background.
+  
+  The parameters have the same meaning as for \ref QCustomPlot::savePng.
+  
+  \see addRastered
+*/
+bool QCPBatchExporter::addPng(QCustomPlot *plot, const QString &fileName, int width, int height, double scale, int quality)
+{
+  return addRastered(plot, fileName, width, height, scale, "PNG", quality);
+}
+
+/*!
+  Draws \a plot into an image and writes it to \a fileName as JPEG in the background.
+  
+  The parameters have the same meaning as for \ref QCustomPlot::saveJpg.
+  
+  \see addRastered
+*/
+bool QCPBatchExporter::addJpg(QCustomPlot *plot, const QString &fileName, int width, int height, double scale, int quality)
+{
+  return addRastered(plot, fileName, width, height, scale, "JPG", quality);
+}
+
+/*!
+  Draws \a plot into an image and writes it to \a fileName as BMP in the background.
+  
+  The parameters have the same meaning as for \ref QCustomPlot::saveBmp.
+  
+  \see addRastered
+*/
+bool QCPBatchExporter::addBmp(QCustomPlot *plot, const QString &fileName, int width, int height, double scale)
+{
+  return addRastered(plot, fileName, width, height, scale, "BMP");
+}
+
+/*!
+  Draws \a plot into an image and writes it to \a fileName in the image format \a format in the
+  background. The parameters have the same meaning as for \ref QCustomPlot::saveRastered.
+  
+  The plot is drawn in the calling thread before this method returns, so \a plot may be changed
+  right afterwards. If \ref maxPendingCount exports are already pending, this method blocks until
+  one of them is finished.
+  
+  Returns false if the plot couldn't be drawn. Whether the file was written successfully (e.g.
+  the \a format is supported by the system) is reported by \ref fileExported and \ref failedCount.
+  
+  \see addPng, addJpg, addBmp, addPdf
+*/
+bool QCPBatchExporter::addRastered(QCustomPlot *plot, const QString &fileName, int width, int height, double scale, const char *format, int quality)
+{
+  if (!plot)
+  {
+    qDebug() << Q_FUNC_INFO << "passed plot is zero";
+    return false;
+  }
+  QImage image = plot->toPixmap(width, height, scale).toImage();
+  if (image.isNull())
+    return false;
+  
+  QCPBatchExportTask *task = new QCPBatchExportTask(this);
+  task->fileName = fileName;
+  task->image = image;
+  task->format = format;
+  task->quality = quality;
+  enqueue(task);
+  return true;
+}
+
+/*!
+  Blocks until all pending exports are written. If called from the thread the exporter lives in,
+  the \ref fileExported signals of the written files are emitted before the function returns.
+  
+  Returns true if no export failed since the exporter was created or \ref resetStatistics was
+  called.
+*/
+bool QCPBatchExporter::waitForFinished()
+{
+  mThreadPool->waitForDone();
+  if (thread() == QThread::currentThread())
+    QCoreApplication::sendPostedEvents(this, QEvent::MetaCall); // deliver the queued fileExported signals
+  QMutexLocker locker(&mMutex);
+  return mFailedCount == 0;
+}
+
+/*!
+  Returns the number of exports that were added but aren't written yet.
+*/
+int QCPBatchExporter::pendingCount() const
+{
+  QMutexLocker locker(&mMutex);
+  return mPendingCount;
+}
+
+/*!
+  Returns the number of files that were written successfully since the exporter was created or
+  \ref resetStatistics was called.
+  
+  \see failedCount, throughput
+*/
+int QCPBatchExporter::exportedCount() const
+{
+  QMutexLocker locker(&mMutex);
+  return mExportedCount;
+}
+
+/*!
+  Returns the number of files that couldn't be written since the exporter was created or \ref
+  resetStatistics was called.
+  
+  \see exportedCount
+*/
+int QCPBatchExporter::failedCount() const
+{
+  QMutexLocker locker(&mMutex);
+  return mFailedCount;
+}
+
+/*!
+  Returns the number of finished files per second. Only the time during which exports were
+  pending is taken into account, so idle periods between batches don't reduce the value.
+  
+  \see exportedCount, resetStatistics
+*/
+double QCPBatchExporter::throughput() const
+{
+  QMutexLocker locker(&mMutex);
+  int elapsed = mElapsedMsec;
+  if (mTimerRunning)
+    elapsed += mTimer.elapsed();
+  if (elapsed <= 0)
+    return 0;
+  return (mExportedCount+mFailedCount)*1000.0/(double)elapsed;
+}
+
+/*!
+  Resets the counters returned by \ref exportedCount and \ref failedCount, as well as the time
+  used to calculate the \ref throughput. Exports that are pending when this is called are counted
+  in the new statistics, once they are finished.
+*/
+void QCPBatchExporter::resetStatistics()
+{
+  QMutexLocker locker(&mMutex);
+  mExportedCount = 0;
+  mFailedCount = 0;
+  mElapsedMsec = 0;
+  if (mTimerRunning)
+    mTimer.start();
+}
+
+/*! \internal
+  
+  Hands \a task over to the thread pool. If \ref maxPendingCount tasks are already pending, blocks
+  until one of them is finished. Starts the throughput timer if the exporter was idle.
+*/
+void QCPBatchExporter::enqueue(QCPBatchExportTask *task)
+{
+  QMutexLocker locker(&mMutex);
+  while (mPendingCount >= mMaxPendingCount)
+    mPendingDecreased.wait(&mMutex);
+  if (!mTimerRunning)
+  {
+    mTimer.start();
+    mTimerRunning = true;
+  }
+  ++mPendingCount;
+  locker.unlock();
+  mThreadPool->start(task);
+}
+
+/*! \internal
+  
+  Called by a \ref QCPBatchExportTask from its worker thread, after it has written (or failed to
+  write) \a fileName. Updates the statistics, wakes a blocked \ref enqueue call and posts \ref
+  fileExported to the thread of the exporter, so receivers (and QSignalSpy) never get it from
+  several worker threads at once.
+*/
+void QCPBatchExporter::taskFinished(const QString &fileName, bool success)
+{
+  {
+    QMutexLocker locker(&mMutex);
+    --mPendingCount;
+    if (success)
+      ++mExportedCount;
+    else
+      ++mFailedCount;
+    if (mPendingCount == 0 && mTimerRunning)
+    {
+      mElapsedMsec += mTimer.elapsed();
+      mTimerRunning = false;
+    }
+    mPendingDecreased.wakeAll();
+  }
+  QMetaObject::invokeMethod(this, "fileExported", Qt::QueuedConnection, Q_ARG(QString, fileName), Q_ARG(bool, success));
+}
+
+/*! \internal
+  
+  Writes the drawing commands recorded in \a picture to a single page PDF file \a fileName with
+  a page of \a size. This doesn't access any plot, so it is safe to call from a worker thread.
+  
+  Returns whether the PDF could be created.
+*/
+bool QCPBatchExporter::writePdf(const QString &fileName, const QPicture &picture, const QSize &size, const QString &pdfCreator, const QString &pdfTitle)
+{
+#ifdef QT_NO_PRINTER
+  Q_UNUSED(fileName)
+  Q_UNUSED(picture)
+  Q_UNUSED(size)
+  Q_UNUSED(pdfCreator)
+  Q_UNUSED(pdfTitle)
+  return false;
+#else
+  QPrinter printer(QPrinter::ScreenResolution);
+  QCustomPlot::setupPdfPrinter(&printer, fileName, size, pdfCreator, pdfTitle);
+  QPainter painter;
+  if (!painter.begin(&printer))
+    return false;
+  painter.setWindow(QRect(QPoint(0, 0), size));
+  painter.drawPicture(0, 0, picture);
+  return painter.end();
+#endif // QT_NO_PRINTER
+}
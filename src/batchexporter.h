@@ -0,0 +1,110 @@
+/***************************************************************************
+**                                                                        **
+**  QCustomPlot, an easy to use, modern plotting widget for Qt            **
+**  Copyright (C) 2011-2015 Emanuel Eichhammer                            **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Emanuel Eichhammer                                   **
+**  Website/Contact: http://www.qcustomplot.com/                          **
+**             Date: 25.04.15                                             **
+**          Version: 1.3.1                                                **
+****************************************************************************/
+
+#ifndef QCP_BATCHEXPORTER_H
+#define QCP_BATCHEXPORTER_H
+
+#include "global.h"
+
+class QCustomPlot;
+class QCPBatchExporter;
+
+class QCPBatchExportTask : public QRunnable
+{
+public:
+  explicit QCPBatchExportTask(QCPBatchExporter *exporter);
+  
+  virtual void run();
+  
+  QCPBatchExporter *exporter;
+  QString fileName;
+  // rastered export:
+  QImage image;
+  QByteArray format;
+  int quality;
+  // pdf export:
+  QPicture picture;
+  QSize pdfSize;
+  QString pdfCreator, pdfTitle;
+};
+
+
+class QCP_LIB_DECL QCPBatchExporter : public QObject
+{
+  Q_OBJECT
+  /// \cond INCLUDE_QPROPERTIES
+  Q_PROPERTY(int maxThreadCount READ maxThreadCount WRITE setMaxThreadCount)
+  Q_PROPERTY(int maxPendingCount READ maxPendingCount WRITE setMaxPendingCount)
+  /// \endcond
+public:
+  explicit QCPBatchExporter(QObject *parent=0);
+  virtual ~QCPBatchExporter();
+  
+  // getters:
+  int maxThreadCount() const;
+  int maxPendingCount() const { return mMaxPendingCount; }
+  
+  // setters:
+  void setMaxThreadCount(int count);
+  void setMaxPendingCount(int count);
+  
+  // non-property methods:
+  bool addPdf(QCustomPlot *plot, const QString &fileName, bool noCosmeticPen=false, int width=0, int height=0, const QString &pdfCreator=QString(), const QString &pdfTitle=QString());
+  bool addPng(QCustomPlot *plot, const QString &fileName, int width=0, int height=0, double scale=1.0, int quality=-1);
+  bool addJpg(QCustomPlot *plot, const QString &fileName, int width=0, int height=0, double scale=1.0, int quality=-1);
+  bool addBmp(QCustomPlot *plot, const QString &fileName, int width=0, int height=0, double scale=1.0);
+  bool addRastered(QCustomPlot *plot, const QString &fileName, int width, int height, double scale, const char *format, int quality=-1);
+  bool waitForFinished();
+  int pendingCount() const;
+  int exportedCount() const;
+  int failedCount() const;
+  double throughput() const;
+  void resetStatistics();
+  
+signals:
+  void fileExported(const QString &fileName, bool success);
+  
+protected:
+  // property members:
+  int mMaxPendingCount;
+  
+  // non-property members:
+  QThreadPool *mThreadPool;
+  mutable QMutex mMutex;
+  QWaitCondition mPendingDecreased;
+  int mPendingCount, mExportedCount, mFailedCount;
+  QTime mTimer;
+  bool mTimerRunning;
+  int mElapsedMsec;
+  
+  // non-virtual methods:
+  void enqueue(QCPBatchExportTask *task);
+  void taskFinished(const QString &fileName, bool success);
+  static bool writePdf(const QString &fileName, const QPicture &picture, const QSize &size, const QString &pdfCreator, const QString &pdfTitle);
+  
+  friend class QCPBatchExportTask;
+};
+
+#endif // QCP_BATCHEXPORTER_H
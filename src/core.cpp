@@ -33,6 +33,7 @@
 #include "layoutelements/layoutelement-axisrect.h"
 #include "layoutelements/layoutelement-legend.h"
 #include "layoutelements/layoutelement-plottitle.h"
+#include "layoutelements/layoutelement-colorscale.h"
 #include "plottable.h"
 #include "plottables/plottable-graph.h"
 #include "item.h"
@@ -73,6 +74,23 @@
   one cell with the main QCPAxisRect inside.
 */
 
+/*! \fn const QCPReplotProfile &QCustomPlot::replotProfile() const
+  
+  Returns the timings and counters of the last replot, if profiling is enabled with \ref
+  setProfiling.
+  
+  \see replotProfiled
+*/
+
+/*! \fn QCPReplotProfile *QCustomPlot::currentReplotProfile() const
+  
+  Returns the profile that is being recorded during a profiled replot, or 0 outside of a replot or
+  if profiling is disabled. Custom plottables and layerables may use it in their draw methods to
+  add their own counts, e.g. to \ref QCPReplotProfile::pointsDrawn.
+  
+  \see setProfiling
+*/
+
 /* end of documentation of inline functions */
 /* start of documentation of signals */
 
@@ -260,7 +278,18 @@
   It is safe to mutually connect the replot slot with this signal on two QCustomPlots to make them
   replot synchronously, it won't cause an infinite recursion.
   
-  \see replot, beforeReplot
+  \see replot, beforeReplot, replotProfiled
+*/
+
+/*! \fn void QCustomPlot::replotProfiled(const QCPReplotProfile &profile)
+  
+  If profiling is enabled with \ref setProfiling, this signal is emitted after every replot, right
+  after \ref afterReplot. \a profile contains the timings and counters of the replot.
+  
+  The profile type is registered with the meta type system, so the signal may be connected to
+  receivers in other threads with a queued connection.
+  
+  \see replotProfile
 */
 
 /* end of documentation of signals */
@@ -362,9 +391,19 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   mCurrentLayer(0),
   mPlottingHints(QCP::phCacheLabels|QCP::phForceRepaint),
   mMultiSelectModifier(Qt::ControlModifier),
+  mVectorResolution(0),
+  mProfiling(false),
+  mProfilingOverlay(false),
   mPaintBuffer(size()),
   mMouseEventElement(0),
-  mReplotting(false)
+  mReplotting(false),
+  mLayoutValid(false),
+  mLayoutPass(0),
+  mLayouting(false),
+  mCullToVisible(false),
+  mExportSamplingScale(0),
+  mCurrentReplotProfile(0),
+  mProfilePreparationTime(0)
 {
   setAttribute(Qt::WA_NoMousePropagation);
   setAttribute(Qt::WA_OpaquePaintEvent);
@@ -372,6 +411,8 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   QLocale currentLocale = locale();
   currentLocale.setNumberOptions(QLocale::OmitGroupSeparator);
   setLocale(currentLocale);
+  // allow queued connections to replotProfiled:
+  qRegisterMetaType<QCPReplotProfile>("QCPReplotProfile");
   
   // create initial layers:
   mLayers.append(new QCPLayer(this, QLatin1String("background")));
@@ -680,6 +721,51 @@ void QCustomPlot::setMultiSelectModifier(Qt::KeyboardModifier modifier)
   mMultiSelectModifier = modifier;
 }
 
+/*!
+  Sets the resolution in dots per inch of the output device that vector exports (\ref savePdf) are
+  intended for, e.g. 600 for a print.
+  
+  If \a dpi is greater than zero, graphs, curves and bars with large data sets reduce their
+  geometry during vector exports to what can be resolved at this resolution, instead of emitting
+  every visible data point. This keeps the file size and export time of plots with millions of data
+  points bounded, while the output looks the same when printed at \a dpi. Graphs use their adaptive
+  sampling algorithm (see \ref QCPGraph::setAdaptiveSampling) with one sampling interval per dot of
+  the output device, even if adaptive sampling is disabled for the screen.
+  
+  If \a dpi is zero (the default), plottables draw the same geometry in vector exports as on the
+  screen.
+*/
+void QCustomPlot::setVectorResolution(int dpi)
+{
+  mVectorResolution = qMax(0, dpi);
+}
+
+/*!
+  Sets whether replots record where their time is spent. If \a enabled, every \ref replot fills a
+  \ref QCPReplotProfile with the time of each phase (layout preparation including the tick
+  generation, margins, layout, drawing), of each layer and of each layerable's draw method, as well
+  as with the number of drawn and sampled away data points and the number of cache hits and
+  misses. The profile is available via \ref replotProfile and the signal \ref replotProfiled.
+  
+  Profiling adds a small overhead to every replot, so it's disabled by default.
+  
+  \see setProfilingOverlay
+*/
+void QCustomPlot::setProfiling(bool enabled)
+{
+  mProfiling = enabled;
+}
+
+/*!
+  Sets whether the \ref QCPReplotProfile::summary "summary" of the profile is drawn on top of the
+  plot, in the top left corner of the viewport. This only has an effect while profiling is
+  enabled with \ref setProfiling. The overlay is only drawn on the screen, not in exports.
+*/
+void QCustomPlot::setProfilingOverlay(bool enabled)
+{
+  mProfilingOverlay = enabled;
+}
+
 /*!
   Sets the viewport of this QCustomPlot. The Viewport is the area that the top level layout
   (QCustomPlot::plotLayout()) uses as its rect. Normally, the viewport is the entire widget rect.
@@ -822,7 +908,7 @@ QCPAbstractPlottable *QCustomPlot::plottable()
 */
 bool QCustomPlot::addPlottable(QCPAbstractPlottable *plottable)
 {
-  if (mPlottables.contains(plottable))
+  if (mPlottableSet.contains(plottable))
   {
     qDebug() << Q_FUNC_INFO << "plottable already added to this QCustomPlot:" << reinterpret_cast<quintptr>(plottable);
     return false;
@@ -834,6 +920,7 @@ bool QCustomPlot::addPlottable(QCPAbstractPlottable *plottable)
   }
   
   mPlottables.append(plottable);
+  mPlottableSet.insert(plottable);
   // possibly add plottable to legend:
   if (mAutoAddPlottableToLegend)
     plottable->addToLegend();
@@ -854,7 +941,7 @@ bool QCustomPlot::addPlottable(QCPAbstractPlottable *plottable)
 */
 bool QCustomPlot::removePlottable(QCPAbstractPlottable *plottable)
 {
-  if (!mPlottables.contains(plottable))
+  if (!mPlottableSet.contains(plottable))
   {
     qDebug() << Q_FUNC_INFO << "plottable not in list:" << reinterpret_cast<quintptr>(plottable);
     return false;
@@ -864,10 +951,11 @@ bool QCustomPlot::removePlottable(QCPAbstractPlottable *plottable)
   plottable->removeFromLegend();
   // special handling for QCPGraphs to maintain the simple graph interface:
   if (QCPGraph *graph = qobject_cast<QCPGraph*>(plottable))
-    mGraphs.removeOne(graph);
-  // remove plottable:
+    mGraphs.removeAt(mGraphs.lastIndexOf(graph));
+  // remove plottable (lists are searched from the back, because recently added plottables are most likely to be removed):
   delete plottable;
-  mPlottables.removeOne(plottable);
+  mPlottables.removeAt(mPlottables.lastIndexOf(plottable));
+  mPlottableSet.remove(plottable);
   return true;
 }
 
@@ -891,14 +979,15 @@ bool QCustomPlot::removePlottable(int index)
   
   Returns the number of plottables removed.
   
+  The plottables are removed in bulk, so this function takes linear time in the number of
+  plottables, also for plots with many thousand plottables.
+  
   \see removePlottable
 */
 int QCustomPlot::clearPlottables()
 {
-  int c = mPlottables.size();
-  for (int i=c-1; i >= 0; --i)
-    removePlottable(mPlottables[i]);
-  return c;
+  const QList<QCPAbstractPlottable*> plottables = mPlottables;
+  return removePlottables(plottables);
 }
 
 /*!
@@ -971,7 +1060,7 @@ QCPAbstractPlottable *QCustomPlot::plottableAt(const QPointF &pos, bool onlySele
 */
 bool QCustomPlot::hasPlottable(QCPAbstractPlottable *plottable) const
 {
-  return mPlottables.contains(plottable);
+  return mPlottableSet.contains(plottable);
 }
 
 /*!
@@ -1080,14 +1169,19 @@ bool QCustomPlot::removeGraph(int index)
 
   Returns the number of graphs removed.
   
+  Like \ref clearPlottables, the graphs are removed in bulk.
+  
   \see removeGraph
 */
 int QCustomPlot::clearGraphs()
 {
-  int c = mGraphs.size();
-  for (int i=c-1; i >= 0; --i)
-    removeGraph(mGraphs[i]);
-  return c;
+  QList<QCPAbstractPlottable*> graphs;
+#if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
+  graphs.reserve(mGraphs.size());
+#endif
+  for (int i=0; i<mGraphs.size(); ++i)
+    graphs.append(mGraphs.at(i));
+  return removePlottables(graphs);
 }
 
 /*!
@@ -1165,9 +1259,10 @@ QCPAbstractItem *QCustomPlot::item() const
 */
 bool QCustomPlot::addItem(QCPAbstractItem *item)
 {
-  if (!mItems.contains(item) && item->parentPlot() == this)
+  if (!mItemSet.contains(item) && item->parentPlot() == this)
   {
     mItems.append(item);
+    mItemSet.insert(item);
     return true;
   } else
   {
@@ -1185,10 +1280,11 @@ bool QCustomPlot::addItem(QCPAbstractItem *item)
 */
 bool QCustomPlot::removeItem(QCPAbstractItem *item)
 {
-  if (mItems.contains(item))
+  if (mItemSet.contains(item))
   {
     delete item;
-    mItems.removeOne(item);
+    mItems.removeAt(mItems.lastIndexOf(item));
+    mItemSet.remove(item);
     return true;
   } else
   {
@@ -1217,14 +1313,24 @@ bool QCustomPlot::removeItem(int index)
   
   Returns the number of items removed.
   
+  Like \ref clearPlottables, the items are removed in bulk.
+  
   \see removeItem
 */
 int QCustomPlot::clearItems()
 {
-  int c = mItems.size();
-  for (int i=c-1; i >= 0; --i)
-    removeItem(mItems[i]);
-  return c;
+  const QList<QCPAbstractItem*> items = mItems;
+  QList<QCPLayerable*> layerables;
+#if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
+  layerables.reserve(items.size());
+#endif
+  for (int i=0; i<items.size(); ++i)
+    layerables.append(items.at(i));
+  removeFromLayers(layerables);
+  mItems.clear();
+  mItemSet.clear();
+  qDeleteAll(items);
+  return items.size();
 }
 
 /*!
@@ -1296,7 +1402,7 @@ QCPAbstractItem *QCustomPlot::itemAt(const QPointF &pos, bool onlySelectable) co
 */
 bool QCustomPlot::hasItem(QCPAbstractItem *item) const
 {
-  return mItems.contains(item);
+  return mItemSet.contains(item);
 }
 
 /*!
@@ -1600,6 +1706,21 @@ QCPLayoutElement *QCustomPlot::layoutElementAt(const QPointF &pos) const
   return currentElement;
 }
 
+/*!
+  Marks the layout of this plot as outdated, so the next replot runs the margin and layout phases
+  (\ref QCPLayoutElement::upMargins, \ref QCPLayoutElement::upLayout) of all layout elements.
+
+  QCustomPlot skips these phases on a replot if nothing that may affect the geometry of the layout
+  elements changed since the last layout pass. All built-in setters that influence the layout
+  (viewport size, layout structure, size constraints, margins, axis properties, visibility,...)
+  call this function already. It only needs to be called manually if custom layout elements
+  depend on state that QCustomPlot can't observe.
+*/
+void QCustomPlot::invalidateLayout()
+{
+  mLayoutValid = false;
+}
+
 /*!
   Returns the axes that currently have selected parts, i.e. whose selection state is not \ref
   QCPAxis::spNone.
@@ -1682,6 +1803,9 @@ void QCustomPlot::deselectAll()
   Under a few circumstances, QCustomPlot causes a replot by itself. Those are resize events of the
   QCustomPlot widget and user interactions (object selection and range dragging/zooming).
   
+  At the beginning of the replot, data that was queued by other threads (see \ref QCPDataQueue) is
+  applied to the respective plottables.
+  
   Before the replot happens, the signal \ref beforeReplot is emitted. After the replot, \ref
   afterReplot is emitted. It is safe to mutually connect the replot slot with any of those two
   signals on two QCustomPlots to make them replot synchronously, it won't cause an infinite
@@ -1692,6 +1816,15 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
   if (mReplotting) // incase signals loop back to replot slot
     return;
   mReplotting = true;
+  if (mProfiling)
+  {
+    mReplotProfile.clear();
+    mCurrentReplotProfile = &mReplotProfile;
+    mProfileTimer.start();
+  }
+  // apply data that was queued by other threads, before anything is drawn or signals are emitted:
+  for (int i=0; i<mPlottables.size(); ++i)
+    mPlottables.at(i)->applyQueuedData();
   emit beforeReplot();
   
   mPaintBuffer.fill(mBackgroundBrush.style() == Qt::SolidPattern ? mBackgroundBrush.color() : Qt::transparent);
@@ -1702,16 +1835,32 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
     painter.setRenderHint(QPainter::HighQualityAntialiasing); // to make Antialiasing look good if using the OpenGL graphicssystem
     if (mBackgroundBrush.style() != Qt::SolidPattern && mBackgroundBrush.style() != Qt::NoBrush)
       painter.fillRect(mViewport, mBackgroundBrush);
+    // with small multiples, only the part of the viewport that is visible on screen is drawn:
+    mVisibleRect = isVisible() ? visibleRegion().boundingRect() & mViewport : mViewport;
+    mCullToVisible = true;
     draw(&painter);
+    mCullToVisible = false;
+    if (mCurrentReplotProfile && mProfilingOverlay)
+      drawProfilingOverlay(&painter);
     painter.end();
+    double lapStart = profileTime();
     if ((refreshPriority == rpHint && mPlottingHints.testFlag(QCP::phForceRepaint)) || refreshPriority==rpImmediate)
       repaint();
     else
       update();
+    if (mCurrentReplotProfile)
+      mCurrentReplotProfile->refreshTime = profileLap(&lapStart);
   } else // might happen if QCustomPlot has width or height zero
     qDebug() << Q_FUNC_INFO << "Couldn't activate painter on buffer. This usually happens because QCustomPlot has width or height zero.";
   
+  if (mCurrentReplotProfile)
+  {
+    mCurrentReplotProfile->totalTime = profileTime();
+    mCurrentReplotProfile = 0;
+  }
   emit afterReplot();
+  if (mProfiling)
+    emit replotProfiled(mReplotProfile);
   mReplotting = false;
 }
 
@@ -1765,6 +1914,9 @@ void QCustomPlot::rescaleAxes(bool onlyVisiblePlottables)
   \a pdfCreator and \a pdfTitle may be used to set the according metadata fields in the resulting
   PDF file.
   
+  For plots with very large data sets, set the resolution of the intended output device with \ref
+  setVectorResolution, to reduce the plottable geometry to what is visible at that resolution.
+  
   \note On Android systems, this method does nothing and issues an according qDebug warning
   message. This is also the case if for other reasons the define flag QT_NO_PRINTER is set.
   
@@ -1794,37 +1946,14 @@ bool QCustomPlot::savePdf(const QString &fileName, bool noCosmeticPen, int width
   }
   
   QPrinter printer(QPrinter::ScreenResolution);
-  printer.setOutputFileName(fileName);
-  printer.setOutputFormat(QPrinter::PdfFormat);
-  printer.setColorMode(QPrinter::Color);
-  printer.printEngine()->setProperty(QPrintEngine::PPK_Creator, pdfCreator);
-  printer.printEngine()->setProperty(QPrintEngine::PPK_DocumentName, pdfTitle);
+  setupPdfPrinter(&printer, fileName, QSize(newWidth, newHeight), pdfCreator, pdfTitle);
   QRect oldViewport = viewport();
   setViewport(QRect(0, 0, newWidth, newHeight));
-#if QT_VERSION < QT_VERSION_CHECK(5, 3, 0)
-  printer.setFullPage(true);
-  printer.setPaperSize(viewport().size(), QPrinter::DevicePixel);
-#else
-  QPageLayout pageLayout;
-  pageLayout.setMode(QPageLayout::FullPageMode);
-  pageLayout.setOrientation(QPageLayout::Portrait);
-  pageLayout.setMargins(QMarginsF(0, 0, 0, 0));
-  pageLayout.setPageSize(QPageSize(viewport().size(), QPageSize::Point, QString(), QPageSize::ExactMatch));
-  printer.setPageLayout(pageLayout);
-#endif
   QCPPainter printpainter;
   if (printpainter.begin(&printer))
   {
-    printpainter.setMode(QCPPainter::pmVectorized);
-    printpainter.setMode(QCPPainter::pmNoCaching);
-    printpainter.setMode(QCPPainter::pmNonCosmetic, noCosmeticPen);
     printpainter.setWindow(mViewport);
-    if (mBackgroundBrush.style() != Qt::NoBrush &&
-        mBackgroundBrush.color() != Qt::white &&
-        mBackgroundBrush.color() != Qt::transparent &&
-        mBackgroundBrush.color().alpha() > 0) // draw pdf background color if not white/transparent
-      printpainter.fillRect(viewport(), mBackgroundBrush);
-    draw(&printpainter);
+    drawVectorExport(&printpainter, noCosmeticPen);
     printpainter.end();
     success = true;
   }
@@ -1950,6 +2079,156 @@ bool QCustomPlot::saveBmp(const QString &fileName, int width, int height, double
   return saveRastered(fileName, width, height, scale, "BMP");
 }
 
+/*!
+  Saves a TIFF image file to \a fileName on disc. The output plot will have the dimensions \a width
+  and \a height in pixels, scaled with \a scale, like with \ref savePng.
+  
+  Unlike the other raster export functions, this function doesn't render the whole image into one
+  pixmap. The plot is rendered in horizontal strips of \a stripHeight pixel rows, which are
+  compressed and written to the file one after another. Thus the memory needed for the export only
+  depends on the width of the image and \a stripHeight, which makes this function suitable for very
+  large images, e.g. posters with tens of thousands of pixels in each dimension, where \ref
+  savePng would fail to allocate the pixmap.
+  
+  The file is written by QCustomPlot itself and doesn't require the TIFF image format plugin of Qt.
+  It is an RGBA TIFF with premultiplied (associated) alpha, each color channel stored in a separate
+  plane and compressed with the lossless PackBits scheme, which is very effective for the large
+  uniformly colored areas typical for plots. Since TIFF files use 32 bit offsets, the file size is
+  limited to 4 GB.
+  
+  The same notes as for \ref savePng apply concerning the \a width and \a height parameters, high
+  scaling factors and the selection state of the plot objects.
+  
+  Returns true on success. If this function fails, the file couldn't be written or the file would
+  exceed 4 GB.
+
+  \see savePng, saveRastered
+*/
+bool QCustomPlot::saveTiff(const QString &fileName, int width, int height, double scale, int stripHeight)
+{
+  int newWidth, newHeight;
+  if (width == 0 || height == 0)
+  {
+    newWidth = this->width();
+    newHeight = this->height();
+  } else
+  {
+    newWidth = width;
+    newHeight = height;
+  }
+  const int scaledWidth = qRound(scale*newWidth);
+  const int scaledHeight = qRound(scale*newHeight);
+  if (scaledWidth <= 0 || scaledHeight <= 0 || stripHeight <= 0)
+  {
+    qDebug() << Q_FUNC_INFO << "Invalid image or strip size:" << scaledWidth << scaledHeight << stripHeight;
+    return false;
+  }
+  stripHeight = qMin(stripHeight, scaledHeight);
+  const int stripCount = (scaledHeight+stripHeight-1)/stripHeight;
+  const int planeCount = 4; // red, green, blue, alpha
+  
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly))
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't open file for writing:" << fileName;
+    return false;
+  }
+  QDataStream stream(&file);
+  stream.setByteOrder(QDataStream::LittleEndian);
+  // header: byte order, magic number and placeholder for the image file directory offset, which is known after all strips are written:
+  stream << quint8('I') << quint8('I') << quint16(42) << quint32(0);
+  
+  // render and write strips, the strips of one plane are consecutive in the offset tables:
+  QVector<quint32> stripOffsets(stripCount*planeCount), stripByteCounts(stripCount*planeCount);
+  QImage strip(scaledWidth, stripHeight, QImage::Format_ARGB32_Premultiplied);
+  QByteArray planeRow(scaledWidth, 0);
+  QByteArray encoded;
+  QRect oldViewport = viewport();
+  setViewport(QRect(0, 0, newWidth, newHeight));
+  bool success = true;
+  for (int stripIndex=0; stripIndex<stripCount && success; ++stripIndex)
+  {
+    const int stripTop = stripIndex*stripHeight;
+    const int rowCount = qMin(stripHeight, scaledHeight-stripTop);
+    if (!drawStrip(&strip, stripTop, scale))
+    {
+      success = false;
+      break;
+    }
+    for (int plane=0; plane<planeCount; ++plane)
+    {
+      encoded.clear();
+      for (int y=0; y<rowCount; ++y)
+      {
+        const QRgb *line = reinterpret_cast<const QRgb*>(strip.scanLine(y));
+        uchar *planeData = reinterpret_cast<uchar*>(planeRow.data());
+        switch (plane)
+        {
+          case 0: for (int x=0; x<scaledWidth; ++x) planeData[x] = qRed(line[x]); break;
+          case 1: for (int x=0; x<scaledWidth; ++x) planeData[x] = qGreen(line[x]); break;
+          case 2: for (int x=0; x<scaledWidth; ++x) planeData[x] = qBlue(line[x]); break;
+          default: for (int x=0; x<scaledWidth; ++x) planeData[x] = qAlpha(line[x]); break;
+        }
+        packBits(planeData, scaledWidth, &encoded); // each row is compressed separately, as required by TIFF
+      }
+      if (file.pos()+encoded.size() > Q_INT64_C(0xFFFFFFFF))
+      {
+        qDebug() << Q_FUNC_INFO << "TIFF file would exceed 4 GB:" << fileName;
+        success = false;
+        break;
+      }
+      stripOffsets[plane*stripCount+stripIndex] = quint32(file.pos());
+      stripByteCounts[plane*stripCount+stripIndex] = encoded.size();
+      if (file.write(encoded) != encoded.size())
+      {
+        qDebug() << Q_FUNC_INFO << "Couldn't write strip to file:" << fileName;
+        success = false;
+        break;
+      }
+    }
+  }
+  setViewport(oldViewport);
+  
+  if (success)
+  {
+    // image file directory, must start on a word boundary. Values that don't fit into their entry follow the directory:
+    if (file.pos() % 2 != 0)
+      stream << quint8(0);
+    const quint16 entryCount = 11;
+    const quint32 directoryOffset = quint32(file.pos());
+    const quint32 bitsPerSampleOffset = directoryOffset + 2 + entryCount*12 + 4;
+    const quint32 stripOffsetsOffset = bitsPerSampleOffset + planeCount*2;
+    const quint32 stripByteCountsOffset = stripOffsetsOffset + stripOffsets.size()*4;
+    // entries are tag, type (3 = short, 4 = long), count and value or offset to values:
+    stream << entryCount;
+    stream << quint16(256) << quint16(4) << quint32(1) << quint32(scaledWidth); // image width
+    stream << quint16(257) << quint16(4) << quint32(1) << quint32(scaledHeight); // image length
+    stream << quint16(258) << quint16(3) << quint32(planeCount) << bitsPerSampleOffset; // bits per sample
+    stream << quint16(259) << quint16(3) << quint32(1) << quint32(32773); // compression: PackBits
+    stream << quint16(262) << quint16(3) << quint32(1) << quint32(2); // photometric interpretation: RGB
+    stream << quint16(273) << quint16(4) << quint32(stripOffsets.size()) << stripOffsetsOffset; // strip offsets
+    stream << quint16(277) << quint16(3) << quint32(1) << quint32(planeCount); // samples per pixel
+    stream << quint16(278) << quint16(4) << quint32(1) << quint32(stripHeight); // rows per strip
+    stream << quint16(279) << quint16(4) << quint32(stripByteCounts.size()) << stripByteCountsOffset; // strip byte counts
+    stream << quint16(284) << quint16(3) << quint32(1) << quint32(2); // planar configuration: separate planes
+    stream << quint16(338) << quint16(3) << quint32(1) << quint32(1); // extra samples: associated alpha
+    stream << quint32(0); // no further image file directories
+    for (int i=0; i<planeCount; ++i)
+      stream << quint16(8);
+    for (int i=0; i<stripOffsets.size(); ++i)
+      stream << stripOffsets.at(i);
+    for (int i=0; i<stripByteCounts.size(); ++i)
+      stream << stripByteCounts.at(i);
+    file.seek(4);
+    stream << directoryOffset;
+    success = stream.status() == QDataStream::Ok;
+  }
+  file.close();
+  if (!success)
+    file.remove();
+  return success;
+}
+
 /*! \internal
   
   Returns a minimum size hint that corresponds to the minimum size of the top level layout
@@ -1977,10 +2256,16 @@ QSize QCustomPlot::sizeHint() const
   
   Event handler for when the QCustomPlot widget needs repainting. This does not cause a \ref replot, but
   draws the internal buffer on the widget surface.
+  
+  The exception is the plotting hint \ref QCP::phSmallMultiples: The last replot only drew the part
+  of the widget that was visible at that time (see \ref isInViewport). If the paint event exposes
+  other parts, e.g. because the plot was scrolled inside a QScrollArea, a replot is performed first.
 */
 void QCustomPlot::paintEvent(QPaintEvent *event)
 {
-  Q_UNUSED(event);
+  const QRect exposedRect = event->rect() & mViewport;
+  if (mPlottingHints.testFlag(QCP::phSmallMultiples) && !mReplotting && !exposedRect.isEmpty() && !mVisibleRect.contains(exposedRect))
+    replot(rpQueued);
   QPainter painter(this);
   painter.drawPixmap(0, 0, mPaintBuffer);
 }
@@ -2197,28 +2482,74 @@ void QCustomPlot::wheelEvent(QWheelEvent *event)
 */
 void QCustomPlot::draw(QCPPainter *painter)
 {
-  // run through layout phases:
+  // tick vectors and label measurements are only shared among axes within one replot:
+  const bool smallMultiples = mPlottingHints.testFlag(QCP::phSmallMultiples);
+  mSharedTicks.clear();
+  mSharedTickLabelExtents.clear();
+  
+  // only measure phases if this is a profiled replot (profileLap then does nothing):
+  QCPReplotProfile *profile = mCurrentReplotProfile;
+  double lapStart = profileTime();
+  
+  // run through layout phases, the margin and layout phases only if something affecting the geometry changed:
   mPlotLayout->update(QCPLayoutElement::upPreparation);
-  mPlotLayout->update(QCPLayoutElement::upMargins);
-  mPlotLayout->update(QCPLayoutElement::upLayout);
+  if (profile) profile->preparationTime = profileLap(&lapStart)-profile->tickTime; // tick time was recorded by the axis rects
+  if (layoutChanged())
+  {
+    // each phase gets a new pass number, so results cached during one phase (e.g. margin group margins) aren't reused in the next:
+    mLayouting = true;
+    ++mLayoutPass;
+    mPlotLayout->update(QCPLayoutElement::upMargins);
+    if (profile) profile->marginsTime = profileLap(&lapStart);
+    ++mLayoutPass;
+    mPlotLayout->update(QCPLayoutElement::upLayout);
+    mLayouting = false;
+    storeLayoutState();
+    if (profile) profile->layoutTime = profileLap(&lapStart);
+  }
   
   // draw viewport background pixmap:
   drawBackground(painter);
+  if (profile) profile->backgroundTime = profileLap(&lapStart);
 
   // draw all layered objects (grid, axes, plottables, items, legend,...):
   foreach (QCPLayer *layer, mLayers)
   {
+    double layerStart = lapStart;
     foreach (QCPLayerable *child, layer->children())
     {
-      if (child->realVisibility())
+      if (child->realVisibility() && (!smallMultiples || isInViewport(child)))
       {
+        const QRect clipRect = child->clipRect();
+        if (clipRect.isEmpty()) // nothing can be drawn inside an empty clip rect, e.g. by legend items scrolled out of a virtualized legend
+          continue;
+        mProfilePreparationTime = 0;
         painter->save();
-        painter->setClipRect(child->clipRect().translated(0, -1));
+        painter->setClipRect(clipRect.translated(0, -1));
         child->applyDefaultAntialiasingHint(painter);
         child->draw(painter);
         painter->restore();
+        if (profile)
+        {
+          QCPReplotProfile::LayerableTiming timing;
+          timing.layerable = child;
+          timing.name = QLatin1String(child->metaObject()->className());
+          if (QCPAbstractPlottable *plottable = qobject_cast<QCPAbstractPlottable*>(child))
+            timing.name += QString(" \"%1\"").arg(plottable->name());
+          timing.layer = layer->name();
+          timing.drawTime = profileLap(&lapStart);
+          timing.preparationTime = qMin(mProfilePreparationTime, timing.drawTime);
+          timing.rasterizationTime = timing.drawTime-timing.preparationTime;
+          profile->layerableTimes.append(timing);
+        }
       }
     }
+    if (profile)
+    {
+      profileLap(&lapStart); // don't attribute the loop overhead of skipped layerables to the next layer
+      profile->layerTimes.append(qMakePair(layer->name(), lapStart-layerStart));
+      profile->layersTime += lapStart-layerStart;
+    }
   }
   
   /* Debug code to draw all layout element rects
@@ -2273,6 +2604,399 @@ void QCustomPlot::drawBackground(QCPPainter *painter)
 }
 
 
+/*! \internal
+  
+  Returns whether the margin and layout phases need to run on the next call of \ref draw.
+
+  This is the case if \ref invalidateLayout was called since the last layout pass, if the margin
+  of an axis that took part in the last margin calculation needs to be recalculated (e.g. because
+  its range and thus its tick labels changed), or if the size hints of a layout element whose size depends on its content (e.g. legend
+  items, plot titles) changed.
+  
+  \see storeLayoutState
+*/
+bool QCustomPlot::layoutChanged() const
+{
+  if (!mLayoutValid)
+    return true;
+  for (int i=0; i<mLayoutAxes.size(); ++i)
+  {
+    QCPAxis *axis = mLayoutAxes.at(i).data();
+    if (!axis || !axis->mCachedMarginValid)
+      return true;
+  }
+  for (int i=0; i<mLayoutHintElements.size(); ++i)
+  {
+    QCPLayoutElement *el = mLayoutHintElements.at(i).data();
+    if (!el)
+      return true;
+    if (el->minimumSizeHint() != mLayoutHints.at(i*2) || el->maximumSizeHint() != mLayoutHints.at(i*2+1))
+      return true;
+  }
+  return false;
+}
+
+/*! \internal
+  
+  Called after a layout pass in \ref draw. Marks the layout as valid and records the axes whose
+  margin was calculated in this pass, as well as the size hints of the content-sized layout
+  elements, which \ref layoutChanged compares on subsequent replots.
+  
+  Axis rects and layouts are not recorded, since their size hints only depend on properties whose
+  setters invalidate the layout anyway. Axes with a manual or hidden margin side don't have a valid
+  cached margin and are skipped, since their margin doesn't take part in the layout.
+  
+  A virtualized legend (\ref QCPLegend::setVirtualized) is recorded like a content-sized element
+  instead of its items, since its size hints only depend on the visible items.
+*/
+void QCustomPlot::storeLayoutState()
+{
+  mLayoutAxes.clear();
+  mLayoutHintElements.clear();
+  mLayoutHints.clear();
+  QList<QCPLayoutElement*> elements = mPlotLayout->elements(true);
+  for (int i=0; i<elements.size(); ++i)
+  {
+    QCPLayoutElement *el = elements.at(i);
+    if (!el)
+      continue;
+    QCPLegend *parentLegend = qobject_cast<QCPLegend*>(el->layout());
+    if (parentLegend && parentLegend->virtualized())
+      continue;
+    QCPLegend *legend = qobject_cast<QCPLegend*>(el);
+    if (QCPAxisRect *ar = qobject_cast<QCPAxisRect*>(el))
+    {
+      QList<QCPAxis*> axes = ar->axes();
+      for (int k=0; k<axes.size(); ++k)
+      {
+        if (axes.at(k)->mCachedMarginValid)
+          mLayoutAxes.append(axes.at(k));
+      }
+    } else if (!qobject_cast<QCPLayout*>(el) || (legend && legend->virtualized()))
+    {
+      if (QCPColorScale *colorScale = qobject_cast<QCPColorScale*>(el))
+      {
+        if (colorScale->axis() && colorScale->axis()->mCachedMarginValid)
+          mLayoutAxes.append(colorScale->axis());
+      }
+      mLayoutHintElements.append(el);
+      mLayoutHints.append(el->minimumSizeHint());
+      mLayoutHints.append(el->maximumSizeHint());
+    }
+  }
+  mLayoutValid = true;
+}
+
+/*! \internal
+  
+  Returns whether \a layerable may draw anything visible. This is the case if its clip rect
+  intersects the visible rect and, if it belongs to a layout element (e.g. an axis or grid of an
+  axis rect), the outer rect of that layout element intersects the visible rect.
+  
+  When drawing to the widget buffer in a \ref replot, the visible rect is the part of the viewport
+  that is currently visible on screen (QWidget::visibleRegion), e.g. the scrolled-to part of a plot
+  inside a QScrollArea. Exposing other parts later causes a replot in \ref paintEvent. For exports,
+  the visible rect is the whole viewport.
+  
+  This is used by \ref draw to skip layerables that aren't visible, if the plotting hint \ref
+  QCP::phSmallMultiples is set.
+*/
+bool QCustomPlot::isInViewport(const QCPLayerable *layerable) const
+{
+  const QRect &visibleRect = mCullToVisible ? mVisibleRect : mViewport;
+  if (!layerable->clipRect().intersects(visibleRect))
+    return false;
+  const QCPLayerable *parent = layerable;
+  while (parent)
+  {
+    if (const QCPLayoutElement *el = qobject_cast<const QCPLayoutElement*>(parent))
+      return el->outerRect().intersects(visibleRect);
+    parent = parent->parentLayerable();
+  }
+  return true;
+}
+
+/*! \internal
+  
+  Removes and deletes all \a plottables at once, including their items in the QCustomPlot::legend.
+  Returns the number of removed plottables.
+  
+  In contrast to calling \ref removePlottable for each plottable, the plottable and graph lists,
+  the legend and the layers are only traversed once. This is used by \ref clearPlottables and \ref
+  clearGraphs. All \a plottables must be in this plot.
+*/
+int QCustomPlot::removePlottables(const QList<QCPAbstractPlottable*> &plottables)
+{
+  if (plottables.isEmpty())
+    return 0;
+  
+  QSet<QCPAbstractPlottable*> removedPlottables;
+  QList<QCPLayerable*> layerables;
+#if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
+  layerables.reserve(plottables.size());
+#endif
+  for (int i=0; i<plottables.size(); ++i)
+  {
+    removedPlottables.insert(plottables.at(i));
+    layerables.append(plottables.at(i));
+  }
+  
+  // remove legend items of all plottables in one pass:
+  if (legend)
+  {
+    QSet<QCPAbstractLegendItem*> legendItems;
+    for (int i=0; i<plottables.size(); ++i)
+    {
+      if (QCPPlottableLegendItem *lip = legend->itemWithPlottable(plottables.at(i)))
+        legendItems.insert(lip);
+    }
+    legend->removeItems(legendItems);
+  }
+  // give plottables with a reimplemented removeFromLegend the chance to remove other kinds of legend items:
+  for (int i=0; i<plottables.size(); ++i)
+    plottables.at(i)->removeFromLegend();
+  // remove plottables from their layers in one pass per layer:
+  removeFromLayers(layerables);
+  // rebuild plottable and graph lists without the removed plottables:
+  QList<QCPAbstractPlottable*> remainingPlottables;
+  for (int i=0; i<mPlottables.size(); ++i)
+  {
+    if (!removedPlottables.contains(mPlottables.at(i)))
+      remainingPlottables.append(mPlottables.at(i));
+  }
+  mPlottables = remainingPlottables;
+  QList<QCPGraph*> remainingGraphs;
+  for (int i=0; i<mGraphs.size(); ++i)
+  {
+    if (!removedPlottables.contains(mGraphs.at(i)))
+      remainingGraphs.append(mGraphs.at(i));
+  }
+  mGraphs = remainingGraphs;
+  mPlottableSet.subtract(removedPlottables);
+  
+  qDeleteAll(plottables);
+  return plottables.size();
+}
+
+/*! \internal
+  
+  Removes all \a layerables from their layers, traversing the children of each affected layer only
+  once. The layer of each layerable is set to 0, so the layerables don't try to remove themselves
+  from the layers again when they are deleted.
+*/
+void QCustomPlot::removeFromLayers(const QList<QCPLayerable*> &layerables)
+{
+  QHash<QCPLayer*, QSet<QCPLayerable*> > layerChildren;
+  for (int i=0; i<layerables.size(); ++i)
+  {
+    QCPLayerable *layerable = layerables.at(i);
+    if (layerable->mLayer)
+    {
+      layerChildren[layerable->mLayer].insert(layerable);
+      layerable->mLayer = 0;
+    }
+  }
+  QHashIterator<QCPLayer*, QSet<QCPLayerable*> > it(layerChildren);
+  while (it.hasNext())
+  {
+    it.next();
+    it.key()->removeChildren(it.value());
+  }
+}
+
+#ifndef QT_NO_PRINTER
+/*! \internal
+  
+  Configures \a printer to write a single page PDF file to \a fileName, with a page that has the
+  size of a viewport of \a size. One viewport pixel corresponds to one point or one printer device
+  pixel on the page, depending on the Qt version. \a pdfCreator and \a pdfTitle are written to the
+  metadata fields of the PDF file.
+  
+  This is used by \ref savePdf and by \ref QCPBatchExporter. It doesn't access any plot state, so
+  it may be called from any thread.
+*/
+void QCustomPlot::setupPdfPrinter(QPrinter *printer, const QString &fileName, const QSize &size, const QString &pdfCreator, const QString &pdfTitle)
+{
+  printer->setOutputFileName(fileName);
+  printer->setOutputFormat(QPrinter::PdfFormat);
+  printer->setColorMode(QPrinter::Color);
+  printer->printEngine()->setProperty(QPrintEngine::PPK_Creator, pdfCreator);
+  printer->printEngine()->setProperty(QPrintEngine::PPK_DocumentName, pdfTitle);
+#if QT_VERSION < QT_VERSION_CHECK(5, 3, 0)
+  printer->setFullPage(true);
+  printer->setPaperSize(size, QPrinter::DevicePixel);
+#else
+  QPageLayout pageLayout;
+  pageLayout.setMode(QPageLayout::FullPageMode);
+  pageLayout.setOrientation(QPageLayout::Portrait);
+  pageLayout.setMargins(QMarginsF(0, 0, 0, 0));
+  pageLayout.setPageSize(QPageSize(size, QPageSize::Point, QString(), QPageSize::ExactMatch));
+  printer->setPageLayout(pageLayout);
+#endif
+}
+#endif // QT_NO_PRINTER
+
+/*! \internal
+  
+  Draws the plot for a vector export (e.g. PDF) with \a painter, which must already be active and
+  map the viewport to the page. The viewport must already be set to the export size.
+  
+  Sets the painter modes for vectorized output, draws the background only if it isn't white or
+  transparent and enables the reduction of plottable geometry, if a resolution was set with \ref
+  setVectorResolution.
+  
+  This is used by \ref savePdf and by \ref QCPBatchExporter::addPdf.
+*/
+void QCustomPlot::drawVectorExport(QCPPainter *painter, bool noCosmeticPen)
+{
+  painter->setMode(QCPPainter::pmVectorized);
+  painter->setMode(QCPPainter::pmNoCaching);
+  painter->setMode(QCPPainter::pmNonCosmetic, noCosmeticPen);
+  if (mBackgroundBrush.style() != Qt::NoBrush &&
+      mBackgroundBrush.color() != Qt::white &&
+      mBackgroundBrush.color() != Qt::transparent &&
+      mBackgroundBrush.color().alpha() > 0) // draw pdf background color if not white/transparent
+    painter->fillRect(viewport(), mBackgroundBrush);
+  if (mVectorResolution > 0)
+  {
+    // number of output dots per viewport pixel, one viewport pixel corresponds to one point or one printer device pixel, depending on how the page size is set in setupPdfPrinter:
+#if QT_VERSION < QT_VERSION_CHECK(5, 3, 0) && !defined(QT_NO_PRINTER)
+    mExportSamplingScale = mVectorResolution/(double)QPrinter(QPrinter::ScreenResolution).resolution();
+#else
+    mExportSamplingScale = mVectorResolution/72.0;
+#endif
+  }
+  draw(painter);
+  mExportSamplingScale = 0;
+}
+
+/*! \internal
+  
+  Draws the \ref QCPReplotProfile::summary "summary" of the profile that is currently being
+  recorded into the top left corner of the viewport. The total time isn't known yet at this
+  point, so it shows the time elapsed up to now.
+  
+  \see setProfilingOverlay
+*/
+void QCustomPlot::drawProfilingOverlay(QCPPainter *painter)
+{
+  QCPReplotProfile profile = *mCurrentReplotProfile;
+  profile.totalTime = profileTime();
+  const QString text = profile.summary();
+  painter->save();
+  painter->setClipRect(mViewport);
+  painter->setFont(QFont(font().family(), 8));
+  QRect textRect = painter->fontMetrics().boundingRect(mViewport.adjusted(4, 4, -4, -4), Qt::AlignLeft|Qt::AlignTop, text);
+  painter->setPen(Qt::NoPen);
+  painter->setBrush(QColor(255, 255, 255, 200));
+  painter->drawRect(textRect.adjusted(-3, -3, 3, 3));
+  painter->setPen(Qt::black);
+  painter->drawText(textRect, Qt::AlignLeft|Qt::AlignTop, text);
+  painter->restore();
+}
+
+/*! \internal
+  
+  Returns the time in milliseconds since the start of the current profiled replot, or 0 if the
+  current replot isn't profiled.
+  
+  \see profileLap
+*/
+double QCustomPlot::profileTime() const
+{
+  if (!mCurrentReplotProfile)
+    return 0;
+#if QT_VERSION >= QT_VERSION_CHECK(4, 8, 0)
+  return mProfileTimer.nsecsElapsed()*1e-6;
+#else
+  return mProfileTimer.elapsed();
+#endif
+}
+
+/*! \internal
+  
+  Returns the time in milliseconds that passed since \a lapStart and sets \a lapStart to the
+  current time (see \ref profileTime). This is used to measure consecutive phases of a profiled
+  replot.
+*/
+double QCustomPlot::profileLap(double *lapStart) const
+{
+  const double now = profileTime();
+  const double lap = now-*lapStart;
+  *lapStart = now;
+  return lap;
+}
+
+/*! \internal
+  
+  Renders the rows starting at \a stripTop of the plot, scaled with \a scale, into \a strip. The
+  viewport must already be set to the unscaled size of the entire image. This is used by \ref
+  saveTiff to render large images strip by strip.
+  
+  This method is somewhat similar to \ref toPixmap. Change something here, and a change in
+  toPixmap might be necessary, too.
+  
+  Returns false if the painter couldn't be activated on \a strip.
+*/
+bool QCustomPlot::drawStrip(QImage *strip, int stripTop, double scale)
+{
+  strip->fill(0); // transparent
+  QCPPainter painter(strip);
+  if (!painter.isActive())
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on strip";
+    return false;
+  }
+  painter.setMode(QCPPainter::pmNoCaching);
+  if (mBackgroundBrush.style() == Qt::SolidPattern)
+    painter.fillRect(strip->rect(), mBackgroundBrush.color());
+  painter.translate(0, -stripTop);
+  if (!qFuzzyCompare(scale, 1.0))
+  {
+    if (scale > 1.0) // for scale < 1 we always want cosmetic pens where possible, because else lines might disappear for very small scales
+      painter.setMode(QCPPainter::pmNonCosmetic);
+    painter.scale(scale, scale);
+  }
+  if (mBackgroundBrush.style() != Qt::SolidPattern && mBackgroundBrush.style() != Qt::NoBrush)
+    painter.fillRect(mViewport, mBackgroundBrush);
+  draw(&painter);
+  painter.end();
+  return true;
+}
+
+/*! \internal
+  
+  Compresses the \a size bytes at \a data with the PackBits run-length scheme and appends the
+  result to \a result. Runs of identical bytes are stored as a negative count followed by the byte,
+  other bytes are stored literally, preceded by their count minus one. This is used by \ref
+  saveTiff for each row of a plane.
+*/
+void QCustomPlot::packBits(const uchar *data, int size, QByteArray *result) const
+{
+  int i = 0;
+  while (i < size)
+  {
+    int run = 1;
+    while (i+run < size && run < 128 && data[i+run] == data[i])
+      ++run;
+    if (run > 1)
+    {
+      result->append(char(1-run));
+      result->append(char(data[i]));
+      i += run;
+    } else
+    {
+      // literal bytes until the next run of two identical bytes starts:
+      int count = 1;
+      while (i+count < size && count < 128 && !(i+count+1 < size && data[i+count] == data[i+count+1]))
+        ++count;
+      result->append(char(count-1));
+      result->append(reinterpret_cast<const char*>(data+i), count);
+      i += count;
+    }
+  }
+}
+
 /*! \internal
   
   This method is used by \ref QCPAxisRect::removeAxis to report removed axes to the QCustomPlot
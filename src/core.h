@@ -29,6 +29,7 @@
 #include "global.h"
 #include "range.h"
 #include "axis.h"
+#include "replotprofile.h"
 
 class QCPPainter;
 class QCPLayer;
@@ -91,6 +92,9 @@ public:
   bool noAntialiasingOnDrag() const { return mNoAntialiasingOnDrag; }
   QCP::PlottingHints plottingHints() const { return mPlottingHints; }
   Qt::KeyboardModifier multiSelectModifier() const { return mMultiSelectModifier; }
+  int vectorResolution() const { return mVectorResolution; }
+  bool profiling() const { return mProfiling; }
+  bool profilingOverlay() const { return mProfilingOverlay; }
 
   // setters:
   void setViewport(const QRect &rect);
@@ -111,6 +115,9 @@ public:
   void setPlottingHints(const QCP::PlottingHints &hints);
   void setPlottingHint(QCP::PlottingHint hint, bool enabled=true);
   void setMultiSelectModifier(Qt::KeyboardModifier modifier);
+  void setVectorResolution(int dpi);
+  void setProfiling(bool enabled);
+  void setProfilingOverlay(bool enabled);
   
   // non-property methods:
   // plottable interface:
@@ -163,6 +170,7 @@ public:
   QCPAxisRect* axisRect(int index=0) const;
   QList<QCPAxisRect*> axisRects() const;
   QCPLayoutElement* layoutElementAt(const QPointF &pos) const;
+  void invalidateLayout();
   Q_SLOT void rescaleAxes(bool onlyVisiblePlottables=false);
   
   QList<QCPAxis*> selectedAxes() const;
@@ -173,10 +181,13 @@ public:
   bool savePng(const QString &fileName, int width=0, int height=0, double scale=1.0, int quality=-1);
   bool saveJpg(const QString &fileName, int width=0, int height=0, double scale=1.0, int quality=-1);
   bool saveBmp(const QString &fileName, int width=0, int height=0, double scale=1.0);
+  bool saveTiff(const QString &fileName, int width=0, int height=0, double scale=1.0, int stripHeight=256);
   bool saveRastered(const QString &fileName, int width, int height, double scale, const char *format, int quality=-1);
   QPixmap toPixmap(int width=0, int height=0, double scale=1.0);
   void toPainter(QCPPainter *painter, int width=0, int height=0);
   Q_SLOT void replot(QCustomPlot::RefreshPriority refreshPriority=QCustomPlot::rpHint);
+  const QCPReplotProfile &replotProfile() const { return mReplotProfile; }
+  QCPReplotProfile *currentReplotProfile() const { return mCurrentReplotProfile; }
   
   QCPAxis *xAxis, *yAxis, *xAxis2, *yAxis2;
   QCPLegend *legend;
@@ -202,6 +213,7 @@ signals:
   void selectionChangedByUser();
   void beforeReplot();
   void afterReplot();
+  void replotProfiled(const QCPReplotProfile &profile);
   
 protected:
   // property members:
@@ -224,12 +236,31 @@ protected:
   QCPLayer *mCurrentLayer;
   QCP::PlottingHints mPlottingHints;
   Qt::KeyboardModifier mMultiSelectModifier;
+  int mVectorResolution;
+  bool mProfiling, mProfilingOverlay;
   
   // non-property members:
   QPixmap mPaintBuffer;
   QPoint mMousePressPos;
   QPointer<QCPLayoutElement> mMouseEventElement;
   bool mReplotting;
+  QSet<QCPAbstractPlottable*> mPlottableSet; // same plottables as mPlottables, for constant time membership tests
+  QSet<QCPAbstractItem*> mItemSet; // same items as mItems, for constant time membership tests
+  bool mLayoutValid;
+  int mLayoutPass;
+  QList<QPointer<QCPAxis> > mLayoutAxes;
+  QList<QPointer<QCPLayoutElement> > mLayoutHintElements;
+  QVector<QSize> mLayoutHints;
+  bool mLayouting;
+  QRect mVisibleRect; // part of the viewport that was visible on screen during the last replot, see isInViewport
+  bool mCullToVisible; // whether isInViewport uses mVisibleRect instead of mViewport, only during the draw of a replot
+  QHash<QByteArray, QCPAxis::SharedTicks> mSharedTicks;
+  QHash<QByteArray, QSize> mSharedTickLabelExtents;
+  double mExportSamplingScale;
+  QCPReplotProfile mReplotProfile;
+  QCPReplotProfile *mCurrentReplotProfile; // points to mReplotProfile during a profiled replot, zero otherwise
+  QElapsedTimer mProfileTimer;
+  double mProfilePreparationTime; // data preparation time reported by the layerable that is currently drawn
   
   // reimplemented virtual methods:
   virtual QSize minimumSizeHint() const;
@@ -251,11 +282,30 @@ protected:
   void updateLayerIndices() const;
   QCPLayerable *layerableAt(const QPointF &pos, bool onlySelectable, QVariant *selectionDetails=0) const;
   void drawBackground(QCPPainter *painter);
+  bool layoutChanged() const;
+  void storeLayoutState();
+  bool isInViewport(const QCPLayerable *layerable) const;
+  int removePlottables(const QList<QCPAbstractPlottable*> &plottables);
+  void removeFromLayers(const QList<QCPLayerable*> &layerables);
+  bool drawStrip(QImage *strip, int stripTop, double scale);
+  void drawVectorExport(QCPPainter *painter, bool noCosmeticPen);
+  void drawProfilingOverlay(QCPPainter *painter);
+  double profileTime() const;
+  double profileLap(double *lapStart) const;
+#ifndef QT_NO_PRINTER
+  static void setupPdfPrinter(QPrinter *printer, const QString &fileName, const QSize &size, const QString &pdfCreator, const QString &pdfTitle);
+#endif
+  void packBits(const uchar *data, int size, QByteArray *result) const;
   
   friend class QCPLegend;
   friend class QCPAxis;
   friend class QCPLayer;
   friend class QCPAxisRect;
+  friend class QCPMarginGroup;
+  friend class QCPLayoutGrid;
+  friend class QCPAxisPainterPrivate;
+  friend class QCPAbstractPlottable;
+  friend class QCPBatchExporter;
 };
 
 #endif // QCP_CORE_H
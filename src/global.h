@@ -34,6 +34,8 @@
 #include <QPaintEvent>
 #include <QMouseEvent>
 #include <QPixmap>
+#include <QFile>
+#include <QDataStream>
 #include <QVector>
 #include <QString>
 #include <QDateTime>
@@ -44,8 +46,19 @@
 #include <QStack>
 #include <QCache>
 #include <QMargins>
+#include <QAtomicInt>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QPicture>
+#include <QTime>
+#include <QElapsedTimer>
+#include <QCoreApplication>
 #include <qmath.h>
 #include <limits>
+#include <algorithm>
 #if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
 #  include <qnumeric.h>
 #  include <QPrinter>
@@ -119,7 +132,9 @@ enum PlottingHint { phNone            = 0x000 ///< <tt>0x000</tt> No hints are s
                                               ///<                especially of the line segment joins. (Only relevant for solid line pens.)
                     ,phForceRepaint   = 0x002 ///< <tt>0x002</tt> causes an immediate repaint() instead of a soft update() when QCustomPlot::replot() is called with parameter \ref QCustomPlot::rpHint.
                                               ///<                This is set by default to prevent the plot from freezing on fast consecutive replots (e.g. user drags ranges with mouse).
-                    ,phCacheLabels    = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps, increasing replot performance.
+                    ,phCacheLabels    = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps, increasing replot performance. Unrotated number and date/time tick labels are composed of individually cached glyphs.
+                    ,phSmallMultiples = 0x008 ///< <tt>0x008</tt> optimizes plots with many axis rects (e.g. a grid of sparklines). Axes with identical tick parameters share their tick vectors and tick label
+                                              ///<                measurements during a replot, and layerables whose layout element lies completely outside the visible part of the widget aren't drawn.
                   };
 Q_DECLARE_FLAGS(PlottingHints, PlottingHint)
 
@@ -201,6 +216,33 @@ inline int getMarginValue(const QMargins &margins, QCP::MarginSide side)
   return 0;
 }
 
+/*! \internal
+
+  Finds the shortest squared distance of \a point to the line segment defined by \a start and \a
+  end. This is the geometry behind the \a selectTest implementations of plottables and items, see
+  \ref QCPAbstractPlottable::distSqrToLine and \ref QCPAbstractItem::distSqrToLine.
+*/
+inline double distSqrToLine(const QPointF &start, const QPointF &end, const QPointF &point)
+{
+  QVector2D a(start);
+  QVector2D b(end);
+  QVector2D p(point);
+  QVector2D v(b-a);
+  
+  double vLengthSqr = v.lengthSquared();
+  if (!qFuzzyIsNull(vLengthSqr))
+  {
+    double mu = QVector2D::dotProduct(p-a, v)/vLengthSqr;
+    if (mu < 0)
+      return (a-p).lengthSquared();
+    else if (mu > 1)
+      return (b-p).lengthSquared();
+    else
+      return ((a + mu*v)-p).lengthSquared();
+  } else
+    return (a-p).lengthSquared();
+}
+
 } // end of namespace QCP
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCP::AntialiasedElements)
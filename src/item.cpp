@@ -1164,23 +1164,7 @@ void QCPAbstractItem::applyDefaultAntialiasingHint(QCPPainter *painter) const
 */
 double QCPAbstractItem::distSqrToLine(const QPointF &start, const QPointF &end, const QPointF &point) const
 {
-  QVector2D a(start);
-  QVector2D b(end);
-  QVector2D p(point);
-  QVector2D v(b-a);
-  
-  double vLengthSqr = v.lengthSquared();
-  if (!qFuzzyIsNull(vLengthSqr))
-  {
-    double mu = QVector2D::dotProduct(p-a, v)/vLengthSqr;
-    if (mu < 0)
-      return (a-p).lengthSquared();
-    else if (mu > 1)
-      return (b-p).lengthSquared();
-    else
-      return ((a + mu*v)-p).lengthSquared();
-  } else
-    return (a-p).lengthSquared();
+  return QCP::distSqrToLine(start, end, point);
 }
 
 /*! \internal
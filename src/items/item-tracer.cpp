@@ -329,46 +329,63 @@ void QCPItemTracer::updatePosition()
   {
     if (mParentPlot->hasPlottable(mGraph))
     {
-      if (mGraph->data()->size() > 1)
+      if (mGraph->dataLayout() == QCPGraph::dlMap)
+        updatePositionFromData(mGraph->data());
+      else
+        updatePositionFromData(mGraph->compactData());
+    } else
+      qDebug() << Q_FUNC_INFO << "graph not contained in QCustomPlot instance (anymore)";
+  }
+}
+
+/*! \internal
+  
+  Updates the tracer's \a position from the graph data container \a data, which is either a \ref
+  QCPDataMap or a \ref QCPCompactData, depending on the graph's \ref QCPGraph::setDataLayout
+  "data layout".
+  
+  \see updatePosition
+*/
+template <class DataContainer>
+void QCPItemTracer::updatePositionFromData(const DataContainer *data)
+{
+  if (data->size() > 1)
+  {
+    typename DataContainer::const_iterator first = data->constBegin();
+    typename DataContainer::const_iterator last = data->constEnd()-1;
+    if (mGraphKey < first.key())
+      position->setCoords(first.key(), first.value().value);
+    else if (mGraphKey > last.key())
+      position->setCoords(last.key(), last.value().value);
+    else
+    {
+      typename DataContainer::const_iterator it = data->lowerBound(mGraphKey);
+      if (it != first) // mGraphKey is somewhere between iterators
       {
-        QCPDataMap::const_iterator first = mGraph->data()->constBegin();
-        QCPDataMap::const_iterator last = mGraph->data()->constEnd()-1;
-        if (mGraphKey < first.key())
-          position->setCoords(first.key(), first.value().value);
-        else if (mGraphKey > last.key())
-          position->setCoords(last.key(), last.value().value);
-        else
+        typename DataContainer::const_iterator prevIt = it-1;
+        if (mInterpolating)
+        {
+          // interpolate between iterators around mGraphKey:
+          double slope = 0;
+          if (!qFuzzyCompare((double)it.key(), (double)prevIt.key()))
+            slope = (it.value().value-prevIt.value().value)/(it.key()-prevIt.key());
+          position->setCoords(mGraphKey, (mGraphKey-prevIt.key())*slope+prevIt.value().value);
+        } else
         {
-          QCPDataMap::const_iterator it = mGraph->data()->lowerBound(mGraphKey);
-          if (it != first) // mGraphKey is somewhere between iterators
-          {
-            QCPDataMap::const_iterator prevIt = it-1;
-            if (mInterpolating)
-            {
-              // interpolate between iterators around mGraphKey:
-              double slope = 0;
-              if (!qFuzzyCompare((double)it.key(), (double)prevIt.key()))
-                slope = (it.value().value-prevIt.value().value)/(it.key()-prevIt.key());
-              position->setCoords(mGraphKey, (mGraphKey-prevIt.key())*slope+prevIt.value().value);
-            } else
-            {
-              // find iterator with key closest to mGraphKey:
-              if (mGraphKey < (prevIt.key()+it.key())*0.5)
-                it = prevIt;
-              position->setCoords(it.key(), it.value().value);
-            }
-          } else // mGraphKey is exactly on first iterator
-            position->setCoords(it.key(), it.value().value);
+          // find iterator with key closest to mGraphKey:
+          if (mGraphKey < (prevIt.key()+it.key())*0.5)
+            it = prevIt;
+          position->setCoords(it.key(), it.value().value);
         }
-      } else if (mGraph->data()->size() == 1)
-      {
-        QCPDataMap::const_iterator it = mGraph->data()->constBegin();
+      } else // mGraphKey is exactly on first iterator
         position->setCoords(it.key(), it.value().value);
-      } else
-        qDebug() << Q_FUNC_INFO << "graph has no data";
-    } else
-      qDebug() << Q_FUNC_INFO << "graph not contained in QCustomPlot instance (anymore)";
-  }
+    }
+  } else if (data->size() == 1)
+  {
+    typename DataContainer::const_iterator it = data->constBegin();
+    position->setCoords(it.key(), it.value().value);
+  } else
+    qDebug() << Q_FUNC_INFO << "graph has no data";
 }
 
 /*! \internal
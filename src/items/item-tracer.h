@@ -110,6 +110,8 @@ protected:
   // non-virtual methods:
   QPen mainPen() const;
   QBrush mainBrush() const;
+  template <class DataContainer>
+  void updatePositionFromData(const DataContainer *data);
 };
 
 #endif // QCP_ITEM_TRACER_H
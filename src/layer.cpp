@@ -150,8 +150,9 @@ void QCPLayer::setVisible(bool visible)
 */
 void QCPLayer::addChild(QCPLayerable *layerable, bool prepend)
 {
-  if (!mChildren.contains(layerable))
+  if (!mChildSet.contains(layerable))
   {
+    mChildSet.insert(layerable);
     if (prepend)
       mChildren.prepend(layerable);
     else
@@ -167,14 +168,43 @@ void QCPLayer::addChild(QCPLayerable *layerable, bool prepend)
   This function does not change the \a mLayer member of \a layerable. (Use QCPLayerable::setLayer
   to change the layer of an object, not this function.)
   
-  \see addChild
+  The list is searched from the back, because layerables are typically removed in reverse order of
+  their creation (e.g. when clearing all plottables).
+  
+  \see addChild, removeChildren
 */
 void QCPLayer::removeChild(QCPLayerable *layerable)
 {
-  if (!mChildren.removeOne(layerable))
+  if (mChildSet.remove(layerable))
+    mChildren.removeAt(mChildren.lastIndexOf(layerable));
+  else
     qDebug() << Q_FUNC_INFO << "layerable is not child of this layer" << reinterpret_cast<quintptr>(layerable);
 }
 
+/*! \internal
+  
+  Removes all \a layerables from the list of this layer with a single pass over the list. Entries of
+  \a layerables that aren't children of this layer are ignored.
+  
+  Like \ref removeChild, this function does not change the \a mLayer member of the layerables. It
+  is used by the bulk removal functions of QCustomPlot, e.g. \ref QCustomPlot::clearPlottables.
+*/
+void QCPLayer::removeChildren(const QSet<QCPLayerable*> &layerables)
+{
+  QList<QCPLayerable*> remainingChildren;
+#if QT_VERSION >= QT_VERSION_CHECK(4, 7, 0)
+  remainingChildren.reserve(mChildren.size());
+#endif
+  for (int i=0; i<mChildren.size(); ++i)
+  {
+    if (layerables.contains(mChildren.at(i)))
+      mChildSet.remove(mChildren.at(i));
+    else
+      remainingChildren.append(mChildren.at(i));
+  }
+  mChildren = remainingChildren;
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPLayerable
@@ -315,6 +345,8 @@ QCPLayerable::~QCPLayerable()
 void QCPLayerable::setVisible(bool on)
 {
   mVisible = on;
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
 }
 
 /*!
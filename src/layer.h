@@ -65,10 +65,13 @@ protected:
   int mIndex;
   QList<QCPLayerable*> mChildren;
   bool mVisible;
+  // non-property members:
+  QSet<QCPLayerable*> mChildSet; // same layerables as mChildren, for constant time membership tests
   
   // non-virtual methods:
   void addChild(QCPLayerable *layerable, bool prepend);
   void removeChild(QCPLayerable *layerable);
+  void removeChildren(const QSet<QCPLayerable*> &layerables);
   
 private:
   Q_DISABLE_COPY(QCPLayer)
@@ -76,7 +76,8 @@
 */
 QCPMarginGroup::QCPMarginGroup(QCustomPlot *parentPlot) :
   QObject(parentPlot),
-  mParentPlot(parentPlot)
+  mParentPlot(parentPlot),
+  mCachedPass(-1)
 {
   mChildren.insert(QCP::msLeft, QList<QCPLayoutElement*>());
   mChildren.insert(QCP::msRight, QList<QCPLayoutElement*>());
@@ -131,9 +132,22 @@ void QCPMarginGroup::clear()
   QCPLayoutElement::calculateAutoMargin) of each element associated with \a side in this margin
   group, and choosing the largest returned value. (QCPLayoutElement::minimumMargins is taken into
   account, too.)
+  
+  Since every element of the group requests the common margin during the same layout pass, the
+  result is calculated only once per side and layout pass.
 */
 int QCPMarginGroup::commonMargin(QCP::MarginSide side) const
 {
+  if (mParentPlot && mParentPlot->mLayouting)
+  {
+    if (mCachedPass != mParentPlot->mLayoutPass)
+    {
+      mCachedMargins.clear();
+      mCachedPass = mParentPlot->mLayoutPass;
+    } else if (mCachedMargins.contains(side))
+      return mCachedMargins.value(side);
+  }
+  
   // query all automatic margins of the layout elements in this margin group side and find maximum:
   int result = 0;
   const QList<QCPLayoutElement*> elements = mChildren.value(side);
@@ -145,6 +159,8 @@ int QCPMarginGroup::commonMargin(QCP::MarginSide side) const
     if (m > result)
       result = m;
   }
+  if (mParentPlot && mParentPlot->mLayouting)
+    mCachedMargins.insert(side, result);
   return result;
 }
 
@@ -157,8 +173,10 @@ int QCPMarginGroup::commonMargin(QCP::MarginSide side) const
 void QCPMarginGroup::addChild(QCP::MarginSide side, QCPLayoutElement *element)
 {
   if (!mChildren[side].contains(element))
+  {
     mChildren[side].append(element);
-  else
+    mCachedPass = -1;
+  } else
     qDebug() << Q_FUNC_INFO << "element is already child of this margin group side" << reinterpret_cast<quintptr>(element);
 }
 
@@ -170,7 +188,9 @@ void QCPMarginGroup::addChild(QCP::MarginSide side, QCPLayoutElement *element)
 */
 void QCPMarginGroup::removeChild(QCP::MarginSide side, QCPLayoutElement *element)
 {
-  if (!mChildren[side].removeOne(element))
+  if (mChildren[side].removeOne(element))
+    mCachedPass = -1;
+  else
     qDebug() << Q_FUNC_INFO << "element is not child of this margin group side" << reinterpret_cast<quintptr>(element);
 }
 
@@ -297,6 +317,8 @@ void QCPLayoutElement::setOuterRect(const QRect &rect)
   {
     mOuterRect = rect;
     mRect = mOuterRect.adjusted(mMargins.left(), mMargins.top(), -mMargins.right(), -mMargins.bottom());
+    if (mParentPlot)
+      mParentPlot->invalidateLayout();
   }
 }
 
@@ -317,6 +339,8 @@ void QCPLayoutElement::setMargins(const QMargins &margins)
   {
     mMargins = margins;
     mRect = mOuterRect.adjusted(mMargins.left(), mMargins.top(), -mMargins.right(), -mMargins.bottom());
+    if (mParentPlot)
+      mParentPlot->invalidateLayout();
   }
 }
 
@@ -334,6 +358,8 @@ void QCPLayoutElement::setMinimumMargins(const QMargins &margins)
   if (mMinimumMargins != margins)
   {
     mMinimumMargins = margins;
+    if (mParentPlot)
+      mParentPlot->invalidateLayout();
   }
 }
 
@@ -349,7 +375,12 @@ void QCPLayoutElement::setMinimumMargins(const QMargins &margins)
 */
 void QCPLayoutElement::setAutoMargins(QCP::MarginSides sides)
 {
-  mAutoMargins = sides;
+  if (mAutoMargins != sides)
+  {
+    mAutoMargins = sides;
+    if (mParentPlot)
+      mParentPlot->invalidateLayout();
+  }
 }
 
 /*!
@@ -439,6 +470,8 @@ void QCPLayoutElement::setMarginGroup(QCP::MarginSides sides, QCPMarginGroup *gr
         mMarginGroups[side] = group;
         group->addChild(side, this);
       }
+      if (mParentPlot)
+        mParentPlot->invalidateLayout();
     }
   }
 }
@@ -784,6 +817,8 @@ void QCPLayout::clear()
 */
 void QCPLayout::sizeConstraintsChanged() const
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   if (QWidget *w = qobject_cast<QWidget*>(parent()))
     w->updateGeometry();
   else if (QCPLayout *l = qobject_cast<QCPLayout*>(parent()))
@@ -828,6 +863,8 @@ void QCPLayout::adoptElement(QCPLayoutElement *el)
     el->setParent(this);
     if (!el->parentPlot())
       el->initializeParentPlot(mParentPlot);
+    if (mParentPlot)
+      mParentPlot->invalidateLayout();
   } else
     qDebug() << Q_FUNC_INFO << "Null element passed";
 }
@@ -850,6 +887,8 @@ void QCPLayout::releaseElement(QCPLayoutElement *el)
     el->setParentLayerable(0);
     el->setParent(mParentPlot);
     // Note: Don't initializeParentPlot(0) here, because layout element will stay in same parent plot
+    if (mParentPlot)
+      mParentPlot->invalidateLayout();
   } else
     qDebug() << Q_FUNC_INFO << "Null element passed";
 }
@@ -1022,7 +1061,9 @@ QVector<int> QCPLayout::getSectionSizes(QVector<int> maxSizes, QVector<int> minS
 */
 QCPLayoutGrid::QCPLayoutGrid() :
   mColumnSpacing(5),
-  mRowSpacing(5)
+  mRowSpacing(5),
+  mCachedMinSizesPass(-1),
+  mCachedMaxSizesPass(-1)
 {
 }
 
@@ -1140,8 +1181,11 @@ void QCPLayoutGrid::setColumnStretchFactor(int column, double factor)
   if (column >= 0 && column < columnCount())
   {
     if (factor > 0)
+    {
       mColumnStretchFactors[column] = factor;
-    else
+      if (mParentPlot)
+        mParentPlot->invalidateLayout();
+    } else
       qDebug() << Q_FUNC_INFO << "Invalid stretch factor, must be positive:" << factor;
   } else
     qDebug() << Q_FUNC_INFO << "Invalid column:" << column;
@@ -1171,6 +1215,8 @@ void QCPLayoutGrid::setColumnStretchFactors(const QList<double> &factors)
         mColumnStretchFactors[i] = 1;
       }
     }
+    if (mParentPlot)
+      mParentPlot->invalidateLayout();
   } else
     qDebug() << Q_FUNC_INFO << "Column count not equal to passed stretch factor count:" << factors;
 }
@@ -1191,8 +1237,11 @@ void QCPLayoutGrid::setRowStretchFactor(int row, double factor)
   if (row >= 0 && row < rowCount())
   {
     if (factor > 0)
+    {
       mRowStretchFactors[row] = factor;
-    else
+      if (mParentPlot)
+        mParentPlot->invalidateLayout();
+    } else
       qDebug() << Q_FUNC_INFO << "Invalid stretch factor, must be positive:" << factor;
   } else
     qDebug() << Q_FUNC_INFO << "Invalid row:" << row;
@@ -1222,6 +1271,8 @@ void QCPLayoutGrid::setRowStretchFactors(const QList<double> &factors)
         mRowStretchFactors[i] = 1;
       }
     }
+    if (mParentPlot)
+      mParentPlot->invalidateLayout();
   } else
     qDebug() << Q_FUNC_INFO << "Row count not equal to passed stretch factor count:" << factors;
 }
@@ -1234,6 +1285,8 @@ void QCPLayoutGrid::setRowStretchFactors(const QList<double> &factors)
 void QCPLayoutGrid::setColumnSpacing(int pixels)
 {
   mColumnSpacing = pixels;
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
 }
 
 /*!
@@ -1244,6 +1297,8 @@ void QCPLayoutGrid::setColumnSpacing(int pixels)
 void QCPLayoutGrid::setRowSpacing(int pixels)
 {
   mRowSpacing = pixels;
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
 }
 
 /*!
@@ -1277,6 +1332,8 @@ void QCPLayoutGrid::expandTo(int newRowCount, int newColumnCount)
   }
   while (mColumnStretchFactors.size() < newColCount)
     mColumnStretchFactors.append(1);
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
 }
 
 /*!
@@ -1303,6 +1360,8 @@ void QCPLayoutGrid::insertRow(int newIndex)
   for (int col=0; col<columnCount(); ++col)
     newRow.append((QCPLayoutElement*)0);
   mElements.insert(newIndex, newRow);
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
 }
 
 /*!
@@ -1327,6 +1386,8 @@ void QCPLayoutGrid::insertColumn(int newIndex)
   mColumnStretchFactors.insert(newIndex, 1);
   for (int row=0; row<rowCount(); ++row)
     mElements[row].insert(newIndex, (QCPLayoutElement*)0);
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
 }
 
 /* inherits documentation from base class */
@@ -1440,6 +1501,9 @@ QList<QCPLayoutElement*> QCPLayoutGrid::elements(bool recursive) const
 */
 void QCPLayoutGrid::simplify()
 {
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
+  
   // remove rows with only empty cells:
   for (int row=rowCount()-1; row>=0; --row)
   {
@@ -1523,10 +1587,22 @@ QSize QCPLayoutGrid::maximumSizeHint() const
   
   This is a helper function for \ref updateLayout.
   
+  During a layout phase, the result is cached, because the sizes are requested both by the parent
+  layout (via \ref minimumSizeHint) and by \ref updateLayout, which makes a difference for grids
+  with many elements.
+  
   \see getMaximumRowColSizes
 */
 void QCPLayoutGrid::getMinimumRowColSizes(QVector<int> *minColWidths, QVector<int> *minRowHeights) const
 {
+  const bool useCache = mParentPlot && mParentPlot->mLayouting;
+  if (useCache && mCachedMinSizesPass == mParentPlot->mLayoutPass)
+  {
+    *minColWidths = mCachedMinColWidths;
+    *minRowHeights = mCachedMinRowHeights;
+    return;
+  }
+  
   *minColWidths = QVector<int>(columnCount(), 0);
   *minRowHeights = QVector<int>(rowCount(), 0);
   for (int row=0; row<rowCount(); ++row)
@@ -1545,6 +1621,13 @@ void QCPLayoutGrid::getMinimumRowColSizes(QVector<int> *minColWidths, QVector<in
       }
     }
   }
+  
+  if (useCache)
+  {
+    mCachedMinColWidths = *minColWidths;
+    mCachedMinRowHeights = *minRowHeights;
+    mCachedMinSizesPass = mParentPlot->mLayoutPass;
+  }
 }
 
 /*! \internal
@@ -1555,12 +1638,21 @@ void QCPLayoutGrid::getMinimumRowColSizes(QVector<int> *minColWidths, QVector<in
   The maximum height of a row is the smallest maximum height of any element in that row. The
   maximum width of a column is the smallest maximum width of any element in that column.
   
-  This is a helper function for \ref updateLayout.
+  This is a helper function for \ref updateLayout. Like \ref getMinimumRowColSizes, the result is
+  cached during a layout phase.
   
   \see getMinimumRowColSizes
 */
 void QCPLayoutGrid::getMaximumRowColSizes(QVector<int> *maxColWidths, QVector<int> *maxRowHeights) const
 {
+  const bool useCache = mParentPlot && mParentPlot->mLayouting;
+  if (useCache && mCachedMaxSizesPass == mParentPlot->mLayoutPass)
+  {
+    *maxColWidths = mCachedMaxColWidths;
+    *maxRowHeights = mCachedMaxRowHeights;
+    return;
+  }
+  
   *maxColWidths = QVector<int>(columnCount(), QWIDGETSIZE_MAX);
   *maxRowHeights = QVector<int>(rowCount(), QWIDGETSIZE_MAX);
   for (int row=0; row<rowCount(); ++row)
@@ -1579,6 +1671,13 @@ void QCPLayoutGrid::getMaximumRowColSizes(QVector<int> *maxColWidths, QVector<in
       }
     }
   }
+  
+  if (useCache)
+  {
+    mCachedMaxColWidths = *maxColWidths;
+    mCachedMaxRowHeights = *maxRowHeights;
+    mCachedMaxSizesPass = mParentPlot->mLayoutPass;
+  }
 }
 
 
@@ -1679,8 +1778,11 @@ QRectF QCPLayoutInset::insetRect(int index) const
 void QCPLayoutInset::setInsetPlacement(int index, QCPLayoutInset::InsetPlacement placement)
 {
   if (elementAt(index))
+  {
     mInsetPlacement[index] = placement;
-  else
+    if (mParentPlot)
+      mParentPlot->invalidateLayout();
+  } else
     qDebug() << Q_FUNC_INFO << "Invalid element index:" << index;
 }
 
@@ -1695,8 +1797,11 @@ void QCPLayoutInset::setInsetPlacement(int index, QCPLayoutInset::InsetPlacement
 void QCPLayoutInset::setInsetAlignment(int index, Qt::Alignment alignment)
 {
   if (elementAt(index))
+  {
     mInsetAlignment[index] = alignment;
-  else
+    if (mParentPlot)
+      mParentPlot->invalidateLayout();
+  } else
     qDebug() << Q_FUNC_INFO << "Invalid element index:" << index;
 }
 
@@ -1714,8 +1819,11 @@ void QCPLayoutInset::setInsetAlignment(int index, Qt::Alignment alignment)
 void QCPLayoutInset::setInsetRect(int index, const QRectF &rect)
 {
   if (elementAt(index))
+  {
     mInsetRect[index] = rect;
-  else
+    if (mParentPlot)
+      mParentPlot->invalidateLayout();
+  } else
     qDebug() << Q_FUNC_INFO << "Invalid element index:" << index;
 }
 
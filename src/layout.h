@@ -49,6 +49,8 @@ protected:
   // non-property members:
   QCustomPlot *mParentPlot;
   QHash<QCP::MarginSide, QList<QCPLayoutElement*> > mChildren;
+  mutable QHash<QCP::MarginSide, int> mCachedMargins;
+  mutable int mCachedPass;
   
   // non-virtual methods:
   int commonMargin(QCP::MarginSide side) const;
@@ -246,6 +248,9 @@ protected:
   QList<double> mColumnStretchFactors;
   QList<double> mRowStretchFactors;
   int mColumnSpacing, mRowSpacing;
+  // non-property members:
+  mutable QVector<int> mCachedMinColWidths, mCachedMinRowHeights, mCachedMaxColWidths, mCachedMaxRowHeights;
+  mutable int mCachedMinSizesPass, mCachedMaxSizesPass;
   
   // non-virtual methods:
   void getMinimumRowColSizes(QVector<int> *minColWidths, QVector<int> *minRowHeights) const;
@@ -332,6 +332,8 @@ QCPAxis *QCPAxisRect::addAxis(QCPAxis::AxisType type, QCPAxis *axis)
     newAxis->setUpperEnding(QCPLineEnding(QCPLineEnding::esHalfBar, 6, 10, invert));
   }
   mAxes[type].append(newAxis);
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
   return newAxis;
 }
 
@@ -377,6 +379,8 @@ bool QCPAxisRect::removeAxis(QCPAxis *axis)
       if (qobject_cast<QCustomPlot*>(parentPlot())) // make sure this isn't called from QObject dtor when QCustomPlot is already destructed (happens when the axis rect is not in any layout and thus QObject-child of QCustomPlot)
         parentPlot()->axisRemoved(axis);
       delete axis;
+      if (mParentPlot)
+        mParentPlot->invalidateLayout();
       return true;
     }
   }
@@ -572,9 +576,14 @@ void QCPAxisRect::update(UpdatePhase phase)
   {
     case upPreparation:
     {
+      // the tick generation is recorded separately in profiled replots:
+      QCPReplotProfile *profile = mParentPlot ? mParentPlot->currentReplotProfile() : 0;
+      const double tickStart = profile ? mParentPlot->profileTime() : 0;
       QList<QCPAxis*> allAxes = axes();
       for (int i=0; i<allAxes.size(); ++i)
         allAxes.at(i)->setupTickVectors();
+      if (profile)
+        profile->tickTime += mParentPlot->profileTime()-tickStart;
       break;
     }
     case upLayout:
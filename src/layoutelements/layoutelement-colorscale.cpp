@@ -221,6 +221,8 @@ void QCPColorScale::setType(QCPAxis::AxisType type)
     connect(mColorAxis.data(), SIGNAL(scaleTypeChanged(QCPAxis::ScaleType)), this, SLOT(setDataScaleType(QCPAxis::ScaleType)));
     mAxisRect.data()->setRangeDragAxes(QCPAxis::orientation(mType) == Qt::Horizontal ? mColorAxis.data() : 0,
                                        QCPAxis::orientation(mType) == Qt::Vertical ? mColorAxis.data() : 0);
+    if (mParentPlot)
+      mParentPlot->invalidateLayout();
   }
 }
 
@@ -307,6 +309,8 @@ void QCPColorScale::setLabel(const QString &str)
 void QCPColorScale::setBarWidth(int width)
 {
   mBarWidth = width;
+  if (mParentPlot)
+    mParentPlot->invalidateLayout();
 }
 
 /*!
@@ -85,6 +85,12 @@ QCPAbstractLegendItem::QCPAbstractLegendItem(QCPLegend *parent) :
   setMargins(QMargins(8, 2, 8, 2));
 }
 
+/* can't make this a header inline function, because QPointer breaks with forward declared types, see QTBUG-29588 */
+QCPLegend *QCPAbstractLegendItem::parentLegend() const
+{
+  return mParentLegend.data();
+}
+
 /*!
   Sets the default font of this specific legend item to \a font.
   
@@ -163,7 +169,7 @@ double QCPAbstractLegendItem::selectTest(const QPointF &pos, bool onlySelectable
 {
   Q_UNUSED(details)
   if (!mParentPlot) return -1;
-  if (onlySelectable && (!mSelectable || !mParentLegend->selectableParts().testFlag(QCPLegend::spItems)))
+  if (onlySelectable && (!mSelectable || !mParentLegend || !mParentLegend->selectableParts().testFlag(QCPLegend::spItems)))
     return -1;
   
   if (mRect.contains(pos.toPoint()))
@@ -189,7 +195,7 @@ void QCPAbstractLegendItem::selectEvent(QMouseEvent *event, bool additive, const
 {
   Q_UNUSED(event)
   Q_UNUSED(details)
-  if (mSelectable && mParentLegend->selectableParts().testFlag(QCPLegend::spItems))
+  if (mSelectable && mParentLegend && mParentLegend->selectableParts().testFlag(QCPLegend::spItems))
   {
     bool selBefore = mSelected;
     setSelected(additive ? !mSelected : true);
@@ -201,7 +207,7 @@ void QCPAbstractLegendItem::selectEvent(QMouseEvent *event, bool additive, const
 /* inherits documentation from base class */
 void QCPAbstractLegendItem::deselectEvent(bool *selectionStateChanged)
 {
-  if (mSelectable && mParentLegend->selectableParts().testFlag(QCPLegend::spItems))
+  if (mSelectable && mParentLegend && mParentLegend->selectableParts().testFlag(QCPLegend::spItems))
   {
     bool selBefore = mSelected;
     setSelected(false);
@@ -210,6 +216,17 @@ void QCPAbstractLegendItem::deselectEvent(bool *selectionStateChanged)
   }
 }
 
+/*! \internal
+  
+  If the parent legend is virtualized (\ref QCPLegend::setVirtualized), the wheel event is passed
+  on to the legend, so it can be scrolled while the cursor is above one of its items.
+*/
+void QCPAbstractLegendItem::wheelEvent(QWheelEvent *event)
+{
+  if (mParentLegend && mParentLegend->virtualized() && layout() == mParentLegend)
+    mParentLegend->wheelEvent(event);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPPlottableLegendItem
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -251,6 +268,15 @@ QCPPlottableLegendItem::QCPPlottableLegendItem(QCPLegend *parent, QCPAbstractPlo
   QCPAbstractLegendItem(parent),
   mPlottable(plottable)
 {
+  // register at parent legend, so QCPLegend::itemWithPlottable doesn't need to search all items:
+  if (mParentLegend)
+    mParentLegend->mPlottableItems.insert(mPlottable, this);
+}
+
+QCPPlottableLegendItem::~QCPPlottableLegendItem()
+{
+  if (mParentLegend)
+    mParentLegend->mPlottableItems.remove(mPlottable, this);
 }
 
 /*! \internal
@@ -288,10 +314,45 @@ QFont QCPPlottableLegendItem::getFont() const
   Draws the item with \a painter. The size and position of the drawn legend item is defined by the
   parent layout (typically a \ref QCPLegend) and the \ref minimumSizeHint and \ref maximumSizeHint
   of this legend item.
+  
+  If the parent legend is virtualized (\ref QCPLegend::setVirtualized), the item is rendered to a
+  pixmap once, which is then drawn on subsequent replots until the appearance of the item changes
+  (see \ref generateAppearanceHash). This is not done for exports, i.e. when the painter has the
+  \ref QCPPainter::pmNoCaching mode set.
 */
 void QCPPlottableLegendItem::draw(QCPPainter *painter)
 {
   if (!mPlottable) return;
+  if (mParentLegend->virtualized() && !mOuterRect.isEmpty() && !painter->modes().testFlag(QCPPainter::pmNoCaching))
+  {
+    QByteArray hash = generateAppearanceHash();
+    hash.append(QByteArray::number((int)painter->antialiasing()));
+    QCPReplotProfile *profile = mParentPlot->currentReplotProfile();
+    if (mCachedPixmap.isNull() || hash != mCachedPixmapHash)
+    {
+      if (profile) ++profile->cacheMisses;
+      mCachedPixmap = QPixmap(mOuterRect.size());
+      mCachedPixmap.fill(Qt::transparent);
+      QCPPainter cachePainter(&mCachedPixmap);
+      cachePainter.setModes(painter->modes());
+      cachePainter.setAntialiasing(painter->antialiasing());
+      cachePainter.translate(-mOuterRect.topLeft());
+      drawContent(&cachePainter);
+      mCachedPixmapHash = hash;
+    } else if (profile)
+      ++profile->cacheHits;
+    painter->drawPixmap(mOuterRect.topLeft(), mCachedPixmap);
+  } else
+    drawContent(painter);
+}
+
+/*! \internal
+  
+  Draws the icon, the icon border and the text of this item with \a painter. This is used by \ref
+  draw, either directly or to render the cached pixmap.
+*/
+void QCPPlottableLegendItem::drawContent(QCPPainter *painter)
+{
   painter->setFont(getFont());
   painter->setPen(QPen(getTextColor()));
   QSizeF iconSize = mParentLegend->iconSize();
@@ -317,10 +378,20 @@ void QCPPlottableLegendItem::draw(QCPPainter *painter)
   
   Calculates and returns the size of this item. This includes the icon, the text and the padding in
   between.
+  
+  If the parent legend is virtualized (\ref QCPLegend::setVirtualized), the size is cached and only
+  recalculated when the text, font or icon metrics change (see \ref generateSizeHash).
 */
 QSize QCPPlottableLegendItem::minimumSizeHint() const
 {
   if (!mPlottable) return QSize();
+  QByteArray hash;
+  if (mParentLegend->virtualized())
+  {
+    hash = generateSizeHash();
+    if (hash == mCachedSizeHash)
+      return mCachedSize;
+  }
   QSize result(0, 0);
   QRect textRect;
   QFontMetrics fontMetrics(getFont());
@@ -328,6 +399,63 @@ QSize QCPPlottableLegendItem::minimumSizeHint() const
   textRect = fontMetrics.boundingRect(0, 0, 0, iconSize.height(), Qt::TextDontClip, mPlottable->name());
   result.setWidth(iconSize.width() + mParentLegend->iconTextPadding() + textRect.width() + mMargins.left() + mMargins.right());
   result.setHeight(qMax(textRect.height(), iconSize.height()) + mMargins.top() + mMargins.bottom());
+  if (!hash.isEmpty())
+  {
+    mCachedSize = result;
+    mCachedSizeHash = hash;
+  }
+  return result;
+}
+
+/*! \internal
+  
+  Returns a byte array that identifies the properties which influence the size of this item, i.e.
+  the plottable name, the current font, the margins and the icon metrics of the parent legend. It
+  is used by \ref minimumSizeHint to decide whether the cached size is still valid.
+*/
+QByteArray QCPPlottableLegendItem::generateSizeHash() const
+{
+  QByteArray result;
+  result.append(mPlottable->name().toUtf8());
+  result.append(getFont().toString().toLatin1());
+  result.append(QByteArray::number(mMargins.left())+' '+QByteArray::number(mMargins.top())+' '+QByteArray::number(mMargins.right())+' '+QByteArray::number(mMargins.bottom()));
+  result.append(QByteArray::number(mParentLegend->iconSize().width())+'x'+QByteArray::number(mParentLegend->iconSize().height()));
+  result.append(QByteArray::number(mParentLegend->iconTextPadding()));
+  return result;
+}
+
+/*! \internal
+  
+  Returns a byte array that identifies the appearance of this item, as used by \ref draw to decide
+  whether the cached pixmap is still valid. Besides the properties of \ref generateSizeHash, it
+  contains the outer rect size, the text color, the icon border pen and the pens and brushes of the
+  plottable.
+  
+  Properties that only affect the legend icon of specific plottable types (e.g. the scatter style of
+  a graph) are not part of the hash. After changing such properties, call \ref
+  QCPLegend::clearItemCaches.
+*/
+QByteArray QCPPlottableLegendItem::generateAppearanceHash() const
+{
+  QByteArray result = generateSizeHash();
+  result.append(QByteArray::number(mOuterRect.width())+'x'+QByteArray::number(mOuterRect.height()));
+  QColor textColor = getTextColor();
+  result.append(textColor.name().toLatin1()+QByteArray::number(textColor.alpha(), 16));
+  QList<QPen> pens;
+  pens << getIconBorderPen() << mPlottable->pen() << mPlottable->selectedPen();
+  for (int i=0; i<pens.size(); ++i)
+  {
+    result.append(pens.at(i).color().name().toLatin1()+QByteArray::number(pens.at(i).color().alpha(), 16));
+    result.append(QByteArray::number(pens.at(i).widthF())+QByteArray::number((int)pens.at(i).style()));
+  }
+  QList<QBrush> brushes;
+  brushes << mPlottable->brush() << mPlottable->selectedBrush();
+  for (int i=0; i<brushes.size(); ++i)
+  {
+    result.append(brushes.at(i).color().name().toLatin1()+QByteArray::number(brushes.at(i).color().alpha(), 16));
+    result.append(QByteArray::number((int)brushes.at(i).style()));
+  }
+  result.append(QByteArray::number((int)mPlottable->selected()));
   return result;
 }
 
@@ -358,6 +486,11 @@ QSize QCPPlottableLegendItem::minimumSizeHint() const
   layout of the main axis rect (\ref QCPAxisRect::insetLayout). To move the legend to another
   position inside the axis rect, use the methods of the \ref QCPLayoutInset. To move the legend
   outside of the axis rect, place it anywhere else with the QCPLayout/QCPLayoutElement interface.
+  
+  Legends with many items (e.g. thousands of graphs) can be virtualized with \ref setVirtualized.
+  The legend then only shows \ref setVisibleRowCount rows, starting at the row given by \ref
+  setScrollPosition. The user can scroll through the rows with the mouse wheel. Only the visible
+  items are measured and laid out, and the plottable items are drawn from cached pixmaps.
 */
 
 /* start of documentation of signals */
@@ -377,7 +510,10 @@ QSize QCPPlottableLegendItem::minimumSizeHint() const
   Note that by default, QCustomPlot already contains a legend ready to be used as
   QCustomPlot::legend
 */
-QCPLegend::QCPLegend()
+QCPLegend::QCPLegend() :
+  mVirtualized(false),
+  mVisibleRowCount(10),
+  mScrollPosition(0)
 {
   setRowSpacing(0);
   setColumnSpacing(10);
@@ -649,6 +785,61 @@ void QCPLegend::setSelectedTextColor(const QColor &color)
   }
 }
 
+/*!
+  Sets whether this legend is virtualized.
+  
+  A virtualized legend only shows \ref setVisibleRowCount rows of its grid, starting at the row
+  set with \ref setScrollPosition. Its size is determined by the visible rows only, so for example
+  the width of a single column legend may change while scrolling. The items in the other rows
+  aren't measured, laid out or drawn, which keeps replots fast for legends with thousands of items.
+  Further, plottable legend items cache their size and render themselves into a pixmap that is
+  reused until their appearance changes (see \ref clearItemCaches).
+  
+  The user can scroll a virtualized legend with the mouse wheel.
+*/
+void QCPLegend::setVirtualized(bool enabled)
+{
+  if (mVirtualized != enabled)
+  {
+    mVirtualized = enabled;
+    if (mParentPlot)
+      mParentPlot->invalidateLayout();
+  }
+}
+
+/*!
+  Sets the number of rows a virtualized legend shows. The minimum is one row.
+  
+  \see setVirtualized, setScrollPosition
+*/
+void QCPLegend::setVisibleRowCount(int count)
+{
+  count = qMax(1, count);
+  if (mVisibleRowCount != count)
+  {
+    mVisibleRowCount = count;
+    if (mParentPlot)
+      mParentPlot->invalidateLayout();
+  }
+}
+
+/*!
+  Sets the first row that is visible in a virtualized legend. When the legend is laid out, \a row
+  is limited such that \ref setVisibleRowCount rows are shown, if the legend has that many rows.
+  
+  \see setVirtualized
+*/
+void QCPLegend::setScrollPosition(int row)
+{
+  row = qMax(0, row);
+  if (mScrollPosition != row)
+  {
+    mScrollPosition = row;
+    if (mParentPlot)
+      mParentPlot->invalidateLayout();
+  }
+}
+
 /*!
   Returns the item with index \a i.
   
@@ -663,17 +854,21 @@ QCPAbstractLegendItem *QCPLegend::item(int index) const
   Returns the QCPPlottableLegendItem which is associated with \a plottable (e.g. a \ref QCPGraph*).
   If such an item isn't in the legend, returns 0.
   
+  The lookup takes constant time, independent of the number of items in the legend. It only
+  considers items that were created with this legend as parent (see \ref
+  QCPPlottableLegendItem::QCPPlottableLegendItem), which is always the case for items created via
+  \ref QCPAbstractPlottable::addToLegend.
+  
   \see hasItemWithPlottable
 */
 QCPPlottableLegendItem *QCPLegend::itemWithPlottable(const QCPAbstractPlottable *plottable) const
 {
-  for (int i=0; i<itemCount(); ++i)
+  QMultiHash<const QCPAbstractPlottable*, QCPPlottableLegendItem*>::const_iterator it = mPlottableItems.constFind(plottable);
+  while (it != mPlottableItems.constEnd() && it.key() == plottable)
   {
-    if (QCPPlottableLegendItem *pli = qobject_cast<QCPPlottableLegendItem*>(item(i)))
-    {
-      if (pli->plottable() == plottable)
-        return pli;
-    }
+    if (it.value()->layout() == this)
+      return it.value();
+    ++it;
   }
   return 0;
 }
@@ -720,7 +915,7 @@ bool QCPLegend::hasItemWithPlottable(const QCPAbstractPlottable *plottable) cons
 */
 bool QCPLegend::addItem(QCPAbstractLegendItem *item)
 {
-  if (!hasItem(item))
+  if (item && item->layout() != this)
   {
     return addElement(rowCount(), 0, item);
   } else
@@ -765,8 +960,13 @@ bool QCPLegend::removeItem(QCPAbstractLegendItem *item)
 */
 void QCPLegend::clearItems()
 {
+  QSet<QCPAbstractLegendItem*> items;
   for (int i=itemCount()-1; i>=0; --i)
-    removeItem(i);
+  {
+    if (QCPAbstractLegendItem *ali = item(i))
+      items.insert(ali);
+  }
+  removeItems(items);
 }
 
 /*!
@@ -807,6 +1007,161 @@ void QCPLegend::applyDefaultAntialiasingHint(QCPPainter *painter) const
   applyAntialiasingHint(painter, mAntialiased, QCP::aeLegend);
 }
 
+/*!
+  Discards the cached sizes and pixmaps of the plottable legend items of a virtualized legend (see
+  \ref setVirtualized).
+  
+  The caches are updated automatically when the name, pens, brushes or selection state of the
+  plottable, or the text properties of the item change. This function only needs to be called after
+  changing other properties that influence the legend icon, e.g. the scatter style of a graph.
+*/
+void QCPLegend::clearItemCaches()
+{
+  for (int i=0; i<itemCount(); ++i)
+  {
+    if (QCPPlottableLegendItem *pli = qobject_cast<QCPPlottableLegendItem*>(item(i)))
+    {
+      pli->mCachedPixmap = QPixmap();
+      pli->mCachedPixmapHash.clear();
+      pli->mCachedSizeHash.clear();
+    }
+  }
+}
+
+/* inherits documentation from base class */
+void QCPLegend::updateLayout()
+{
+  if (!mVirtualized)
+  {
+    QCPLayoutGrid::updateLayout();
+    return;
+  }
+  
+  int beginRow, endRow;
+  getVisibleRows(&beginRow, &endRow);
+  QVector<int> minColWidths, minRowHeights, maxColWidths, maxRowHeights;
+  getVisibleRowColSizes(&minColWidths, &minRowHeights, &maxColWidths, &maxRowHeights);
+  
+  int totalRowSpacing = qMax(0, endRow-beginRow-1) * mRowSpacing;
+  int totalColSpacing = (columnCount()-1) * mColumnSpacing;
+  QVector<int> colWidths = getSectionSizes(maxColWidths, minColWidths, mColumnStretchFactors.toVector(), mRect.width()-totalColSpacing);
+  QVector<int> rowHeights = getSectionSizes(maxRowHeights, minRowHeights, mRowStretchFactors.mid(beginRow, endRow-beginRow).toVector(), mRect.height()-totalRowSpacing);
+  
+  // place the visible rows, elements in the other rows get an empty rect, so they're neither drawn nor hit by selection tests:
+  int yOffset = mRect.top();
+  for (int row=0; row<rowCount(); ++row)
+  {
+    if (row < beginRow || row >= endRow)
+    {
+      for (int col=0; col<columnCount(); ++col)
+      {
+        if (mElements.at(row).at(col))
+          mElements.at(row).at(col)->setOuterRect(QRect());
+      }
+      continue;
+    }
+    if (row > beginRow)
+      yOffset += rowHeights.at(row-beginRow-1)+mRowSpacing;
+    int xOffset = mRect.left();
+    for (int col=0; col<columnCount(); ++col)
+    {
+      if (col > 0)
+        xOffset += colWidths.at(col-1)+mColumnSpacing;
+      if (mElements.at(row).at(col))
+        mElements.at(row).at(col)->setOuterRect(QRect(xOffset, yOffset, colWidths.at(col), rowHeights.at(row-beginRow)));
+    }
+  }
+}
+
+/* inherits documentation from base class */
+QSize QCPLegend::minimumSizeHint() const
+{
+  if (!mVirtualized)
+    return QCPLayoutGrid::minimumSizeHint();
+  
+  QVector<int> minColWidths, minRowHeights, maxColWidths, maxRowHeights;
+  getVisibleRowColSizes(&minColWidths, &minRowHeights, &maxColWidths, &maxRowHeights);
+  QSize result(0, 0);
+  for (int i=0; i<minColWidths.size(); ++i)
+    result.rwidth() += minColWidths.at(i);
+  for (int i=0; i<minRowHeights.size(); ++i)
+    result.rheight() += minRowHeights.at(i);
+  result.rwidth() += qMax(0, columnCount()-1) * mColumnSpacing + mMargins.left() + mMargins.right();
+  result.rheight() += qMax(0, minRowHeights.size()-1) * mRowSpacing + mMargins.top() + mMargins.bottom();
+  return result;
+}
+
+/* inherits documentation from base class */
+QSize QCPLegend::maximumSizeHint() const
+{
+  if (!mVirtualized)
+    return QCPLayoutGrid::maximumSizeHint();
+  
+  QVector<int> minColWidths, minRowHeights, maxColWidths, maxRowHeights;
+  getVisibleRowColSizes(&minColWidths, &minRowHeights, &maxColWidths, &maxRowHeights);
+  QSize result(0, 0);
+  for (int i=0; i<maxColWidths.size(); ++i)
+    result.setWidth(qMin(result.width()+maxColWidths.at(i), QWIDGETSIZE_MAX));
+  for (int i=0; i<maxRowHeights.size(); ++i)
+    result.setHeight(qMin(result.height()+maxRowHeights.at(i), QWIDGETSIZE_MAX));
+  result.rwidth() += qMax(0, columnCount()-1) * mColumnSpacing + mMargins.left() + mMargins.right();
+  result.rheight() += qMax(0, maxRowHeights.size()-1) * mRowSpacing + mMargins.top() + mMargins.bottom();
+  return result;
+}
+
+/*! \internal
+  
+  Places the range of rows that are visible in a virtualized legend into \a begin (first visible
+  row) and \a end (one past the last visible row). The scroll position is limited such that \ref
+  setVisibleRowCount rows are visible, if there are enough rows.
+*/
+void QCPLegend::getVisibleRows(int *begin, int *end) const
+{
+  *begin = qBound(0, mScrollPosition, qMax(0, rowCount()-mVisibleRowCount));
+  *end = qMin(rowCount(), *begin+mVisibleRowCount);
+}
+
+/*! \internal
+  
+  The counterpart of \ref QCPLayoutGrid::getMinimumRowColSizes and \ref
+  QCPLayoutGrid::getMaximumRowColSizes for virtualized legends: Only the elements in the visible
+  rows (see \ref getVisibleRows) are asked for their size hints. The row vectors only contain the
+  visible rows.
+*/
+void QCPLegend::getVisibleRowColSizes(QVector<int> *minColWidths, QVector<int> *minRowHeights, QVector<int> *maxColWidths, QVector<int> *maxRowHeights) const
+{
+  int beginRow, endRow;
+  getVisibleRows(&beginRow, &endRow);
+  *minColWidths = QVector<int>(columnCount(), 0);
+  *minRowHeights = QVector<int>(endRow-beginRow, 0);
+  *maxColWidths = QVector<int>(columnCount(), QWIDGETSIZE_MAX);
+  *maxRowHeights = QVector<int>(endRow-beginRow, QWIDGETSIZE_MAX);
+  for (int row=beginRow; row<endRow; ++row)
+  {
+    for (int col=0; col<columnCount(); ++col)
+    {
+      if (QCPLayoutElement *el = mElements.at(row).at(col))
+      {
+        QSize minHint = el->minimumSizeHint();
+        QSize min = el->minimumSize();
+        QSize minFinal(min.width() > 0 ? min.width() : minHint.width(), min.height() > 0 ? min.height() : minHint.height());
+        if (minColWidths->at(col) < minFinal.width())
+          (*minColWidths)[col] = minFinal.width();
+        if (minRowHeights->at(row-beginRow) < minFinal.height())
+          (*minRowHeights)[row-beginRow] = minFinal.height();
+        
+        QSize maxHint = el->maximumSizeHint();
+        QSize max = el->maximumSize();
+        QSize maxFinal(max.width() < QWIDGETSIZE_MAX ? max.width() : maxHint.width(), max.height() < QWIDGETSIZE_MAX ? max.height() : maxHint.height());
+        if (maxColWidths->at(col) > maxFinal.width())
+          (*maxColWidths)[col] = maxFinal.width();
+        if (maxRowHeights->at(row-beginRow) > maxFinal.height())
+          (*maxRowHeights)[row-beginRow] = maxFinal.height();
+      }
+    }
+  }
+}
+
 /*! \internal
   
   Returns the pen used to paint the border of the legend, taking into account the selection state
@@ -827,6 +1182,32 @@ QBrush QCPLegend::getBrush() const
   return mSelectedParts.testFlag(spLegendBox) ? mSelectedBrush : mBrush;
 }
 
+/*! \internal
+  
+  Removes and deletes all \a items that are in this legend. Unlike calling \ref removeItem for each
+  item, the legend is traversed and simplified only once, so removing many items takes linear
+  time. This is used by \ref clearItems and the bulk removal functions of QCustomPlot, e.g. \ref
+  QCustomPlot::clearPlottables.
+*/
+void QCPLegend::removeItems(const QSet<QCPAbstractLegendItem*> &items)
+{
+  if (items.isEmpty())
+    return;
+  
+  QList<QCPAbstractLegendItem*> removedItems;
+  for (int i=0; i<elementCount(); ++i)
+  {
+    QCPAbstractLegendItem *ali = item(i);
+    if (ali && items.contains(ali))
+    {
+      takeAt(i);
+      removedItems.append(ali);
+    }
+  }
+  simplify();
+  qDeleteAll(removedItems);
+}
+
 /*! \internal
   
   Draws the legend box with the provided \a painter. The individual legend items are layerables
@@ -882,6 +1263,29 @@ void QCPLegend::deselectEvent(bool *selectionStateChanged)
   }
 }
 
+/*! \internal
+  
+  Scrolls a virtualized legend (\ref setVirtualized) by one row per wheel step and replots.
+  
+  Note, that event->delta() is usually +/-120 for single rotation steps. Smaller deltas (e.g. from
+  touchpads) still scroll by one row.
+*/
+void QCPLegend::wheelEvent(QWheelEvent *event)
+{
+  if (!mVirtualized || event->delta() == 0)
+    return;
+  int steps = event->delta()/120;
+  if (steps == 0)
+    steps = event->delta() > 0 ? 1 : -1;
+  int newPosition = qBound(0, mScrollPosition-steps, qMax(0, rowCount()-mVisibleRowCount));
+  if (newPosition != mScrollPosition)
+  {
+    setScrollPosition(newPosition);
+    if (mParentPlot)
+      mParentPlot->replot();
+  }
+}
+
 /* inherits documentation from base class */
 QCP::Interaction QCPLegend::selectionCategory() const
 {
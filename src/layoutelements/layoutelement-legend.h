@@ -51,7 +51,7 @@ public:
   explicit QCPAbstractLegendItem(QCPLegend *parent);
   
   // getters:
-  QCPLegend *parentLegend() const { return mParentLegend; }
+  QCPLegend *parentLegend() const;
   QFont font() const { return mFont; }
   QColor textColor() const { return mTextColor; }
   QFont selectedFont() const { return mSelectedFont; }
@@ -76,7 +76,7 @@ signals:
   
 protected:
   // property members:
-  QCPLegend *mParentLegend;
+  QPointer<QCPLegend> mParentLegend;
   QFont mFont;
   QColor mTextColor;
   QFont mSelectedFont;
@@ -91,6 +91,7 @@ protected:
   // events:
   virtual void selectEvent(QMouseEvent *event, bool additive, const QVariant &details, bool *selectionStateChanged);
   virtual void deselectEvent(bool *selectionStateChanged);
+  virtual void wheelEvent(QWheelEvent *event);
   
 private:
   Q_DISABLE_COPY(QCPAbstractLegendItem)
@@ -104,6 +105,7 @@ class QCP_LIB_DECL QCPPlottableLegendItem : public QCPAbstractLegendItem
   Q_OBJECT
 public:
   QCPPlottableLegendItem(QCPLegend *parent, QCPAbstractPlottable *plottable);
+  virtual ~QCPPlottableLegendItem();
   
   // getters:
   QCPAbstractPlottable *plottable() { return mPlottable; }
@@ -112,6 +114,12 @@ protected:
   // property members:
   QCPAbstractPlottable *mPlottable;
   
+  // non-property members:
+  QPixmap mCachedPixmap;
+  QByteArray mCachedPixmapHash;
+  mutable QSize mCachedSize;
+  mutable QByteArray mCachedSizeHash;
+  
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter);
   virtual QSize minimumSizeHint() const;
@@ -120,6 +128,11 @@ protected:
   QPen getIconBorderPen() const;
   QColor getTextColor() const;
   QFont getFont() const;
+  void drawContent(QCPPainter *painter);
+  QByteArray generateSizeHash() const;
+  QByteArray generateAppearanceHash() const;
+  
+  friend class QCPLegend;
 };
 
 
@@ -141,6 +154,9 @@ class QCP_LIB_DECL QCPLegend : public QCPLayoutGrid
   Q_PROPERTY(QBrush selectedBrush READ selectedBrush WRITE setSelectedBrush)
   Q_PROPERTY(QFont selectedFont READ selectedFont WRITE setSelectedFont)
   Q_PROPERTY(QColor selectedTextColor READ selectedTextColor WRITE setSelectedTextColor)
+  Q_PROPERTY(bool virtualized READ virtualized WRITE setVirtualized)
+  Q_PROPERTY(int visibleRowCount READ visibleRowCount WRITE setVisibleRowCount)
+  Q_PROPERTY(int scrollPosition READ scrollPosition WRITE setScrollPosition)
   /// \endcond
 public:
   /*!
@@ -173,6 +189,9 @@ public:
   QBrush selectedBrush() const { return mSelectedBrush; }
   QFont selectedFont() const { return mSelectedFont; }
   QColor selectedTextColor() const { return mSelectedTextColor; }
+  bool virtualized() const { return mVirtualized; }
+  int visibleRowCount() const { return mVisibleRowCount; }
+  int scrollPosition() const { return mScrollPosition; }
   
   // setters:
   void setBorderPen(const QPen &pen);
@@ -190,8 +209,14 @@ public:
   void setSelectedBrush(const QBrush &brush);
   void setSelectedFont(const QFont &font);
   void setSelectedTextColor(const QColor &color);
+  void setVirtualized(bool enabled);
+  void setVisibleRowCount(int count);
+  void setScrollPosition(int row);
   
   // reimplemented virtual methods:
+  virtual void updateLayout();
+  virtual QSize minimumSizeHint() const;
+  virtual QSize maximumSizeHint() const;
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const;
   
   // non-virtual methods:
@@ -205,6 +230,7 @@ public:
   bool removeItem(QCPAbstractLegendItem *item);
   void clearItems();
   QList<QCPAbstractLegendItem*> selectedItems() const;
+  void clearItemCaches();
   
 signals:
   void selectionChanged(QCPLegend::SelectableParts parts);
@@ -223,6 +249,10 @@ protected:
   QBrush mSelectedBrush;
   QFont mSelectedFont;
   QColor mSelectedTextColor;
+  bool mVirtualized;
+  int mVisibleRowCount, mScrollPosition;
+  // non-property members:
+  QMultiHash<const QCPAbstractPlottable*, QCPPlottableLegendItem*> mPlottableItems; // plottable legend items created with this legend as parent, maintained by QCPPlottableLegendItem
   
   // reimplemented virtual methods:
   virtual void parentPlotInitialized(QCustomPlot *parentPlot);
@@ -232,16 +262,21 @@ protected:
   // events:
   virtual void selectEvent(QMouseEvent *event, bool additive, const QVariant &details, bool *selectionStateChanged);
   virtual void deselectEvent(bool *selectionStateChanged);
+  virtual void wheelEvent(QWheelEvent *event);
   
   // non-virtual methods:
   QPen getBorderPen() const;
   QBrush getBrush() const;
+  void removeItems(const QSet<QCPAbstractLegendItem*> &items);
+  void getVisibleRows(int *begin, int *end) const;
+  void getVisibleRowColSizes(QVector<int> *minColWidths, QVector<int> *minRowHeights, QVector<int> *maxColWidths, QVector<int> *maxRowHeights) const;
   
 private:
   Q_DISABLE_COPY(QCPLegend)
   
   friend class QCustomPlot;
   friend class QCPAbstractLegendItem;
+  friend class QCPPlottableLegendItem;
 };
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCPLegend::SelectableParts)
 Q_DECLARE_METATYPE(QCPLegend::SelectablePart)
@@ -132,6 +132,33 @@ void QCPPainter::drawLine(const QLineF &line)
     QPainter::drawLine(line.toLine());
 }
 
+/*! \overload
+  
+  Draws the first \a lineCount lines in \a lines with a single call to the underlying paint
+  engine. This is much faster than calling \ref drawLine for each line individually, because the
+  per-call overhead of QPainter is only paid once.
+  
+  The same workaround as in \ref drawLine(const QLineF &line) is applied, i.e. when antialiasing is
+  disabled, the lines are rounded to integer coordinates before being drawn.
+  
+  \note this function hides the non-virtual base class implementation.
+*/
+void QCPPainter::drawLines(const QLineF *lines, int lineCount)
+{
+  if (lineCount <= 0)
+    return;
+  if (mIsAntialiasing || mModes.testFlag(pmVectorized))
+  {
+    QPainter::drawLines(lines, lineCount);
+  } else
+  {
+    QVector<QLine> roundedLines(lineCount);
+    for (int i=0; i<lineCount; ++i)
+      roundedLines[i] = lines[i].toLine();
+    QPainter::drawLines(roundedLines.constData(), lineCount);
+  }
+}
+
 /*!
   Sets whether painting uses antialiasing or not. Use this method instead of using setRenderHint
   with QPainter::Antialiasing directly, as it allows QCPPainter to regain pixel exactness between
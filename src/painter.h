@@ -144,6 +144,9 @@ public:
   void setPen(Qt::PenStyle penStyle);
   void drawLine(const QLineF &line);
   void drawLine(const QPointF &p1, const QPointF &p2) {drawLine(QLineF(p1, p2));}
+  using QPainter::drawLines;
+  void drawLines(const QLineF *lines, int lineCount);
+  void drawLines(const QVector<QLineF> &lines) {drawLines(lines.constData(), lines.size());}
   void save();
   void restore();
   
@@ -31,6 +31,113 @@
 #include "layoutelements/layoutelement-axisrect.h"
 #include "layoutelements/layoutelement-legend.h"
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPScratchPool
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPScratchPool
+  \brief A pool of reusable temporary buffers for replot-time calculations.
+  
+  Plottables need several temporary vectors during each replot, e.g. the prepared data points and
+  their pixel coordinates. Allocating and freeing these large buffers anew on every replot causes
+  considerable allocator load and page faults, especially with high replot rates of live data.
+  
+  A QCPScratchPool hands out buffers via \ref acquire and takes them back via \ref release. Released
+  buffers are emptied but keep their allocated capacity, so the next replot can reuse the memory
+  without reallocation. Usually you don't call \ref acquire and \ref release directly, but use a
+  QCPScratchBuffer, which returns its buffer to the pool automatically when it goes out of scope.
+  
+  The pool keeps track of its memory consumption: \ref retainedBytes is the memory currently held
+  by idle buffers, \ref peakBytes the highest value this ever reached, and \ref peakSize the
+  largest number of elements any single buffer held upon release. Call \ref squeeze to free all
+  retained memory, e.g. after a temporarily very large data set was removed.
+  
+  Scratch pools are not thread-safe. Like the plottables owning them, they must only be used from
+  the thread the QCustomPlot lives in.
+*/
+
+/*! \fn QVector<T> *QCPScratchPool::acquire()
+  
+  Returns an empty buffer from the pool, or a newly allocated one if no idle buffers are
+  available. The buffer must be returned to the pool with \ref release after use.
+*/
+
+/*! \fn void QCPScratchPool::release(QVector<T> *buffer)
+  
+  Returns \a buffer, previously obtained by \ref acquire, to the pool. The buffer is emptied but
+  keeps its capacity, so it can be reused without reallocation.
+*/
+
+/*! \fn void QCPScratchPool::squeeze()
+  
+  Frees all idle buffers held by the pool. Buffers that are currently acquired are not affected.
+*/
+
+/*! \class QCPScratchBuffer
+  \brief Scope guard that borrows a buffer from a QCPScratchPool.
+  
+  The buffer is acquired from the pool passed to the constructor and released back to it in the
+  destructor. Access the borrowed QVector via \ref data or the pointer-like operators.
+*/
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPDataQueue
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPDataQueue
+  \brief A lock-free queue for passing data points from a producer thread to a plottable.
+  
+  QCustomPlot and its plottables are not thread-safe, so data acquired in a worker thread can't be
+  added to a plottable directly. Instead of marshalling every batch through queued signals, the
+  acquisition thread may \ref push data points into a QCPDataQueue, e.g. the one provided by \ref
+  QCPGraph::dataQueue. The plottable drains the queue in bulk at the beginning of each \ref
+  QCustomPlot::replot, so the data is applied in large batches in the GUI thread.
+  
+  The queue is a fixed size ring buffer that is safe for exactly one producer thread and one
+  consumer thread (the GUI thread) operating concurrently, without any locking. If multiple threads
+  produce data, they must synchronize their calls to \ref push among each other.
+  
+  If the queue is full, data points that don't fit are dropped and counted. The producer can react
+  to back-pressure by checking the return value of \ref push or by querying \ref freeSpace before
+  pushing, and the number of dropped points is available via \ref droppedCount.
+*/
+
+/*! \fn QCPDataQueue::QCPDataQueue(int capacity)
+  
+  Creates a queue that can hold at least \a capacity data points. The capacity is rounded up such
+  that the internal ring buffer size is a power of two.
+*/
+
+/*! \fn int QCPDataQueue::size() const
+  
+  Returns the number of data points currently in the queue. Since the other thread may be pushing
+  or draining concurrently, this is only a snapshot.
+*/
+
+/*! \fn int QCPDataQueue::push(const T *data, int count)
+  
+  Appends the \a count data points in \a data to the queue and returns the number of points that
+  were accepted. If the queue doesn't have enough free space, the remaining points are dropped and
+  added to the \ref droppedCount.
+  
+  This function may only be called from the producer thread.
+*/
+
+/*! \fn int QCPDataQueue::drain(QVector<T> *target, int maxCount)
+  
+  Moves up to \a maxCount data points (all, if \a maxCount is negative) from the queue to the end
+  of \a target and returns the number of moved points.
+  
+  This function may only be called from the consumer thread.
+*/
+
+/*! \fn int QCPDataQueue::resetDroppedCount()
+  
+  Resets the number of dropped data points to zero and returns the number before the reset.
+*/
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPAbstractPlottable
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -510,6 +617,20 @@ bool QCPAbstractPlottable::removeFromLegend() const
     return false;
 }
 
+/*! \internal
+  
+  Called by \ref QCustomPlot::replot before anything is drawn, to apply data that was passed to the
+  plottable from other threads, e.g. via a \ref QCPDataQueue. Returns the number of data points
+  that were applied.
+  
+  The default implementation does nothing and returns 0. Plottables which offer a data queue
+  reimplement this function to drain it into their data.
+*/
+int QCPAbstractPlottable::applyQueuedData()
+{
+  return 0;
+}
+
 /* inherits documentation from base class */
 QRect QCPAbstractPlottable::clipRect() const
 {
@@ -704,23 +825,46 @@ void QCPAbstractPlottable::applyErrorBarsAntialiasingHint(QCPPainter *painter) c
 */
 double QCPAbstractPlottable::distSqrToLine(const QPointF &start, const QPointF &end, const QPointF &point) const
 {
-  QVector2D a(start);
-  QVector2D b(end);
-  QVector2D p(point);
-  QVector2D v(b-a);
+  return QCP::distSqrToLine(start, end, point);
+}
+
+/*! \internal
+  
+  Returns the number of output device dots per viewport pixel, if the plot is currently being
+  exported to a vector format with a resolution set via \ref QCustomPlot::setVectorResolution.
+  Plottables with large data sets then reduce their geometry to this resolution. Otherwise, e.g.
+  when drawing to the screen, returns 0.
+*/
+double QCPAbstractPlottable::exportSamplingScale() const
+{
+  return mParentPlot ? mParentPlot->mExportSamplingScale : 0;
+}
+
+/*! \internal
   
-  double vLengthSqr = v.lengthSquared();
-  if (!qFuzzyIsNull(vLengthSqr))
-  {
-    double mu = QVector2D::dotProduct(p-a, v)/vLengthSqr;
-    if (mu < 0)
-      return (a-p).lengthSquared();
-    else if (mu > 1)
-      return (b-p).lengthSquared();
-    else
-      return ((a + mu*v)-p).lengthSquared();
-  } else
-    return (a-p).lengthSquared();
+  Returns the time in milliseconds since the current profiled replot started, or 0 if the replot
+  isn't profiled (see \ref QCustomPlot::setProfiling).
+  
+  \see addProfilePreparationTime
+*/
+double QCPAbstractPlottable::profileTime() const
+{
+  return mParentPlot ? mParentPlot->profileTime() : 0;
+}
+
+/*! \internal
+  
+  Adds the time passed since \a startTime (obtained with \ref profileTime) to the data preparation
+  time of this plottable in the current profiled replot. Plottables call this around the parts of
+  their \ref draw implementation that transform data to pixel geometry, so the replot profile can
+  tell them apart from the time spent rasterizing with QPainter.
+  
+  Does nothing if the replot isn't profiled.
+*/
+void QCPAbstractPlottable::addProfilePreparationTime(double startTime) const
+{
+  if (mParentPlot && mParentPlot->mCurrentReplotProfile)
+    mParentPlot->mProfilePreparationTime += mParentPlot->profileTime()-startTime;
 }
 
 /* inherits documentation from base class */
@@ -33,6 +33,159 @@
 
 class QCPPainter;
 
+template <class T>
+class QCPScratchPool
+{
+public:
+  QCPScratchPool() : mRetainedBytes(0), mPeakBytes(0), mPeakSize(0) {}
+  ~QCPScratchPool() { qDeleteAll(mFreeBuffers); }
+  
+  // getters:
+  int peakSize() const { return mPeakSize; }
+  qint64 peakBytes() const { return mPeakBytes; }
+  qint64 retainedBytes() const { return mRetainedBytes; }
+  
+  // non-property methods:
+  QVector<T> *acquire()
+  {
+    if (mFreeBuffers.isEmpty())
+      return new QVector<T>;
+    QVector<T> *buffer = mFreeBuffers.takeLast();
+    mRetainedBytes -= qint64(buffer->capacity())*sizeof(T);
+    return buffer;
+  }
+  void release(QVector<T> *buffer)
+  {
+    if (!buffer) return;
+    if (buffer->size() > mPeakSize)
+      mPeakSize = buffer->size();
+    buffer->reserve(buffer->capacity()); // marks capacity as reserved, so resize(0) doesn't free the memory
+    buffer->resize(0);
+    mFreeBuffers.append(buffer);
+    mRetainedBytes += qint64(buffer->capacity())*sizeof(T);
+    if (mRetainedBytes > mPeakBytes)
+      mPeakBytes = mRetainedBytes;
+  }
+  void squeeze()
+  {
+    qDeleteAll(mFreeBuffers);
+    mFreeBuffers.clear();
+    mRetainedBytes = 0;
+  }
+  
+protected:
+  QList<QVector<T>*> mFreeBuffers;
+  qint64 mRetainedBytes, mPeakBytes;
+  int mPeakSize;
+  
+private:
+  Q_DISABLE_COPY(QCPScratchPool)
+};
+
+template <class T>
+class QCPScratchBuffer
+{
+public:
+  explicit QCPScratchBuffer(QCPScratchPool<T> &pool) : mPool(pool), mBuffer(pool.acquire()) {}
+  ~QCPScratchBuffer() { mPool.release(mBuffer); }
+  
+  QVector<T> *data() const { return mBuffer; }
+  QVector<T> *operator->() const { return mBuffer; }
+  QVector<T> &operator*() const { return *mBuffer; }
+  
+protected:
+  QCPScratchPool<T> &mPool;
+  QVector<T> *mBuffer;
+  
+private:
+  Q_DISABLE_COPY(QCPScratchBuffer)
+};
+
+
+template <class T>
+class QCPDataQueue
+{
+public:
+  explicit QCPDataQueue(int capacity) :
+    mDroppedCount(0)
+  {
+    int bufferSize = 2;
+    while (bufferSize <= capacity && bufferSize < (1<<30))
+      bufferSize *= 2;
+    mBuffer.resize(bufferSize);
+    mData = mBuffer.data(); // detach once here, so producer and consumer never touch the vector's reference count
+    mMask = bufferSize-1;
+  }
+  
+  // getters:
+  int capacity() const { return mMask; }
+  int size() const { return (loadAcquire(mHead)-loadAcquire(mTail)) & mMask; }
+  int freeSpace() const { return capacity()-size(); }
+  bool isEmpty() const { return loadAcquire(mHead) == loadAcquire(mTail); }
+  int droppedCount() const { return loadAcquire(mDroppedCount); }
+  
+  // non-property methods (producer side):
+  bool push(const T &data) { return push(&data, 1) == 1; }
+  int push(const T *data, int count)
+  {
+    const int head = loadAcquire(mHead); // only modified by the producer
+    const int tail = loadAcquire(mTail);
+    const int freeSlots = mMask-((head-tail) & mMask);
+    const int accepted = qMin(count, freeSlots);
+    for (int i=0; i<accepted; ++i)
+      mData[(head+i) & mMask] = data[i];
+    storeRelease(mHead, (head+accepted) & mMask);
+    if (accepted < count)
+      mDroppedCount.fetchAndAddOrdered(count-accepted);
+    return accepted;
+  }
+  
+  // non-property methods (consumer side):
+  int drain(QVector<T> *target, int maxCount=-1)
+  {
+    const int tail = loadAcquire(mTail); // only modified by the consumer
+    const int head = loadAcquire(mHead);
+    int count = (head-tail) & mMask;
+    if (maxCount >= 0 && count > maxCount)
+      count = maxCount;
+    const int oldSize = target->size();
+    target->resize(oldSize+count);
+    T *targetData = target->data()+oldSize;
+    for (int i=0; i<count; ++i)
+      targetData[i] = mData[(tail+i) & mMask];
+    storeRelease(mTail, (tail+count) & mMask);
+    return count;
+  }
+  int resetDroppedCount() { return mDroppedCount.fetchAndStoreOrdered(0); }
+  
+protected:
+  QVector<T> mBuffer;
+  T *mData;
+  int mMask;
+  QAtomicInt mHead, mTail, mDroppedCount;
+  
+  static int loadAcquire(const QAtomicInt &value)
+  {
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+    return const_cast<QAtomicInt&>(value).fetchAndAddAcquire(0);
+#else
+    return value.loadAcquire();
+#endif
+  }
+  static void storeRelease(QAtomicInt &value, int newValue)
+  {
+#if QT_VERSION < QT_VERSION_CHECK(5, 0, 0)
+    value.fetchAndStoreRelease(newValue);
+#else
+    value.storeRelease(newValue);
+#endif
+  }
+  
+private:
+  Q_DISABLE_COPY(QCPDataQueue)
+};
+
+
 class QCP_LIB_DECL QCPAbstractPlottable : public QCPLayerable
 {
   Q_OBJECT
@@ -126,6 +279,7 @@ protected:
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const = 0;
   virtual QCPRange getKeyRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const = 0;
   virtual QCPRange getValueRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const = 0;
+  virtual int applyQueuedData();
   
   // non-virtual methods:
   void coordsToPixels(double key, double value, double &x, double &y) const;
@@ -138,6 +292,9 @@ protected:
   void applyScattersAntialiasingHint(QCPPainter *painter) const;
   void applyErrorBarsAntialiasingHint(QCPPainter *painter) const;
   double distSqrToLine(const QPointF &start, const QPointF &end, const QPointF &point) const;
+  double exportSamplingScale() const;
+  double profileTime() const;
+  void addProfilePreparationTime(double startTime) const;
 
 private:
   Q_DISABLE_COPY(QCPAbstractPlottable)
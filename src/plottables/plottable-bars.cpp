@@ -106,7 +106,11 @@ QCPBarsGroup::QCPBarsGroup(QCustomPlot *parentPlot) :
   QObject(parentPlot),
   mParentPlot(parentPlot),
   mSpacingType(stAbsolute),
-  mSpacing(4)
+  mSpacing(4),
+  mBaseBarsValid(false),
+  mOffsetsRangeReversed(false),
+  mOffsetsScaleType(QCPAxis::stLinear),
+  mOffsetsKeyIndependent(false)
 {
 }
 
@@ -125,6 +129,7 @@ QCPBarsGroup::~QCPBarsGroup()
 void QCPBarsGroup::setSpacingType(SpacingType spacingType)
 {
   mSpacingType = spacingType;
+  invalidateKeyPixelOffsets();
 }
 
 /*!
@@ -136,6 +141,7 @@ void QCPBarsGroup::setSpacingType(SpacingType spacingType)
 void QCPBarsGroup::setSpacing(double spacing)
 {
   mSpacing = spacing;
+  invalidateKeyPixelOffsets();
 }
 
 /*!
@@ -209,6 +215,7 @@ void QCPBarsGroup::insert(int i, QCPBars *bars)
     bars->setBarsGroup(this);
   // then move to according position:
   mBars.move(mBars.indexOf(bars), qBound(0, i, mBars.size()-1));
+  invalidateKeyPixelOffsets();
 }
 
 /*!
@@ -241,6 +248,7 @@ void QCPBarsGroup::registerBars(QCPBars *bars)
 {
   if (!mBars.contains(bars))
     mBars.append(bars);
+  invalidateKeyPixelOffsets();
 }
 
 /*! \internal
@@ -253,6 +261,7 @@ void QCPBarsGroup::registerBars(QCPBars *bars)
 void QCPBarsGroup::unregisterBars(QCPBars *bars)
 {
   mBars.removeOne(bars);
+  invalidateKeyPixelOffsets();
 }
 
 /*! \internal
@@ -260,80 +269,114 @@ void QCPBarsGroup::unregisterBars(QCPBars *bars)
   Returns the pixel offset in the key dimension the specified \a bars plottable should have at the
   given key coordinate \a keyCoord. The offset is relative to the pixel position of the key
   coordinate \a keyCoord.
+  
+  This is called for every bar that is drawn, so the offsets of all bars in the group are
+  calculated at once by \ref getKeyPixelOffsets and kept. Unless the bar widths or spacings depend
+  on the key (which is only the case for \ref QCPBars::wtPlotCoords or \ref stPlotCoords on a
+  logarithmic key axis), they are reused for all keys until the key axis range or the axis rect
+  size changes, or the group is changed (see \ref invalidateKeyPixelOffsets).
 */
 double QCPBarsGroup::keyPixelOffset(const QCPBars *bars, double keyCoord)
 {
-  // find list of all base bars in case some mBars are stacked:
-  QList<const QCPBars*> baseBars;
-  foreach (const QCPBars *b, mBars)
-  {
-    while (b->barBelow())
-      b = b->barBelow();
-    if (!baseBars.contains(b))
-      baseBars.append(b);
-  }
   // find base bar this "bars" is stacked on:
   const QCPBars *thisBase = bars;
   while (thisBase->barBelow())
     thisBase = thisBase->barBelow();
   
-  // determine key pixel offset of this base bars considering all other base bars in this barsgroup:
-  double result = 0;
-  int index = baseBars.indexOf(thisBase);
-  if (index >= 0)
+  // find list of all base bars in case some mBars are stacked:
+  if (!mBaseBarsValid)
   {
-    int startIndex;
-    double lowerPixelWidth, upperPixelWidth;
-    if (baseBars.size() % 2 == 1 && index == (baseBars.size()-1)/2) // is center bar (int division on purpose)
-    {
-      return result;
-    } else if (index < (baseBars.size()-1)/2.0) // bar is to the left of center
+    mBaseBars.clear();
+    foreach (const QCPBars *b, mBars)
     {
-      if (baseBars.size() % 2 == 0) // even number of bars
-      {
-        startIndex = baseBars.size()/2-1;
-        result -= getPixelSpacing(baseBars.at(startIndex), keyCoord)*0.5; // half of middle spacing
-      } else // uneven number of bars
-      {
-        startIndex = (baseBars.size()-1)/2-1;
-        baseBars.at((baseBars.size()-1)/2)->getPixelWidth(keyCoord, lowerPixelWidth, upperPixelWidth);
-        result -= qAbs(upperPixelWidth-lowerPixelWidth)*0.5; // half of center bar
-        result -= getPixelSpacing(baseBars.at((baseBars.size()-1)/2), keyCoord); // center bar spacing
-      }
-      for (int i=startIndex; i>index; --i) // add widths and spacings of bars in between center and our bars
-      {
-        baseBars.at(i)->getPixelWidth(keyCoord, lowerPixelWidth, upperPixelWidth);
-        result -= qAbs(upperPixelWidth-lowerPixelWidth);
-        result -= getPixelSpacing(baseBars.at(i), keyCoord);
-      }
-      // finally half of our bars width:
-      baseBars.at(index)->getPixelWidth(keyCoord, lowerPixelWidth, upperPixelWidth);
-      result -= qAbs(upperPixelWidth-lowerPixelWidth)*0.5;
-    } else // bar is to the right of center
+      while (b->barBelow())
+        b = b->barBelow();
+      if (!mBaseBars.contains(b))
+        mBaseBars.append(b);
+    }
+    mBaseBarsValid = true;
+    mOffsetsKeyAxis = 0; // forces recalculation of offsets below
+  }
+  int index = mBaseBars.indexOf(thisBase);
+  if (index < 0)
+    return 0;
+  
+  // recalculate offsets of all base bars if they depend on the key, or if the key axis transformation changed:
+  QCPAxis *keyAxis = bars->keyAxis();
+  if (!mOffsetsKeyIndependent ||
+      keyAxis != mOffsetsKeyAxis.data() ||
+      keyAxis->range() != mOffsetsKeyRange ||
+      keyAxis->rangeReversed() != mOffsetsRangeReversed ||
+      keyAxis->axisRect()->size() != mOffsetsAxisRectSize ||
+      keyAxis->scaleType() != mOffsetsScaleType)
+  {
+    getKeyPixelOffsets(&mKeyPixelOffsets, keyCoord);
+    mOffsetsKeyAxis = keyAxis;
+    mOffsetsKeyRange = keyAxis->range();
+    mOffsetsRangeReversed = keyAxis->rangeReversed();
+    mOffsetsAxisRectSize = keyAxis->axisRect()->size();
+    mOffsetsScaleType = keyAxis->scaleType();
+    // on linear axes, widths and spacings in plot coordinates have the same pixel size at all keys:
+    mOffsetsKeyIndependent = true;
+    if (mOffsetsScaleType == QCPAxis::stLogarithmic)
     {
-      if (baseBars.size() % 2 == 0) // even number of bars
-      {
-        startIndex = baseBars.size()/2;
-        result += getPixelSpacing(baseBars.at(startIndex), keyCoord)*0.5; // half of middle spacing
-      } else // uneven number of bars
-      {
-        startIndex = (baseBars.size()-1)/2+1;
-        baseBars.at((baseBars.size()-1)/2)->getPixelWidth(keyCoord, lowerPixelWidth, upperPixelWidth);
-        result += qAbs(upperPixelWidth-lowerPixelWidth)*0.5; // half of center bar
-        result += getPixelSpacing(baseBars.at((baseBars.size()-1)/2), keyCoord); // center bar spacing
-      }
-      for (int i=startIndex; i<index; ++i) // add widths and spacings of bars in between center and our bars
+      if (mSpacingType == stPlotCoords)
+        mOffsetsKeyIndependent = false;
+      foreach (const QCPBars *b, mBaseBars)
       {
-        baseBars.at(i)->getPixelWidth(keyCoord, lowerPixelWidth, upperPixelWidth);
-        result += qAbs(upperPixelWidth-lowerPixelWidth);
-        result += getPixelSpacing(baseBars.at(i), keyCoord);
+        if (b->widthType() == QCPBars::wtPlotCoords)
+          mOffsetsKeyIndependent = false;
       }
-      // finally half of our bars width:
-      baseBars.at(index)->getPixelWidth(keyCoord, lowerPixelWidth, upperPixelWidth);
-      result += qAbs(upperPixelWidth-lowerPixelWidth)*0.5;
     }
   }
-  return result;
+  return mKeyPixelOffsets.at(index);
+}
+
+/*! \internal
+  
+  Calculates the key pixel offsets of all base bars of this group (the bottom-most bars of each
+  stack) at the key coordinate \a keyCoord, and writes them to \a offsets, in the order of the base
+  bars list. The bars are placed next to each other, separated by the spacing, such that the group
+  is centered around the key.
+*/
+void QCPBarsGroup::getKeyPixelOffsets(QVector<double> *offsets, double keyCoord)
+{
+  const int count = mBaseBars.size();
+  offsets->resize(count);
+  if (count == 0)
+    return;
+  
+  const double spacing = getPixelSpacing(mBaseBars.first(), keyCoord);
+  double position = 0;
+  double center = 0;
+  double previousHalfWidth = 0;
+  double lowerPixelWidth, upperPixelWidth;
+  for (int i=0; i<count; ++i)
+  {
+    mBaseBars.at(i)->getPixelWidth(keyCoord, lowerPixelWidth, upperPixelWidth);
+    const double halfWidth = qAbs(upperPixelWidth-lowerPixelWidth)*0.5;
+    if (i > 0)
+      position += previousHalfWidth + spacing + halfWidth;
+    (*offsets)[i] = position;
+    if (count % 2 == 1 && i == (count-1)/2) // uneven number of bars, center is at the middle bars
+      center = position;
+    else if (count % 2 == 0 && i == count/2) // even number of bars, center is in the middle of the spacing before this bars
+      center = position-halfWidth-spacing*0.5;
+    previousHalfWidth = halfWidth;
+  }
+  for (int i=0; i<count; ++i)
+    (*offsets)[i] -= center;
+}
+
+/*! \internal
+  
+  Discards the key pixel offsets calculated by \ref keyPixelOffset. This is called when the bars
+  in this group, their stacking or widths, or the spacing change.
+*/
+void QCPBarsGroup::invalidateKeyPixelOffsets()
+{
+  mBaseBarsValid = false;
+  mOffsetsKeyAxis = 0;
 }
 
 /*! \internal
@@ -364,7 +407,7 @@ double QCPBarsGroup::getPixelSpacing(const QCPBars *bars, double keyCoord)
     case stPlotCoords:
     {
       double keyPixel = bars->keyAxis()->coordToPixel(keyCoord);
-      return bars->keyAxis()->coordToPixel(keyCoord+mSpacing)-keyPixel;
+      return qAbs(bars->keyAxis()->coordToPixel(keyCoord+mSpacing)-keyPixel); // pixel direction is inverted on reversed and vertical key axes
     }
   }
   return 0;
@@ -454,6 +497,16 @@ QCPBarData::QCPBarData(double key, double value) :
   \see barAbove, moveBelow, moveAbove
 */
 
+/*! \fn QCPBarDataMap *QCPBars::data() const
+  
+  Returns a pointer to the internal data storage of type \ref QCPBarDataMap. You may use it to
+  directly manipulate the data, which may be more convenient and faster than using the regular \ref
+  setData or \ref addData methods, in certain situations.
+  
+  If this bars plottable is part of a stack (see \ref moveAbove), call \ref invalidateStackCache
+  after manipulating the data directly, so the bars above it are drawn on the new values.
+*/
+
 /*! \fn QCPBars *QCPBars::barAbove() const
   Returns the bars plottable that is directly above this bars plottable.
   If there is no such plottable, returns 0.
@@ -508,6 +561,7 @@ QCPBars::~QCPBars()
 void QCPBars::setWidth(double width)
 {
   mWidth = width;
+  invalidateGroupOffsets();
 }
 
 /*!
@@ -521,6 +575,7 @@ void QCPBars::setWidth(double width)
 void QCPBars::setWidthType(QCPBars::WidthType widthType)
 {
   mWidthType = widthType;
+  invalidateGroupOffsets();
 }
 
 /*!
@@ -555,6 +610,7 @@ void QCPBars::setBarsGroup(QCPBarsGroup *barsGroup)
 void QCPBars::setBaseValue(double baseValue)
 {
   mBaseValue = baseValue;
+  invalidateStackCache();
 }
 
 /*!
@@ -579,6 +635,7 @@ void QCPBars::setData(QCPBarDataMap *data, bool copy)
     delete mData;
     mData = data;
   }
+  invalidateStackCache();
 }
 
 /*! \overload
@@ -599,6 +656,7 @@ void QCPBars::setData(const QVector<double> &key, const QVector<double> &value)
     newData.value = value[i];
     mData->insertMulti(newData.key, newData);
   }
+  invalidateStackCache();
 }
 
 /*!
@@ -674,6 +732,7 @@ void QCPBars::moveAbove(QCPBars *bars)
 void QCPBars::addData(const QCPBarDataMap &dataMap)
 {
   mData->unite(dataMap);
+  invalidateStackCache();
 }
 
 /*! \overload
@@ -683,6 +742,7 @@ void QCPBars::addData(const QCPBarDataMap &dataMap)
 void QCPBars::addData(const QCPBarData &data)
 {
   mData->insertMulti(data.key, data);
+  invalidateStackCache();
 }
 
 /*! \overload
@@ -695,6 +755,7 @@ void QCPBars::addData(double key, double value)
   newData.key = key;
   newData.value = value;
   mData->insertMulti(newData.key, newData);
+  invalidateStackCache();
 }
 
 /*! \overload
@@ -712,6 +773,7 @@ void QCPBars::addData(const QVector<double> &keys, const QVector<double> &values
     newData.value = values[i];
     mData->insertMulti(newData.key, newData);
   }
+  invalidateStackCache();
 }
 
 /*!
@@ -723,6 +785,7 @@ void QCPBars::removeDataBefore(double key)
   QCPBarDataMap::iterator it = mData->begin();
   while (it != mData->end() && it.key() < key)
     it = mData->erase(it);
+  invalidateStackCache();
 }
 
 /*!
@@ -735,6 +798,7 @@ void QCPBars::removeDataAfter(double key)
   QCPBarDataMap::iterator it = mData->upperBound(key);
   while (it != mData->end())
     it = mData->erase(it);
+  invalidateStackCache();
 }
 
 /*!
@@ -751,6 +815,7 @@ void QCPBars::removeData(double fromKey, double toKey)
   QCPBarDataMap::iterator itEnd = mData->upperBound(toKey);
   while (it != itEnd)
     it = mData->erase(it);
+  invalidateStackCache();
 }
 
 /*! \overload
@@ -764,6 +829,7 @@ void QCPBars::removeData(double fromKey, double toKey)
 void QCPBars::removeData(double key)
 {
   mData->remove(key);
+  invalidateStackCache();
 }
 
 /*!
@@ -773,6 +839,28 @@ void QCPBars::removeData(double key)
 void QCPBars::clearData()
 {
   mData->clear();
+  invalidateStackCache();
+}
+
+/*!
+  Discards the cached stack base values of this bars plottable and of all bars stacked above it
+  (see \ref moveAbove).
+  
+  To avoid walking down the whole stack for every bar, each bars plottable in a stack caches at
+  which value its bars start, per key. The cache is discarded automatically when the data of a
+  bars plottable in the stack is changed via \ref setData, \ref addData or \ref removeData, when
+  the base value changes or when the stacking changes. You only need to call this function if you
+  manipulate the data directly via the pointer returned by \ref data.
+*/
+void QCPBars::invalidateStackCache()
+{
+  // the base values of all bars above depend on this bars plottable:
+  QCPBars *bars = this;
+  while (bars)
+  {
+    bars->mStackBaseCache.clear();
+    bars = bars->mBarAbove.data();
+  }
 }
 
 /* inherits documentation from base class */
@@ -795,37 +883,126 @@ double QCPBars::selectTest(const QPointF &pos, bool onlySelectable, QVariant *de
   return -1;
 }
 
-/* inherits documentation from base class */
+/*! \internal
+  
+  Draws the visible bars with \a painter.
+  
+  The bars are first collected, then all fills are drawn in one call and all outlines in another
+  call, so the painter state only changes twice per plottable instead of twice per bar. If bars
+  overlap, this means the outlines of all bars lie above the fills of all bars.
+  
+  Consecutive bars that are narrower than one pixel and fall into the same pixel column are merged
+  and drawn as one bar that spans their minimum and maximum, because they can't be distinguished
+  anyway. In vector exports, this is only done with a resolution set via \ref
+  QCustomPlot::setVectorResolution, using columns of one output device dot.
+*/
 void QCPBars::draw(QCPPainter *painter)
 {
   if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   if (mData->isEmpty()) return;
-  
+  const bool hasFill = mainBrush().style() != Qt::NoBrush && mainBrush().color().alpha() != 0;
+  const bool hasOutline = mainPen().style() != Qt::NoPen && mainPen().color().alpha() != 0;
+  if (!hasFill && !hasOutline) return;
+  
+  // columns in which narrow bars are merged are one pixel wide, or one output dot in vector exports with a set resolution:
+  double samplingScale = exportSamplingScale();
+  if (samplingScale <= 0 && !painter->modes().testFlag(QCPPainter::pmVectorized))
+    samplingScale = 1.0;
+  
+  // collect the geometry of all visible bars, four points per bar (see getBarPolygon):
+  const double prepStart = profileTime();
+  QVector<QPointF> barPoints;
+  double mergedKeyLower = 0, mergedKeyUpper = 0, mergedBase = 0, mergedMin = 0, mergedMax = 0;
+  int mergedColumn = 0;
+  int mergedCount = 0;
+  int visibleCount = 0;
   QCPBarDataMap::const_iterator it, lower, upperEnd;
   getVisibleDataBounds(lower, upperEnd);
   for (it = lower; it != upperEnd; ++it)
   {
+    ++visibleCount;
     // check data validity if flag set:
 #ifdef QCUSTOMPLOT_CHECK_DATA
     if (QCP::isInvalidData(it.value().key, it.value().value))
       qDebug() << Q_FUNC_INFO << "Data point at" << it.key() << "of drawn range invalid." << "Plottable name:" << name();
 #endif
-    QPolygonF barPolygon = getBarPolygon(it.key(), it.value().value);
-    // draw bar fill:
-    if (mainBrush().style() != Qt::NoBrush && mainBrush().color().alpha() != 0)
+    double keyLower, keyUpper, basePixel, valuePixel;
+    getBarPixels(it.key(), it.value().value, keyLower, keyUpper, basePixel, valuePixel);
+    if (samplingScale > 0 && qAbs(keyUpper-keyLower)*samplingScale < 1.0) // bar narrower than one pixel (or output dot)
     {
-      applyFillAntialiasingHint(painter);
-      painter->setPen(Qt::NoPen);
-      painter->setBrush(mainBrush());
-      painter->drawPolygon(barPolygon);
+      int column = qFloor((keyLower+keyUpper)*0.5*samplingScale);
+      if (mergedCount > 0 && column == mergedColumn)
+      {
+        mergedKeyLower = qMin(mergedKeyLower, qMin(keyLower, keyUpper));
+        mergedKeyUpper = qMax(mergedKeyUpper, qMax(keyLower, keyUpper));
+        mergedMin = qMin(mergedMin, qMin(basePixel, valuePixel));
+        mergedMax = qMax(mergedMax, qMax(basePixel, valuePixel));
+        ++mergedCount;
+        continue;
+      }
+      if (mergedCount > 0)
+        appendMergedBarPoints(&barPoints, mergedKeyLower, mergedKeyUpper, mergedBase, mergedMin, mergedMax);
+      mergedKeyLower = qMin(keyLower, keyUpper);
+      mergedKeyUpper = qMax(keyLower, keyUpper);
+      mergedBase = basePixel;
+      mergedMin = qMin(basePixel, valuePixel);
+      mergedMax = qMax(basePixel, valuePixel);
+      mergedColumn = column;
+      mergedCount = 1;
+      continue;
     }
-    // draw bar line:
-    if (mainPen().style() != Qt::NoPen && mainPen().color().alpha() != 0)
+    if (mergedCount > 0)
     {
-      applyDefaultAntialiasingHint(painter);
-      painter->setPen(mainPen());
-      painter->setBrush(Qt::NoBrush);
-      painter->drawPolyline(barPolygon);
+      appendMergedBarPoints(&barPoints, mergedKeyLower, mergedKeyUpper, mergedBase, mergedMin, mergedMax);
+      mergedCount = 0;
+    }
+    appendBarPoints(&barPoints, keyLower, keyUpper, basePixel, valuePixel);
+  }
+  if (mergedCount > 0)
+    appendMergedBarPoints(&barPoints, mergedKeyLower, mergedKeyUpper, mergedBase, mergedMin, mergedMax);
+  addProfilePreparationTime(prepStart);
+  const int barCount = barPoints.size()/4;
+  
+  // in profiled replots, report how many of the visible bars are drawn, the others were merged with neighbouring bars:
+  if (QCPReplotProfile *profile = mParentPlot->currentReplotProfile())
+  {
+    profile->pointsDrawn += barCount;
+    profile->pointsSampledAway += visibleCount-barCount;
+  }
+  if (barCount == 0)
+    return;
+  
+  // draw all bar fills:
+  if (hasFill)
+  {
+    QVector<QRectF> fillRects(barCount);
+    for (int i=0; i<barCount; ++i)
+      fillRects[i] = QRectF(barPoints.at(i*4), barPoints.at(i*4+2)).normalized();
+    applyFillAntialiasingHint(painter);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(mainBrush());
+    painter->drawRects(fillRects.constData(), barCount);
+  }
+  // draw all bar outlines:
+  if (hasOutline)
+  {
+    applyDefaultAntialiasingHint(painter);
+    painter->setPen(mainPen());
+    painter->setBrush(Qt::NoBrush);
+    if (painter->pen().widthF() <= 1.0 && !painter->modes().testFlag(QCPPainter::pmVectorized)) // line joins aren't visible, so draw the three sides of each bar as separate lines in one call
+    {
+      QVector<QLineF> lines(barCount*3);
+      for (int i=0; i<barCount; ++i)
+      {
+        lines[i*3+0] = QLineF(barPoints.at(i*4+0), barPoints.at(i*4+1));
+        lines[i*3+1] = QLineF(barPoints.at(i*4+1), barPoints.at(i*4+2));
+        lines[i*3+2] = QLineF(barPoints.at(i*4+2), barPoints.at(i*4+3));
+      }
+      painter->drawLines(lines);
+    } else
+    {
+      for (int i=0; i<barCount; ++i)
+        painter->drawPolyline(barPoints.constData()+i*4, 4);
     }
   }
 }
@@ -916,29 +1093,74 @@ QPolygonF QCPBars::getBarPolygon(double key, double value) const
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return QPolygonF(); }
   
-  QPolygonF result;
+  QVector<QPointF> result;
+  double keyLower, keyUpper, basePixel, valuePixel;
+  getBarPixels(key, value, keyLower, keyUpper, basePixel, valuePixel);
+  appendBarPoints(&result, keyLower, keyUpper, basePixel, valuePixel);
+  return QPolygonF(result);
+}
+
+/*! \internal
+  
+  Calculates the pixel positions of a single bar with \a key and \a value. \a keyLower and \a
+  keyUpper return the pixel positions of the two sides of the bar along the key axis. \a basePixel
+  and \a valuePixel return the pixel positions of the bar base and of the bar end along the value
+  axis, taking into account the bar stacking (see \ref moveAbove) and base value (see \ref
+  setBaseValue).
+  
+  The key and value axes must be valid when calling this function.
+*/
+void QCPBars::getBarPixels(double key, double value, double &keyLower, double &keyUpper, double &basePixel, double &valuePixel) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
   double lowerPixelWidth, upperPixelWidth;
   getPixelWidth(key, lowerPixelWidth, upperPixelWidth);
   double base = getStackedBaseValue(key, value >= 0);
-  double basePixel = valueAxis->coordToPixel(base);
-  double valuePixel = valueAxis->coordToPixel(base+value);
+  basePixel = valueAxis->coordToPixel(base);
+  valuePixel = valueAxis->coordToPixel(base+value);
   double keyPixel = keyAxis->coordToPixel(key);
   if (mBarsGroup)
     keyPixel += mBarsGroup->keyPixelOffset(this, key);
-  if (keyAxis->orientation() == Qt::Horizontal)
+  keyLower = keyPixel+lowerPixelWidth;
+  keyUpper = keyPixel+upperPixelWidth;
+}
+
+/*! \internal
+  
+  Appends the four points of a bar to \a points, in the same order as in the polygon returned by
+  \ref getBarPolygon. The parameters are pixel positions as returned by \ref getBarPixels.
+*/
+void QCPBars::appendBarPoints(QVector<QPointF> *points, double keyLower, double keyUpper, double basePixel, double valuePixel) const
+{
+  if (mKeyAxis.data()->orientation() == Qt::Horizontal)
   {
-    result << QPointF(keyPixel+lowerPixelWidth, basePixel);
-    result << QPointF(keyPixel+lowerPixelWidth, valuePixel);
-    result << QPointF(keyPixel+upperPixelWidth, valuePixel);
-    result << QPointF(keyPixel+upperPixelWidth, basePixel);
+    points->append(QPointF(keyLower, basePixel));
+    points->append(QPointF(keyLower, valuePixel));
+    points->append(QPointF(keyUpper, valuePixel));
+    points->append(QPointF(keyUpper, basePixel));
   } else
   {
-    result << QPointF(basePixel, keyPixel+lowerPixelWidth);
-    result << QPointF(valuePixel, keyPixel+lowerPixelWidth);
-    result << QPointF(valuePixel, keyPixel+upperPixelWidth);
-    result << QPointF(basePixel, keyPixel+upperPixelWidth);
+    points->append(QPointF(basePixel, keyLower));
+    points->append(QPointF(valuePixel, keyLower));
+    points->append(QPointF(valuePixel, keyUpper));
+    points->append(QPointF(basePixel, keyUpper));
   }
-  return result;
+}
+
+/*! \internal
+  
+  Appends the four points of a bar that represents several merged bars (see \ref draw) to \a
+  points. The merged bar spans \a keyLower to \a keyUpper along the key axis and \a minPixel to \a
+  maxPixel along the value axis. Its open side is the one closer to \a basePixel, the base of the
+  first merged bar, so merged bars that all have the same base look like a single regular bar.
+*/
+void QCPBars::appendMergedBarPoints(QVector<QPointF> *points, double keyLower, double keyUpper, double basePixel, double minPixel, double maxPixel) const
+{
+  if (qAbs(minPixel-basePixel) < qAbs(maxPixel-basePixel))
+    appendBarPoints(points, keyLower, keyUpper, minPixel, maxPixel);
+  else
+    appendBarPoints(points, keyLower, keyUpper, maxPixel, minPixel);
 }
 
 /*! \internal
@@ -1001,27 +1223,38 @@ void QCPBars::getPixelWidth(double key, double &lower, double &upper) const
   positive and negative bars are separated per stack (positive are stacked above baseValue upwards,
   negative are stacked below baseValue downwards). This can be indicated with \a positive. So if the
   bar for which we need the base value is negative, set \a positive to false.
+  
+  The results for both signs are cached per key, so each bars plottable of a stack only looks up
+  the bars directly below it once per key, and reads the rest of the stack from the cache of the
+  bars below. The cache is discarded by \ref invalidateStackCache.
 */
 double QCPBars::getStackedBaseValue(double key, bool positive) const
 {
   if (mBarBelow)
   {
-    double max = 0; // don't use mBaseValue here because only base value of bottom-most bar has meaning in a bar stack
-    // find bars of mBarBelow that are approximately at key and find largest one:
-    double epsilon = qAbs(key)*1e-6; // should be safe even when changed to use float at some point
-    if (key == 0)
-      epsilon = 1e-6;
-    QCPBarDataMap::const_iterator it = mBarBelow.data()->mData->lowerBound(key-epsilon);
-    QCPBarDataMap::const_iterator itEnd = mBarBelow.data()->mData->upperBound(key+epsilon);
-    while (it != itEnd)
+    QMap<double, QPair<double, double> >::const_iterator cached = mStackBaseCache.constFind(key);
+    if (cached == mStackBaseCache.constEnd())
     {
-      if ((positive && it.value().value > max) ||
-          (!positive && it.value().value < max))
-        max = it.value().value;
-      ++it;
+      double maxPositive = 0, minNegative = 0; // don't use mBaseValue here because only base value of bottom-most bar has meaning in a bar stack
+      // find bars of mBarBelow that are approximately at key and find largest positive and negative one:
+      double epsilon = qAbs(key)*1e-6; // should be safe even when changed to use float at some point
+      if (key == 0)
+        epsilon = 1e-6;
+      QCPBarDataMap::const_iterator it = mBarBelow.data()->mData->lowerBound(key-epsilon);
+      QCPBarDataMap::const_iterator itEnd = mBarBelow.data()->mData->upperBound(key+epsilon);
+      while (it != itEnd)
+      {
+        if (it.value().value > maxPositive)
+          maxPositive = it.value().value;
+        else if (it.value().value < minNegative)
+          minNegative = it.value().value;
+        ++it;
+      }
+      // add the total height of the bar-stack below, which is cached in the bars below:
+      cached = mStackBaseCache.insert(key, qMakePair(minNegative + mBarBelow.data()->getStackedBaseValue(key, false),
+                                                     maxPositive + mBarBelow.data()->getStackedBaseValue(key, true)));
     }
-    // recurse down the bar-stack to find the total height:
-    return max + mBarBelow.data()->getStackedBaseValue(key, positive);
+    return positive ? cached.value().second : cached.value().first;
   } else
     return mBaseValue;
 }
@@ -1038,6 +1271,7 @@ void QCPBars::connectBars(QCPBars *lower, QCPBars *upper)
 {
   if (!lower && !upper) return;
   
+  QCPBars *oldUpper = 0; // bars that was above lower before and loses its bars below
   if (!lower) // disconnect upper at bottom
   {
     // disconnect old bar below upper:
@@ -1048,19 +1282,55 @@ void QCPBars::connectBars(QCPBars *lower, QCPBars *upper)
   {
     // disconnect old bar above lower:
     if (lower->mBarAbove && lower->mBarAbove.data()->mBarBelow.data() == lower)
-      lower->mBarAbove.data()->mBarBelow = 0;
+    {
+      oldUpper = lower->mBarAbove.data();
+      oldUpper->mBarBelow = 0;
+    }
     lower->mBarAbove = 0;
   } else // connect lower and upper
   {
     // disconnect old bar above lower:
     if (lower->mBarAbove && lower->mBarAbove.data()->mBarBelow.data() == lower)
-      lower->mBarAbove.data()->mBarBelow = 0;
+    {
+      oldUpper = lower->mBarAbove.data();
+      oldUpper->mBarBelow = 0;
+    }
     // disconnect old bar below upper:
     if (upper->mBarBelow && upper->mBarBelow.data()->mBarAbove.data() == upper)
       upper->mBarBelow.data()->mBarAbove = 0;
     lower->mBarAbove = upper;
     upper->mBarBelow = lower;
   }
+  // the stack base values and bars group offsets of bars that now have different bars below them are outdated:
+  if (oldUpper && oldUpper != upper)
+  {
+    oldUpper->invalidateStackCache();
+    oldUpper->invalidateGroupOffsets();
+  }
+  if (upper)
+  {
+    upper->invalidateStackCache();
+    upper->invalidateGroupOffsets();
+  }
+}
+
+/*! \internal
+  
+  Discards the key pixel offsets of the bars groups of this bars plottable and of all bars stacked
+  above it. The position of a stack in a bars group depends on the width of the bars at the bottom
+  of the stack, which don't need to be in the group themselves.
+  
+  \see QCPBarsGroup::invalidateKeyPixelOffsets
+*/
+void QCPBars::invalidateGroupOffsets()
+{
+  QCPBars *bars = this;
+  while (bars)
+  {
+    if (bars->mBarsGroup)
+      bars->mBarsGroup->invalidateKeyPixelOffsets();
+    bars = bars->mBarAbove.data();
+  }
 }
 
 /* inherits documentation from base class */
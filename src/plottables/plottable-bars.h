@@ -80,10 +80,21 @@ protected:
   SpacingType mSpacingType;
   double mSpacing;
   QList<QCPBars*> mBars;
+  QList<const QCPBars*> mBaseBars; // bottom-most bars of all stacks in mBars, valid if mBaseBarsValid
+  bool mBaseBarsValid;
+  QVector<double> mKeyPixelOffsets; // offsets of mBaseBars, for the key axis state below
+  QPointer<QCPAxis> mOffsetsKeyAxis;
+  QCPRange mOffsetsKeyRange;
+  bool mOffsetsRangeReversed;
+  QSize mOffsetsAxisRectSize;
+  QCPAxis::ScaleType mOffsetsScaleType;
+  bool mOffsetsKeyIndependent;
   
   // non-virtual methods:
   void registerBars(QCPBars *bars);
   void unregisterBars(QCPBars *bars);
+  void getKeyPixelOffsets(QVector<double> *offsets, double keyCoord);
+  void invalidateKeyPixelOffsets();
   
   // virtual methods:
   double keyPixelOffset(const QCPBars *bars, double keyCoord);
@@ -172,6 +183,7 @@ public:
   void removeDataAfter(double key);
   void removeData(double fromKey, double toKey);
   void removeData(double key);
+  void invalidateStackCache();
   
   // reimplemented virtual methods:
   virtual void clearData();
@@ -186,6 +198,9 @@ protected:
   double mBaseValue;
   QPointer<QCPBars> mBarBelow, mBarAbove;
   
+  // non-property members:
+  mutable QMap<double, QPair<double, double> > mStackBaseCache; // stack base value per key, first for negative and second for positive bars
+  
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter);
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const;
@@ -195,8 +210,12 @@ protected:
   // non-virtual methods:
   void getVisibleDataBounds(QCPBarDataMap::const_iterator &lower, QCPBarDataMap::const_iterator &upperEnd) const;
   QPolygonF getBarPolygon(double key, double value) const;
+  void getBarPixels(double key, double value, double &keyLower, double &keyUpper, double &basePixel, double &valuePixel) const;
+  void appendBarPoints(QVector<QPointF> *points, double keyLower, double keyUpper, double basePixel, double valuePixel) const;
+  void appendMergedBarPoints(QVector<QPointF> *points, double keyLower, double keyUpper, double basePixel, double minPixel, double maxPixel) const;
   void getPixelWidth(double key, double &lower, double &upper) const;
   double getStackedBaseValue(double key, bool positive) const;
+  void invalidateGroupOffsets();
   static void connectBars(QCPBars* lower, QCPBars* upper);
   
   friend class QCustomPlot;
@@ -0,0 +1,881 @@
+/***************************************************************************
+**                                                                        **
+**  QCustomPlot, an easy to use, modern plotting widget for Qt            **
+**  Copyright (C) 2011-2015 Emanuel Eichhammer                            **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Emanuel Eichhammer                                   **
+**  Website/Contact: http://www.qcustomplot.com/                          **
+**             Date: 25.04.15                                             **
+**          Version: 1.3.1                                                **
+****************************************************************************/
+
+#include "plottable-boxplot.h"
+
+#include "../painter.h"
+#include "../core.h"
+#include "../axis.h"
+#include "../layoutelements/layoutelement-axisrect.h"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPBoxPlotData
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPBoxPlotData
+  \brief Holds the data of one single box for QCPBoxPlot.
+  
+  The container for storing multiple boxes is \ref QCPBoxPlotDataMap.
+  
+  The stored data is:
+  \li \a key: coordinate on the key axis of this box
+  \li \a minimum: The position of the lower whisker
+  \li \a lowerQuartile: The lower end of the box
+  \li \a median: The position of the median line inside the box
+  \li \a upperQuartile: The upper end of the box
+  \li \a maximum: The position of the upper whisker
+  \li \a outliers: The sample values beyond the whiskers, drawn as scatter points
+  
+  Instead of providing these parameters, they can also be computed from the raw samples with \ref
+  QCPBoxPlot::samplesToBox or QCPBoxPlot::samplesToBoxes.
+  
+  \see QCPBoxPlotDataMap
+*/
+
+/*!
+  Constructs a box with key and all values set to zero and no outliers.
+*/
+QCPBoxPlotData::QCPBoxPlotData() :
+  key(0),
+  minimum(0),
+  lowerQuartile(0),
+  median(0),
+  upperQuartile(0),
+  maximum(0)
+{
+}
+
+/*!
+  Constructs a box with the specified \a key, five-number summary and \a outliers.
+*/
+QCPBoxPlotData::QCPBoxPlotData(double key, double minimum, double lowerQuartile, double median, double upperQuartile, double maximum, const QVector<double> &outliers) :
+  key(key),
+  minimum(minimum),
+  lowerQuartile(lowerQuartile),
+  median(median),
+  upperQuartile(upperQuartile),
+  maximum(maximum),
+  outliers(outliers)
+{
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPBoxPlotSampleJob
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// shared state of the threads computing boxes in QCPBoxPlot::samplesToBoxes. The boxes are split into chunks, and each thread takes
+// the next unprocessed chunk until none are left, so threads that happen to get cheaper boxes don't idle.
+class QCPBoxPlotSampleJob
+{
+public:
+  QCPBoxPlotSampleJob(const QVector<double> &keys, const QVector<QVector<double> > &samples, int count, double whiskerFactor, int chunkSize) :
+    keys(keys),
+    samples(samples),
+    count(count),
+    whiskerFactor(whiskerFactor),
+    chunkSize(chunkSize),
+    chunkCount((count+chunkSize-1)/chunkSize),
+    boxes(count),
+    valid(count),
+    nextChunk(0),
+    runningTasks(0)
+  {
+    boxData = boxes.data();
+    validData = valid.data();
+  }
+  
+  void process()
+  {
+    int chunk;
+    while ((chunk = nextChunk.fetchAndAddRelaxed(1)) < chunkCount)
+    {
+      const int end = qMin(count, (chunk+1)*chunkSize);
+      for (int i=chunk*chunkSize; i<end; ++i)
+        validData[i] = QCPBoxPlot::samplesToBox(keys.at(i), samples.at(i), whiskerFactor, boxData+i);
+    }
+  }
+  
+  const QVector<double> &keys;
+  const QVector<QVector<double> > &samples;
+  const int count;
+  const double whiskerFactor;
+  const int chunkSize, chunkCount;
+  QVector<QCPBoxPlotData> boxes;
+  QVector<bool> valid;
+  QCPBoxPlotData *boxData; // the vectors are only written through these pointers while threads are running, so they are never detached concurrently
+  bool *validData;
+  QAtomicInt nextChunk;
+  QMutex mutex;
+  QWaitCondition tasksFinished;
+  int runningTasks;
+};
+
+// runs QCPBoxPlotSampleJob::process in a thread of the global thread pool and reports back to the job when finished
+class QCPBoxPlotSampleTask : public QRunnable
+{
+public:
+  explicit QCPBoxPlotSampleTask(QCPBoxPlotSampleJob *job) : mJob(job) { setAutoDelete(true); }
+  
+  virtual void run()
+  {
+    mJob->process();
+    QMutexLocker locker(&mJob->mutex);
+    --mJob->runningTasks;
+    mJob->tasksFinished.wakeAll();
+  }
+  
+private:
+  QCPBoxPlotSampleJob *mJob;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPBoxPlot
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPBoxPlot
+  \brief A plottable representing many statistical boxes (box-and-whisker plots) in a plot.
+  
+  Unlike \ref QCPStatisticalBox, which represents exactly one box, QCPBoxPlot holds any number of
+  boxes at different keys in one \ref QCPBoxPlotDataMap. Large box plots (e.g. one box per sensor
+  or per time interval) thus only need one plottable, one legend item and one selection test, and
+  all boxes are drawn in a few batched passes.
+  
+  To plot data, assign precomputed five-number summaries with the \ref setData or \ref addData
+  functions, or let the plottable compute them from raw sample values with \ref setSamples or
+  \ref addSamples. The latter determine the quartiles with a selection algorithm (linear time on
+  average, instead of sorting each sample) and process many boxes in parallel on the global thread
+  pool. The whiskers then reach the most extreme samples within \ref setWhiskerFactor times the
+  interquartile range from the box, and all samples beyond are outliers.
+  
+  \section appearance Changing the appearance
+  
+  The appearance of the boxes is controlled with the same properties as \ref QCPStatisticalBox:
+  \ref setPen and \ref setBrush for the boxes, \ref setWidth for their width in key coordinates,
+  \ref setWhiskerPen, \ref setWhiskerBarPen and \ref setWhiskerWidth for the whiskers, \ref
+  setMedianPen for the median line and \ref setOutlierStyle for the outlier scatters.
+  
+  Since all boxes are drawn at once, the median line isn't clipped to the box. Use a pen with
+  Qt::FlatCap (as the default median pen does) so it doesn't exceed the box.
+  
+  \section usage Usage
+  
+  Like all data representing objects in QCustomPlot, the QCPBoxPlot is a plottable
+  (QCPAbstractPlottable). So the plottable-interface of QCustomPlot applies
+  (QCustomPlot::plottable, QCustomPlot::addPlottable, QCustomPlot::removePlottable, etc.)
+  
+  Usually, you first create an instance and add it to the customPlot with \ref
+  QCustomPlot::addPlottable, and then fill it with the samples of each box:
+  \code
+  QCPBoxPlot *boxPlot = new QCPBoxPlot(customPlot->xAxis, customPlot->yAxis);
+  customPlot->addPlottable(boxPlot);
+  boxPlot->setSamples(sensorIndices, sensorSamples);
+  \endcode
+*/
+
+/* start of documentation of inline functions */
+
+/*! \fn QCPBoxPlotDataMap *QCPBoxPlot::data() const
+  
+  Returns a pointer to the internal data storage of type \ref QCPBoxPlotDataMap. You may use it to
+  directly manipulate the data, which may be more convenient and faster than using the regular \ref
+  setData or \ref addData methods, in certain situations.
+*/
+
+/* end of documentation of inline functions */
+
+/*!
+  Constructs a box plot which uses \a keyAxis as its key axis ("x") and \a valueAxis as its value
+  axis ("y"). \a keyAxis and \a valueAxis must reside in the same QCustomPlot instance and not have
+  the same orientation. If either of these restrictions is violated, a corresponding message is
+  printed to the debug output (qDebug), the construction is not aborted, though.
+  
+  The constructed QCPBoxPlot can be added to the plot with QCustomPlot::addPlottable, QCustomPlot
+  then takes ownership of the box plot.
+*/
+QCPBoxPlot::QCPBoxPlot(QCPAxis *keyAxis, QCPAxis *valueAxis) :
+  QCPAbstractPlottable(keyAxis, valueAxis),
+  mData(0)
+{
+  mData = new QCPBoxPlotDataMap;
+  
+  setOutlierStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, Qt::blue, 6));
+  setWhiskerWidth(0.2);
+  setWidth(0.5);
+  setWhiskerFactor(1.5);
+  
+  setPen(QPen(Qt::black));
+  setSelectedPen(QPen(Qt::blue, 2.5));
+  setMedianPen(QPen(Qt::black, 3, Qt::SolidLine, Qt::FlatCap));
+  setWhiskerPen(QPen(Qt::black, 0, Qt::DashLine, Qt::FlatCap));
+  setWhiskerBarPen(QPen(Qt::black));
+  setBrush(Qt::NoBrush);
+  setSelectedBrush(Qt::NoBrush);
+}
+
+QCPBoxPlot::~QCPBoxPlot()
+{
+  delete mData;
+}
+
+/*!
+  Replaces the current data with the provided \a data.
+  
+  If \a copy is set to true, data points in \a data will only be copied. if false, the plottable
+  takes ownership of the passed data and replaces the internal data pointer with it. This is
+  significantly faster than copying for large datasets.
+  
+  Alternatively, you can also access and modify the plottable's data via the \ref data method, which
+  returns a pointer to the internal \ref QCPBoxPlotDataMap.
+  
+  \see setSamples, addData
+*/
+void QCPBoxPlot::setData(QCPBoxPlotDataMap *data, bool copy)
+{
+  if (mData == data)
+  {
+    qDebug() << Q_FUNC_INFO << "The data pointer is already in (and owned by) this plottable" << reinterpret_cast<quintptr>(data);
+    return;
+  }
+  if (copy)
+  {
+    *mData = *data;
+  } else
+  {
+    delete mData;
+    mData = data;
+  }
+}
+
+/*! \overload
+  
+  Replaces the current data with the provided boxes given by the five-number summaries in \a
+  minimum, \a lowerQuartile, \a median, \a upperQuartile and \a maximum at the keys in \a key. The
+  provided vectors should have equal length. Else, the number of boxes will be the size of the
+  smallest vector. The boxes don't have outliers.
+  
+  \see setSamples, addData
+*/
+void QCPBoxPlot::setData(const QVector<double> &key, const QVector<double> &minimum, const QVector<double> &lowerQuartile, const QVector<double> &median, const QVector<double> &upperQuartile, const QVector<double> &maximum)
+{
+  mData->clear();
+  int n = key.size();
+  n = qMin(n, minimum.size());
+  n = qMin(n, lowerQuartile.size());
+  n = qMin(n, median.size());
+  n = qMin(n, upperQuartile.size());
+  n = qMin(n, maximum.size());
+  for (int i=0; i<n; ++i)
+  {
+    mData->insertMulti(key[i], QCPBoxPlotData(key[i], minimum[i], lowerQuartile[i], median[i], upperQuartile[i], maximum[i]));
+  }
+}
+
+/*!
+  Replaces the current data with boxes computed from raw sample values. Box \a i is placed at \a
+  key[i] and summarizes the values in \a samples[i]. The provided vectors should have equal length.
+  Else, the number of boxes will be the size of the smallest vector.
+  
+  The boxes are computed with \ref samplesToBoxes, using the current \ref setWhiskerFactor "whisker
+  factor" and all threads of the global thread pool. Samples without any valid (non-NaN) values
+  don't create a box.
+  
+  \see addSamples, setData
+*/
+void QCPBoxPlot::setSamples(const QVector<double> &key, const QVector<QVector<double> > &samples)
+{
+  *mData = samplesToBoxes(key, samples, mWhiskerFactor);
+}
+
+/*!
+  Sets the width of the boxes in key coordinates.
+  
+  \see setWhiskerWidth
+*/
+void QCPBoxPlot::setWidth(double width)
+{
+  mWidth = width;
+}
+
+/*!
+  Sets the width of the whisker bars (the lines at \a minimum and \a maximum of each box) in key
+  coordinates.
+  
+  \see setWidth
+*/
+void QCPBoxPlot::setWhiskerWidth(double width)
+{
+  mWhiskerWidth = width;
+}
+
+/*!
+  Sets the pen used for drawing the whisker backbones (That's the line parallel to the value axis).
+  
+  Make sure to set the \a pen capStyle to Qt::FlatCap to prevent the whisker backbone from reaching
+  a few pixels past the whisker bars, when using a non-zero pen width.
+  
+  \see setWhiskerBarPen
+*/
+void QCPBoxPlot::setWhiskerPen(const QPen &pen)
+{
+  mWhiskerPen = pen;
+}
+
+/*!
+  Sets the pen used for drawing the whisker bars (Those are the lines parallel to the key axis at
+  each end of the whisker backbone).
+  
+  \see setWhiskerPen
+*/
+void QCPBoxPlot::setWhiskerBarPen(const QPen &pen)
+{
+  mWhiskerBarPen = pen;
+}
+
+/*!
+  Sets the pen used for drawing the median indicator line inside the boxes.
+*/
+void QCPBoxPlot::setMedianPen(const QPen &pen)
+{
+  mMedianPen = pen;
+}
+
+/*!
+  Sets the appearance of the outlier data points.
+*/
+void QCPBoxPlot::setOutlierStyle(const QCPScatterStyle &style)
+{
+  mOutlierStyle = style;
+}
+
+/*!
+  Sets how far the whiskers of boxes computed from raw samples (\ref setSamples, \ref addSamples)
+  may reach, as a multiple of the interquartile range (the height of the box). The whiskers end at
+  the most extreme sample values within this distance from the box, all values beyond are outliers.
+  
+  The default of 1.5 is the common choice of Tukey's box plots. If \a factor is zero or negative,
+  the whiskers reach the minimum and maximum of the samples and there are no outliers.
+  
+  Boxes that were already computed aren't changed, so set this before passing the samples.
+*/
+void QCPBoxPlot::setWhiskerFactor(double factor)
+{
+  mWhiskerFactor = factor;
+}
+
+/*!
+  Adds the provided boxes in \a dataMap to the current data.
+  
+  \see removeData
+*/
+void QCPBoxPlot::addData(const QCPBoxPlotDataMap &dataMap)
+{
+  mData->unite(dataMap);
+}
+
+/*! \overload
+  
+  Adds the provided single box in \a data to the current data.
+  
+  \see removeData
+*/
+void QCPBoxPlot::addData(const QCPBoxPlotData &data)
+{
+  mData->insertMulti(data.key, data);
+}
+
+/*! \overload
+  
+  Adds the provided single box given by \a key, its five-number summary and \a outliers to the
+  current data.
+  
+  \see removeData
+*/
+void QCPBoxPlot::addData(double key, double minimum, double lowerQuartile, double median, double upperQuartile, double maximum, const QVector<double> &outliers)
+{
+  mData->insertMulti(key, QCPBoxPlotData(key, minimum, lowerQuartile, median, upperQuartile, maximum, outliers));
+}
+
+/*!
+  Adds a box at \a key, computed from the raw sample values in \a samples with the current \ref
+  setWhiskerFactor "whisker factor". If \a samples contains no valid (non-NaN) values, no box is
+  added.
+  
+  \see setSamples, samplesToBox
+*/
+void QCPBoxPlot::addSamples(double key, const QVector<double> &samples)
+{
+  QCPBoxPlotData box;
+  if (samplesToBox(key, samples, mWhiskerFactor, &box))
+    mData->insertMulti(key, box);
+}
+
+/*! \overload
+  
+  Adds boxes computed from raw sample values, in parallel. Box \a i is placed at \a key[i] and
+  summarizes the values in \a samples[i]. See \ref setSamples for details.
+*/
+void QCPBoxPlot::addSamples(const QVector<double> &key, const QVector<QVector<double> > &samples)
+{
+  mData->unite(samplesToBoxes(key, samples, mWhiskerFactor));
+}
+
+/*!
+  Removes all boxes with keys smaller than \a key.
+  
+  \see addData, clearData
+*/
+void QCPBoxPlot::removeDataBefore(double key)
+{
+  QCPBoxPlotDataMap::iterator it = mData->begin();
+  while (it != mData->end() && it.key() < key)
+    it = mData->erase(it);
+}
+
+/*!
+  Removes all boxes with keys greater than \a key.
+  
+  \see addData, clearData
+*/
+void QCPBoxPlot::removeDataAfter(double key)
+{
+  if (mData->isEmpty()) return;
+  QCPBoxPlotDataMap::iterator it = mData->upperBound(key);
+  while (it != mData->end())
+    it = mData->erase(it);
+}
+
+/*!
+  Removes all boxes with keys between \a fromKey and \a toKey. if \a fromKey is greater or equal
+  to \a toKey, the function does nothing. To remove a single box with known key, use \ref
+  removeData(double key).
+  
+  \see addData, clearData
+*/
+void QCPBoxPlot::removeData(double fromKey, double toKey)
+{
+  if (fromKey >= toKey || mData->isEmpty()) return;
+  QCPBoxPlotDataMap::iterator it = mData->upperBound(fromKey);
+  QCPBoxPlotDataMap::iterator itEnd = mData->upperBound(toKey);
+  while (it != itEnd)
+    it = mData->erase(it);
+}
+
+/*! \overload
+  
+  Removes a single box at \a key. If the position is not known with absolute precision, consider
+  using \ref removeData(double fromKey, double toKey) with a small fuzziness interval around the
+  suspected position, depeding on the precision with which the key is known.
+  
+  \see addData, clearData
+*/
+void QCPBoxPlot::removeData(double key)
+{
+  mData->remove(key);
+}
+
+/*!
+  Removes all boxes.
+  
+  \see removeData, removeDataAfter, removeDataBefore
+*/
+void QCPBoxPlot::clearData()
+{
+  mData->clear();
+}
+
+/* inherits documentation from base class */
+double QCPBoxPlot::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
+{
+  Q_UNUSED(details)
+  if (onlySelectable && !mSelectable)
+    return -1;
+  if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return -1; }
+  
+  if (mKeyAxis.data()->axisRect()->rect().contains(pos.toPoint()))
+  {
+    // only test the boxes close to pos in key direction:
+    QCPBoxPlotDataMap::const_iterator begin, end;
+    getSelectTestBounds(pos, begin, end);
+    double posKey, posValue;
+    pixelsToCoords(pos, posKey, posValue);
+    double minDistance = -1;
+    for (QCPBoxPlotDataMap::const_iterator it=begin; it != end; ++it)
+    {
+      double distance = -1;
+      // quartile box:
+      QCPRange keyRange(it.value().key-mWidth*0.5, it.value().key+mWidth*0.5);
+      QCPRange valueRange(it.value().lowerQuartile, it.value().upperQuartile);
+      if (keyRange.contains(posKey) && valueRange.contains(posValue))
+        distance = mParentPlot->selectionTolerance()*0.99;
+      // min/max whiskers:
+      else if (QCPRange(it.value().minimum, it.value().maximum).contains(posValue))
+        distance = qAbs(mKeyAxis.data()->coordToPixel(it.value().key)-mKeyAxis.data()->coordToPixel(posKey));
+      if (distance >= 0 && (distance < minDistance || minDistance < 0))
+        minDistance = distance;
+    }
+    return minDistance;
+  }
+  return -1;
+}
+
+/*!
+  Computes the box of the raw sample values in \a samples and stores it, placed at \a key, in \a
+  box. Returns false and leaves \a box unchanged if \a samples contains no valid (non-NaN) values.
+  
+  The quartiles and the median are linearly interpolated between the two closest sample values
+  (as with the default method of common statistics packages). They are found with a selection
+  algorithm that only partially orders a copy of the samples, which takes linear time on average.
+  
+  The whiskers reach the most extreme sample values within \a whiskerFactor times the interquartile
+  range from the box, the remaining values are stored (sorted) as outliers. If \a whiskerFactor is
+  zero or negative, the whiskers reach the minimum and maximum and there are no outliers.
+  
+  \see samplesToBoxes, QCPBoxPlot::setWhiskerFactor
+*/
+bool QCPBoxPlot::samplesToBox(double key, const QVector<double> &samples, double whiskerFactor, QCPBoxPlotData *box)
+{
+  QVector<double> values;
+  values.reserve(samples.size());
+  for (int i=0; i<samples.size(); ++i)
+  {
+    if (!qIsNaN(samples.at(i)))
+      values.append(samples.at(i));
+  }
+  const int n = values.size();
+  if (n == 0)
+    return false;
+  
+  // select median first, the quartiles then only need to be searched in the lower/upper part. The upper
+  // quartile range excludes the median position (unless the quartile is at it), so the median value stays
+  // in place as the upper end of the lower quartile range:
+  double *data = values.data();
+  const int medianIndex = int(0.5*(n-1));
+  const int upperIndex = int(0.75*(n-1));
+  double median = selectQuantile(data, n, 0.5, 0, n);
+  double upperQuartile = selectQuantile(data, n, 0.75, qMin(upperIndex, medianIndex+1), n);
+  double lowerQuartile = selectQuantile(data, n, 0.25, 0, medianIndex+1);
+  
+  // whiskers and outliers:
+  double lowerFence = -std::numeric_limits<double>::max();
+  double upperFence = std::numeric_limits<double>::max();
+  if (whiskerFactor > 0)
+  {
+    lowerFence = lowerQuartile-whiskerFactor*(upperQuartile-lowerQuartile);
+    upperFence = upperQuartile+whiskerFactor*(upperQuartile-lowerQuartile);
+  }
+  double minimum = lowerQuartile;
+  double maximum = upperQuartile;
+  QVector<double> outliers;
+  for (int i=0; i<n; ++i)
+  {
+    const double value = data[i];
+    if (value < lowerFence || value > upperFence)
+      outliers.append(value);
+    else if (value < minimum)
+      minimum = value;
+    else if (value > maximum)
+      maximum = value;
+  }
+  std::sort(outliers.begin(), outliers.end());
+  
+  *box = QCPBoxPlotData(key, minimum, lowerQuartile, median, upperQuartile, maximum, outliers);
+  return true;
+}
+
+/*!
+  Computes many boxes from raw sample values at once and returns them in a \ref QCPBoxPlotDataMap.
+  Box \a i is placed at \a key[i] and summarizes the values in \a samples[i], see \ref samplesToBox
+  for the meaning of \a whiskerFactor. The provided vectors should have equal length. Else, the
+  number of boxes will be the size of the smallest vector. Samples without any valid (non-NaN)
+  values don't create a box.
+  
+  The boxes are computed in parallel by the calling thread and by idle threads of the global
+  QThreadPool. \a maxThreadCount limits the number of threads including the calling thread, if it's
+  zero or negative, QThread::idealThreadCount is used. The function returns when all boxes are
+  computed.
+*/
+QCPBoxPlotDataMap QCPBoxPlot::samplesToBoxes(const QVector<double> &key, const QVector<QVector<double> > &samples, double whiskerFactor, int maxThreadCount)
+{
+  const int n = qMin(key.size(), samples.size());
+  if (maxThreadCount <= 0)
+    maxThreadCount = QThread::idealThreadCount();
+  const int chunkSize = qMax(1, n/(qMax(1, maxThreadCount)*4)); // a few chunks per thread to balance boxes of different sample counts
+  QCPBoxPlotSampleJob job(key, samples, n, whiskerFactor, chunkSize);
+  
+  // start helper tasks only on threads that are idle right now, so a busy pool can't delay the result:
+  const int helperCount = qMin(maxThreadCount, job.chunkCount)-1;
+  for (int i=0; i<helperCount; ++i)
+  {
+    QCPBoxPlotSampleTask *task = new QCPBoxPlotSampleTask(&job);
+    job.mutex.lock();
+    ++job.runningTasks;
+    job.mutex.unlock();
+    if (!QThreadPool::globalInstance()->tryStart(task))
+    {
+      delete task;
+      job.mutex.lock();
+      --job.runningTasks;
+      job.mutex.unlock();
+      break;
+    }
+  }
+  job.process();
+  job.mutex.lock();
+  while (job.runningTasks > 0)
+    job.tasksFinished.wait(&job.mutex);
+  job.mutex.unlock();
+  
+  QCPBoxPlotDataMap result;
+  for (int i=0; i<n; ++i)
+  {
+    if (job.valid.at(i))
+      result.insertMulti(job.boxes.at(i).key, job.boxes.at(i));
+  }
+  return result;
+}
+
+/* inherits documentation from base class */
+void QCPBoxPlot::draw(QCPPainter *painter)
+{
+  if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  
+  // get visible data range:
+  QCPBoxPlotDataMap::const_iterator begin, end;
+  getVisibleDataBounds(begin, end);
+  if (begin == end)
+    return;
+  
+  // check data validity if flag set:
+#ifdef QCUSTOMPLOT_CHECK_DATA
+  for (QCPBoxPlotDataMap::const_iterator it = begin; it != end; ++it)
+  {
+    if (QCP::isInvalidData(it.value().key, it.value().median) ||
+        QCP::isInvalidData(it.value().lowerQuartile, it.value().upperQuartile) ||
+        QCP::isInvalidData(it.value().minimum, it.value().maximum))
+      qDebug() << Q_FUNC_INFO << "Data point at" << it.key() << "of drawn range has invalid data." << "Plottable name:" << name();
+    for (int i=0; i<it.value().outliers.size(); ++i)
+      if (QCP::isInvalidData(it.value().outliers.at(i)))
+        qDebug() << Q_FUNC_INFO << "Data point outlier at" << it.key() << "of drawn range invalid." << "Plottable name:" << name();
+  }
+#endif
+  
+  // collect the geometry of all visible boxes, so each element type is drawn in one pass:
+  const double prepStart = profileTime();
+  QVector<QRectF> boxes;
+  QVector<QLineF> medians, whiskers, whiskerBars;
+  QVector<QPointF> outliers;
+  int boxCount = 0;
+  for (QCPBoxPlotDataMap::const_iterator it = begin; it != end; ++it)
+    ++boxCount;
+  boxes.reserve(boxCount);
+  medians.reserve(boxCount);
+  whiskers.reserve(2*boxCount);
+  whiskerBars.reserve(2*boxCount);
+  for (QCPBoxPlotDataMap::const_iterator it = begin; it != end; ++it)
+  {
+    const QCPBoxPlotData &box = it.value();
+    boxes.append(QRectF(coordsToPixels(box.key-mWidth*0.5, box.upperQuartile), coordsToPixels(box.key+mWidth*0.5, box.lowerQuartile)));
+    medians.append(QLineF(coordsToPixels(box.key-mWidth*0.5, box.median), coordsToPixels(box.key+mWidth*0.5, box.median)));
+    whiskers.append(QLineF(coordsToPixels(box.key, box.upperQuartile), coordsToPixels(box.key, box.maximum)));
+    whiskers.append(QLineF(coordsToPixels(box.key, box.lowerQuartile), coordsToPixels(box.key, box.minimum)));
+    whiskerBars.append(QLineF(coordsToPixels(box.key-mWhiskerWidth*0.5, box.maximum), coordsToPixels(box.key+mWhiskerWidth*0.5, box.maximum)));
+    whiskerBars.append(QLineF(coordsToPixels(box.key-mWhiskerWidth*0.5, box.minimum), coordsToPixels(box.key+mWhiskerWidth*0.5, box.minimum)));
+    for (int i=0; i<box.outliers.size(); ++i)
+      outliers.append(coordsToPixels(box.key, box.outliers.at(i)));
+  }
+  addProfilePreparationTime(prepStart);
+  
+  // quartile boxes and medians:
+  applyDefaultAntialiasingHint(painter);
+  painter->setPen(mainPen());
+  painter->setBrush(mainBrush());
+  painter->drawRects(boxes);
+  painter->setPen(mMedianPen);
+  painter->drawLines(medians);
+  // whiskers:
+  applyErrorBarsAntialiasingHint(painter);
+  painter->setPen(mWhiskerPen);
+  painter->drawLines(whiskers);
+  painter->setPen(mWhiskerBarPen);
+  painter->drawLines(whiskerBars);
+  // outliers:
+  if (!outliers.isEmpty())
+  {
+    applyScattersAntialiasingHint(painter);
+    mOutlierStyle.applyTo(painter, mPen);
+    for (int i=0; i<outliers.size(); ++i)
+      mOutlierStyle.drawShape(painter, outliers.at(i));
+  }
+  
+  QCPReplotProfile *profile = mParentPlot->currentReplotProfile();
+  if (profile)
+    profile->pointsDrawn += boxCount+outliers.size();
+}
+
+/* inherits documentation from base class */
+void QCPBoxPlot::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
+{
+  // draw filled rect:
+  applyDefaultAntialiasingHint(painter);
+  painter->setPen(mPen);
+  painter->setBrush(mBrush);
+  QRectF r = QRectF(0, 0, rect.width()*0.67, rect.height()*0.67);
+  r.moveCenter(rect.center());
+  painter->drawRect(r);
+}
+
+/*! \internal
+  
+  Returns the range of boxes that are (at least partially) inside the visible key range. \a end
+  points one past the last visible box.
+*/
+void QCPBoxPlot::getVisibleDataBounds(QCPBoxPlotDataMap::const_iterator &begin, QCPBoxPlotDataMap::const_iterator &end) const
+{
+  const QCPRange range = mKeyAxis.data()->range();
+  const double halfWidth = qMax(mWidth, mWhiskerWidth)*0.5;
+  begin = mData->lowerBound(range.lower-halfWidth);
+  end = mData->upperBound(range.upper+halfWidth);
+}
+
+/*! \internal
+  
+  Returns the range of boxes whose key is within the selection tolerance (in pixels) plus half the
+  box width of the key position of \a pos, so \ref selectTest doesn't need to test all boxes. \a
+  end points one past the last candidate.
+*/
+void QCPBoxPlot::getSelectTestBounds(const QPointF &pos, QCPBoxPlotDataMap::const_iterator &begin, QCPBoxPlotDataMap::const_iterator &end) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  double posKeyPixel = keyAxis->orientation() == Qt::Horizontal ? pos.x() : pos.y();
+  double tolerance = mParentPlot->selectionTolerance();
+  double key1 = keyAxis->pixelToCoord(posKeyPixel-tolerance);
+  double key2 = keyAxis->pixelToCoord(posKeyPixel+tolerance);
+  const double halfWidth = qMax(mWidth, mWhiskerWidth)*0.5;
+  begin = mData->lowerBound(qMin(key1, key2)-halfWidth);
+  end = mData->upperBound(qMax(key1, key2)+halfWidth);
+}
+
+/*! \internal
+  
+  Returns the quantile \a fraction (e.g. 0.5 for the median) of the \a count values in \a values,
+  linearly interpolated between the two closest values.
+  
+  The value at the lower of the two positions is selected with std::nth_element, searching only
+  between the indices \a rangeBegin and \a rangeEnd (exclusive). This allows to narrow the search
+  for further quantiles, since after selecting the median, all smaller values are before and all
+  greater values after it. The caller must make sure that \a values is partitioned accordingly,
+  i.e. that no value inside the range is greater than a value after it. The order of \a values
+  inside the range is changed.
+*/
+double QCPBoxPlot::selectQuantile(double *values, int count, double fraction, int rangeBegin, int rangeEnd)
+{
+  const double position = fraction*(count-1);
+  const int index = int(position);
+  std::nth_element(values+rangeBegin, values+index, values+rangeEnd);
+  double result = values[index];
+  if (position > index && index+1 < count)
+  {
+    // the next value is the smallest one after index, which is inside the range unless index is the last position of the range:
+    const int nextEnd = index+1 < rangeEnd ? rangeEnd : count;
+    result += (position-index)*(*std::min_element(values+index+1, values+nextEnd)-result);
+  }
+  return result;
+}
+
+/* inherits documentation from base class */
+QCPRange QCPBoxPlot::getKeyRange(bool &foundRange, SignDomain inSignDomain) const
+{
+  QCPRange range;
+  bool haveLower = false;
+  bool haveUpper = false;
+  
+  double current;
+  QCPBoxPlotDataMap::const_iterator it = mData->constBegin();
+  while (it != mData->constEnd())
+  {
+    current = it.value().key;
+    if (inSignDomain == sdBoth || (inSignDomain == sdNegative && current < 0) || (inSignDomain == sdPositive && current > 0))
+    {
+      if (current < range.lower || !haveLower)
+      {
+        range.lower = current;
+        haveLower = true;
+      }
+      if (current > range.upper || !haveUpper)
+      {
+        range.upper = current;
+        haveUpper = true;
+      }
+    }
+    ++it;
+  }
+  // determine exact range by including width of boxes:
+  if (haveLower && mKeyAxis)
+    range.lower = range.lower-mWidth*0.5;
+  if (haveUpper && mKeyAxis)
+    range.upper = range.upper+mWidth*0.5;
+  foundRange = haveLower && haveUpper;
+  return range;
+}
+
+/* inherits documentation from base class */
+QCPRange QCPBoxPlot::getValueRange(bool &foundRange, SignDomain inSignDomain) const
+{
+  QCPRange range;
+  bool haveLower = false;
+  bool haveUpper = false;
+  
+  double current;
+  QCPBoxPlotDataMap::const_iterator it = mData->constBegin();
+  while (it != mData->constEnd())
+  {
+    // the whisker ends and all outliers must be considered, outliers may lie on either side of the whiskers:
+    const double whiskers[2] = {it.value().minimum, it.value().maximum};
+    const QVector<double> &outliers = it.value().outliers;
+    for (int i=0; i<2+outliers.size(); ++i)
+    {
+      current = i < 2 ? whiskers[i] : outliers.at(i-2);
+      if (inSignDomain == sdBoth || (inSignDomain == sdNegative && current < 0) || (inSignDomain == sdPositive && current > 0))
+      {
+        if (current < range.lower || !haveLower)
+        {
+          range.lower = current;
+          haveLower = true;
+        }
+        if (current > range.upper || !haveUpper)
+        {
+          range.upper = current;
+          haveUpper = true;
+        }
+      }
+    }
+    ++it;
+  }
+  
+  foundRange = haveLower && haveUpper;
+  return range;
+}
@@ -0,0 +1,140 @@
+/***************************************************************************
+**                                                                        **
+**  QCustomPlot, an easy to use, modern plotting widget for Qt            **
+**  Copyright (C) 2011-2015 Emanuel Eichhammer                            **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Emanuel Eichhammer                                   **
+**  Website/Contact: http://www.qcustomplot.com/                          **
+**             Date: 25.04.15                                             **
+**          Version: 1.3.1                                                **
+****************************************************************************/
+/*! \file */
+#ifndef QCP_PLOTTABLE_BOXPLOT_H
+#define QCP_PLOTTABLE_BOXPLOT_H
+
+#include "../global.h"
+#include "../range.h"
+#include "../plottable.h"
+#include "../painter.h"
+
+class QCPPainter;
+class QCPAxis;
+
+class QCP_LIB_DECL QCPBoxPlotData
+{
+public:
+  QCPBoxPlotData();
+  QCPBoxPlotData(double key, double minimum, double lowerQuartile, double median, double upperQuartile, double maximum, const QVector<double> &outliers=QVector<double>());
+  double key, minimum, lowerQuartile, median, upperQuartile, maximum;
+  QVector<double> outliers;
+};
+Q_DECLARE_TYPEINFO(QCPBoxPlotData, Q_MOVABLE_TYPE);
+
+/*! \typedef QCPBoxPlotDataMap
+  Container for storing \ref QCPBoxPlotData items in a sorted fashion. The key of the map
+  is the key member of the QCPBoxPlotData instance.
+  
+  This is the container in which QCPBoxPlot holds its data.
+  \see QCPBoxPlot, QCPBoxPlot::setData
+*/
+typedef QMap<double, QCPBoxPlotData> QCPBoxPlotDataMap;
+typedef QMapIterator<double, QCPBoxPlotData> QCPBoxPlotDataMapIterator;
+typedef QMutableMapIterator<double, QCPBoxPlotData> QCPBoxPlotDataMutableMapIterator;
+
+
+class QCP_LIB_DECL QCPBoxPlot : public QCPAbstractPlottable
+{
+  Q_OBJECT
+  /// \cond INCLUDE_QPROPERTIES
+  Q_PROPERTY(double width READ width WRITE setWidth)
+  Q_PROPERTY(double whiskerWidth READ whiskerWidth WRITE setWhiskerWidth)
+  Q_PROPERTY(QPen whiskerPen READ whiskerPen WRITE setWhiskerPen)
+  Q_PROPERTY(QPen whiskerBarPen READ whiskerBarPen WRITE setWhiskerBarPen)
+  Q_PROPERTY(QPen medianPen READ medianPen WRITE setMedianPen)
+  Q_PROPERTY(QCPScatterStyle outlierStyle READ outlierStyle WRITE setOutlierStyle)
+  Q_PROPERTY(double whiskerFactor READ whiskerFactor WRITE setWhiskerFactor)
+  /// \endcond
+public:
+  explicit QCPBoxPlot(QCPAxis *keyAxis, QCPAxis *valueAxis);
+  virtual ~QCPBoxPlot();
+  
+  // getters:
+  QCPBoxPlotDataMap *data() const { return mData; }
+  double width() const { return mWidth; }
+  double whiskerWidth() const { return mWhiskerWidth; }
+  QPen whiskerPen() const { return mWhiskerPen; }
+  QPen whiskerBarPen() const { return mWhiskerBarPen; }
+  QPen medianPen() const { return mMedianPen; }
+  QCPScatterStyle outlierStyle() const { return mOutlierStyle; }
+  double whiskerFactor() const { return mWhiskerFactor; }
+  
+  // setters:
+  void setData(QCPBoxPlotDataMap *data, bool copy=false);
+  void setData(const QVector<double> &key, const QVector<double> &minimum, const QVector<double> &lowerQuartile, const QVector<double> &median, const QVector<double> &upperQuartile, const QVector<double> &maximum);
+  void setSamples(const QVector<double> &key, const QVector<QVector<double> > &samples);
+  void setWidth(double width);
+  void setWhiskerWidth(double width);
+  void setWhiskerPen(const QPen &pen);
+  void setWhiskerBarPen(const QPen &pen);
+  void setMedianPen(const QPen &pen);
+  void setOutlierStyle(const QCPScatterStyle &style);
+  void setWhiskerFactor(double factor);
+  
+  // non-property methods:
+  void addData(const QCPBoxPlotDataMap &dataMap);
+  void addData(const QCPBoxPlotData &data);
+  void addData(double key, double minimum, double lowerQuartile, double median, double upperQuartile, double maximum, const QVector<double> &outliers=QVector<double>());
+  void addSamples(double key, const QVector<double> &samples);
+  void addSamples(const QVector<double> &key, const QVector<QVector<double> > &samples);
+  void removeDataBefore(double key);
+  void removeDataAfter(double key);
+  void removeData(double fromKey, double toKey);
+  void removeData(double key);
+  
+  // reimplemented virtual methods:
+  virtual void clearData();
+  virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const;
+  
+  // static methods:
+  static bool samplesToBox(double key, const QVector<double> &samples, double whiskerFactor, QCPBoxPlotData *box);
+  static QCPBoxPlotDataMap samplesToBoxes(const QVector<double> &key, const QVector<QVector<double> > &samples, double whiskerFactor, int maxThreadCount=-1);
+  
+protected:
+  // property members:
+  QCPBoxPlotDataMap *mData;
+  double mWidth;
+  double mWhiskerWidth;
+  QPen mWhiskerPen, mWhiskerBarPen, mMedianPen;
+  QCPScatterStyle mOutlierStyle;
+  double mWhiskerFactor;
+  
+  // reimplemented virtual methods:
+  virtual void draw(QCPPainter *painter);
+  virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const;
+  virtual QCPRange getKeyRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const;
+  virtual QCPRange getValueRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const;
+  
+  // non-virtual methods:
+  void getVisibleDataBounds(QCPBoxPlotDataMap::const_iterator &begin, QCPBoxPlotDataMap::const_iterator &end) const;
+  void getSelectTestBounds(const QPointF &pos, QCPBoxPlotDataMap::const_iterator &begin, QCPBoxPlotDataMap::const_iterator &end) const;
+  static double selectQuantile(double *values, int count, double fraction, int rangeBegin, int rangeEnd);
+  
+  friend class QCustomPlot;
+  friend class QCPLegend;
+};
+
+#endif // QCP_PLOTTABLE_BOXPLOT_H
@@ -856,7 +856,11 @@ void QCPColorMap::draw(QCPPainter *painter)
   applyDefaultAntialiasingHint(painter);
   
   if (mMapData->mDataModified || mMapImageInvalidated)
+  {
+    const double prepStart = profileTime();
     updateMapImage();
+    addProfilePreparationTime(prepStart);
+  }
   
   // use buffer if painting vectorized (PDF):
   bool useBuffer = painter->modes().testFlag(QCPPainter::pmVectorized);
@@ -68,6 +68,530 @@ QCPCurveData::QCPCurveData(double t, double key, double value) :
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPCurveCompactData
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPCurveCompactData
+  \brief Holds the data of a QCPCurve in compact, column-wise storage.
+  
+  By default, QCPCurve stores its data in a \ref QCPCurveDataMap, where each data point occupies a
+  separate map node. QCPCurveCompactData instead stores the curve parameters \a t, the keys and the
+  values in three contiguous arrays that are sorted by \a t, so replotting iterates linearly over
+  memory.
+  
+  Curves like recorded trajectories are typically append-only with increasing \a t. Adding a data
+  point with a \a t greater or equal to the last one appends it in constant (amortized) time.
+  Removing data points from the front, e.g. with \ref removeBefore to keep a rolling window of the
+  latest points, also takes constant (amortized) time, because the removed points are only
+  released from the arrays once they make up the larger part of them.
+  
+  To make a curve use this storage, call \ref QCPCurve::setDataLayout with \ref
+  QCPCurve::dlCompact. The regular data interface of QCPCurve (\ref QCPCurve::setData, \ref
+  QCPCurve::addData, \ref QCPCurve::removeData, etc.) then operates on the QCPCurveCompactData
+  instance, which is accessible via \ref QCPCurve::compactData.
+  
+  Like a QCPCurveDataMap, the container offers \ref constBegin, \ref constEnd, \ref lowerBound and
+  \ref upperBound, returning iterators with \a key() (the curve parameter \a t) and \a value()
+  methods. Note that \a value() returns a \ref QCPCurveData by value, assembled from the columns.
+*/
+
+/*!
+  Constructs an empty data container.
+*/
+QCPCurveCompactData::QCPCurveCompactData() :
+  mOffset(0)
+{
+}
+
+/*!
+  Returns the number of bytes allocated by the columns of this container.
+*/
+qint64 QCPCurveCompactData::memoryUsage() const
+{
+  return qint64(mT.capacity()+mKeys.capacity()+mValues.capacity())*sizeof(double);
+}
+
+/*!
+  Returns an iterator to the first data point with a curve parameter greater or equal to \a t, or
+  \ref constEnd if there is none.
+*/
+QCPCurveCompactData::const_iterator QCPCurveCompactData::lowerBound(double t) const
+{
+  return const_iterator(this, lowerBoundIndex(t));
+}
+
+/*!
+  Returns an iterator to the first data point with a curve parameter greater than \a t, or \ref
+  constEnd if there is none.
+*/
+QCPCurveCompactData::const_iterator QCPCurveCompactData::upperBound(double t) const
+{
+  return const_iterator(this, upperBoundIndex(t));
+}
+
+/*!
+  Returns the index of the first data point with a curve parameter greater or equal to \a t, or
+  \ref size if there is none.
+*/
+int QCPCurveCompactData::lowerBoundIndex(double t) const
+{
+  const double *begin = mT.constData()+mOffset;
+  return int(std::lower_bound(begin, begin+size(), t)-begin);
+}
+
+/*!
+  Returns the index of the first data point with a curve parameter greater than \a t, or \ref size
+  if there is none.
+*/
+int QCPCurveCompactData::upperBoundIndex(double t) const
+{
+  const double *begin = mT.constData()+mOffset;
+  return int(std::upper_bound(begin, begin+size(), t)-begin);
+}
+
+/*!
+  Replaces the current data with the provided points in \a t, \a keys and \a values tuples. The
+  provided vectors should have equal length. Else, the number of points will be the size of the
+  smallest vector.
+  
+  The points don't need to be sorted by \a t. If they are, and the vectors have equal length, the
+  vectors are implicitly shared instead of copied.
+*/
+void QCPCurveCompactData::set(const QVector<double> &t, const QVector<double> &keys, const QVector<double> &values)
+{
+  int n = qMin(t.size(), qMin(keys.size(), values.size()));
+  clear();
+  mT = t.size() == n ? t : t.mid(0, n);
+  mKeys = keys.size() == n ? keys : keys.mid(0, n);
+  mValues = values.size() == n ? values : values.mid(0, n);
+  if (!isSortedFrom(0))
+    sortByT();
+}
+
+/*! \overload
+  
+  Replaces the current data with the data points in \a dataMap.
+*/
+void QCPCurveCompactData::set(const QCPCurveDataMap &dataMap)
+{
+  clear();
+  add(dataMap);
+}
+
+/*!
+  Adds the provided single data point in \a data. If its curve parameter \a t is greater or equal
+  to the one of the last data point, it is appended in constant (amortized) time. Otherwise, it is
+  inserted at the appropriate position, which requires moving all following data points.
+*/
+void QCPCurveCompactData::add(const QCPCurveData &data)
+{
+  if (isEmpty() || data.t >= mT.last())
+  {
+    mT.append(data.t);
+    mKeys.append(data.key);
+    mValues.append(data.value);
+  } else
+  {
+    int index = mOffset+upperBoundIndex(data.t);
+    mT.insert(index, data.t);
+    mKeys.insert(index, data.key);
+    mValues.insert(index, data.value);
+  }
+}
+
+/*! \overload
+  
+  Adds the provided single data point as \a t, \a key and \a value tuple.
+*/
+void QCPCurveCompactData::add(double t, double key, double value)
+{
+  add(QCPCurveData(t, key, value));
+}
+
+/*! \overload
+  
+  Adds the provided data points as \a t, \a keys and \a values tuples. If the new points are sorted
+  and don't start before the current last curve parameter, they are appended without resorting.
+*/
+void QCPCurveCompactData::add(const QVector<double> &t, const QVector<double> &keys, const QVector<double> &values)
+{
+  int n = qMin(t.size(), qMin(keys.size(), values.size()));
+  if (n == 0)
+    return;
+  int oldSize = size();
+  mT.reserve(mT.size()+n);
+  mKeys.reserve(mKeys.size()+n);
+  mValues.reserve(mValues.size()+n);
+  for (int i=0; i<n; ++i)
+  {
+    mT.append(t.at(i));
+    mKeys.append(keys.at(i));
+    mValues.append(values.at(i));
+  }
+  if (!isSortedFrom(qMax(0, oldSize-1)))
+    sortByT();
+}
+
+/*! \overload
+  
+  Adds the data points in \a dataMap.
+*/
+void QCPCurveCompactData::add(const QCPCurveDataMap &dataMap)
+{
+  mT.reserve(mT.size()+dataMap.size());
+  mKeys.reserve(mKeys.size()+dataMap.size());
+  mValues.reserve(mValues.size()+dataMap.size());
+  QCPCurveDataMap::const_iterator it;
+  for (it = dataMap.constBegin(); it != dataMap.constEnd(); ++it)
+    add(it.value());
+}
+
+/*!
+  Removes all data points with curve parameters smaller than \a t.
+  
+  This takes constant (amortized) time, so it can be used to keep a rolling window of the latest
+  data points of an append-only curve.
+*/
+void QCPCurveCompactData::removeBefore(double t)
+{
+  removeRange(0, lowerBoundIndex(t));
+}
+
+/*!
+  Removes all data points with curve parameters greater than \a t.
+*/
+void QCPCurveCompactData::removeAfter(double t)
+{
+  removeRange(upperBoundIndex(t), size());
+}
+
+/*!
+  Removes all data points with curve parameters between \a fromT and \a toT. If \a fromT is
+  greater or equal to \a toT, the function does nothing.
+*/
+void QCPCurveCompactData::remove(double fromT, double toT)
+{
+  if (fromT >= toT)
+    return;
+  removeRange(upperBoundIndex(fromT), upperBoundIndex(toT));
+}
+
+/*! \overload
+  
+  Removes all data points with curve parameter \a t.
+*/
+void QCPCurveCompactData::remove(double t)
+{
+  removeRange(lowerBoundIndex(t), upperBoundIndex(t));
+}
+
+/*!
+  Removes all data points.
+*/
+void QCPCurveCompactData::clear()
+{
+  mT.clear();
+  mKeys.clear();
+  mValues.clear();
+  mOffset = 0;
+}
+
+/*!
+  Releases memory that was reserved by the columns but isn't used by data points, including the
+  memory of data points that were removed from the front.
+*/
+void QCPCurveCompactData::squeeze()
+{
+  releaseRemoved();
+  mT.squeeze();
+  mKeys.squeeze();
+  mValues.squeeze();
+}
+
+/*!
+  Replaces the contents of \a dataMap with the data points of this container.
+*/
+void QCPCurveCompactData::toDataMap(QCPCurveDataMap *dataMap) const
+{
+  dataMap->clear();
+  for (int i=size()-1; i>=0; --i) // insert in reverse order, so the original order of points with identical t is kept by insertMulti
+    dataMap->insertMulti(t(i), at(i));
+}
+
+/*! \internal
+  
+  Removes the data points with indices from \a fromIndex (inclusive) to \a toIndex (exclusive) from
+  all columns. If the range starts at the first data point, the points are only skipped by
+  increasing the offset of the first valid point, and released later by \ref releaseRemoved.
+*/
+void QCPCurveCompactData::removeRange(int fromIndex, int toIndex)
+{
+  int count = toIndex-fromIndex;
+  if (count <= 0)
+    return;
+  if (fromIndex == 0 && toIndex < size())
+  {
+    mOffset += count;
+    if (mOffset > size()) // removed points make up the larger part of the columns, release them
+      releaseRemoved();
+  } else if (fromIndex == 0) // all points removed
+  {
+    clear();
+  } else
+  {
+    mT.remove(mOffset+fromIndex, count);
+    mKeys.remove(mOffset+fromIndex, count);
+    mValues.remove(mOffset+fromIndex, count);
+  }
+}
+
+/*! \internal
+  
+  Releases the data points that were removed from the front of the columns by \ref removeRange.
+*/
+void QCPCurveCompactData::releaseRemoved()
+{
+  if (mOffset == 0)
+    return;
+  mT.remove(0, mOffset);
+  mKeys.remove(0, mOffset);
+  mValues.remove(0, mOffset);
+  mOffset = 0;
+}
+
+/*! \internal
+  
+  Returns whether the curve parameters starting at \a index are sorted in ascending order.
+*/
+bool QCPCurveCompactData::isSortedFrom(int index) const
+{
+  const int count = size();
+  for (int i=qMax(1, index+1); i<count; ++i)
+  {
+    if (t(i) < t(i-1))
+      return false;
+  }
+  return true;
+}
+
+// comparison functor that orders indices by the curve parameters they refer to, used by QCPCurveCompactData::sortByT
+class QCPCurveCompactDataIndexLess
+{
+public:
+  explicit QCPCurveCompactDataIndexLess(const double *t) : mT(t) {}
+  bool operator()(int a, int b) const { return mT[a] < mT[b]; }
+private:
+  const double *mT;
+};
+
+/*! \internal
+  
+  Sorts all columns by curve parameter. Points with identical curve parameters keep their relative
+  order.
+*/
+void QCPCurveCompactData::sortByT()
+{
+  releaseRemoved();
+  const int size = mT.size();
+  QVector<int> order(size);
+  for (int i=0; i<size; ++i)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(), QCPCurveCompactDataIndexLess(mT.constData()));
+  
+  QVector<double> *columns[3] = {&mT, &mKeys, &mValues};
+  QVector<double> sorted(size);
+  for (int c=0; c<3; ++c)
+  {
+    for (int i=0; i<size; ++i)
+      sorted[i] = columns[c]->at(order.at(i));
+    qSwap(*columns[c], sorted);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPCurveSegmentIndex
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPCurveSegmentIndex
+  \brief A uniform grid over the line segments of a QCPCurve in pixel coordinates
+  
+  Since a curve isn't sorted by key, finding the segment closest to a point would otherwise require
+  measuring the distance to every segment of the curve. QCPCurve uses this class to answer its \ref
+  QCPCurve::selectTest queries.
+  
+  \ref build divides the area covered by the line into square cells and records for each cell the
+  segments that pass through it. The cell size is chosen such that there are about as many cells as
+  segments. \ref distanceSqr then only inspects the cells in growing rings around the queried
+  point, until no unvisited cell can contain a closer segment.
+  
+  Segments with NaN end points (gaps in the curve) are not recorded.
+*/
+
+/*!
+  Constructs an empty index.
+*/
+QCPCurveSegmentIndex::QCPCurveSegmentIndex() :
+  mCellSize(1),
+  mColumns(0),
+  mRows(0)
+{
+}
+
+/*!
+  Builds the index for the polyline \a line given in pixel coordinates, replacing any previous
+  contents. \a queryRect is the area in which points will be passed to \ref distanceSqr, typically
+  the axis rect. The grid covers it as well as all points of \a line.
+*/
+void QCPCurveSegmentIndex::build(const QVector<QPointF> &line, const QRectF &queryRect)
+{
+  clear();
+  mLine = line;
+  if (mLine.size() < 2)
+    return;
+  
+  // determine grid bounds and cell size:
+  double left = queryRect.left(), right = queryRect.right();
+  double top = queryRect.top(), bottom = queryRect.bottom();
+  for (int i=0; i<mLine.size(); ++i)
+  {
+    const QPointF &p = mLine.at(i);
+    if (qIsNaN(p.x()) || qIsNaN(p.y()))
+      continue;
+    left = qMin(left, p.x());
+    right = qMax(right, p.x());
+    top = qMin(top, p.y());
+    bottom = qMax(bottom, p.y());
+  }
+  const int segmentCount = mLine.size()-1;
+  mCellSize = qMax(4.0, qSqrt((right-left)*(bottom-top)/segmentCount));
+  mOrigin = QPointF(left, top);
+  mColumns = int((right-left)/mCellSize)+1;
+  mRows = int((bottom-top)/mCellSize)+1;
+  
+  // count entries per cell, then fill the segment indices cell by cell:
+  mCellStart.fill(0, mColumns*mRows+1);
+  for (int i=0; i<segmentCount; ++i)
+    addSegmentCells(i, mCellStart, false);
+  for (int i=0; i<mColumns*mRows; ++i)
+    mCellStart[i+1] += mCellStart.at(i);
+  mCellSegments.resize(mCellStart.last());
+  QVector<int> fillPositions(mCellStart);
+  for (int i=0; i<segmentCount; ++i)
+    addSegmentCells(i, fillPositions, true);
+}
+
+/*!
+  Removes all segments from the index.
+*/
+void QCPCurveSegmentIndex::clear()
+{
+  mLine.clear();
+  mCellStart.clear();
+  mCellSegments.clear();
+  mColumns = 0;
+  mRows = 0;
+}
+
+/*!
+  Returns the squared distance in pixels from \a point to the closest segment of the line the
+  index was built for. If the index is empty, returns the largest representable double value.
+*/
+double QCPCurveSegmentIndex::distanceSqr(const QPointF &point) const
+{
+  double minDistSqr = std::numeric_limits<double>::max();
+  if (isEmpty())
+    return minDistSqr;
+  
+  const int column = qBound(0, int(qFloor((point.x()-mOrigin.x())/mCellSize)), mColumns-1);
+  const int row = qBound(0, int(qFloor((point.y()-mOrigin.y())/mCellSize)), mRows-1);
+  // distance from point to the border of its own cell, segments outside ring k are at least k cells further away:
+  const double cellLeft = mOrigin.x()+column*mCellSize;
+  const double cellTop = mOrigin.y()+row*mCellSize;
+  const double borderDistance = qMax(0.0, qMin(qMin(point.x()-cellLeft, cellLeft+mCellSize-point.x()),
+                                               qMin(point.y()-cellTop, cellTop+mCellSize-point.y())));
+  const int maxRing = qMax(qMax(column, mColumns-1-column), qMax(row, mRows-1-row));
+  for (int ring=0; ring<=maxRing; ++ring)
+  {
+    for (int r=row-ring; r<=row+ring; ++r)
+    {
+      if (r < 0 || r >= mRows)
+        continue;
+      const bool fullRow = r == row-ring || r == row+ring;
+      const int step = fullRow || ring == 0 ? 1 : 2*ring;
+      for (int c=column-ring; c<=column+ring; c+=step)
+      {
+        if (c < 0 || c >= mColumns)
+          continue;
+        const int cell = r*mColumns+c;
+        for (int i=mCellStart.at(cell); i<mCellStart.at(cell+1); ++i)
+        {
+          const int segment = mCellSegments.at(i);
+          double distSqr = QCP::distSqrToLine(mLine.at(segment), mLine.at(segment+1), point);
+          if (distSqr < minDistSqr)
+            minDistSqr = distSqr;
+        }
+      }
+    }
+    const double coveredDistance = ring*mCellSize+borderDistance;
+    if (minDistSqr <= coveredDistance*coveredDistance)
+      break;
+  }
+  return minDistSqr;
+}
+
+/*! \internal
+  
+  Visits all cells that the segment from point \a segment to point \a segment+1 of the line passes
+  through. If \a fill is false, the entry of \a cellCounters following each visited cell is
+  incremented (counting pass). If \a fill is true, the segment is written to \ref mCellSegments at
+  the position given by the entry of \a cellCounters of each visited cell, which is then
+  incremented (filling pass).
+  
+  The segment is processed column by column. Within each column, all rows between the segment's
+  lowest and highest point inside that column are visited.
+*/
+void QCPCurveSegmentIndex::addSegmentCells(int segment, QVector<int> &cellCounters, bool fill)
+{
+  QPointF a = (mLine.at(segment)-mOrigin)/mCellSize; // in grid coordinates
+  QPointF b = (mLine.at(segment+1)-mOrigin)/mCellSize;
+  if (qIsNaN(a.x()) || qIsNaN(a.y()) || qIsNaN(b.x()) || qIsNaN(b.y()))
+    return;
+  if (a.x() > b.x())
+    qSwap(a, b);
+  
+  const int firstColumn = qBound(0, int(a.x()), mColumns-1);
+  const int lastColumn = qBound(0, int(b.x()), mColumns-1);
+  const double slope = b.x() > a.x() ? (b.y()-a.y())/(b.x()-a.x()) : 0;
+  for (int c=firstColumn; c<=lastColumn; ++c)
+  {
+    double yLower, yUpper;
+    if (b.x() > a.x())
+    {
+      yLower = a.y()+(qMax(a.x(), double(c))-a.x())*slope;
+      yUpper = a.y()+(qMin(b.x(), double(c+1))-a.x())*slope;
+      if (yLower > yUpper)
+        qSwap(yLower, yUpper);
+    } else
+    {
+      yLower = qMin(a.y(), b.y());
+      yUpper = qMax(a.y(), b.y());
+    }
+    const int firstRow = qBound(0, int(yLower), mRows-1);
+    const int lastRow = qBound(0, int(yUpper), mRows-1);
+    for (int r=firstRow; r<=lastRow; ++r)
+    {
+      const int cell = r*mColumns+c;
+      if (fill)
+        mCellSegments[cellCounters[cell]++] = segment;
+      else
+        ++cellCounters[cell+1];
+    }
+  }
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPCurve
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -82,7 +606,9 @@ QCPCurveData::QCPCurveData(double t, double key, double value) :
   coordinate \a t, which defines the order of the points described by the other two coordinates \a
   x and \a y.
 
-  To plot data, assign it with the \ref setData or \ref addData functions.
+  To plot data, assign it with the \ref setData or \ref addData functions. For long, append-only
+  curves (e.g. recorded trajectories), the curve can alternatively store its data in the
+  contiguous \ref QCPCurveCompactData container, see \ref setDataLayout.
   
   Gaps in the curve can be created by adding data points with NaN as key and value
   (<tt>qQNaN()</tt> or <tt>std::numeric_limits<double>::quiet_NaN()</tt>) in between the two data points that shall be
@@ -102,6 +628,36 @@ QCPCurveData::QCPCurveData(double t, double key, double value) :
   \snippet documentation/doc-code-snippets/mainwindow.cpp qcpcurve-creation-2
 */
 
+/* start of documentation of inline functions */
+
+/*! \fn QCPCurveDataMap *QCPCurve::data() const
+  
+  Returns a pointer to the internal data storage of type \ref QCPCurveDataMap. You may use it to
+  directly manipulate the data, which may be more convenient and faster than using the regular \ref
+  setData or \ref addData methods, in certain situations.
+  
+  If the curve uses the compact \ref setDataLayout "data layout", the returned map is empty and
+  the data is held by \ref compactData instead.
+  
+  If you modify the data this way, call \ref invalidateSegmentIndex afterwards.
+*/
+
+/*! \fn QCPCurveCompactData *QCPCurve::compactData() const
+  
+  Returns a pointer to the contiguous data storage, which holds the data points while the curve
+  uses the \ref dlCompact \ref setDataLayout "data layout".
+  
+  If you modify the data this way, call \ref invalidateSegmentIndex afterwards.
+*/
+
+/*! \fn int QCPCurve::dataCount() const
+  
+  Returns the number of data points of this curve, regardless of the \ref setDataLayout "data
+  layout".
+*/
+
+/* end of documentation of inline functions */
+
 /*!
   Constructs a curve which uses \a keyAxis as its key axis ("x") and \a valueAxis as its value
   axis ("y"). \a keyAxis and \a valueAxis must reside in the same QCustomPlot instance and not have
@@ -115,6 +671,13 @@ QCPCurve::QCPCurve(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   QCPAbstractPlottable(keyAxis, valueAxis)
 {
   mData = new QCPCurveDataMap;
+  mCompactData = new QCPCurveCompactData;
+  mDataLayout = dlMap;
+  mSegmentIndexValid = false;
+  mSegmentIndexKeyScaleType = QCPAxis::stLinear;
+  mSegmentIndexValueScaleType = QCPAxis::stLinear;
+  mSegmentIndexKeyReversed = false;
+  mSegmentIndexValueReversed = false;
   mPen.setColor(Qt::blue);
   mPen.setStyle(Qt::SolidLine);
   mBrush.setColor(Qt::blue);
@@ -126,11 +689,13 @@ QCPCurve::QCPCurve(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   
   setScatterStyle(QCPScatterStyle());
   setLineStyle(lsLine);
+  setAdaptiveSampling(true);
 }
 
 QCPCurve::~QCPCurve()
 {
   delete mData;
+  delete mCompactData;
 }
 
 /*!
@@ -139,6 +704,10 @@ QCPCurve::~QCPCurve()
   If \a copy is set to true, data points in \a data will only be copied. if false, the plottable
   takes ownership of the passed data and replaces the internal data pointer with it. This is
   significantly faster than copying for large datasets.
+  
+  If the curve uses the compact \ref setDataLayout "data layout", the points are transferred to
+  the \ref compactData container. In that case, if \a copy is false, \a data is deleted after the
+  transfer.
 */
 void QCPCurve::setData(QCPCurveDataMap *data, bool copy)
 {
@@ -147,6 +716,14 @@ void QCPCurve::setData(QCPCurveDataMap *data, bool copy)
     qDebug() << Q_FUNC_INFO << "The data pointer is already in (and owned by) this plottable" << reinterpret_cast<quintptr>(data);
     return;
   }
+  invalidateSegmentIndex();
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->set(*data);
+    if (!copy)
+      delete data;
+    return;
+  }
   if (copy)
   {
     *mData = *data;
@@ -165,6 +742,12 @@ void QCPCurve::setData(QCPCurveDataMap *data, bool copy)
 */
 void QCPCurve::setData(const QVector<double> &t, const QVector<double> &key, const QVector<double> &value)
 {
+  invalidateSegmentIndex();
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->set(t, key, value);
+    return;
+  }
   mData->clear();
   int n = t.size();
   n = qMin(n, key.size());
@@ -186,9 +769,18 @@ void QCPCurve::setData(const QVector<double> &t, const QVector<double> &key, con
 */
 void QCPCurve::setData(const QVector<double> &key, const QVector<double> &value)
 {
-  mData->clear();
+  invalidateSegmentIndex();
   int n = key.size();
   n = qMin(n, value.size());
+  if (mDataLayout != dlMap)
+  {
+    QVector<double> t(n);
+    for (int i=0; i<n; ++i)
+      t[i] = i;
+    mCompactData->set(t, key, value);
+    return;
+  }
+  mData->clear();
   QCPCurveData newData;
   for (int i=0; i<n; ++i)
   {
@@ -208,6 +800,7 @@ void QCPCurve::setData(const QVector<double> &key, const QVector<double> &value)
 */
 void QCPCurve::setScatterStyle(const QCPScatterStyle &style)
 {
+  invalidateSegmentIndex();
   mScatterStyle = style;
 }
 
@@ -223,13 +816,92 @@ void QCPCurve::setLineStyle(QCPCurve::LineStyle style)
   mLineStyle = style;
 }
 
+/*!
+  Sets in which kind of container the curve stores its data points.
+  
+  The default layout \ref dlMap stores the data in a \ref QCPCurveDataMap, which is accessible via
+  \ref data. Each data point then occupies a separate map node.
+  
+  The layout \ref dlCompact stores the curve parameters, keys and values in the contiguous
+  columns of the \ref QCPCurveCompactData container accessible via \ref compactData. Replots then
+  iterate linearly over memory instead of following map nodes. Appending data points with
+  increasing curve parameter (e.g. \ref addData(double key, double value)) and removing data
+  points from the front (\ref removeDataBefore) take constant (amortized) time, which makes this
+  layout well suited for long trajectory recordings, optionally limited to a rolling window.
+  
+  The existing data points are converted to the new layout. Note that while the compact layout is
+  active, the map returned by \ref data stays empty and is not considered by the curve. All other
+  data functions (\ref setData, \ref addData, \ref removeData, \ref clearData, etc.) work
+  transparently with either layout.
+*/
+void QCPCurve::setDataLayout(DataLayout layout)
+{
+  if (mDataLayout == layout)
+    return;
+  
+  if (layout == dlCompact)
+  {
+    mCompactData->set(*mData);
+    mData->clear();
+  } else
+  {
+    mCompactData->toDataMap(mData);
+    mCompactData->clear();
+    mCompactData->squeeze();
+  }
+  mDataLayout = layout;
+}
+
+/*!
+  Sets whether adaptive sampling shall be used when plotting this curve. With very large data sets
+  (e.g. millions of points of a trajectory that is fully visible), most consecutive points end up
+  within the same pixel, so drawing all of them only costs time without changing the appearance.
+  
+  If enabled, runs of consecutive points that stay closer than one pixel to the last drawn point
+  are collapsed into that point. Every point of the curve thus stays within one pixel of the drawn
+  line, and excursions, extremes and self-intersections that span more than a pixel are reproduced
+  exactly. The last point of the curve is always drawn. The number of drawn points then depends on
+  the length of the curve on screen instead of the number of data points.
+  
+  Scatter symbols are drawn at the remaining points, so in dense scatter plots symbols that
+  would overlap within one pixel are drawn only once. If this is undesired, e.g. for saving a
+  high quality image, set \a enabled to false.
+  
+  By default, adaptive sampling is enabled. In vector exports with a resolution set via \ref
+  QCustomPlot::setVectorResolution, the curve is always sampled with a tolerance of one output
+  device dot.
+*/
+void QCPCurve::setAdaptiveSampling(bool enabled)
+{
+  invalidateSegmentIndex();
+  mAdaptiveSampling = enabled;
+}
+
+/*!
+  Discards the cached segment index that speeds up \ref selectTest. It is rebuilt on the next call
+  of \ref selectTest.
+  
+  The index is invalidated automatically when the data is changed through the data methods of the
+  curve, or when the ranges, scale types or the axis rect of the curve's axes change. Call this
+  function only after manipulating the data directly via \ref data or \ref compactData.
+*/
+void QCPCurve::invalidateSegmentIndex()
+{
+  mSegmentIndexValid = false;
+  mSegmentIndex.clear();
+}
+
 /*!
   Adds the provided data points in \a dataMap to the current data.
   \see removeData
 */
 void QCPCurve::addData(const QCPCurveDataMap &dataMap)
 {
-  mData->unite(dataMap);
+  invalidateSegmentIndex();
+  if (mDataLayout != dlMap)
+    mCompactData->add(dataMap);
+  else
+    mData->unite(dataMap);
 }
 
 /*! \overload
@@ -238,7 +910,11 @@ void QCPCurve::addData(const QCPCurveDataMap &dataMap)
 */
 void QCPCurve::addData(const QCPCurveData &data)
 {
-  mData->insertMulti(data.t, data);
+  invalidateSegmentIndex();
+  if (mDataLayout != dlMap)
+    mCompactData->add(data);
+  else
+    mData->insertMulti(data.t, data);
 }
 
 /*! \overload
@@ -251,7 +927,7 @@ void QCPCurve::addData(double t, double key, double value)
   newData.t = t;
   newData.key = key;
   newData.value = value;
-  mData->insertMulti(newData.t, newData);
+  addData(newData);
 }
 
 /*! \overload
@@ -265,13 +941,15 @@ void QCPCurve::addData(double t, double key, double value)
 void QCPCurve::addData(double key, double value)
 {
   QCPCurveData newData;
-  if (!mData->isEmpty())
+  if (mDataLayout != dlMap)
+    newData.t = !mCompactData->isEmpty() ? mCompactData->t(mCompactData->size()-1)+1 : 0;
+  else if (!mData->isEmpty())
     newData.t = (mData->constEnd()-1).key()+1;
   else
     newData.t = 0;
   newData.key = key;
   newData.value = value;
-  mData->insertMulti(newData.t, newData);
+  addData(newData);
 }
 
 /*! \overload
@@ -280,6 +958,12 @@ void QCPCurve::addData(double key, double value)
 */
 void QCPCurve::addData(const QVector<double> &ts, const QVector<double> &keys, const QVector<double> &values)
 {
+  invalidateSegmentIndex();
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->add(ts, keys, values);
+    return;
+  }
   int n = ts.size();
   n = qMin(n, keys.size());
   n = qMin(n, values.size());
@@ -295,10 +979,20 @@ void QCPCurve::addData(const QVector<double> &ts, const QVector<double> &keys, c
 
 /*!
   Removes all data points with curve parameter t smaller than \a t.
+  
+  With the compact \ref setDataLayout "data layout", this takes constant (amortized) time, so it
+  can be called after each append to keep a rolling window of the latest data points.
+  
   \see addData, clearData
 */
 void QCPCurve::removeDataBefore(double t)
 {
+  invalidateSegmentIndex();
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->removeBefore(t);
+    return;
+  }
   QCPCurveDataMap::iterator it = mData->begin();
   while (it != mData->end() && it.key() < t)
     it = mData->erase(it);
@@ -310,6 +1004,12 @@ void QCPCurve::removeDataBefore(double t)
 */
 void QCPCurve::removeDataAfter(double t)
 {
+  invalidateSegmentIndex();
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->removeAfter(t);
+    return;
+  }
   if (mData->isEmpty()) return;
   QCPCurveDataMap::iterator it = mData->upperBound(t);
   while (it != mData->end())
@@ -325,6 +1025,12 @@ void QCPCurve::removeDataAfter(double t)
 */
 void QCPCurve::removeData(double fromt, double tot)
 {
+  invalidateSegmentIndex();
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->remove(fromt, tot);
+    return;
+  }
   if (fromt >= tot || mData->isEmpty()) return;
   QCPCurveDataMap::iterator it = mData->upperBound(fromt);
   QCPCurveDataMap::iterator itEnd = mData->upperBound(tot);
@@ -343,7 +1049,11 @@ void QCPCurve::removeData(double fromt, double tot)
 */
 void QCPCurve::removeData(double t)
 {
-  mData->remove(t);
+  invalidateSegmentIndex();
+  if (mDataLayout != dlMap)
+    mCompactData->remove(t);
+  else
+    mData->remove(t);
 }
 
 /*!
@@ -352,14 +1062,16 @@ void QCPCurve::removeData(double t)
 */
 void QCPCurve::clearData()
 {
+  invalidateSegmentIndex();
   mData->clear();
+  mCompactData->clear();
 }
 
 /* inherits documentation from base class */
 double QCPCurve::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
 {
   Q_UNUSED(details)
-  if ((onlySelectable && !mSelectable) || mData->isEmpty())
+  if ((onlySelectable && !mSelectable) || dataCount() == 0)
     return -1;
   if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return -1; }
   
@@ -372,16 +1084,32 @@ double QCPCurve::selectTest(const QPointF &pos, bool onlySelectable, QVariant *d
 /* inherits documentation from base class */
 void QCPCurve::draw(QCPPainter *painter)
 {
-  if (mData->isEmpty()) return;
+  if (dataCount() == 0) return;
   
-  // allocate line vector:
-  QVector<QPointF> *lineData = new QVector<QPointF>;
+  // borrow line vector from the scratch pool:
+  QCPScratchBuffer<QPointF> lineBuffer(mPointScratch);
+  QVector<QPointF> *lineData = lineBuffer.data();
   
   // fill with curve data:
-  getCurveData(lineData);
+  int sampledAway = 0;
+  const double prepStart = profileTime();
+  getCurveData(lineData, &sampledAway);
+  addProfilePreparationTime(prepStart);
+  QCPReplotProfile *profile = mParentPlot->currentReplotProfile();
+  if (profile)
+  {
+    profile->pointsDrawn += lineData->size();
+    profile->pointsSampledAway += sampledAway;
+  }
   
   // check data validity if flag set:
 #ifdef QCUSTOMPLOT_CHECK_DATA
+  for (int i=0; i<mCompactData->size(); ++i)
+  {
+    if (QCP::isInvalidData(mCompactData->t(i)) ||
+        QCP::isInvalidData(mCompactData->key(i), mCompactData->value(i)))
+      qDebug() << Q_FUNC_INFO << "Data point at" << mCompactData->t(i) << "invalid." << "Plottable name:" << name();
+  }
   QCPCurveDataMap::const_iterator it;
   for (it = mData->constBegin(); it != mData->constEnd(); ++it)
   {
@@ -452,9 +1180,6 @@ void QCPCurve::draw(QCPPainter *painter)
   // draw scatters:
   if (!mScatterStyle.isNone())
     drawScatterPlot(painter, lineData);
-  
-  // free allocated line data:
-  delete lineData;
 }
 
 /* inherits documentation from base class */
@@ -519,8 +1244,29 @@ void QCPCurve::drawScatterPlot(QCPPainter *painter, const QVector<QPointF> *poin
   
   Methods that are also involved in the algorithm are: \ref getRegion, \ref getOptimizedPoint, \ref
   getOptimizedCornerPoints \ref mayTraverse, \ref getTraverse, \ref getTraverseCornerPoints.
+  
+  If adaptive sampling is enabled (\ref setAdaptiveSampling), points inside the visible rect that
+  are closer than one pixel to the previously added point are skipped. In vector exports with a
+  resolution set via \ref QCustomPlot::setVectorResolution, the tolerance is one output device dot.
+  If \a sampledAway is non-zero, the number of data points skipped this way is written to it.
+*/
+void QCPCurve::getCurveData(QVector<QPointF> *lineData, int *sampledAway) const
+{
+  if (mDataLayout == dlMap)
+    getCurveData(mData, lineData, sampledAway);
+  else
+    getCurveData(mCompactData, lineData, sampledAway);
+}
+
+/*! \internal
+  \overload
+  
+  Generates the curve line data from the data container \a data, which is either the \ref
+  QCPCurveDataMap or the \ref QCPCurveCompactData of this curve, depending on the \ref
+  setDataLayout "data layout".
 */
-void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
+template <class DataContainer>
+void QCPCurve::getCurveData(const DataContainer *data, QVector<QPointF> *lineData, int *sampledAway) const
 {
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
@@ -535,11 +1281,18 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
   double rectBottom = valueAxis->pixelToCoord(valueAxis->coordToPixel(valueAxis->range().lower)+strokeMargin*((valueAxis->orientation()==Qt::Horizontal)!=valueAxis->rangeReversed()?-1:1));
   double rectTop = valueAxis->pixelToCoord(valueAxis->coordToPixel(valueAxis->range().upper)-strokeMargin*((valueAxis->orientation()==Qt::Horizontal)!=valueAxis->rangeReversed()?-1:1));
   int currentRegion;
-  QCPCurveDataMap::const_iterator it = mData->constBegin();
-  QCPCurveDataMap::const_iterator prevIt = mData->constEnd()-1;
+  typename DataContainer::const_iterator it = data->constBegin();
+  typename DataContainer::const_iterator prevIt = data->constEnd()-1;
   int prevRegion = getRegion(prevIt.value().key, prevIt.value().value, rectLeft, rectTop, rectRight, rectBottom);
   QVector<QPointF> trailingPoints; // points that must be applied after all other points (are generated only when handling first point to get virtual segment between last and first point right)
-  while (it != mData->constEnd())
+  // in vector exports with a set resolution, always sample adaptively with a tolerance of one output device dot instead of one pixel:
+  const double exportScale = exportSamplingScale();
+  const bool adaptiveSampling = mAdaptiveSampling || exportScale > 0;
+  const double tolerance = adaptiveSampling ? (exportScale > 0 ? 1.0/exportScale : 1.0) : 0; // in pixels
+  const double toleranceSqr = tolerance*tolerance;
+  bool skippedPrev = false; // whether the previous point was inside R but skipped by adaptive sampling
+  int skippedCount = 0;
+  while (it != data->constEnd())
   {
     currentRegion = getRegion(it.value().key, it.value().value, rectLeft, rectTop, rectRight, rectBottom);
     if (currentRegion != prevRegion) // changed region, possibly need to add some optimized edge points or original points if entering R
@@ -558,7 +1311,7 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
           // add the two cross points optimized if segment crosses R and if segment isn't virtual zeroth segment between last and first curve point:
           QVector<QPointF> beforeTraverseCornerPoints, afterTraverseCornerPoints;
           getTraverseCornerPoints(prevRegion, currentRegion, rectLeft, rectTop, rectRight, rectBottom, beforeTraverseCornerPoints, afterTraverseCornerPoints);
-          if (it != mData->constBegin())
+          if (it != data->constBegin())
           {
             *lineData << beforeTraverseCornerPoints;
             lineData->append(crossA);
@@ -576,7 +1329,7 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
         }
       } else // segment does end in R, so we add previous point optimized and this point at original position
       {
-        if (it == mData->constBegin()) // it is first point in curve and prevIt is last one. So save optimized point for adding it to the lineData in the end
+        if (it == data->constBegin()) // it is first point in curve and prevIt is last one. So save optimized point for adding it to the lineData in the end
           trailingPoints << getOptimizedPoint(prevRegion, prevIt.value().key, prevIt.value().value, it.value().key, it.value().value, rectLeft, rectTop, rectRight, rectBottom);
         else
           lineData->append(getOptimizedPoint(prevRegion, prevIt.value().key, prevIt.value().value, it.value().key, it.value().value, rectLeft, rectTop, rectRight, rectBottom));
@@ -586,17 +1339,38 @@ void QCPCurve::getCurveData(QVector<QPointF> *lineData) const
     {
       if (currentRegion == 5) // still in R, keep adding original points
       {
-        lineData->append(coordsToPixels(it.value().key, it.value().value));
+        const QPointF point = coordsToPixels(it.value().key, it.value().value);
+        skippedPrev = false;
+        if (tolerance > 0 && !lineData->isEmpty())
+        {
+          // collapse points that stay within the tolerance of the last added point (NaN gaps fail the comparison and are always added):
+          const double dx = point.x()-lineData->last().x();
+          const double dy = point.y()-lineData->last().y();
+          skippedPrev = dx*dx+dy*dy < toleranceSqr;
+        }
+        if (!skippedPrev)
+          lineData->append(point);
+        else
+          ++skippedCount;
       } else // still outside R, no need to add anything
       {
         // see how this is not doing anything? That's the main optimization...
       }
     }
+    if (currentRegion != 5)
+      skippedPrev = false;
     prevIt = it;
     prevRegion = currentRegion;
     ++it;
   }
+  if (skippedPrev) // curve ended in a collapsed run, make sure the actual last point is drawn
+  {
+    lineData->append(coordsToPixels(prevIt.value().key, prevIt.value().value));
+    --skippedCount;
+  }
   *lineData << trailingPoints;
+  if (sampledAway)
+    *sampledAway = skippedCount;
 }
 
 /*! \internal
@@ -1213,36 +1987,95 @@ void QCPCurve::getTraverseCornerPoints(int prevRegion, int currentRegion, double
   Calculates the (minimum) distance (in pixels) the curve's representation has from the given \a
   pixelPoint in pixels. This is used to determine whether the curve was clicked or not, e.g. in
   \ref selectTest.
+  
+  The line segments close to \a pixelPoint are looked up in a \ref QCPCurveSegmentIndex, which is
+  kept between calls as long as the data and the axes don't change (see \ref updateSegmentIndex).
+  Repeated calls thus don't need to process all data points of the curve.
 */
 double QCPCurve::pointDistance(const QPointF &pixelPoint) const
 {
-  if (mData->isEmpty())
+  const int count = dataCount();
+  if (count == 0)
   {
     qDebug() << Q_FUNC_INFO << "requested point distance on curve" << mName << "without data";
     return 500;
   }
-  if (mData->size() == 1)
+  if (count == 1)
   {
-    QPointF dataPoint = coordsToPixels(mData->constBegin().key(), mData->constBegin().value().value);
+    QPointF dataPoint;
+    if (mDataLayout == dlMap)
+      dataPoint = coordsToPixels(mData->constBegin().key(), mData->constBegin().value().value);
+    else
+      dataPoint = coordsToPixels(mCompactData->key(0), mCompactData->value(0));
     return QVector2D(dataPoint-pixelPoint).length();
   }
   
-  // calculate minimum distance to line segments:
-  QVector<QPointF> *lineData = new QVector<QPointF>;
-  getCurveData(lineData);
-  double minDistSqr = std::numeric_limits<double>::max();
-  for (int i=0; i<lineData->size()-1; ++i)
-  {
-    double currentDistSqr = distSqrToLine(lineData->at(i), lineData->at(i+1), pixelPoint);
-    if (currentDistSqr < minDistSqr)
-      minDistSqr = currentDistSqr;
-  }
-  delete lineData;
-  return qSqrt(minDistSqr);
+  // calculate minimum distance to line segments, only inspecting the segments near pixelPoint:
+  updateSegmentIndex();
+  return qSqrt(mSegmentIndex.distanceSqr(pixelPoint));
+}
+
+/*! \internal
+  
+  Rebuilds the segment index used by \ref pointDistance from the current curve line (see \ref
+  getCurveData), unless it is still valid. The index is outdated if it was invalidated by a data
+  change (\ref invalidateSegmentIndex), or if the range, scale type or reversal of the key or
+  value axis, or the geometry of the axis rect changed since it was built.
+*/
+void QCPCurve::updateSegmentIndex() const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  
+  if (mSegmentIndexValid &&
+      keyAxis->range() == mSegmentIndexKeyRange &&
+      valueAxis->range() == mSegmentIndexValueRange &&
+      keyAxis->axisRect()->rect() == mSegmentIndexAxisRect &&
+      keyAxis->scaleType() == mSegmentIndexKeyScaleType &&
+      valueAxis->scaleType() == mSegmentIndexValueScaleType &&
+      keyAxis->rangeReversed() == mSegmentIndexKeyReversed &&
+      valueAxis->rangeReversed() == mSegmentIndexValueReversed)
+    return;
+  
+  QVector<QPointF> lineData;
+  getCurveData(&lineData);
+  mSegmentIndex.build(lineData, keyAxis->axisRect()->rect());
+  mSegmentIndexKeyRange = keyAxis->range();
+  mSegmentIndexValueRange = valueAxis->range();
+  mSegmentIndexAxisRect = keyAxis->axisRect()->rect();
+  mSegmentIndexKeyScaleType = keyAxis->scaleType();
+  mSegmentIndexValueScaleType = valueAxis->scaleType();
+  mSegmentIndexKeyReversed = keyAxis->rangeReversed();
+  mSegmentIndexValueReversed = valueAxis->rangeReversed();
+  mSegmentIndexValid = true;
 }
 
 /* inherits documentation from base class */
 QCPRange QCPCurve::getKeyRange(bool &foundRange, SignDomain inSignDomain) const
+{
+  if (mDataLayout == dlMap)
+    return findKeyRange(mData, foundRange, inSignDomain);
+  else
+    return findKeyRange(mCompactData, foundRange, inSignDomain);
+}
+
+/* inherits documentation from base class */
+QCPRange QCPCurve::getValueRange(bool &foundRange, SignDomain inSignDomain) const
+{
+  if (mDataLayout == dlMap)
+    return findValueRange(mData, foundRange, inSignDomain);
+  else
+    return findValueRange(mCompactData, foundRange, inSignDomain);
+}
+
+/*! \internal
+  
+  Calculates the key range of the data points in \a data, which may be either a \ref
+  QCPCurveDataMap or a \ref QCPCurveCompactData. See \ref getKeyRange.
+*/
+template <class DataContainer>
+QCPRange QCPCurve::findKeyRange(const DataContainer *data, bool &foundRange, SignDomain inSignDomain) const
 {
   QCPRange range;
   bool haveLower = false;
@@ -1250,8 +2083,8 @@ QCPRange QCPCurve::getKeyRange(bool &foundRange, SignDomain inSignDomain) const
   
   double current;
   
-  QCPCurveDataMap::const_iterator it = mData->constBegin();
-  while (it != mData->constEnd())
+  typename DataContainer::const_iterator it = data->constBegin();
+  while (it != data->constEnd())
   {
     current = it.value().key;
     if (!qIsNaN(current) && !qIsNaN(it.value().value))
@@ -1277,8 +2110,13 @@ QCPRange QCPCurve::getKeyRange(bool &foundRange, SignDomain inSignDomain) const
   return range;
 }
 
-/* inherits documentation from base class */
-QCPRange QCPCurve::getValueRange(bool &foundRange, SignDomain inSignDomain) const
+/*! \internal
+  
+  Calculates the value range of the data points in \a data, which may be either a \ref
+  QCPCurveDataMap or a \ref QCPCurveCompactData. See \ref getValueRange.
+*/
+template <class DataContainer>
+QCPRange QCPCurve::findValueRange(const DataContainer *data, bool &foundRange, SignDomain inSignDomain) const
 {
   QCPRange range;
   bool haveLower = false;
@@ -1286,8 +2124,8 @@ QCPRange QCPCurve::getValueRange(bool &foundRange, SignDomain inSignDomain) cons
   
   double current;
   
-  QCPCurveDataMap::const_iterator it = mData->constBegin();
-  while (it != mData->constEnd())
+  typename DataContainer::const_iterator it = data->constBegin();
+  while (it != data->constEnd())
   {
     current = it.value().value;
     if (!qIsNaN(current) && !qIsNaN(it.value().key))
@@ -56,12 +56,109 @@ typedef QMapIterator<double, QCPCurveData> QCPCurveDataMapIterator;
 typedef QMutableMapIterator<double, QCPCurveData> QCPCurveDataMutableMapIterator;
 
 
+class QCP_LIB_DECL QCPCurveCompactData
+{
+public:
+  class const_iterator
+  {
+  public:
+    const_iterator() : mData(0), mIndex(0) {}
+    const_iterator(const QCPCurveCompactData *data, int index) : mData(data), mIndex(index) {}
+    double key() const { return mData->t(mIndex); }
+    QCPCurveData value() const { return mData->at(mIndex); }
+    int index() const { return mIndex; }
+    const_iterator &operator++() { ++mIndex; return *this; }
+    const_iterator &operator--() { --mIndex; return *this; }
+    const_iterator operator+(int j) const { return const_iterator(mData, mIndex+j); }
+    const_iterator operator-(int j) const { return const_iterator(mData, mIndex-j); }
+    int operator-(const const_iterator &other) const { return mIndex-other.mIndex; }
+    bool operator==(const const_iterator &other) const { return mIndex == other.mIndex && mData == other.mData; }
+    bool operator!=(const const_iterator &other) const { return !(*this == other); }
+  private:
+    const QCPCurveCompactData *mData;
+    int mIndex;
+  };
+  
+  QCPCurveCompactData();
+  
+  // getters:
+  int size() const { return mT.size()-mOffset; }
+  bool isEmpty() const { return size() == 0; }
+  double t(int index) const { return mT.at(mOffset+index); }
+  double key(int index) const { return mKeys.at(mOffset+index); }
+  double value(int index) const { return mValues.at(mOffset+index); }
+  QCPCurveData at(int index) const { return QCPCurveData(t(index), key(index), value(index)); }
+  qint64 memoryUsage() const;
+  
+  // non-property methods:
+  const_iterator constBegin() const { return const_iterator(this, 0); }
+  const_iterator constEnd() const { return const_iterator(this, size()); }
+  const_iterator lowerBound(double t) const;
+  const_iterator upperBound(double t) const;
+  int lowerBoundIndex(double t) const;
+  int upperBoundIndex(double t) const;
+  void set(const QVector<double> &t, const QVector<double> &keys, const QVector<double> &values);
+  void set(const QCPCurveDataMap &dataMap);
+  void add(const QCPCurveData &data);
+  void add(double t, double key, double value);
+  void add(const QVector<double> &t, const QVector<double> &keys, const QVector<double> &values);
+  void add(const QCPCurveDataMap &dataMap);
+  void removeBefore(double t);
+  void removeAfter(double t);
+  void remove(double fromT, double toT);
+  void remove(double t);
+  void clear();
+  void squeeze();
+  void toDataMap(QCPCurveDataMap *dataMap) const;
+  
+protected:
+  // non-property members:
+  QVector<double> mT, mKeys, mValues;
+  int mOffset; // number of points at the front of the columns that were removed, but not released yet
+  
+  // non-virtual methods:
+  void removeRange(int fromIndex, int toIndex);
+  void releaseRemoved();
+  void sortByT();
+  bool isSortedFrom(int index) const;
+};
+
+
+class QCP_LIB_DECL QCPCurveSegmentIndex
+{
+public:
+  QCPCurveSegmentIndex();
+  
+  // getters:
+  bool isEmpty() const { return mCellStart.isEmpty(); }
+  
+  // non-property methods:
+  void build(const QVector<QPointF> &line, const QRectF &queryRect);
+  void clear();
+  double distanceSqr(const QPointF &point) const;
+  
+protected:
+  // non-property members:
+  QVector<QPointF> mLine;
+  QPointF mOrigin;
+  double mCellSize;
+  int mColumns, mRows;
+  QVector<int> mCellStart; // index of the first entry in mCellSegments for each cell, plus one past the end
+  QVector<int> mCellSegments; // indices of the segments (i.e. their start points in mLine) that touch each cell
+  
+  // non-virtual methods:
+  void addSegmentCells(int segment, QVector<int> &cellCounters, bool fill);
+};
+
+
 class QCP_LIB_DECL QCPCurve : public QCPAbstractPlottable
 {
   Q_OBJECT
   /// \cond INCLUDE_QPROPERTIES
   Q_PROPERTY(QCPScatterStyle scatterStyle READ scatterStyle WRITE setScatterStyle)
   Q_PROPERTY(LineStyle lineStyle READ lineStyle WRITE setLineStyle)
+  Q_PROPERTY(DataLayout dataLayout READ dataLayout WRITE setDataLayout)
+  Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
   /// \endcond
 public:
   /*!
@@ -72,6 +169,16 @@ public:
   enum LineStyle { lsNone  ///< No line is drawn between data points (e.g. only scatters)
                    ,lsLine ///< Data points are connected with a straight line
                  };
+  /*!
+    Defines in which kind of container the curve stores its data points.
+    
+    \see setDataLayout
+  */
+  enum DataLayout { dlMap      ///< data is stored in the \ref QCPCurveDataMap accessible via \ref data (default)
+                    ,dlCompact ///< data is stored column-wise in the \ref QCPCurveCompactData accessible via \ref compactData
+                  };
+  Q_ENUMS(DataLayout)
+  
   explicit QCPCurve(QCPAxis *keyAxis, QCPAxis *valueAxis);
   virtual ~QCPCurve();
   
@@ -79,6 +186,9 @@ public:
   QCPCurveDataMap *data() const { return mData; }
   QCPScatterStyle scatterStyle() const { return mScatterStyle; }
   LineStyle lineStyle() const { return mLineStyle; }
+  DataLayout dataLayout() const { return mDataLayout; }
+  QCPCurveCompactData *compactData() const { return mCompactData; }
+  bool adaptiveSampling() const { return mAdaptiveSampling; }
   
   // setters:
   void setData(QCPCurveDataMap *data, bool copy=false);
@@ -86,8 +196,12 @@ public:
   void setData(const QVector<double> &key, const QVector<double> &value);
   void setScatterStyle(const QCPScatterStyle &style);
   void setLineStyle(LineStyle style);
+  void setDataLayout(DataLayout layout);
+  void setAdaptiveSampling(bool enabled);
   
   // non-property methods:
+  int dataCount() const { return mDataLayout == dlMap ? mData->size() : mCompactData->size(); }
+  void invalidateSegmentIndex();
   void addData(const QCPCurveDataMap &dataMap);
   void addData(const QCPCurveData &data);
   void addData(double t, double key, double value);
@@ -107,6 +221,18 @@ protected:
   QCPCurveDataMap *mData;
   QCPScatterStyle mScatterStyle;
   LineStyle mLineStyle;
+  DataLayout mDataLayout;
+  bool mAdaptiveSampling;
+  
+  // non-property members:
+  QCPCurveCompactData *mCompactData;
+  mutable QCPScratchPool<QPointF> mPointScratch;
+  mutable QCPCurveSegmentIndex mSegmentIndex;
+  mutable bool mSegmentIndexValid;
+  mutable QCPRange mSegmentIndexKeyRange, mSegmentIndexValueRange;
+  mutable QRect mSegmentIndexAxisRect;
+  mutable QCPAxis::ScaleType mSegmentIndexKeyScaleType, mSegmentIndexValueScaleType;
+  mutable bool mSegmentIndexKeyReversed, mSegmentIndexValueReversed;
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter);
@@ -118,7 +244,7 @@ protected:
   virtual void drawScatterPlot(QCPPainter *painter, const QVector<QPointF> *pointData) const;
   
   // non-virtual methods:
-  void getCurveData(QVector<QPointF> *lineData) const;
+  void getCurveData(QVector<QPointF> *lineData, int *sampledAway=0) const;
   int getRegion(double x, double y, double rectLeft, double rectTop, double rectRight, double rectBottom) const;
   QPointF getOptimizedPoint(int prevRegion, double prevKey, double prevValue, double key, double value, double rectLeft, double rectTop, double rectRight, double rectBottom) const;
   QVector<QPointF> getOptimizedCornerPoints(int prevRegion, int currentRegion, double prevKey, double prevValue, double key, double value, double rectLeft, double rectTop, double rectRight, double rectBottom) const;
@@ -126,6 +252,15 @@ protected:
   bool getTraverse(double prevKey, double prevValue, double key, double value, double rectLeft, double rectTop, double rectRight, double rectBottom, QPointF &crossA, QPointF &crossB) const;
   void getTraverseCornerPoints(int prevRegion, int currentRegion, double rectLeft, double rectTop, double rectRight, double rectBottom, QVector<QPointF> &beforeTraverse, QVector<QPointF> &afterTraverse) const;
   double pointDistance(const QPointF &pixelPoint) const;
+  void updateSegmentIndex() const;
+  
+  // data container templates (instantiated for QCPCurveDataMap and QCPCurveCompactData):
+  template <class DataContainer>
+  void getCurveData(const DataContainer *data, QVector<QPointF> *lineData, int *sampledAway) const;
+  template <class DataContainer>
+  QCPRange findKeyRange(const DataContainer *data, bool &foundRange, SignDomain inSignDomain) const;
+  template <class DataContainer>
+  QCPRange findValueRange(const DataContainer *data, bool &foundRange, SignDomain inSignDomain) const;
   
   friend class QCustomPlot;
   friend class QCPLegend;
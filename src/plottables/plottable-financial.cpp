@@ -108,6 +108,17 @@ QCPFinancialData::QCPFinancialData(double key, double open, double high, double
   however, the normal selected pen/brush (\ref setSelectedPen, \ref setSelectedBrush) is used,
   irrespective of whether the chart is single- or two-colored.
   
+  \section streaming Live data
+  
+  For live data feeds, the individual ticks (\a value at \a time) can be aggregated directly with
+  \ref addTick, after setting the bin size with \ref setTickBinSize. Each tick only updates the bin
+  it falls into, which usually is the newest one. A new bin is started when the time of a tick
+  crosses the border of the newest bin.
+  
+  \section performance Performance with large data sets
+  
+  When zoomed out so far that the bars/candlesticks are closer together than a few pixels, the data
+  is drawn at a coarser level of detail, see \ref setAdaptiveBinning.
 */
 
 /* start of documentation of inline functions */
@@ -117,6 +128,9 @@ QCPFinancialData::QCPFinancialData(double key, double open, double high, double
   Returns a pointer to the internal data storage of type \ref QCPFinancialDataMap. You may use it to
   directly manipulate the data, which may be more convenient and faster than using the regular \ref
   setData or \ref addData methods, in certain situations.
+  
+  If you modify the data this way while adaptive binning is enabled, call \ref
+  invalidateBinnedLevels afterwards (see \ref setAdaptiveBinning).
 */
 
 /* end of documentation of inline functions */
@@ -139,7 +153,12 @@ QCPFinancial::QCPFinancial(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   mBrushPositive(QBrush(QColor(210, 210, 255))),
   mBrushNegative(QBrush(QColor(255, 210, 210))),
   mPenPositive(QPen(QColor(10, 40, 180))),
-  mPenNegative(QPen(QColor(180, 40, 10)))
+  mPenNegative(QPen(QColor(180, 40, 10))),
+  mAdaptiveBinning(true),
+  mTickBinSize(0),
+  mTickBinOffset(0),
+  mBinInterval(0),
+  mBinOrigin(0)
 {
   mData = new QCPFinancialDataMap;
   
@@ -179,6 +198,8 @@ void QCPFinancial::setData(QCPFinancialDataMap *data, bool copy)
     delete mData;
     mData = data;
   }
+  mTickTimes.clear();
+  invalidateBinnedLevels();
 }
 
 /*! \overload
@@ -200,6 +221,8 @@ void QCPFinancial::setData(const QVector<double> &key, const QVector<double> &op
   {
     mData->insertMulti(key[i], QCPFinancialData(key[i], open[i], high[i], low[i], close[i]));
   }
+  mTickTimes.clear();
+  invalidateBinnedLevels();
 }
 
 /*!
@@ -290,6 +313,63 @@ void QCPFinancial::setPenNegative(const QPen &pen)
   mPenNegative = pen;
 }
 
+/*!
+  Sets whether adaptive binning shall be used when plotting this financial chart. While adaptive
+  binning is enabled, the chart is drawn at a coarser level of detail when neighbouring
+  bars/candlesticks would be less than three pixels apart, e.g. when zooming out on a long time
+  series. Bars/candlesticks that are narrow but far apart are not combined. Then
+  neighbouring data points are combined to one bar/candlestick per bin, with the open value of the
+  first, the highest high, the lowest low and the close value of the last data point in the bin,
+  like \ref timeSeriesToOhlc does. This way, the number of drawn bars/candlesticks stays
+  approximately constant, regardless of how many data points are in the visible key range.
+  
+  The bins are powers of two multiples of the smallest key interval in the data, so each level of
+  detail combines pairs of bins of the previous one. The levels are calculated when they're needed
+  for the first time and kept until the data changes. The width of a combined bar/candlestick is
+  the width (\ref setWidth) multiplied by the number of smallest intervals in its bin, so the
+  gaps between them keep their proportions.
+  
+  If the data is modified directly via the \ref data pointer, call \ref invalidateBinnedLevels
+  afterwards, so the levels are recalculated. Selection tests are always performed with the full
+  data.
+  
+  Adaptive binning is enabled by default. It has no effect on vectorized exports (e.g. PDF), unless
+  a resolution is set with \ref QCustomPlot::setVectorResolution.
+*/
+void QCPFinancial::setAdaptiveBinning(bool enabled)
+{
+  mAdaptiveBinning = enabled;
+}
+
+/*!
+  Sets the size of the bins to which \ref addTick aggregates ticks, in the same units as the tick
+  time. For example, if the time is given in seconds and each bar/candlestick shall span one
+  minute, set \a size to 60. The width of the bars/candlesticks (\ref setWidth) is not changed
+  automatically, a typical choice is slightly less than the bin size.
+  
+  The bin size is zero by default, and must be set before ticks can be added. Changing the bin size
+  doesn't affect bins that already exist.
+  
+  \see setTickBinOffset
+*/
+void QCPFinancial::setTickBinSize(double size)
+{
+  mTickBinSize = size;
+}
+
+/*!
+  Sets the offset of the bins to which \ref addTick aggregates ticks, i.e. a \a time coordinate at
+  which a bin is centered. This has the same meaning as the \a timeBinOffset parameter of \ref
+  timeSeriesToOhlc, so with the same bin size and offset, ticks added with \ref addTick continue
+  the bins of data generated with \ref timeSeriesToOhlc seamlessly.
+  
+  \see setTickBinSize
+*/
+void QCPFinancial::setTickBinOffset(double offset)
+{
+  mTickBinOffset = offset;
+}
+
 /*!
   Adds the provided data points in \a dataMap to the current data.
   
@@ -301,6 +381,7 @@ void QCPFinancial::setPenNegative(const QPen &pen)
 void QCPFinancial::addData(const QCPFinancialDataMap &dataMap)
 {
   mData->unite(dataMap);
+  invalidateBinnedLevels();
 }
 
 /*! \overload
@@ -315,6 +396,7 @@ void QCPFinancial::addData(const QCPFinancialDataMap &dataMap)
 void QCPFinancial::addData(const QCPFinancialData &data)
 {
   mData->insertMulti(data.key, data);
+  invalidateBinnedLevels();
 }
 
 /*! \overload
@@ -330,6 +412,7 @@ void QCPFinancial::addData(const QCPFinancialData &data)
 void QCPFinancial::addData(double key, double open, double high, double low, double close)
 {
   mData->insertMulti(key, QCPFinancialData(key, open, high, low, close));
+  invalidateBinnedLevels();
 }
 
 /*! \overload
@@ -352,6 +435,7 @@ void QCPFinancial::addData(const QVector<double> &key, const QVector<double> &op
   {
     mData->insertMulti(key[i], QCPFinancialData(key[i], open[i], high[i], low[i], close[i]));
   }
+  invalidateBinnedLevels();
 }
 
 /*!
@@ -364,6 +448,10 @@ void QCPFinancial::removeDataBefore(double key)
   QCPFinancialDataMap::iterator it = mData->begin();
   while (it != mData->end() && it.key() < key)
     it = mData->erase(it);
+  QMap<double, QCPRange>::iterator timesIt = mTickTimes.begin();
+  while (timesIt != mTickTimes.end() && timesIt.key() < key)
+    timesIt = mTickTimes.erase(timesIt);
+  invalidateBinnedLevels();
 }
 
 /*!
@@ -377,6 +465,10 @@ void QCPFinancial::removeDataAfter(double key)
   QCPFinancialDataMap::iterator it = mData->upperBound(key);
   while (it != mData->end())
     it = mData->erase(it);
+  QMap<double, QCPRange>::iterator timesIt = mTickTimes.upperBound(key);
+  while (timesIt != mTickTimes.end())
+    timesIt = mTickTimes.erase(timesIt);
+  invalidateBinnedLevels();
 }
 
 /*!
@@ -393,6 +485,11 @@ void QCPFinancial::removeData(double fromKey, double toKey)
   QCPFinancialDataMap::iterator itEnd = mData->upperBound(toKey);
   while (it != itEnd)
     it = mData->erase(it);
+  QMap<double, QCPRange>::iterator timesIt = mTickTimes.upperBound(fromKey);
+  QMap<double, QCPRange>::iterator timesItEnd = mTickTimes.upperBound(toKey);
+  while (timesIt != timesItEnd)
+    timesIt = mTickTimes.erase(timesIt);
+  invalidateBinnedLevels();
 }
 
 /*! \overload
@@ -406,6 +503,8 @@ void QCPFinancial::removeData(double fromKey, double toKey)
 void QCPFinancial::removeData(double key)
 {
   mData->remove(key);
+  mTickTimes.remove(key);
+  invalidateBinnedLevels();
 }
 
 /*!
@@ -416,6 +515,125 @@ void QCPFinancial::removeData(double key)
 void QCPFinancial::clearData()
 {
   mData->clear();
+  mTickTimes.clear();
+  invalidateBinnedLevels();
+}
+
+/*!
+  Aggregates a single tick of a live data feed, the \a value at \a time, into the bin it falls
+  into. The bins have the size set with \ref setTickBinSize and are centered at \a time
+  coordinates given by \ref setTickBinOffset plus multiples of the bin size, just like the bins of
+  \ref timeSeriesToOhlc.
+  
+  If the tick falls into an existing bin, the high and low value of that bin are extended. The
+  first and last tick time of each bin are recorded, so the open and close value of the bin are
+  only replaced by \a value if \a time is earlier than the first or not earlier than the last tick
+  of the bin, respectively. Ticks that arrive out of order (e.g. late ticks for an older bin) thus
+  don't corrupt the open/close values. If the bin was not created by addTick but e.g. by \ref
+  addData or \ref timeSeriesToOhlc, the times of its data are unknown: A tick in the newest bin is
+  then assumed to be later than the existing data and sets the close value, a tick in an older bin
+  only extends the high and low value. If the tick's time has crossed the border of the newest
+  bin, a new bin is started with \a value as open, high, low and close value.
+  
+  Updating the newest bin doesn't touch any other data, so existing bins are never aggregated
+  again. Also the levels of adaptive binning (\ref
+  setAdaptiveBinning) are only updated at their newest bins, instead of being recalculated.
+  
+  \see addTicks
+*/
+void QCPFinancial::addTick(double time, double value)
+{
+  if (mTickBinSize <= 0)
+  {
+    qDebug() << Q_FUNC_INFO << "tick bin size not set, see setTickBinSize" << mTickBinSize;
+    return;
+  }
+  
+  int index = qFloor((time-mTickBinOffset)/mTickBinSize+0.5);
+  double key = mTickBinOffset+index*mTickBinSize;
+  if (!mData->isEmpty())
+  {
+    QCPFinancialDataMap::iterator newest = mData->end()-1;
+    int newestIndex = qFloor((newest.key()-mTickBinOffset)/mTickBinSize+0.5);
+    if (index <= newestIndex) // tick for newest or older bin, extend high/low and set open/close according to tick time:
+    {
+      QCPFinancialDataMap::iterator it = index == newestIndex ? newest : mData->find(key);
+      if (it == mData->end()) // late tick for an older bin that doesn't exist yet:
+      {
+        mData->insert(key, QCPFinancialData(key, value, value, value, value));
+        mTickTimes.insert(key, QCPRange(time, time));
+        invalidateBinnedLevels();
+        return;
+      }
+      QCPFinancialData &bin = it.value();
+      bool openChanged = false;
+      if (value < bin.low) bin.low = value;
+      if (value > bin.high) bin.high = value;
+      QMap<double, QCPRange>::iterator times = mTickTimes.find(it.key());
+      if (times != mTickTimes.end())
+      {
+        if (time < times.value().lower)
+        {
+          times.value().lower = time;
+          bin.open = value;
+          openChanged = true;
+        }
+        if (time >= times.value().upper)
+        {
+          times.value().upper = time;
+          bin.close = value;
+        }
+      } else if (it == newest) // bin not created by ticks, assume continuation of its data:
+      {
+        mTickTimes.insert(it.key(), QCPRange(-std::numeric_limits<double>::max(), time));
+        bin.close = value;
+      }
+      if (it == newest && !openChanged)
+        updateBinnedLevels(bin);
+      else
+        invalidateBinnedLevels();
+      return;
+    }
+  }
+  
+  // tick crossed the border of the newest bin (or there is no data yet), start new bin:
+  QCPFinancialData bin(key, value, value, value, value);
+  mTickTimes.insert(key, QCPRange(time, time));
+  if (!mData->isEmpty() && key-(mData->constEnd()-1).key() < mBinInterval) // adaptive binning levels are based on a larger key interval
+  {
+    mData->insert(key, bin);
+    invalidateBinnedLevels();
+  } else
+  {
+    mData->insert(key, bin);
+    updateBinnedLevels(bin);
+  }
+}
+
+/*! \overload
+  
+  Aggregates the ticks given by \a time and \a value, one after another, like \ref
+  addTick(double time, double value) does. The provided vectors should have equal length. Else,
+  the number of added ticks will be the size of the smallest vector.
+*/
+void QCPFinancial::addTicks(const QVector<double> &time, const QVector<double> &value)
+{
+  int n = qMin(time.size(), value.size());
+  for (int i=0; i<n; ++i)
+    addTick(time.at(i), value.at(i));
+}
+
+/*!
+  Discards the data binned for adaptive binning (\ref setAdaptiveBinning), so it is recalculated
+  from the current data the next time it is needed.
+  
+  This is done automatically by all methods that modify the data. You only need to call it after
+  modifying the data directly via the \ref data pointer.
+*/
+void QCPFinancial::invalidateBinnedLevels()
+{
+  mBinnedLevels.clear();
+  mBinInterval = 0;
 }
 
 /* inherits documentation from base class */
@@ -428,18 +646,18 @@ double QCPFinancial::selectTest(const QPointF &pos, bool onlySelectable, QVarian
   
   if (mKeyAxis.data()->axisRect()->rect().contains(pos.toPoint()))
   {
-    // get visible data range:
-    QCPFinancialDataMap::const_iterator lower, upper; // note that upper is the actual upper point, and not 1 step after the upper point
-    getVisibleDataBounds(lower, upper);
-    if (lower == mData->constEnd() || upper == mData->constEnd())
+    // only test the data points close to pos in key direction:
+    QCPFinancialDataMap::const_iterator begin, end;
+    getSelectTestBounds(pos, begin, end);
+    if (begin == end)
       return -1;
     // perform select test according to configured style:
     switch (mChartStyle)
     {
       case QCPFinancial::csOhlc:
-        return ohlcSelectTest(pos, lower, upper+1); break;
+        return ohlcSelectTest(pos, begin, end); break;
       case QCPFinancial::csCandlestick:
-        return candlestickSelectTest(pos, lower, upper+1); break;
+        return candlestickSelectTest(pos, begin, end); break;
     }
   }
   return -1;
@@ -500,19 +718,52 @@ QCPFinancialDataMap QCPFinancial::timeSeriesToOhlc(const QVector<double> &time,
 /* inherits documentation from base class */
 void QCPFinancial::draw(QCPPainter *painter)
 {
+  // choose level of detail, bars/candlesticks must be at least a few pixels (or output dots in vector exports with a set resolution) apart:
+  const double prepStart = profileTime();
+  const QCPFinancialDataMap *data = mData;
+  double width = mWidth;
+  if (mAdaptiveBinning)
+  {
+    double samplingScale = exportSamplingScale();
+    if (samplingScale <= 0 && !painter->modes().testFlag(QCPPainter::pmVectorized))
+      samplingScale = 1.0;
+    if (samplingScale > 0)
+      data = getBinnedData(samplingScale, width);
+  }
+  
   // get visible data range:
   QCPFinancialDataMap::const_iterator lower, upper; // note that upper is the actual upper point, and not 1 step after the upper point
-  getVisibleDataBounds(lower, upper);
-  if (lower == mData->constEnd() || upper == mData->constEnd())
+  getVisibleDataBounds(data, lower, upper);
+  addProfilePreparationTime(prepStart);
+  if (lower == data->constEnd() || upper == data->constEnd())
     return;
   
+  // in profiled replots, report how many of the visible data points are drawn:
+  QCPReplotProfile *profile = mParentPlot->currentReplotProfile();
+  if (profile)
+  {
+    int drawnCount = 0;
+    for (QCPFinancialDataMap::const_iterator it = lower; it != upper+1; ++it)
+      ++drawnCount;
+    profile->pointsDrawn += drawnCount;
+    if (data != mData)
+    {
+      QCPFinancialDataMap::const_iterator dataLower, dataUpper;
+      getVisibleDataBounds(mData, dataLower, dataUpper);
+      int dataCount = 0;
+      for (QCPFinancialDataMap::const_iterator it = dataLower; it != dataUpper+1; ++it)
+        ++dataCount;
+      profile->pointsSampledAway += qMax(0, dataCount-drawnCount);
+    }
+  }
+  
   // draw visible data range according to configured style:
   switch (mChartStyle)
   {
     case QCPFinancial::csOhlc:
-      drawOhlcPlot(painter, lower, upper+1); break;
+      drawOhlcPlot(painter, lower, upper+1, width); break;
     case QCPFinancial::csCandlestick:
-      drawCandlestickPlot(painter, lower, upper+1); break;
+      drawCandlestickPlot(painter, lower, upper+1, width); break;
   }
 }
 
@@ -658,155 +909,120 @@ QCPRange QCPFinancial::getValueRange(bool &foundRange, QCPAbstractPlottable::Sig
 
 /*! \internal
   
-  Draws the data from \a begin to \a end as OHLC bars with the provided \a painter.
+  Draws the data from \a begin to \a end as OHLC bars with the provided \a painter. The bars are
+  \a width wide in key coordinates.
+  
+  The lines of all bars that share a pen (see \ref getColorGroup) are collected and drawn with one
+  call, so the painter state is only changed once per color instead of once per bar.
 
   This method is a helper function for \ref draw. It is used when the chart style is \ref csOhlc.
 */
-void QCPFinancial::drawOhlcPlot(QCPPainter *painter, const QCPFinancialDataMap::const_iterator &begin, const QCPFinancialDataMap::const_iterator &end)
+void QCPFinancial::drawOhlcPlot(QCPPainter *painter, const QCPFinancialDataMap::const_iterator &begin, const QCPFinancialDataMap::const_iterator &end, double width)
 {
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   
-  QPen linePen;
+  QVector<QLineF> lines[2]; // backbone, open and close line of each bar, per color group
   
   if (keyAxis->orientation() == Qt::Horizontal)
   {
     for (QCPFinancialDataMap::const_iterator it = begin; it != end; ++it)
     {
-      if (mSelected)
-        linePen = mSelectedPen;
-      else if (mTwoColored)
-        linePen = it.value().close >= it.value().open ? mPenPositive : mPenNegative;
-      else
-        linePen = mPen;
-      painter->setPen(linePen);
+      QVector<QLineF> &groupLines = lines[getColorGroup(it.value())];
       double keyPixel = keyAxis->coordToPixel(it.value().key);
       double openPixel = valueAxis->coordToPixel(it.value().open);
       double closePixel = valueAxis->coordToPixel(it.value().close);
-      // draw backbone:
-      painter->drawLine(QPointF(keyPixel, valueAxis->coordToPixel(it.value().high)), QPointF(keyPixel, valueAxis->coordToPixel(it.value().low)));
-      // draw open:
-      double keyWidthPixels = keyPixel-keyAxis->coordToPixel(it.value().key-mWidth*0.5); // sign of this makes sure open/close are on correct sides
-      painter->drawLine(QPointF(keyPixel-keyWidthPixels, openPixel), QPointF(keyPixel, openPixel));
-      // draw close:
-      painter->drawLine(QPointF(keyPixel, closePixel), QPointF(keyPixel+keyWidthPixels, closePixel));
+      double keyWidthPixels = keyPixel-keyAxis->coordToPixel(it.value().key-width*0.5); // sign of this makes sure open/close are on correct sides
+      groupLines.append(QLineF(keyPixel, valueAxis->coordToPixel(it.value().high), keyPixel, valueAxis->coordToPixel(it.value().low))); // backbone
+      groupLines.append(QLineF(keyPixel-keyWidthPixels, openPixel, keyPixel, openPixel)); // open
+      groupLines.append(QLineF(keyPixel, closePixel, keyPixel+keyWidthPixels, closePixel)); // close
     }
   } else
   {
     for (QCPFinancialDataMap::const_iterator it = begin; it != end; ++it)
     {
-      if (mSelected)
-        linePen = mSelectedPen;
-      else if (mTwoColored)
-        linePen = it.value().close >= it.value().open ? mPenPositive : mPenNegative;
-      else
-        linePen = mPen;
-      painter->setPen(linePen);
+      QVector<QLineF> &groupLines = lines[getColorGroup(it.value())];
       double keyPixel = keyAxis->coordToPixel(it.value().key);
       double openPixel = valueAxis->coordToPixel(it.value().open);
       double closePixel = valueAxis->coordToPixel(it.value().close);
-      // draw backbone:
-      painter->drawLine(QPointF(valueAxis->coordToPixel(it.value().high), keyPixel), QPointF(valueAxis->coordToPixel(it.value().low), keyPixel));
-      // draw open:
-      double keyWidthPixels = keyPixel-keyAxis->coordToPixel(it.value().key-mWidth*0.5); // sign of this makes sure open/close are on correct sides
-      painter->drawLine(QPointF(openPixel, keyPixel-keyWidthPixels), QPointF(openPixel, keyPixel));
-      // draw close:
-      painter->drawLine(QPointF(closePixel, keyPixel), QPointF(closePixel, keyPixel+keyWidthPixels));
+      double keyWidthPixels = keyPixel-keyAxis->coordToPixel(it.value().key-width*0.5); // sign of this makes sure open/close are on correct sides
+      groupLines.append(QLineF(valueAxis->coordToPixel(it.value().high), keyPixel, valueAxis->coordToPixel(it.value().low), keyPixel)); // backbone
+      groupLines.append(QLineF(openPixel, keyPixel-keyWidthPixels, openPixel, keyPixel)); // open
+      groupLines.append(QLineF(closePixel, keyPixel, closePixel, keyPixel+keyWidthPixels)); // close
     }
   }
+  
+  for (int group=0; group<2; ++group)
+  {
+    if (lines[group].isEmpty())
+      continue;
+    painter->setPen(getColorGroupPen(group));
+    painter->drawLines(lines[group]);
+  }
 }
 
 /*! \internal
   
-  Draws the data from \a begin to \a end as Candlesticks with the provided \a painter.
+  Draws the data from \a begin to \a end as Candlesticks with the provided \a painter. The
+  candlesticks are \a width wide in key coordinates.
+  
+  The high/low lines and the open-close boxes of all candlesticks that share a pen and brush (see
+  \ref getColorGroup) are collected and drawn with one call each, so the painter state is only
+  changed once per color instead of once per candlestick.
 
   This method is a helper function for \ref draw. It is used when the chart style is \ref csCandlestick.
 */
-void QCPFinancial::drawCandlestickPlot(QCPPainter *painter, const QCPFinancialDataMap::const_iterator &begin, const QCPFinancialDataMap::const_iterator &end)
+void QCPFinancial::drawCandlestickPlot(QCPPainter *painter, const QCPFinancialDataMap::const_iterator &begin, const QCPFinancialDataMap::const_iterator &end, double width)
 {
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   
-  QPen linePen;
-  QBrush boxBrush;
+  QVector<QLineF> lines[2]; // high and low line of each candlestick, per color group
+  QVector<QRectF> boxes[2]; // open-close box of each candlestick, per color group
   
   if (keyAxis->orientation() == Qt::Horizontal)
   {
     for (QCPFinancialDataMap::const_iterator it = begin; it != end; ++it)
     {
-      if (mSelected)
-      {
-        linePen = mSelectedPen;
-        boxBrush = mSelectedBrush;
-      } else if (mTwoColored)
-      {
-        if (it.value().close >= it.value().open)
-        {
-          linePen = mPenPositive;
-          boxBrush = mBrushPositive;
-        } else
-        {
-          linePen = mPenNegative;
-          boxBrush = mBrushNegative;
-        }
-      } else
-      {
-        linePen = mPen;
-        boxBrush = mBrush;
-      }
-      painter->setPen(linePen);
-      painter->setBrush(boxBrush);
+      int group = getColorGroup(it.value());
       double keyPixel = keyAxis->coordToPixel(it.value().key);
       double openPixel = valueAxis->coordToPixel(it.value().open);
       double closePixel = valueAxis->coordToPixel(it.value().close);
-      // draw high:
-      painter->drawLine(QPointF(keyPixel, valueAxis->coordToPixel(it.value().high)), QPointF(keyPixel, valueAxis->coordToPixel(qMax(it.value().open, it.value().close))));
-      // draw low:
-      painter->drawLine(QPointF(keyPixel, valueAxis->coordToPixel(it.value().low)), QPointF(keyPixel, valueAxis->coordToPixel(qMin(it.value().open, it.value().close))));
-      // draw open-close box:
-      double keyWidthPixels = keyPixel-keyAxis->coordToPixel(it.value().key-mWidth*0.5);
-      painter->drawRect(QRectF(QPointF(keyPixel-keyWidthPixels, closePixel), QPointF(keyPixel+keyWidthPixels, openPixel)));
+      // high and low:
+      lines[group].append(QLineF(keyPixel, valueAxis->coordToPixel(it.value().high), keyPixel, valueAxis->coordToPixel(qMax(it.value().open, it.value().close))));
+      lines[group].append(QLineF(keyPixel, valueAxis->coordToPixel(it.value().low), keyPixel, valueAxis->coordToPixel(qMin(it.value().open, it.value().close))));
+      // open-close box:
+      double keyWidthPixels = keyPixel-keyAxis->coordToPixel(it.value().key-width*0.5);
+      boxes[group].append(QRectF(QPointF(keyPixel-keyWidthPixels, closePixel), QPointF(keyPixel+keyWidthPixels, openPixel)));
     }
   } else // keyAxis->orientation() == Qt::Vertical
   {
     for (QCPFinancialDataMap::const_iterator it = begin; it != end; ++it)
     {
-      if (mSelected)
-      {
-        linePen = mSelectedPen;
-        boxBrush = mSelectedBrush;
-      } else if (mTwoColored)
-      {
-        if (it.value().close >= it.value().open)
-        {
-          linePen = mPenPositive;
-          boxBrush = mBrushPositive;
-        } else
-        {
-          linePen = mPenNegative;
-          boxBrush = mBrushNegative;
-        }
-      } else
-      {
-        linePen = mPen;
-        boxBrush = mBrush;
-      }
-      painter->setPen(linePen);
-      painter->setBrush(boxBrush);
+      int group = getColorGroup(it.value());
       double keyPixel = keyAxis->coordToPixel(it.value().key);
       double openPixel = valueAxis->coordToPixel(it.value().open);
       double closePixel = valueAxis->coordToPixel(it.value().close);
-      // draw high:
-      painter->drawLine(QPointF(valueAxis->coordToPixel(it.value().high), keyPixel), QPointF(valueAxis->coordToPixel(qMax(it.value().open, it.value().close)), keyPixel));
-      // draw low:
-      painter->drawLine(QPointF(valueAxis->coordToPixel(it.value().low), keyPixel), QPointF(valueAxis->coordToPixel(qMin(it.value().open, it.value().close)), keyPixel));
-      // draw open-close box:
-      double keyWidthPixels = keyPixel-keyAxis->coordToPixel(it.value().key-mWidth*0.5);
-      painter->drawRect(QRectF(QPointF(closePixel, keyPixel-keyWidthPixels), QPointF(openPixel, keyPixel+keyWidthPixels)));
+      // high and low:
+      lines[group].append(QLineF(valueAxis->coordToPixel(it.value().high), keyPixel, valueAxis->coordToPixel(qMax(it.value().open, it.value().close)), keyPixel));
+      lines[group].append(QLineF(valueAxis->coordToPixel(it.value().low), keyPixel, valueAxis->coordToPixel(qMin(it.value().open, it.value().close)), keyPixel));
+      // open-close box:
+      double keyWidthPixels = keyPixel-keyAxis->coordToPixel(it.value().key-width*0.5);
+      boxes[group].append(QRectF(QPointF(closePixel, keyPixel-keyWidthPixels), QPointF(openPixel, keyPixel+keyWidthPixels)));
     }
   }
+  
+  for (int group=0; group<2; ++group)
+  {
+    if (boxes[group].isEmpty())
+      continue;
+    painter->setPen(getColorGroupPen(group));
+    painter->setBrush(getColorGroupBrush(group));
+    painter->drawLines(lines[group]);
+    painter->drawRects(boxes[group]);
+  }
 }
 
 /*! \internal
@@ -858,6 +1074,8 @@ double QCPFinancial::candlestickSelectTest(const QPointF &pos, const QCPFinancia
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return -1; }
 
+  double posKey, posValue;
+  pixelsToCoords(pos, posKey, posValue);
   double minDistSqr = std::numeric_limits<double>::max();
   QCPFinancialDataMap::const_iterator it;
   if (keyAxis->orientation() == Qt::Horizontal)
@@ -868,8 +1086,6 @@ double QCPFinancial::candlestickSelectTest(const QPointF &pos, const QCPFinancia
       // determine whether pos is in open-close-box:
       QCPRange boxKeyRange(it.value().key-mWidth*0.5, it.value().key+mWidth*0.5);
       QCPRange boxValueRange(it.value().close, it.value().open);
-      double posKey, posValue;
-      pixelsToCoords(pos, posKey, posValue);
       if (boxKeyRange.contains(posKey) && boxValueRange.contains(posValue)) // is in open-close-box
       {
         currentDistSqr = mParentPlot->selectionTolerance()*0.99 * mParentPlot->selectionTolerance()*0.99;
@@ -892,8 +1108,6 @@ double QCPFinancial::candlestickSelectTest(const QPointF &pos, const QCPFinancia
       // determine whether pos is in open-close-box:
       QCPRange boxKeyRange(it.value().key-mWidth*0.5, it.value().key+mWidth*0.5);
       QCPRange boxValueRange(it.value().close, it.value().open);
-      double posKey, posValue;
-      pixelsToCoords(pos, posKey, posValue);
       if (boxKeyRange.contains(posKey) && boxValueRange.contains(posValue)) // is in open-close-box
       {
         currentDistSqr = mParentPlot->selectionTolerance()*0.99 * mParentPlot->selectionTolerance()*0.99;
@@ -914,8 +1128,9 @@ double QCPFinancial::candlestickSelectTest(const QPointF &pos, const QCPFinancia
 
 /*!  \internal
   
-  called by the drawing methods to determine which data (key) range is visible at the current key
-  axis range setting, so only that needs to be processed.
+  called by the drawing methods to determine which data (key) range of \a data is visible at the
+  current key axis range setting, so only that needs to be processed. \a data is either the data of
+  this plottable or one of its binned levels (see \ref getBinnedData).
   
   \a lower returns an iterator to the lowest data point that needs to be taken into account when
   plotting. Note that in order to get a clean plot all the way to the edge of the axis rect, \a
@@ -928,22 +1143,253 @@ double QCPFinancial::candlestickSelectTest(const QPointF &pos, const QCPFinancia
   
   \see QCPGraph::getVisibleDataBounds
 */
-void QCPFinancial::getVisibleDataBounds(QCPFinancialDataMap::const_iterator &lower, QCPFinancialDataMap::const_iterator &upper) const
+void QCPFinancial::getVisibleDataBounds(const QCPFinancialDataMap *data, QCPFinancialDataMap::const_iterator &lower, QCPFinancialDataMap::const_iterator &upper) const
 {
   if (!mKeyAxis) { qDebug() << Q_FUNC_INFO << "invalid key axis"; return; }
-  if (mData->isEmpty())
+  if (data->isEmpty())
   {
-    lower = mData->constEnd();
-    upper = mData->constEnd();
+    lower = data->constEnd();
+    upper = data->constEnd();
     return;
   }
   
   // get visible data range as QMap iterators
-  QCPFinancialDataMap::const_iterator lbound = mData->lowerBound(mKeyAxis.data()->range().lower);
-  QCPFinancialDataMap::const_iterator ubound = mData->upperBound(mKeyAxis.data()->range().upper);
-  bool lowoutlier = lbound != mData->constBegin(); // indicates whether there exist points below axis range
-  bool highoutlier = ubound != mData->constEnd(); // indicates whether there exist points above axis range
+  QCPFinancialDataMap::const_iterator lbound = data->lowerBound(mKeyAxis.data()->range().lower);
+  QCPFinancialDataMap::const_iterator ubound = data->upperBound(mKeyAxis.data()->range().upper);
+  bool lowoutlier = lbound != data->constBegin(); // indicates whether there exist points below axis range
+  bool highoutlier = ubound != data->constEnd(); // indicates whether there exist points above axis range
   
   lower = (lowoutlier ? lbound-1 : lbound); // data point range that will be actually drawn
   upper = (highoutlier ? ubound : ubound-1); // data point range that will be actually drawn
 }
+
+/*! \internal
+  
+  Called by \ref selectTest to determine which data points may be within the selection tolerance
+  of \a pos, so only those need to be tested. These are the data points whose bars/candlesticks
+  extend to less than the selection tolerance away from \a pos in key direction. They are found
+  with a binary search in the data, so the cost of a selection test doesn't grow with the number
+  of visible data points.
+  
+  \a begin and \a end return the range of data points to test. If no data point is that close,
+  the range contains the data points directly below and above the key of \a pos, so the selection
+  test still returns a meaningful distance. If the plottable contains no data, both point to
+  constEnd.
+*/
+void QCPFinancial::getSelectTestBounds(const QPointF &pos, QCPFinancialDataMap::const_iterator &begin, QCPFinancialDataMap::const_iterator &end) const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  if (!keyAxis || mData->isEmpty())
+  {
+    begin = mData->constEnd();
+    end = mData->constEnd();
+    return;
+  }
+  
+  double posKeyPixel = keyAxis->orientation() == Qt::Horizontal ? pos.x() : pos.y();
+  double tolerance = mParentPlot->selectionTolerance();
+  double key1 = keyAxis->pixelToCoord(posKeyPixel-tolerance);
+  double key2 = keyAxis->pixelToCoord(posKeyPixel+tolerance);
+  begin = mData->lowerBound(qMin(key1, key2)-mWidth*0.5);
+  end = mData->upperBound(qMax(key1, key2)+mWidth*0.5);
+  if (begin == end) // no data point close enough, use neighbours
+  {
+    if (begin != mData->constBegin())
+      --begin;
+    if (end != mData->constEnd())
+      ++end;
+  }
+}
+
+/*! \internal
+  
+  Returns the color group of the data point \a data, i.e. 1 if it is drawn with the negative pen
+  and brush (see \ref setTwoColored), or 0 if it is drawn with the positive ones, the normal ones,
+  or the selected ones. The drawing methods collect the geometry per color group, see \ref
+  getColorGroupPen and \ref getColorGroupBrush.
+*/
+int QCPFinancial::getColorGroup(const QCPFinancialData &data) const
+{
+  return mTwoColored && !mSelected && data.close < data.open ? 1 : 0;
+}
+
+/*! \internal
+  
+  Returns the pen with which the data points of the color \a group are drawn.
+  
+  \see getColorGroup
+*/
+QPen QCPFinancial::getColorGroupPen(int group) const
+{
+  if (mSelected)
+    return mSelectedPen;
+  else if (mTwoColored)
+    return group == 1 ? mPenNegative : mPenPositive;
+  else
+    return mPen;
+}
+
+/*! \internal
+  
+  Returns the brush with which the data points of the color \a group are drawn.
+  
+  \see getColorGroup
+*/
+QBrush QCPFinancial::getColorGroupBrush(int group) const
+{
+  if (mSelected)
+    return mSelectedBrush;
+  else if (mTwoColored)
+    return group == 1 ? mBrushNegative : mBrushPositive;
+  else
+    return mBrush;
+}
+
+/*! \internal
+  
+  Returns the data that shall be drawn at the current key axis range when adaptive binning is
+  enabled (\ref setAdaptiveBinning). This is the finest level of detail whose bars/candlesticks are
+  at least three pixels apart, or the data of this plottable itself, if its bars/candlesticks are
+  far enough apart already. The spacing is the bin interval of the level, independent of the width
+  of the bars/candlesticks (\ref setWidth). \a samplingScale is the number of output device dots
+  per pixel.
+  
+  \a width returns the width of the bars/candlesticks of the returned data in key coordinates. It
+  is scaled with the bin interval of the level, so the gaps between bars/candlesticks keep their
+  proportions.
+  
+  Each level of detail is calculated from the previous one with \ref binOhlcData when it is first
+  needed, and kept until the data changes.
+*/
+const QCPFinancialDataMap *QCPFinancial::getBinnedData(double samplingScale, double &width)
+{
+  width = mWidth;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  if (!keyAxis || mData->size() < 2)
+    return mData;
+  
+  // determine the smallest key interval in the data, the bins of the first level are twice as large:
+  if (mBinInterval <= 0)
+  {
+    mBinnedLevels.clear();
+    QCPFinancialDataMap::const_iterator it = mData->constBegin();
+    double previousKey = it.key();
+    for (++it; it != mData->constEnd(); ++it)
+    {
+      double interval = it.key()-previousKey;
+      if (interval > 0 && (interval < mBinInterval || mBinInterval <= 0))
+        mBinInterval = interval;
+      previousKey = it.key();
+    }
+    if (mBinInterval <= 0) // all data points have the same key
+      return mData;
+    mBinInterval = qMax(mBinInterval, ((mData->constEnd()-1).key()-mData->constBegin().key())*1e-9); // keeps bin indices in int range
+    mBinOrigin = mData->constBegin().key()-mBinInterval*0.5;
+  }
+  
+  // find the level whose bars/candlesticks are at least three pixels apart, the spacing of a level is its bin interval:
+  const double minimumPixelSpacing = 3.0;
+  const double centerKey = keyAxis->range().center();
+  const double pixelSpacing = qAbs(keyAxis->coordToPixel(centerKey+mBinInterval)-keyAxis->coordToPixel(centerKey))*samplingScale;
+  if (pixelSpacing >= minimumPixelSpacing)
+    return mData;
+  int level = 0;
+  double factor = 1;
+  while (pixelSpacing*factor < minimumPixelSpacing)
+  {
+    // calculate the level if it doesn't exist yet, unless the previous level already holds only one bin:
+    if (level >= mBinnedLevels.size())
+    {
+      const QCPFinancialDataMap &previous = level > 0 ? mBinnedLevels.at(level-1) : *mData;
+      if (previous.size() < 2)
+        break;
+      mBinnedLevels.append(QCPFinancialDataMap());
+      binOhlcData(previous, &mBinnedLevels.last(), mBinInterval*factor*2, mBinOrigin);
+    }
+    factor *= 2;
+    ++level;
+  }
+  if (level == 0)
+    return mData;
+  width = mWidth*factor;
+  return &mBinnedLevels.at(level-1);
+}
+
+/*! \internal
+  
+  Updates the levels of adaptive binning after the newest data point of this plottable was
+  extended or added by \ref addTick. \a newest is that data point.
+  
+  Because the data point only ever grows (its high and low are extended and its close is replaced),
+  only the newest bin of each level needs to be merged with it, or a new bin is appended to the
+  level if \a newest is the first data point in it. Levels that weren't calculated yet are left
+  alone.
+*/
+void QCPFinancial::updateBinnedLevels(const QCPFinancialData &newest)
+{
+  if (mBinInterval <= 0) // levels not calculated yet
+    return;
+  double binSize = mBinInterval;
+  for (int i=0; i<mBinnedLevels.size(); ++i)
+  {
+    binSize *= 2;
+    QCPFinancialDataMap &level = mBinnedLevels[i];
+    int index = qFloor((newest.key-mBinOrigin)/binSize);
+    if (!level.isEmpty())
+    {
+      QCPFinancialDataMap::iterator levelNewest = level.end()-1;
+      if (qFloor((levelNewest.key()-mBinOrigin)/binSize) == index) // newest data point falls into newest bin of level, merge:
+      {
+        QCPFinancialData &bin = levelNewest.value();
+        if (newest.low < bin.low) bin.low = newest.low;
+        if (newest.high > bin.high) bin.high = newest.high;
+        bin.close = newest.close;
+        continue;
+      }
+    }
+    QCPFinancialData bin = newest;
+    bin.key = mBinOrigin+(index+0.5)*binSize;
+    level.insert(bin.key, bin);
+  }
+}
+
+/*! \internal
+  
+  Combines the data points in \a source to bins of size \a binSize and writes the resulting data
+  points to \a target. The bins start at \a binOrigin, and the key of each resulting data point is
+  the center of its bin.
+  
+  Like \ref timeSeriesToOhlc, the combined data point has the open value of the first, the highest
+  high and the lowest low value of all, and the close value of the last data point in the bin.
+  Since the bin borders are multiples of \a binSize apart from \a binOrigin, binning the result
+  again with twice the bin size yields the same bins as binning \a source with that size.
+*/
+void QCPFinancial::binOhlcData(const QCPFinancialDataMap &source, QCPFinancialDataMap *target, double binSize, double binOrigin)
+{
+  target->clear();
+  if (source.isEmpty())
+    return;
+  
+  QCPFinancialDataMap::const_iterator it = source.constBegin();
+  QCPFinancialData currentBinData = it.value();
+  int currentBinIndex = qFloor((it.key()-binOrigin)/binSize);
+  for (++it; it != source.constEnd(); ++it)
+  {
+    int index = qFloor((it.key()-binOrigin)/binSize);
+    if (index == currentBinIndex) // data point still in current bin, extend high/low and set close:
+    {
+      if (it.value().low < currentBinData.low) currentBinData.low = it.value().low;
+      if (it.value().high > currentBinData.high) currentBinData.high = it.value().high;
+      currentBinData.close = it.value().close;
+    } else // data point not anymore in current bin, add finished bin to map and start next bin with this data point:
+    {
+      currentBinData.key = binOrigin+(currentBinIndex+0.5)*binSize;
+      target->insert(currentBinData.key, currentBinData);
+      currentBinIndex = index;
+      currentBinData = it.value();
+    }
+  }
+  // finalize last bin:
+  currentBinData.key = binOrigin+(currentBinIndex+0.5)*binSize;
+  target->insert(currentBinData.key, currentBinData);
+}
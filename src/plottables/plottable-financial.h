@@ -66,6 +66,9 @@ class QCP_LIB_DECL QCPFinancial : public QCPAbstractPlottable
   Q_PROPERTY(QBrush brushNegative READ brushNegative WRITE setBrushNegative)
   Q_PROPERTY(QPen penPositive READ penPositive WRITE setPenPositive)
   Q_PROPERTY(QPen penNegative READ penNegative WRITE setPenNegative)
+  Q_PROPERTY(bool adaptiveBinning READ adaptiveBinning WRITE setAdaptiveBinning)
+  Q_PROPERTY(double tickBinSize READ tickBinSize WRITE setTickBinSize)
+  Q_PROPERTY(double tickBinOffset READ tickBinOffset WRITE setTickBinOffset)
   /// \endcond
 public:
   /*!
@@ -90,7 +93,9 @@ public:
   QBrush brushNegative() const { return mBrushNegative; }
   QPen penPositive() const { return mPenPositive; }
   QPen penNegative() const { return mPenNegative; }
-  
+  bool adaptiveBinning() const { return mAdaptiveBinning; }
+  double tickBinSize() const { return mTickBinSize; }
+  double tickBinOffset() const { return mTickBinOffset; }
   
   // setters:
   void setData(QCPFinancialDataMap *data, bool copy=false);
@@ -102,6 +107,9 @@ public:
   void setBrushNegative(const QBrush &brush);
   void setPenPositive(const QPen &pen);
   void setPenNegative(const QPen &pen);
+  void setAdaptiveBinning(bool enabled);
+  void setTickBinSize(double size);
+  void setTickBinOffset(double offset);
   
   // non-property methods:
   void addData(const QCPFinancialDataMap &dataMap);
@@ -112,6 +120,9 @@ public:
   void removeDataAfter(double key);
   void removeData(double fromKey, double toKey);
   void removeData(double key);
+  void addTick(double time, double value);
+  void addTicks(const QVector<double> &time, const QVector<double> &value);
+  void invalidateBinnedLevels();
   
   // reimplemented virtual methods:
   virtual void clearData();
@@ -128,6 +139,13 @@ protected:
   bool mTwoColored;
   QBrush mBrushPositive, mBrushNegative;
   QPen mPenPositive, mPenNegative;
+  bool mAdaptiveBinning;
+  double mTickBinSize, mTickBinOffset;
+  
+  // non-property members:
+  QList<QCPFinancialDataMap> mBinnedLevels; // level i holds the data binned to intervals of mBinInterval*2^(i+1)
+  double mBinInterval, mBinOrigin;
+  QMap<double, QCPRange> mTickTimes; // first (lower) and last (upper) tick time of the bins aggregated by addTick
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter);
@@ -136,11 +154,18 @@ protected:
   virtual QCPRange getValueRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const;
   
   // non-virtual methods:
-  void drawOhlcPlot(QCPPainter *painter, const QCPFinancialDataMap::const_iterator &begin, const QCPFinancialDataMap::const_iterator &end);
-  void drawCandlestickPlot(QCPPainter *painter, const QCPFinancialDataMap::const_iterator &begin, const QCPFinancialDataMap::const_iterator &end);
+  void drawOhlcPlot(QCPPainter *painter, const QCPFinancialDataMap::const_iterator &begin, const QCPFinancialDataMap::const_iterator &end, double width);
+  void drawCandlestickPlot(QCPPainter *painter, const QCPFinancialDataMap::const_iterator &begin, const QCPFinancialDataMap::const_iterator &end, double width);
   double ohlcSelectTest(const QPointF &pos, const QCPFinancialDataMap::const_iterator &begin, const QCPFinancialDataMap::const_iterator &end) const;
   double candlestickSelectTest(const QPointF &pos, const QCPFinancialDataMap::const_iterator &begin, const QCPFinancialDataMap::const_iterator &end) const;
-  void getVisibleDataBounds(QCPFinancialDataMap::const_iterator &lower, QCPFinancialDataMap::const_iterator &upper) const;
+  void getVisibleDataBounds(const QCPFinancialDataMap *data, QCPFinancialDataMap::const_iterator &lower, QCPFinancialDataMap::const_iterator &upper) const;
+  void getSelectTestBounds(const QPointF &pos, QCPFinancialDataMap::const_iterator &begin, QCPFinancialDataMap::const_iterator &end) const;
+  int getColorGroup(const QCPFinancialData &data) const;
+  QPen getColorGroupPen(int group) const;
+  QBrush getColorGroupBrush(int group) const;
+  const QCPFinancialDataMap *getBinnedData(double samplingScale, double &width);
+  void updateBinnedLevels(const QCPFinancialData &newest);
+  static void binOhlcData(const QCPFinancialDataMap &source, QCPFinancialDataMap *target, double binSize, double binOrigin);
   
   friend class QCustomPlot;
   friend class QCPLegend;
@@ -77,6 +77,632 @@ QCPData::QCPData(double key, double value) :
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPCompactData
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPCompactData
+  \brief Holds the data of a QCPGraph in compact, column-wise storage.
+  
+  By default, QCPGraph stores its data in a \ref QCPDataMap. Each data point then occupies a full
+  \ref QCPData instance (key, value and four error values) plus the node overhead of the QMap,
+  even if the graph doesn't show any error bars. For very large data sets, this memory footprint
+  and the scattered node allocations become the limiting factor.
+  
+  QCPCompactData instead stores the keys and values in separate, contiguous arrays that are sorted
+  by key. The four error columns are only allocated once the first error of the respective
+  dimension (key or value) is set. Optionally, the values may be stored with single precision (see
+  \ref setValuePrecision), reducing the footprint of a data point without errors to 12 bytes.
+  
+  To make a graph use this storage, call \ref QCPGraph::setDataLayout with \ref
+  QCPGraph::dlCompact or \ref QCPGraph::dlCompactFloat. The regular data interface of QCPGraph
+  (\ref QCPGraph::setData, \ref QCPGraph::addData, \ref QCPGraph::removeData, etc.) then operates
+  on the QCPCompactData instance, which is accessible via \ref QCPGraph::compactData.
+  
+  Like a QCPDataMap, the container offers \ref constBegin, \ref constEnd, \ref lowerBound and \ref
+  upperBound, returning iterators with \a key() and \a value() methods. Note that \a value()
+  returns a \ref QCPData by value, assembled from the columns.
+  
+  Large data sets can be passed without copying: \ref adopt takes over the buffers of the passed
+  vectors, and \ref setExternal makes the container reference arrays owned by the caller.
+*/
+
+/*!
+  Constructs an empty data container which stores its values with the specified \a precision.
+*/
+QCPCompactData::QCPCompactData(ValuePrecision precision) :
+  mValuePrecision(precision),
+  mHasKeyErrors(false),
+  mHasValueErrors(false),
+  mExternalKeys(0),
+  mExternalValues(0),
+  mExternalSize(0)
+{
+}
+
+/*!
+  Returns the data point at \a index as a \ref QCPData. Errors are zero if the respective error
+  columns haven't been allocated.
+*/
+QCPData QCPCompactData::at(int index) const
+{
+  QCPData result(key(index), value(index));
+  if (mHasKeyErrors)
+  {
+    result.keyErrorMinus = mKeyErrorMinus.at(index);
+    result.keyErrorPlus = mKeyErrorPlus.at(index);
+  }
+  if (mHasValueErrors)
+  {
+    result.valueErrorMinus = mValueErrorMinus.at(index);
+    result.valueErrorPlus = mValueErrorPlus.at(index);
+  }
+  return result;
+}
+
+/*!
+  Returns the number of bytes allocated by the columns of this container. Externally referenced
+  arrays (see \ref setExternal) are not included.
+*/
+qint64 QCPCompactData::memoryUsage() const
+{
+  qint64 result = qint64(mKeys.capacity())*sizeof(double);
+  result += qint64(mValues.capacity())*sizeof(double);
+  result += qint64(mFloatValues.capacity())*sizeof(float);
+  result += qint64(mKeyErrorMinus.capacity()+mKeyErrorPlus.capacity())*sizeof(double);
+  result += qint64(mValueErrorMinus.capacity()+mValueErrorPlus.capacity())*sizeof(double);
+  return result;
+}
+
+/*!
+  Sets the floating point precision with which values are stored. Existing values are converted.
+  Note that converting from \ref vpDouble to \ref vpFloat loses precision.
+  
+  Keys and errors are always stored with double precision. While the container references external
+  arrays (see \ref setExternal), the precision only takes effect once the data is copied into the
+  container.
+*/
+void QCPCompactData::setValuePrecision(ValuePrecision precision)
+{
+  if (mValuePrecision == precision)
+    return;
+  if (mExternalKeys)
+  {
+    mValuePrecision = precision;
+    return;
+  }
+  if (precision == vpFloat)
+  {
+    mFloatValues.resize(mValues.size());
+    for (int i=0; i<mValues.size(); ++i)
+      mFloatValues[i] = float(mValues.at(i));
+    mValues = QVector<double>();
+  } else
+  {
+    mValues.resize(mFloatValues.size());
+    for (int i=0; i<mFloatValues.size(); ++i)
+      mValues[i] = mFloatValues.at(i);
+    mFloatValues = QVector<float>();
+  }
+  mValuePrecision = precision;
+}
+
+/*!
+  Returns an iterator to the first data point with a key greater or equal to \a key, or \ref
+  constEnd if there is none.
+*/
+QCPCompactData::const_iterator QCPCompactData::lowerBound(double key) const
+{
+  return const_iterator(this, lowerBoundIndex(key));
+}
+
+/*!
+  Returns an iterator to the first data point with a key greater than \a key, or \ref constEnd if
+  there is none.
+*/
+QCPCompactData::const_iterator QCPCompactData::upperBound(double key) const
+{
+  return const_iterator(this, upperBoundIndex(key));
+}
+
+/*!
+  Returns the index of the first data point with a key greater or equal to \a key, or \ref size if
+  there is none.
+*/
+int QCPCompactData::lowerBoundIndex(double key) const
+{
+  const double *begin = mExternalKeys ? mExternalKeys : mKeys.constData();
+  return int(std::lower_bound(begin, begin+size(), key)-begin);
+}
+
+/*!
+  Returns the index of the first data point with a key greater than \a key, or \ref size if there
+  is none.
+*/
+int QCPCompactData::upperBoundIndex(double key) const
+{
+  const double *begin = mExternalKeys ? mExternalKeys : mKeys.constData();
+  return int(std::upper_bound(begin, begin+size(), key)-begin);
+}
+
+/*!
+  Replaces the current data with the provided points in \a keys and \a values pairs. The provided
+  vectors should have equal length. Else, the number of points will be the size of the smallest
+  vector. Any error columns are released.
+  
+  The points don't need to be sorted by key. If they are, and the vectors have equal length, the
+  key (and for \ref vpDouble, the value) vector is implicitly shared instead of copied.
+*/
+void QCPCompactData::set(const QVector<double> &keys, const QVector<double> &values)
+{
+  set(keys, values, QVector<double>(), QVector<double>(), QVector<double>(), QVector<double>());
+}
+
+/*! \overload
+  
+  Replaces the current data with the provided points in \a keys and \a values pairs, and the
+  respective errors. Empty error vectors indicate that the data has no errors of that kind, in
+  which case the respective error columns aren't allocated. The minus and plus errors of one
+  dimension must either be both empty or both non-empty.
+  
+  The number of points will be the size of the smallest non-empty vector.
+*/
+void QCPCompactData::set(const QVector<double> &keys, const QVector<double> &values, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus, const QVector<double> &valueErrorMinus, const QVector<double> &valueErrorPlus)
+{
+  int n = qMin(keys.size(), values.size());
+  bool withKeyErrors = !keyErrorMinus.isEmpty() && !keyErrorPlus.isEmpty();
+  bool withValueErrors = !valueErrorMinus.isEmpty() && !valueErrorPlus.isEmpty();
+  if (withKeyErrors)
+    n = qMin(n, qMin(keyErrorMinus.size(), keyErrorPlus.size()));
+  if (withValueErrors)
+    n = qMin(n, qMin(valueErrorMinus.size(), valueErrorPlus.size()));
+  
+  clear();
+  mKeys = keys.size() == n ? keys : keys.mid(0, n);
+  appendValues(values, n);
+  if (withKeyErrors)
+  {
+    mKeyErrorMinus = keyErrorMinus.size() == n ? keyErrorMinus : keyErrorMinus.mid(0, n);
+    mKeyErrorPlus = keyErrorPlus.size() == n ? keyErrorPlus : keyErrorPlus.mid(0, n);
+    mHasKeyErrors = true;
+  }
+  if (withValueErrors)
+  {
+    mHasValueErrors = true;
+    mValueErrorMinus = valueErrorMinus.size() == n ? valueErrorMinus : valueErrorMinus.mid(0, n);
+    mValueErrorPlus = valueErrorPlus.size() == n ? valueErrorPlus : valueErrorPlus.mid(0, n);
+  }
+  if (!isSortedFrom(0))
+    sortByKey();
+}
+
+/*! \overload
+  
+  Replaces the current data with the data points in \a dataMap. Error columns are only allocated if
+  the map contains non-zero errors of the respective dimension.
+*/
+void QCPCompactData::set(const QCPDataMap &dataMap)
+{
+  clear();
+  add(dataMap);
+}
+
+/*!
+  Replaces the current data with the points in \a keys and \a values by taking over their buffers,
+  so no data is copied. After this call, both passed vectors are empty. If the vectors have
+  different lengths, the longer one is truncated.
+  
+  For \ref vpFloat, the values need to be converted and are thus copied, while the keys are still
+  taken over. If the keys aren't sorted, the points are sorted by key, which requires a copy, too.
+*/
+void QCPCompactData::adopt(QVector<double> &keys, QVector<double> &values)
+{
+  clear();
+  int n = qMin(keys.size(), values.size());
+  if (keys.size() != n)
+    keys.resize(n);
+  qSwap(mKeys, keys);
+  if (mValuePrecision == vpFloat)
+  {
+    appendValues(values, n);
+  } else
+  {
+    if (values.size() != n)
+      values.resize(n);
+    qSwap(mValues, values);
+  }
+  keys.clear();
+  values.clear();
+  if (!isSortedFrom(0))
+    sortByKey();
+}
+
+/*!
+  Makes this container reference the \a count data points in the external arrays \a keys and \a
+  values, replacing the current data. No data is copied, and the container doesn't take ownership
+  of the arrays.
+  
+  The caller must make sure the arrays stay valid and unchanged for as long as they are
+  referenced, i.e. until the data is replaced (e.g. with \ref set or another call to this
+  function), \ref clear is called, or this container is destroyed. Any modification of the data
+  (e.g. via \ref add or \ref remove) first copies the referenced points into the container, after
+  which the external arrays are no longer referenced.
+  
+  The keys must be sorted in ascending order. If they aren't, the points are copied into the
+  container and sorted there.
+*/
+void QCPCompactData::setExternal(const double *keys, const double *values, int count)
+{
+  clear();
+  if (!keys || !values || count <= 0)
+    return;
+  mExternalKeys = keys;
+  mExternalValues = values;
+  mExternalSize = count;
+  if (!isSortedFrom(0))
+  {
+    detach();
+    sortByKey();
+  }
+}
+
+/*!
+  Adds the provided single data point in \a data. If its key is greater or equal to the key of the
+  last data point, it is appended in constant (amortized) time. Otherwise, it is inserted at the
+  appropriate position, which requires moving all following data points.
+*/
+void QCPCompactData::add(const QCPData &data)
+{
+  detach();
+  if (mKeys.isEmpty() || data.key >= mKeys.last())
+    insertPoint(mKeys.size(), data);
+  else
+    insertPoint(upperBoundIndex(data.key), data);
+}
+
+/*! \overload
+  
+  Adds the provided single data point as \a key and \a value pair.
+*/
+void QCPCompactData::add(double key, double value)
+{
+  add(QCPData(key, value));
+}
+
+/*! \overload
+  
+  Adds the provided data points as \a keys and \a values pairs. If the new points are sorted and
+  don't start before the current last key, they are appended without resorting.
+*/
+void QCPCompactData::add(const QVector<double> &keys, const QVector<double> &values)
+{
+  detach();
+  int n = qMin(keys.size(), values.size());
+  if (n == 0)
+    return;
+  int oldSize = mKeys.size();
+  mKeys.reserve(oldSize+n);
+  for (int i=0; i<n; ++i)
+    mKeys.append(keys.at(i));
+  appendValues(values, n);
+  if (mHasKeyErrors)
+  {
+    mKeyErrorMinus.resize(oldSize+n);
+    mKeyErrorPlus.resize(oldSize+n);
+    for (int i=oldSize; i<oldSize+n; ++i)
+      mKeyErrorMinus[i] = mKeyErrorPlus[i] = 0;
+  }
+  if (mHasValueErrors)
+  {
+    mValueErrorMinus.resize(oldSize+n);
+    mValueErrorPlus.resize(oldSize+n);
+    for (int i=oldSize; i<oldSize+n; ++i)
+      mValueErrorMinus[i] = mValueErrorPlus[i] = 0;
+  }
+  if (!isSortedFrom(qMax(0, oldSize-1)))
+    sortByKey();
+}
+
+/*! \overload
+  
+  Adds the data points in \a dataMap.
+*/
+void QCPCompactData::add(const QCPDataMap &dataMap)
+{
+  detach();
+  mKeys.reserve(mKeys.size()+dataMap.size());
+  QCPDataMap::const_iterator it;
+  for (it = dataMap.constBegin(); it != dataMap.constEnd(); ++it)
+    add(it.value());
+}
+
+/*!
+  Removes all data points with keys smaller than \a key.
+*/
+void QCPCompactData::removeBefore(double key)
+{
+  removeRange(0, lowerBoundIndex(key));
+}
+
+/*!
+  Removes all data points with keys greater than \a key.
+*/
+void QCPCompactData::removeAfter(double key)
+{
+  removeRange(upperBoundIndex(key), size());
+}
+
+/*!
+  Removes all data points with keys between \a fromKey and \a toKey. If \a fromKey is greater or
+  equal to \a toKey, the function does nothing.
+*/
+void QCPCompactData::remove(double fromKey, double toKey)
+{
+  if (fromKey >= toKey)
+    return;
+  removeRange(upperBoundIndex(fromKey), upperBoundIndex(toKey));
+}
+
+/*! \overload
+  
+  Removes all data points with key \a key.
+*/
+void QCPCompactData::remove(double key)
+{
+  removeRange(lowerBoundIndex(key), upperBoundIndex(key));
+}
+
+/*!
+  Removes all data points and releases the error columns. If the container referenced external
+  arrays (see \ref setExternal), they are no longer referenced. The value precision is kept.
+*/
+void QCPCompactData::clear()
+{
+  mExternalKeys = 0;
+  mExternalValues = 0;
+  mExternalSize = 0;
+  mKeys.clear();
+  mValues.clear();
+  mFloatValues.clear();
+  mKeyErrorMinus.clear();
+  mKeyErrorPlus.clear();
+  mValueErrorMinus.clear();
+  mValueErrorPlus.clear();
+  mHasKeyErrors = false;
+  mHasValueErrors = false;
+}
+
+/*!
+  Releases memory that was reserved by the columns but isn't used by data points.
+*/
+void QCPCompactData::squeeze()
+{
+  mKeys.squeeze();
+  mValues.squeeze();
+  mFloatValues.squeeze();
+  mKeyErrorMinus.squeeze();
+  mKeyErrorPlus.squeeze();
+  mValueErrorMinus.squeeze();
+  mValueErrorPlus.squeeze();
+}
+
+/*!
+  Replaces the contents of \a dataMap with the data points of this container.
+*/
+void QCPCompactData::toDataMap(QCPDataMap *dataMap) const
+{
+  dataMap->clear();
+  for (int i=size()-1; i>=0; --i) // insert in reverse order, so the original order of points with identical keys is kept by insertMulti
+    dataMap->insertMulti(key(i), at(i));
+}
+
+/*! \internal
+  
+  If this container references external arrays (see \ref setExternal), copies the referenced data
+  points into the own columns and stops referencing the arrays. Otherwise does nothing.
+  
+  This must be called before any modification of the data.
+*/
+void QCPCompactData::detach()
+{
+  if (!mExternalKeys)
+    return;
+  const double *keys = mExternalKeys;
+  const double *values = mExternalValues;
+  int count = mExternalSize;
+  mExternalKeys = 0;
+  mExternalValues = 0;
+  mExternalSize = 0;
+  mKeys.resize(count);
+  qCopy(keys, keys+count, mKeys.begin());
+  if (mValuePrecision == vpFloat)
+  {
+    mFloatValues.resize(count);
+    for (int i=0; i<count; ++i)
+      mFloatValues[i] = float(values[i]);
+  } else
+  {
+    mValues.resize(count);
+    qCopy(values, values+count, mValues.begin());
+  }
+}
+
+/*! \internal
+  
+  Inserts the data point \a data at \a index, which must be a position that keeps the keys sorted.
+  Error columns are allocated if \a data carries a non-zero error of the respective dimension.
+*/
+void QCPCompactData::insertPoint(int index, const QCPData &data)
+{
+  if (data.keyErrorMinus != 0 || data.keyErrorPlus != 0)
+    ensureKeyErrors();
+  if (data.valueErrorMinus != 0 || data.valueErrorPlus != 0)
+    ensureValueErrors();
+  mKeys.insert(index, data.key);
+  if (mValuePrecision == vpFloat)
+    mFloatValues.insert(index, float(data.value));
+  else
+    mValues.insert(index, data.value);
+  if (mHasKeyErrors)
+  {
+    mKeyErrorMinus.insert(index, data.keyErrorMinus);
+    mKeyErrorPlus.insert(index, data.keyErrorPlus);
+  }
+  if (mHasValueErrors)
+  {
+    mValueErrorMinus.insert(index, data.valueErrorMinus);
+    mValueErrorPlus.insert(index, data.valueErrorPlus);
+  }
+}
+
+/*! \internal
+  
+  Appends the first \a count elements of \a values to the value column, converting them if the
+  value precision is \ref vpFloat. If the value column is empty and \a values has exactly \a count
+  elements, the vector is implicitly shared instead of copied.
+*/
+void QCPCompactData::appendValues(const QVector<double> &values, int count)
+{
+  if (mValuePrecision == vpFloat)
+  {
+    int oldSize = mFloatValues.size();
+    mFloatValues.resize(oldSize+count);
+    for (int i=0; i<count; ++i)
+      mFloatValues[oldSize+i] = float(values.at(i));
+  } else if (mValues.isEmpty() && values.size() == count)
+  {
+    mValues = values;
+  } else
+  {
+    mValues.reserve(mValues.size()+count);
+    for (int i=0; i<count; ++i)
+      mValues.append(values.at(i));
+  }
+}
+
+/*! \internal
+  
+  Removes the data points with indices from \a fromIndex (inclusive) to \a toIndex (exclusive) from
+  all columns.
+*/
+void QCPCompactData::removeRange(int fromIndex, int toIndex)
+{
+  detach();
+  int count = toIndex-fromIndex;
+  if (count <= 0)
+    return;
+  mKeys.remove(fromIndex, count);
+  if (mValuePrecision == vpFloat)
+    mFloatValues.remove(fromIndex, count);
+  else
+    mValues.remove(fromIndex, count);
+  if (mHasKeyErrors)
+  {
+    mKeyErrorMinus.remove(fromIndex, count);
+    mKeyErrorPlus.remove(fromIndex, count);
+  }
+  if (mHasValueErrors)
+  {
+    mValueErrorMinus.remove(fromIndex, count);
+    mValueErrorPlus.remove(fromIndex, count);
+  }
+}
+
+/*! \internal
+  
+  Allocates the key error columns (initialized with zeros), if they aren't allocated yet.
+*/
+void QCPCompactData::ensureKeyErrors()
+{
+  if (!mHasKeyErrors)
+  {
+    mKeyErrorMinus.fill(0, mKeys.size());
+    mKeyErrorPlus.fill(0, mKeys.size());
+    mHasKeyErrors = true;
+  }
+}
+
+/*! \internal
+  
+  Allocates the value error columns (initialized with zeros), if they aren't allocated yet.
+*/
+void QCPCompactData::ensureValueErrors()
+{
+  if (!mHasValueErrors)
+  {
+    mValueErrorMinus.fill(0, mKeys.size());
+    mValueErrorPlus.fill(0, mKeys.size());
+    mHasValueErrors = true;
+  }
+}
+
+/*! \internal
+  
+  Returns whether the keys starting at \a index are sorted in ascending order.
+*/
+bool QCPCompactData::isSortedFrom(int index) const
+{
+  const int count = size();
+  for (int i=qMax(1, index+1); i<count; ++i)
+  {
+    if (key(i) < key(i-1))
+      return false;
+  }
+  return true;
+}
+
+// comparison functor that orders indices by the keys they refer to, used by QCPCompactData::sortByKey
+class QCPCompactDataIndexLess
+{
+public:
+  explicit QCPCompactDataIndexLess(const double *keys) : mKeys(keys) {}
+  bool operator()(int a, int b) const { return mKeys[a] < mKeys[b]; }
+private:
+  const double *mKeys;
+};
+
+/*! \internal
+  
+  Sorts all columns by key. Points with identical keys keep their relative order.
+*/
+void QCPCompactData::sortByKey()
+{
+  const int size = mKeys.size();
+  QVector<int> order(size);
+  for (int i=0; i<size; ++i)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(), QCPCompactDataIndexLess(mKeys.constData()));
+  
+  QVector<double> sortedDoubles(size);
+  for (int i=0; i<size; ++i)
+    sortedDoubles[i] = mKeys.at(order.at(i));
+  qSwap(mKeys, sortedDoubles);
+  if (mValuePrecision == vpFloat)
+  {
+    QVector<float> sortedFloats(size);
+    for (int i=0; i<size; ++i)
+      sortedFloats[i] = mFloatValues.at(order.at(i));
+    qSwap(mFloatValues, sortedFloats);
+  } else
+  {
+    for (int i=0; i<size; ++i)
+      sortedDoubles[i] = mValues.at(order.at(i));
+    qSwap(mValues, sortedDoubles);
+  }
+  QVector<double> *errorColumns[4] = {&mKeyErrorMinus, &mKeyErrorPlus, &mValueErrorMinus, &mValueErrorPlus};
+  bool errorColumnUsed[4] = {mHasKeyErrors, mHasKeyErrors, mHasValueErrors, mHasValueErrors};
+  for (int c=0; c<4; ++c)
+  {
+    if (!errorColumnUsed[c])
+      continue;
+    sortedDoubles.resize(size);
+    for (int i=0; i<size; ++i)
+      sortedDoubles[i] = errorColumns[c]->at(order.at(i));
+    qSwap(*errorColumns[c], sortedDoubles);
+  }
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPGraph
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -91,7 +717,8 @@ QCPData::QCPData(double key, double value) :
 
   To plot data, assign it with the \ref setData or \ref addData functions. Alternatively, you can
   also access and modify the graph's data via the \ref data method, which returns a pointer to the
-  internal \ref QCPDataMap.
+  internal \ref QCPDataMap. For very large data sets, the graph can alternatively store its data in
+  the more memory efficient \ref QCPCompactData container, see \ref setDataLayout.
   
   Graphs are used to display single-valued data. Single-valued means that there should only be one
   data point per unique key coordinate. In other words, the graph can't have \a loops. If you do
@@ -128,6 +755,16 @@ QCPData::QCPData(double key, double value) :
   setData or \ref addData methods, in certain situations.
 */
 
+/*! \fn QCPDataQueue<QCPData> *QCPGraph::dataQueue() const
+  
+  Returns the queue through which other threads can pass data points to this graph, or 0 if no
+  queue was created with \ref setDataQueueCapacity.
+  
+  Obtain the pointer in the GUI thread and hand it to the producer thread, which may then call
+  QCPDataQueue::push. The queued points are added to the graph's data at the beginning of the next
+  \ref QCustomPlot::replot.
+*/
+
 /* end of documentation of inline functions */
 
 /*!
@@ -145,6 +782,11 @@ QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   QCPAbstractPlottable(keyAxis, valueAxis)
 {
   mData = new QCPDataMap;
+  mCompactData = new QCPCompactData;
+  mDataQueue = 0;
+  mDataLayout = dlMap;
+  mPreparedVisibleCount = 0;
+  mPreparedCount = 0;
   
   setPen(QPen(Qt::blue, 0));
   setErrorPen(QPen(Qt::black));
@@ -163,6 +805,8 @@ QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
 QCPGraph::~QCPGraph()
 {
   delete mData;
+  delete mCompactData;
+  delete mDataQueue;
 }
 
 /*!
@@ -174,6 +818,10 @@ QCPGraph::~QCPGraph()
   
   Alternatively, you can also access and modify the graph's data via the \ref data method, which
   returns a pointer to the internal \ref QCPDataMap.
+  
+  If the graph uses a compact \ref setDataLayout "data layout", the points are transferred to the
+  \ref compactData container. In that case, if \a copy is false, \a data is deleted after the
+  transfer.
 */
 void QCPGraph::setData(QCPDataMap *data, bool copy)
 {
@@ -182,6 +830,13 @@ void QCPGraph::setData(QCPDataMap *data, bool copy)
     qDebug() << Q_FUNC_INFO << "The data pointer is already in (and owned by) this plottable" << reinterpret_cast<quintptr>(data);
     return;
   }
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->set(*data);
+    if (!copy)
+      delete data;
+    return;
+  }
   if (copy)
   {
     *mData = *data;
@@ -200,6 +855,11 @@ void QCPGraph::setData(QCPDataMap *data, bool copy)
 */
 void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
 {
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->set(key, value);
+    return;
+  }
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -212,6 +872,60 @@ void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
   }
 }
 
+/*!
+  Replaces the current data with the provided points in \a keys and \a values pairs, taking over the
+  buffers of the passed vectors instead of copying them. After this call, both vectors are empty.
+  
+  The data is only taken over without copying if the graph uses the compact \ref setDataLayout
+  "data layout" \ref dlCompact and the keys are sorted. Otherwise, the points are copied as with
+  \ref setData(const QVector<double> &key, const QVector<double> &value), and the vectors are
+  cleared afterwards nonetheless.
+  
+  \see setExternalData, QCPCompactData::adopt
+*/
+void QCPGraph::adoptData(QVector<double> &keys, QVector<double> &values)
+{
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->adopt(keys, values);
+  } else
+  {
+    setData(keys, values);
+    keys.clear();
+    values.clear();
+  }
+}
+
+/*!
+  Replaces the current data with the \a count points in the arrays \a keys and \a values, which
+  must be sorted by key.
+  
+  If the graph uses a compact \ref setDataLayout "data layout", the arrays are referenced instead
+  of copied. In that case, the caller must make sure the arrays stay valid and unchanged until the
+  graph's data is replaced or cleared, or the graph is deleted. If you modify the data via \ref
+  addData or \ref removeData, the graph first copies the referenced points, after which the arrays
+  are no longer referenced. See \ref QCPCompactData::setExternal for details.
+  
+  If the graph uses the \ref dlMap layout, the points are copied into the map.
+*/
+void QCPGraph::setExternalData(const double *keys, const double *values, int count)
+{
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->setExternal(keys, values, count);
+  } else
+  {
+    mData->clear();
+    QCPData newData;
+    for (int i=0; i<count; ++i)
+    {
+      newData.key = keys[i];
+      newData.value = values[i];
+      mData->insertMulti(newData.key, newData);
+    }
+  }
+}
+
 /*!
   Replaces the current data with the provided points in \a key and \a value pairs. Additionally the
   symmetrical value error of the data points are set to the values in \a valueError.
@@ -223,6 +937,11 @@ void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
 */
 void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueError)
 {
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->set(key, value, QVector<double>(), QVector<double>(), valueError, valueError);
+    return;
+  }
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -249,6 +968,11 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
 */
 void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueErrorMinus, const QVector<double> &valueErrorPlus)
 {
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->set(key, value, QVector<double>(), QVector<double>(), valueErrorMinus, valueErrorPlus);
+    return;
+  }
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -276,6 +1000,11 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
 */
 void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError)
 {
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->set(key, value, keyError, keyError, QVector<double>(), QVector<double>());
+    return;
+  }
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -302,6 +1031,11 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
 */
 void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus)
 {
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->set(key, value, keyErrorMinus, keyErrorPlus, QVector<double>(), QVector<double>());
+    return;
+  }
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -329,6 +1063,11 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
 */
 void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError, const QVector<double> &valueError)
 {
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->set(key, value, keyError, keyError, valueError, valueError);
+    return;
+  }
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -358,6 +1097,11 @@ void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double
 */
 void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus, const QVector<double> &valueErrorMinus, const QVector<double> &valueErrorPlus)
 {
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->set(key, value, keyErrorMinus, keyErrorPlus, valueErrorMinus, valueErrorPlus);
+    return;
+  }
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -512,6 +1256,67 @@ void QCPGraph::setAdaptiveSampling(bool enabled)
   mAdaptiveSampling = enabled;
 }
 
+/*!
+  Sets in which kind of container the graph stores its data points.
+  
+  The default layout \ref dlMap stores the data in a \ref QCPDataMap, which is accessible via \ref
+  data. Each data point then occupies a separate map node, holding the key, the value and four
+  error values, plus the map's own bookkeeping.
+  
+  The layouts \ref dlCompact and \ref dlCompactFloat store the data column-wise in the \ref
+  QCPCompactData container accessible via \ref compactData. Error columns are only allocated if
+  error data is actually passed (e.g. via \ref setDataValueError), and with \ref dlCompactFloat,
+  the values are stored with single precision. For large data sets without error bars, this
+  reduces the memory footprint to less than a fifth of the map layout, and iterating over the
+  data during replots becomes more cache friendly.
+  
+  The existing data points are converted to the new layout. Note that while a compact layout is
+  active, the map returned by \ref data stays empty and is not considered by the graph. All
+  other data functions (\ref setData, \ref addData, \ref removeData, \ref clearData, etc.) work
+  transparently with either layout.
+*/
+void QCPGraph::setDataLayout(DataLayout layout)
+{
+  if (mDataLayout == layout)
+    return;
+  
+  if (mDataLayout == dlMap)
+  {
+    mCompactData->set(*mData);
+    mData->clear();
+  } else if (layout == dlMap)
+  {
+    mCompactData->toDataMap(mData);
+    mCompactData->clear();
+    mCompactData->squeeze();
+  }
+  if (layout != dlMap)
+    mCompactData->setValuePrecision(layout == dlCompactFloat ? QCPCompactData::vpFloat : QCPCompactData::vpDouble);
+  mDataLayout = layout;
+}
+
+/*!
+  Creates a queue which allows another thread to pass data points to this graph without locking,
+  see \ref dataQueue and \ref QCPDataQueue. The queue holds at least \a capacity data points, so
+  it should be large enough for the number of points the producer generates between two replots.
+  
+  Setting \a capacity to 0 removes the queue. Points still in the old queue are applied to the
+  graph before it is replaced or removed.
+  
+  This function must be called from the GUI thread while no other thread is using the current queue.
+*/
+void QCPGraph::setDataQueueCapacity(int capacity)
+{
+  if (mDataQueue)
+  {
+    applyQueuedData();
+    delete mDataQueue;
+    mDataQueue = 0;
+  }
+  if (capacity > 0)
+    mDataQueue = new QCPDataQueue<QCPData>(capacity);
+}
+
 /*!
   Adds the provided data points in \a dataMap to the current data.
   
@@ -522,7 +1327,10 @@ void QCPGraph::setAdaptiveSampling(bool enabled)
 */
 void QCPGraph::addData(const QCPDataMap &dataMap)
 {
-  mData->unite(dataMap);
+  if (mDataLayout != dlMap)
+    mCompactData->add(dataMap);
+  else
+    mData->unite(dataMap);
 }
 
 /*! \overload
@@ -535,7 +1343,10 @@ void QCPGraph::addData(const QCPDataMap &dataMap)
 */
 void QCPGraph::addData(const QCPData &data)
 {
-  mData->insertMulti(data.key, data);
+  if (mDataLayout != dlMap)
+    mCompactData->add(data);
+  else
+    mData->insertMulti(data.key, data);
 }
 
 /*! \overload
@@ -548,6 +1359,11 @@ void QCPGraph::addData(const QCPData &data)
 */
 void QCPGraph::addData(double key, double value)
 {
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->add(key, value);
+    return;
+  }
   QCPData newData;
   newData.key = key;
   newData.value = value;
@@ -564,6 +1380,11 @@ void QCPGraph::addData(double key, double value)
 */
 void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &values)
 {
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->add(keys, values);
+    return;
+  }
   int n = qMin(keys.size(), values.size());
   QCPData newData;
   for (int i=0; i<n; ++i)
@@ -580,6 +1401,11 @@ void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &value
 */
 void QCPGraph::removeDataBefore(double key)
 {
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->removeBefore(key);
+    return;
+  }
   QCPDataMap::iterator it = mData->begin();
   while (it != mData->end() && it.key() < key)
     it = mData->erase(it);
@@ -591,6 +1417,11 @@ void QCPGraph::removeDataBefore(double key)
 */
 void QCPGraph::removeDataAfter(double key)
 {
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->removeAfter(key);
+    return;
+  }
   if (mData->isEmpty()) return;
   QCPDataMap::iterator it = mData->upperBound(key);
   while (it != mData->end())
@@ -606,6 +1437,11 @@ void QCPGraph::removeDataAfter(double key)
 */
 void QCPGraph::removeData(double fromKey, double toKey)
 {
+  if (mDataLayout != dlMap)
+  {
+    mCompactData->remove(fromKey, toKey);
+    return;
+  }
   if (fromKey >= toKey || mData->isEmpty()) return;
   QCPDataMap::iterator it = mData->upperBound(fromKey);
   QCPDataMap::iterator itEnd = mData->upperBound(toKey);
@@ -623,7 +1459,36 @@ void QCPGraph::removeData(double fromKey, double toKey)
 */
 void QCPGraph::removeData(double key)
 {
-  mData->remove(key);
+  if (mDataLayout != dlMap)
+    mCompactData->remove(key);
+  else
+    mData->remove(key);
+}
+
+/*!
+  Returns the peak amount of memory in bytes that was retained by this graph's temporary replot
+  buffers. These buffers keep their capacity across replots, so the memory allocated during one
+  replot can be reused by the next one, instead of being freed and allocated again.
+  
+  \see squeezeScratchBuffers, QCPScratchPool
+*/
+qint64 QCPGraph::scratchPeakBytes() const
+{
+  return mPointScratch.peakBytes()+mDataScratch.peakBytes()+mLineScratch.peakBytes();
+}
+
+/*!
+  Frees the memory retained by this graph's temporary replot buffers. This may be useful after the
+  number of visible data points has decreased significantly, e.g. because a large part of the data
+  was removed. The buffers are allocated again as needed during the next replot.
+  
+  \see scratchPeakBytes
+*/
+void QCPGraph::squeezeScratchBuffers()
+{
+  mPointScratch.squeeze();
+  mDataScratch.squeeze();
+  mLineScratch.squeeze();
 }
 
 /*!
@@ -633,13 +1498,26 @@ void QCPGraph::removeData(double key)
 void QCPGraph::clearData()
 {
   mData->clear();
+  mCompactData->clear();
+}
+
+/* inherits documentation from base class */
+int QCPGraph::applyQueuedData()
+{
+  if (!mDataQueue || mDataQueue->isEmpty())
+    return 0;
+  QCPScratchBuffer<QCPData> queuedData(mDataScratch);
+  int count = mDataQueue->drain(queuedData.data());
+  for (int i=0; i<count; ++i)
+    addData(queuedData->at(i));
+  return count;
 }
 
 /* inherits documentation from base class */
 double QCPGraph::selectTest(const QPointF &pos, bool onlySelectable, QVariant *details) const
 {
   Q_UNUSED(details)
-  if ((onlySelectable && !mSelectable) || mData->isEmpty())
+  if ((onlySelectable && !mSelectable) || dataCount() == 0)
     return -1;
   if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return -1; }
   
@@ -673,7 +1551,7 @@ void QCPGraph::rescaleKeyAxis(bool onlyEnlarge, bool includeErrorBars) const
 {
   // this code is a copy of QCPAbstractPlottable::rescaleKeyAxis with the only change
   // that getKeyRange is passed the includeErrorBars value.
-  if (mData->isEmpty()) return;
+  if (dataCount() == 0) return;
   
   QCPAxis *keyAxis = mKeyAxis.data();
   if (!keyAxis) { qDebug() << Q_FUNC_INFO << "invalid key axis"; return; }
@@ -709,7 +1587,7 @@ void QCPGraph::rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars) const
 {
   // this code is a copy of QCPAbstractPlottable::rescaleValueAxis with the only change
   // is that getValueRange is passed the includeErrorBars value.
-  if (mData->isEmpty()) return;
+  if (dataCount() == 0) return;
   
   QCPAxis *valueAxis = mValueAxis.data();
   if (!valueAxis) { qDebug() << Q_FUNC_INFO << "invalid value axis"; return; }
@@ -738,27 +1616,44 @@ void QCPGraph::rescaleValueAxis(bool onlyEnlarge, bool includeErrorBars) const
 void QCPGraph::draw(QCPPainter *painter)
 {
   if (!mKeyAxis || !mValueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
-  if (mKeyAxis.data()->range().size() <= 0 || mData->isEmpty()) return;
+  if (mKeyAxis.data()->range().size() <= 0 || dataCount() == 0) return;
   if (mLineStyle == lsNone && mScatterStyle.isNone()) return;
   
-  // allocate line and (if necessary) point vectors:
-  QVector<QPointF> *lineData = new QVector<QPointF>;
+  // borrow line and (if necessary) point vectors from the scratch pools:
+  QCPScratchBuffer<QPointF> lineBuffer(mPointScratch);
+  QCPScratchBuffer<QCPData> scatterBuffer(mDataScratch);
+  QVector<QPointF> *lineData = lineBuffer.data();
   QVector<QCPData> *scatterData = 0;
   if (!mScatterStyle.isNone())
-    scatterData = new QVector<QCPData>;
+    scatterData = scatterBuffer.data();
   
   // fill vectors with data appropriate to plot style:
+  const double prepStart = profileTime();
   getPlotData(lineData, scatterData);
+  addProfilePreparationTime(prepStart);
+  
+  // in profiled replots, report how many of the visible points are drawn. This is done here and not
+  // in getPreparedData, because that is also called for the channel fill graph of another graph:
+  if (QCPReplotProfile *profile = mParentPlot->currentReplotProfile())
+  {
+    profile->pointsDrawn += mPreparedCount;
+    profile->pointsSampledAway += qMax(0, mPreparedVisibleCount-mPreparedCount);
+  }
   
   // check data validity if flag set:
 #ifdef QCUSTOMPLOT_CHECK_DATA
-  QCPDataMap::const_iterator it;
-  for (it = mData->constBegin(); it != mData->constEnd(); ++it)
-  {
-    if (QCP::isInvalidData(it.value().key, it.value().value) ||
-        QCP::isInvalidData(it.value().keyErrorPlus, it.value().keyErrorMinus) ||
-        QCP::isInvalidData(it.value().valueErrorPlus, it.value().valueErrorPlus))
-      qDebug() << Q_FUNC_INFO << "Data point at" << it.key() << "invalid." << "Plottable name:" << name();
+  QVector<QCPData> checkDataVector;
+  if (mDataLayout == dlMap)
+    checkDataVector = mData->values().toVector();
+  else
+    for (int i=0; i<mCompactData->size(); ++i)
+      checkDataVector.append(mCompactData->at(i));
+  foreach (const QCPData &checkData, checkDataVector)
+  {
+    if (QCP::isInvalidData(checkData.key, checkData.value) ||
+        QCP::isInvalidData(checkData.keyErrorPlus, checkData.keyErrorMinus) ||
+        QCP::isInvalidData(checkData.valueErrorPlus, checkData.valueErrorPlus))
+      qDebug() << Q_FUNC_INFO << "Data point at" << checkData.key << "invalid." << "Plottable name:" << name();
   }
 #endif
 
@@ -774,11 +1669,6 @@ void QCPGraph::draw(QCPPainter *painter)
   // draw scatters:
   if (scatterData)
     drawScatterPlot(painter, scatterData);
-  
-  // free allocated line and point vectors:
-  delete lineData;
-  if (scatterData)
-    delete scatterData;
 }
 
 /* inherits documentation from base class */
@@ -881,25 +1771,25 @@ void QCPGraph::getLinePlotData(QVector<QPointF> *linePixelData, QVector<QCPData>
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   if (!linePixelData) { qDebug() << Q_FUNC_INFO << "null pointer passed as linePixelData"; return; }
   
-  QVector<QCPData> lineData;
-  getPreparedData(&lineData, scatterData);
-  linePixelData->reserve(lineData.size()+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
-  linePixelData->resize(lineData.size());
+  QCPScratchBuffer<QCPData> lineData(mDataScratch);
+  getPreparedData(lineData.data(), scatterData);
+  linePixelData->reserve(lineData->size()+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
+  linePixelData->resize(lineData->size());
   
   // transform lineData points to pixels:
   if (keyAxis->orientation() == Qt::Vertical)
   {
-    for (int i=0; i<lineData.size(); ++i)
+    for (int i=0; i<lineData->size(); ++i)
     {
-      (*linePixelData)[i].setX(valueAxis->coordToPixel(lineData.at(i).value));
-      (*linePixelData)[i].setY(keyAxis->coordToPixel(lineData.at(i).key));
+      (*linePixelData)[i].setX(valueAxis->coordToPixel(lineData->at(i).value));
+      (*linePixelData)[i].setY(keyAxis->coordToPixel(lineData->at(i).key));
     }
   } else // key axis is horizontal
   {
-    for (int i=0; i<lineData.size(); ++i)
+    for (int i=0; i<lineData->size(); ++i)
     {
-      (*linePixelData)[i].setX(keyAxis->coordToPixel(lineData.at(i).key));
-      (*linePixelData)[i].setY(valueAxis->coordToPixel(lineData.at(i).value));
+      (*linePixelData)[i].setX(keyAxis->coordToPixel(lineData->at(i).key));
+      (*linePixelData)[i].setY(valueAxis->coordToPixel(lineData->at(i).value));
     }
   }
 }
@@ -922,35 +1812,35 @@ void QCPGraph::getStepLeftPlotData(QVector<QPointF> *linePixelData, QVector<QCPD
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   if (!linePixelData) { qDebug() << Q_FUNC_INFO << "null pointer passed as lineData"; return; }
   
-  QVector<QCPData> lineData;
-  getPreparedData(&lineData, scatterData);
-  linePixelData->reserve(lineData.size()*2+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
-  linePixelData->resize(lineData.size()*2);
+  QCPScratchBuffer<QCPData> lineData(mDataScratch);
+  getPreparedData(lineData.data(), scatterData);
+  linePixelData->reserve(lineData->size()*2+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
+  linePixelData->resize(lineData->size()*2);
   
   // calculate steps from lineData and transform to pixel coordinates:
   if (keyAxis->orientation() == Qt::Vertical)
   {
-    double lastValue = valueAxis->coordToPixel(lineData.first().value);
+    double lastValue = valueAxis->coordToPixel(lineData->first().value);
     double key;
-    for (int i=0; i<lineData.size(); ++i)
+    for (int i=0; i<lineData->size(); ++i)
     {
-      key = keyAxis->coordToPixel(lineData.at(i).key);
+      key = keyAxis->coordToPixel(lineData->at(i).key);
       (*linePixelData)[i*2+0].setX(lastValue);
       (*linePixelData)[i*2+0].setY(key);
-      lastValue = valueAxis->coordToPixel(lineData.at(i).value);
+      lastValue = valueAxis->coordToPixel(lineData->at(i).value);
       (*linePixelData)[i*2+1].setX(lastValue);
       (*linePixelData)[i*2+1].setY(key);
     }
   } else // key axis is horizontal
   {
-    double lastValue = valueAxis->coordToPixel(lineData.first().value);
+    double lastValue = valueAxis->coordToPixel(lineData->first().value);
     double key;
-    for (int i=0; i<lineData.size(); ++i)
+    for (int i=0; i<lineData->size(); ++i)
     {
-      key = keyAxis->coordToPixel(lineData.at(i).key);
+      key = keyAxis->coordToPixel(lineData->at(i).key);
       (*linePixelData)[i*2+0].setX(key);
       (*linePixelData)[i*2+0].setY(lastValue);
-      lastValue = valueAxis->coordToPixel(lineData.at(i).value);
+      lastValue = valueAxis->coordToPixel(lineData->at(i).value);
       (*linePixelData)[i*2+1].setX(key);
       (*linePixelData)[i*2+1].setY(lastValue);
     }
@@ -975,35 +1865,35 @@ void QCPGraph::getStepRightPlotData(QVector<QPointF> *linePixelData, QVector<QCP
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   if (!linePixelData) { qDebug() << Q_FUNC_INFO << "null pointer passed as lineData"; return; }
   
-  QVector<QCPData> lineData;
-  getPreparedData(&lineData, scatterData);
-  linePixelData->reserve(lineData.size()*2+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
-  linePixelData->resize(lineData.size()*2);
+  QCPScratchBuffer<QCPData> lineData(mDataScratch);
+  getPreparedData(lineData.data(), scatterData);
+  linePixelData->reserve(lineData->size()*2+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
+  linePixelData->resize(lineData->size()*2);
   
   // calculate steps from lineData and transform to pixel coordinates:
   if (keyAxis->orientation() == Qt::Vertical)
   {
-    double lastKey = keyAxis->coordToPixel(lineData.first().key);
+    double lastKey = keyAxis->coordToPixel(lineData->first().key);
     double value;
-    for (int i=0; i<lineData.size(); ++i)
+    for (int i=0; i<lineData->size(); ++i)
     {
-      value = valueAxis->coordToPixel(lineData.at(i).value);
+      value = valueAxis->coordToPixel(lineData->at(i).value);
       (*linePixelData)[i*2+0].setX(value);
       (*linePixelData)[i*2+0].setY(lastKey);
-      lastKey = keyAxis->coordToPixel(lineData.at(i).key);
+      lastKey = keyAxis->coordToPixel(lineData->at(i).key);
       (*linePixelData)[i*2+1].setX(value);
       (*linePixelData)[i*2+1].setY(lastKey);
     }
   } else // key axis is horizontal
   {
-    double lastKey = keyAxis->coordToPixel(lineData.first().key);
+    double lastKey = keyAxis->coordToPixel(lineData->first().key);
     double value;
-    for (int i=0; i<lineData.size(); ++i)
+    for (int i=0; i<lineData->size(); ++i)
     {
-      value = valueAxis->coordToPixel(lineData.at(i).value);
+      value = valueAxis->coordToPixel(lineData->at(i).value);
       (*linePixelData)[i*2+0].setX(lastKey);
       (*linePixelData)[i*2+0].setY(value);
-      lastKey = keyAxis->coordToPixel(lineData.at(i).key);
+      lastKey = keyAxis->coordToPixel(lineData->at(i).key);
       (*linePixelData)[i*2+1].setX(lastKey);
       (*linePixelData)[i*2+1].setY(value);
     }
@@ -1028,49 +1918,49 @@ void QCPGraph::getStepCenterPlotData(QVector<QPointF> *linePixelData, QVector<QC
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   if (!linePixelData) { qDebug() << Q_FUNC_INFO << "null pointer passed as lineData"; return; }
   
-  QVector<QCPData> lineData;
-  getPreparedData(&lineData, scatterData);
-  linePixelData->reserve(lineData.size()*2+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
-  linePixelData->resize(lineData.size()*2);
+  QCPScratchBuffer<QCPData> lineData(mDataScratch);
+  getPreparedData(lineData.data(), scatterData);
+  linePixelData->reserve(lineData->size()*2+2); // added 2 to reserve memory for lower/upper fill base points that might be needed for fill
+  linePixelData->resize(lineData->size()*2);
   // calculate steps from lineData and transform to pixel coordinates:
   if (keyAxis->orientation() == Qt::Vertical)
   {
-    double lastKey = keyAxis->coordToPixel(lineData.first().key);
-    double lastValue = valueAxis->coordToPixel(lineData.first().value);
+    double lastKey = keyAxis->coordToPixel(lineData->first().key);
+    double lastValue = valueAxis->coordToPixel(lineData->first().value);
     double key;
     (*linePixelData)[0].setX(lastValue);
     (*linePixelData)[0].setY(lastKey);
-    for (int i=1; i<lineData.size(); ++i)
+    for (int i=1; i<lineData->size(); ++i)
     {
-      key = (keyAxis->coordToPixel(lineData.at(i).key)+lastKey)*0.5;
+      key = (keyAxis->coordToPixel(lineData->at(i).key)+lastKey)*0.5;
       (*linePixelData)[i*2-1].setX(lastValue);
       (*linePixelData)[i*2-1].setY(key);
-      lastValue = valueAxis->coordToPixel(lineData.at(i).value);
-      lastKey = keyAxis->coordToPixel(lineData.at(i).key);
+      lastValue = valueAxis->coordToPixel(lineData->at(i).value);
+      lastKey = keyAxis->coordToPixel(lineData->at(i).key);
       (*linePixelData)[i*2+0].setX(lastValue);
       (*linePixelData)[i*2+0].setY(key);
     }
-    (*linePixelData)[lineData.size()*2-1].setX(lastValue);
-    (*linePixelData)[lineData.size()*2-1].setY(lastKey);
+    (*linePixelData)[lineData->size()*2-1].setX(lastValue);
+    (*linePixelData)[lineData->size()*2-1].setY(lastKey);
   } else // key axis is horizontal
   {
-    double lastKey = keyAxis->coordToPixel(lineData.first().key);
-    double lastValue = valueAxis->coordToPixel(lineData.first().value);
+    double lastKey = keyAxis->coordToPixel(lineData->first().key);
+    double lastValue = valueAxis->coordToPixel(lineData->first().value);
     double key;
     (*linePixelData)[0].setX(lastKey);
     (*linePixelData)[0].setY(lastValue);
-    for (int i=1; i<lineData.size(); ++i)
+    for (int i=1; i<lineData->size(); ++i)
     {
-      key = (keyAxis->coordToPixel(lineData.at(i).key)+lastKey)*0.5;
+      key = (keyAxis->coordToPixel(lineData->at(i).key)+lastKey)*0.5;
       (*linePixelData)[i*2-1].setX(key);
       (*linePixelData)[i*2-1].setY(lastValue);
-      lastValue = valueAxis->coordToPixel(lineData.at(i).value);
-      lastKey = keyAxis->coordToPixel(lineData.at(i).key);
+      lastValue = valueAxis->coordToPixel(lineData->at(i).value);
+      lastKey = keyAxis->coordToPixel(lineData->at(i).key);
       (*linePixelData)[i*2+0].setX(key);
       (*linePixelData)[i*2+0].setY(lastValue);
     }
-    (*linePixelData)[lineData.size()*2-1].setX(lastKey);
-    (*linePixelData)[lineData.size()*2-1].setY(lastValue);
+    (*linePixelData)[lineData->size()*2-1].setX(lastKey);
+    (*linePixelData)[lineData->size()*2-1].setY(lastValue);
   }
 
 }
@@ -1093,34 +1983,34 @@ void QCPGraph::getImpulsePlotData(QVector<QPointF> *linePixelData, QVector<QCPDa
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
   if (!linePixelData) { qDebug() << Q_FUNC_INFO << "null pointer passed as linePixelData"; return; }
   
-  QVector<QCPData> lineData;
-  getPreparedData(&lineData, scatterData);
-  linePixelData->resize(lineData.size()*2); // no need to reserve 2 extra points because impulse plot has no fill
+  QCPScratchBuffer<QCPData> lineData(mDataScratch);
+  getPreparedData(lineData.data(), scatterData);
+  linePixelData->resize(lineData->size()*2); // no need to reserve 2 extra points because impulse plot has no fill
   
   // transform lineData points to pixels:
   if (keyAxis->orientation() == Qt::Vertical)
   {
     double zeroPointX = valueAxis->coordToPixel(0);
     double key;
-    for (int i=0; i<lineData.size(); ++i)
+    for (int i=0; i<lineData->size(); ++i)
     {
-      key = keyAxis->coordToPixel(lineData.at(i).key);
+      key = keyAxis->coordToPixel(lineData->at(i).key);
       (*linePixelData)[i*2+0].setX(zeroPointX);
       (*linePixelData)[i*2+0].setY(key);
-      (*linePixelData)[i*2+1].setX(valueAxis->coordToPixel(lineData.at(i).value));
+      (*linePixelData)[i*2+1].setX(valueAxis->coordToPixel(lineData->at(i).value));
       (*linePixelData)[i*2+1].setY(key);
     }
   } else // key axis is horizontal
   {
     double zeroPointY = valueAxis->coordToPixel(0);
     double key;
-    for (int i=0; i<lineData.size(); ++i)
+    for (int i=0; i<lineData->size(); ++i)
     {
-      key = keyAxis->coordToPixel(lineData.at(i).key);
+      key = keyAxis->coordToPixel(lineData->at(i).key);
       (*linePixelData)[i*2+0].setX(key);
       (*linePixelData)[i*2+0].setY(zeroPointY);
       (*linePixelData)[i*2+1].setX(key);
-      (*linePixelData)[i*2+1].setY(valueAxis->coordToPixel(lineData.at(i).value));
+      (*linePixelData)[i*2+1].setY(valueAxis->coordToPixel(lineData->at(i).value));
     }
   }
 }
@@ -1155,9 +2045,11 @@ void QCPGraph::drawFill(QCPPainter *painter, QVector<QPointF> *lineData) const
   } else
   {
     // draw channel fill between this graph and mChannelFillGraph:
+    QCPScratchBuffer<QPointF> channelPolygon(mPointScratch);
+    getChannelFillPolygon(lineData, channelPolygon.data());
     painter->setPen(Qt::NoPen);
     painter->setBrush(mainBrush());
-    painter->drawPolygon(getChannelFillPolygon(lineData));
+    painter->drawPolygon(channelPolygon->constData(), channelPolygon->size());
   }
 }
 
@@ -1179,17 +2071,20 @@ void QCPGraph::drawScatterPlot(QCPPainter *painter, QVector<QCPData> *scatterDat
   // draw error bars:
   if (mErrorType != etNone)
   {
-    applyErrorBarsAntialiasingHint(painter);
-    painter->setPen(mErrorPen);
+    QCPScratchBuffer<QLineF> errorLines(mLineScratch);
+    errorLines->reserve(scatterData->size()*(mErrorType == etBoth ? 8 : 4)); // up to two spine segments and two handles per error dimension
     if (keyAxis->orientation() == Qt::Vertical)
     {
       for (int i=0; i<scatterData->size(); ++i)
-        drawError(painter, valueAxis->coordToPixel(scatterData->at(i).value), keyAxis->coordToPixel(scatterData->at(i).key), scatterData->at(i));
+        getErrorBarLines(errorLines.data(), valueAxis->coordToPixel(scatterData->at(i).value), keyAxis->coordToPixel(scatterData->at(i).key), scatterData->at(i));
     } else
     {
       for (int i=0; i<scatterData->size(); ++i)
-        drawError(painter, keyAxis->coordToPixel(scatterData->at(i).key), valueAxis->coordToPixel(scatterData->at(i).value), scatterData->at(i));
+        getErrorBarLines(errorLines.data(), keyAxis->coordToPixel(scatterData->at(i).key), valueAxis->coordToPixel(scatterData->at(i).value), scatterData->at(i));
     }
+    applyErrorBarsAntialiasingHint(painter);
+    painter->setPen(mErrorPen);
+    painter->drawLines(*errorLines);
   }
   
   // draw scatter point symbols:
@@ -1250,6 +2145,8 @@ void QCPGraph::drawLinePlot(QCPPainter *painter, QVector<QPointF> *lineData) con
       int i = 0;
       bool lastIsNan = false;
       const int lineDataSize = lineData->size();
+      QCPScratchBuffer<QLineF> lines(mLineScratch); // segments are collected and passed to the painter in one batch, avoiding per-segment QPainter overhead
+      lines->reserve(lineDataSize);
       while (i < lineDataSize && (qIsNaN(lineData->at(i).y()) || qIsNaN(lineData->at(i).x()))) // make sure first point is not NaN
         ++i;
       ++i; // because drawing works in 1 point retrospect
@@ -1258,13 +2155,14 @@ void QCPGraph::drawLinePlot(QCPPainter *painter, QVector<QPointF> *lineData) con
         if (!qIsNaN(lineData->at(i).y()) && !qIsNaN(lineData->at(i).x())) // NaNs create a gap in the line
         {
           if (!lastIsNan)
-            painter->drawLine(lineData->at(i-1), lineData->at(i));
+            lines->append(QLineF(lineData->at(i-1), lineData->at(i)));
           else
             lastIsNan = false;
         } else
           lastIsNan = true;
         ++i;
       }
+      painter->drawLines(*lines);
     } else
     {
       int segmentStart = 0;
@@ -1302,7 +2200,17 @@ void QCPGraph::drawImpulsePlot(QCPPainter *painter, QVector<QPointF> *lineData)
     pen.setCapStyle(Qt::FlatCap); // so impulse line doesn't reach beyond zero-line
     painter->setPen(pen);
     painter->setBrush(Qt::NoBrush);
-    painter->drawLines(*lineData);
+    // lineData holds pairs of base and tip points, impulses of NaN data points are left out of the batch:
+    QCPScratchBuffer<QLineF> lines(mLineScratch);
+    lines->reserve(lineData->size()/2);
+    for (int i=1; i<lineData->size(); i+=2)
+    {
+      const QPointF &base = lineData->at(i-1);
+      const QPointF &tip = lineData->at(i);
+      if (!qIsNaN(tip.x()) && !qIsNaN(tip.y()) && !qIsNaN(base.x()) && !qIsNaN(base.y()))
+        lines->append(QLineF(base, tip));
+    }
+    painter->drawLines(*lines);
   }
 }
 
@@ -1319,39 +2227,61 @@ void QCPGraph::drawImpulsePlot(QCPPainter *painter, QVector<QPointF> *lineData)
   This method is used by the various "get(...)PlotData" methods to get the basic working set of data.
 */
 void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *scatterData) const
+{
+  if (mDataLayout == dlMap)
+    getPreparedData(mData, lineData, scatterData);
+  else
+    getPreparedData(mCompactData, lineData, scatterData);
+}
+
+/*! \internal
+  \overload
+  
+  Generates the prepared data from the data container \a data, which is either the \ref QCPDataMap
+  or the \ref QCPCompactData of this graph, depending on the \ref setDataLayout "data layout".
+*/
+template <class DataContainer>
+void QCPGraph::getPreparedData(const DataContainer *data, QVector<QCPData> *lineData, QVector<QCPData> *scatterData) const
 {
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return; }
+  mPreparedVisibleCount = 0;
+  mPreparedCount = 0;
   // get visible data range:
-  QCPDataMap::const_iterator lower, upper; // note that upper is the actual upper point, and not 1 step after the upper point
-  getVisibleDataBounds(lower, upper);
-  if (lower == mData->constEnd() || upper == mData->constEnd())
+  typename DataContainer::const_iterator lower, upper; // note that upper is the actual upper point, and not 1 step after the upper point
+  getVisibleDataBounds(data, lower, upper);
+  if (lower == data->constEnd() || upper == data->constEnd())
     return;
   
+  // in vector exports with a set resolution, always sample adaptively with one interval per output device dot instead of per pixel:
+  const double exportScale = exportSamplingScale();
+  const bool adaptiveSampling = mAdaptiveSampling || exportScale > 0;
+  const double samplingScale = exportScale > 0 ? exportScale : 1.0;
+  
   // count points in visible range, taking into account that we only need to count to the limit maxCount if using adaptive sampling:
   int maxCount = std::numeric_limits<int>::max();
-  if (mAdaptiveSampling)
+  if (adaptiveSampling)
   {
-    int keyPixelSpan = qAbs(keyAxis->coordToPixel(lower.key())-keyAxis->coordToPixel(upper.key()));
-    maxCount = 2*keyPixelSpan+2;
+    double keyPixelSpan = qAbs(keyAxis->coordToPixel(lower.key())-keyAxis->coordToPixel(upper.key()));
+    maxCount = 2*int(keyPixelSpan*samplingScale)+2;
   }
-  int dataCount = countDataInBounds(lower, upper, maxCount);
+  int dataCount = countDataInBounds(data, lower, upper, maxCount);
   
-  if (mAdaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel on average
+  if (adaptiveSampling && dataCount >= maxCount) // use adaptive sampling only if there are at least two points per pixel (or output dot) on average
   {
     if (lineData)
     {
-      QCPDataMap::const_iterator it = lower;
-      QCPDataMap::const_iterator upperEnd = upper+1;
+      typename DataContainer::const_iterator it = lower;
+      typename DataContainer::const_iterator upperEnd = upper+1;
       double minValue = it.value().value;
       double maxValue = it.value().value;
-      QCPDataMap::const_iterator currentIntervalFirstPoint = it;
+      typename DataContainer::const_iterator currentIntervalFirstPoint = it;
       int reversedFactor = keyAxis->rangeReversed() != (keyAxis->orientation()==Qt::Vertical) ? -1 : 1; // is used to calculate keyEpsilon pixel into the correct direction
       int reversedRound = keyAxis->rangeReversed() != (keyAxis->orientation()==Qt::Vertical) ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
-      double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(lower.key())+reversedRound));
+      double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(lower.key())*samplingScale+reversedRound)/samplingScale);
       double lastIntervalEndKey = currentIntervalStartKey;
-      double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+      double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+reversedFactor/samplingScale)); // interval of one pixel on screen when mapped to plot key coordinates
       bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
       int intervalDataCount = 1;
       ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
@@ -1380,9 +2310,9 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
           minValue = it.value().value;
           maxValue = it.value().value;
           currentIntervalFirstPoint = it;
-          currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it.key())+reversedRound));
+          currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it.key())*samplingScale+reversedRound)/samplingScale);
           if (keyEpsilonVariable)
-            keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
+            keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+reversedFactor/samplingScale));
           intervalDataCount = 1;
         }
         ++it;
@@ -1402,17 +2332,17 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
     {
       double valueMaxRange = valueAxis->range().upper;
       double valueMinRange = valueAxis->range().lower;
-      QCPDataMap::const_iterator it = lower;
-      QCPDataMap::const_iterator upperEnd = upper+1;
+      typename DataContainer::const_iterator it = lower;
+      typename DataContainer::const_iterator upperEnd = upper+1;
       double minValue = it.value().value;
       double maxValue = it.value().value;
-      QCPDataMap::const_iterator minValueIt = it;
-      QCPDataMap::const_iterator maxValueIt = it;
-      QCPDataMap::const_iterator currentIntervalStart = it;
+      typename DataContainer::const_iterator minValueIt = it;
+      typename DataContainer::const_iterator maxValueIt = it;
+      typename DataContainer::const_iterator currentIntervalStart = it;
       int reversedFactor = keyAxis->rangeReversed() ? -1 : 1; // is used to calculate keyEpsilon pixel into the correct direction
       int reversedRound = keyAxis->rangeReversed() ? 1 : 0; // is used to switch between floor (normal) and ceil (reversed) rounding of currentIntervalStartKey
-      double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(lower.key())+reversedRound));
-      double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor)); // interval of one pixel on screen when mapped to plot key coordinates
+      double currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(lower.key())*samplingScale+reversedRound)/samplingScale);
+      double keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+reversedFactor/samplingScale)); // interval of one pixel on screen when mapped to plot key coordinates
       bool keyEpsilonVariable = keyAxis->scaleType() == QCPAxis::stLogarithmic; // indicates whether keyEpsilon needs to be updated after every interval (for log axes)
       int intervalDataCount = 1;
       ++it; // advance iterator to second data point because adaptive sampling works in 1 point retrospect
@@ -1435,9 +2365,9 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
           if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them
           {
             // determine value pixel span and add as many points in interval to maintain certain vertical data density (this is specific to scatter plot):
-            double valuePixelSpan = qAbs(valueAxis->coordToPixel(minValue)-valueAxis->coordToPixel(maxValue));
+            double valuePixelSpan = qAbs(valueAxis->coordToPixel(minValue)-valueAxis->coordToPixel(maxValue))*samplingScale;
             int dataModulo = qMax(1, qRound(intervalDataCount/(valuePixelSpan/4.0))); // approximately every 4 value pixels one data point on average
-            QCPDataMap::const_iterator intervalIt = currentIntervalStart;
+            typename DataContainer::const_iterator intervalIt = currentIntervalStart;
             int c = 0;
             while (intervalIt != it)
             {
@@ -1451,9 +2381,9 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
           minValue = it.value().value;
           maxValue = it.value().value;
           currentIntervalStart = it;
-          currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it.key())+reversedRound));
+          currentIntervalStartKey = keyAxis->pixelToCoord((int)(keyAxis->coordToPixel(it.key())*samplingScale+reversedRound)/samplingScale);
           if (keyEpsilonVariable)
-            keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+1.0*reversedFactor));
+            keyEpsilon = qAbs(currentIntervalStartKey-keyAxis->pixelToCoord(keyAxis->coordToPixel(currentIntervalStartKey)+reversedFactor/samplingScale));
           intervalDataCount = 1;
         }
         ++it;
@@ -1462,9 +2392,9 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
       if (intervalDataCount >= 2) // last pixel had multiple data points, consolidate them
       {
         // determine value pixel span and add as many points in interval to maintain certain vertical data density (this is specific to scatter plot):
-        double valuePixelSpan = qAbs(valueAxis->coordToPixel(minValue)-valueAxis->coordToPixel(maxValue));
+        double valuePixelSpan = qAbs(valueAxis->coordToPixel(minValue)-valueAxis->coordToPixel(maxValue))*samplingScale;
         int dataModulo = qMax(1, qRound(intervalDataCount/(valuePixelSpan/4.0))); // approximately every 4 value pixels one data point on average
-        QCPDataMap::const_iterator intervalIt = currentIntervalStart;
+        typename DataContainer::const_iterator intervalIt = currentIntervalStart;
         int c = 0;
         while (intervalIt != it)
         {
@@ -1485,8 +2415,8 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
       dataVector = scatterData;
     if (dataVector)
     {
-      QCPDataMap::const_iterator it = lower;
-      QCPDataMap::const_iterator upperEnd = upper+1;
+      typename DataContainer::const_iterator it = lower;
+      typename DataContainer::const_iterator upperEnd = upper+1;
       dataVector->reserve(dataCount+2); // +2 for possible fill end points
       while (it != upperEnd)
       {
@@ -1495,18 +2425,34 @@ void QCPGraph::getPreparedData(QVector<QCPData> *lineData, QVector<QCPData> *sca
       }
     }
     if (lineData && scatterData)
-      *scatterData = *dataVector;
+    {
+      // copy element-wise instead of assigning, so scatterData keeps its own (reusable) memory:
+      scatterData->resize(dataVector->size());
+      for (int i=0; i<dataVector->size(); ++i)
+        (*scatterData)[i] = dataVector->at(i);
+    }
+  }
+  
+  // remember the point counts for the profile of a profiled replot (see \ref draw):
+  if (mParentPlot->currentReplotProfile())
+  {
+    if (adaptiveSampling && dataCount >= maxCount) // points were only counted up to maxCount
+      dataCount = countDataInBounds(data, lower, upper, std::numeric_limits<int>::max());
+    mPreparedVisibleCount = dataCount;
+    mPreparedCount = lineData ? lineData->size() : (scatterData ? scatterData->size() : 0);
   }
 }
 
 /*!  \internal
   
-  called by the scatter drawing function (\ref drawScatterPlot) to draw the error bars on one data
-  point. \a x and \a y pixel positions of the data point are passed since they are already known in
-  pixel coordinates in the drawing function, so we save some extra coordToPixel transforms here. \a
-  data is therefore only used for the errors, not key and value.
+  called by the scatter drawing function (\ref drawScatterPlot) to collect the lines making up the
+  error bars of one data point. The lines are appended to \a errorLines, so the scatter drawing
+  function can pass the error bars of all data points to the painter in one batch. \a x and \a y
+  pixel positions of the data point are passed since they are already known in pixel coordinates
+  in the drawing function, so we save some extra coordToPixel transforms here. \a data is
+  therefore only used for the errors, not key and value.
 */
-void QCPGraph::drawError(QCPPainter *painter, double x, double y, const QCPData &data) const
+void QCPGraph::getErrorBarLines(QVector<QLineF> *errorLines, double x, double y, const QCPData &data) const
 {
   if (qIsNaN(data.value))
     return;
@@ -1531,14 +2477,14 @@ void QCPGraph::drawError(QCPPainter *painter, double x, double y, const QCPData
       if (mErrorBarSkipSymbol)
       {
         if (a-y > skipSymbolMargin) // don't draw spine if error is so small it's within skipSymbolmargin
-          painter->drawLine(QLineF(x, a, x, y+skipSymbolMargin));
+          errorLines->append(QLineF(x, a, x, y+skipSymbolMargin));
         if (y-b > skipSymbolMargin)
-          painter->drawLine(QLineF(x, y-skipSymbolMargin, x, b));
+          errorLines->append(QLineF(x, y-skipSymbolMargin, x, b));
       } else
-        painter->drawLine(QLineF(x, a, x, b));
+        errorLines->append(QLineF(x, a, x, b));
       // draw handles:
-      painter->drawLine(QLineF(x-barWidthHalf, a, x+barWidthHalf, a));
-      painter->drawLine(QLineF(x-barWidthHalf, b, x+barWidthHalf, b));
+      errorLines->append(QLineF(x-barWidthHalf, a, x+barWidthHalf, a));
+      errorLines->append(QLineF(x-barWidthHalf, b, x+barWidthHalf, b));
     }
     if (mErrorType == etValue || mErrorType == etBoth)
     {
@@ -1550,14 +2496,14 @@ void QCPGraph::drawError(QCPPainter *painter, double x, double y, const QCPData
       if (mErrorBarSkipSymbol)
       {
         if (x-a > skipSymbolMargin) // don't draw spine if error is so small it's within skipSymbolmargin
-          painter->drawLine(QLineF(a, y, x-skipSymbolMargin, y));
+          errorLines->append(QLineF(a, y, x-skipSymbolMargin, y));
         if (b-x > skipSymbolMargin)
-          painter->drawLine(QLineF(x+skipSymbolMargin, y, b, y));
+          errorLines->append(QLineF(x+skipSymbolMargin, y, b, y));
       } else
-        painter->drawLine(QLineF(a, y, b, y));
+        errorLines->append(QLineF(a, y, b, y));
       // draw handles:
-      painter->drawLine(QLineF(a, y-barWidthHalf, a, y+barWidthHalf));
-      painter->drawLine(QLineF(b, y-barWidthHalf, b, y+barWidthHalf));
+      errorLines->append(QLineF(a, y-barWidthHalf, a, y+barWidthHalf));
+      errorLines->append(QLineF(b, y-barWidthHalf, b, y+barWidthHalf));
     }
   } else // mKeyAxis->orientation() is Qt::Horizontal
   {
@@ -1572,14 +2518,14 @@ void QCPGraph::drawError(QCPPainter *painter, double x, double y, const QCPData
       if (mErrorBarSkipSymbol)
       {
         if (x-a > skipSymbolMargin) // don't draw spine if error is so small it's within skipSymbolmargin
-          painter->drawLine(QLineF(a, y, x-skipSymbolMargin, y));
+          errorLines->append(QLineF(a, y, x-skipSymbolMargin, y));
         if (b-x > skipSymbolMargin)
-          painter->drawLine(QLineF(x+skipSymbolMargin, y, b, y));
+          errorLines->append(QLineF(x+skipSymbolMargin, y, b, y));
       } else
-        painter->drawLine(QLineF(a, y, b, y));
+        errorLines->append(QLineF(a, y, b, y));
       // draw handles:
-      painter->drawLine(QLineF(a, y-barWidthHalf, a, y+barWidthHalf));
-      painter->drawLine(QLineF(b, y-barWidthHalf, b, y+barWidthHalf));
+      errorLines->append(QLineF(a, y-barWidthHalf, a, y+barWidthHalf));
+      errorLines->append(QLineF(b, y-barWidthHalf, b, y+barWidthHalf));
     }
     if (mErrorType == etValue || mErrorType == etBoth)
     {
@@ -1591,14 +2537,14 @@ void QCPGraph::drawError(QCPPainter *painter, double x, double y, const QCPData
       if (mErrorBarSkipSymbol)
       {
         if (a-y > skipSymbolMargin) // don't draw spine if error is so small it's within skipSymbolmargin
-          painter->drawLine(QLineF(x, a, x, y+skipSymbolMargin));
+          errorLines->append(QLineF(x, a, x, y+skipSymbolMargin));
         if (y-b > skipSymbolMargin)
-          painter->drawLine(QLineF(x, y-skipSymbolMargin, x, b));
+          errorLines->append(QLineF(x, y-skipSymbolMargin, x, b));
       } else
-        painter->drawLine(QLineF(x, a, x, b));
+        errorLines->append(QLineF(x, a, x, b));
       // draw handles:
-      painter->drawLine(QLineF(x-barWidthHalf, a, x+barWidthHalf, a));
-      painter->drawLine(QLineF(x-barWidthHalf, b, x+barWidthHalf, b));
+      errorLines->append(QLineF(x-barWidthHalf, a, x+barWidthHalf, a));
+      errorLines->append(QLineF(x-barWidthHalf, b, x+barWidthHalf, b));
     }
   }
 }
@@ -1618,20 +2564,32 @@ void QCPGraph::drawError(QCPPainter *painter, double x, double y, const QCPData
   if the graph contains no data, both \a lower and \a upper point to constEnd.
 */
 void QCPGraph::getVisibleDataBounds(QCPDataMap::const_iterator &lower, QCPDataMap::const_iterator &upper) const
+{
+  getVisibleDataBounds(mData, lower, upper);
+}
+
+/*!  \internal
+  \overload
+  
+  Determines the visible data bounds in the data container \a data, which may be either a \ref
+  QCPDataMap or a \ref QCPCompactData.
+*/
+template <class DataContainer>
+void QCPGraph::getVisibleDataBounds(const DataContainer *data, typename DataContainer::const_iterator &lower, typename DataContainer::const_iterator &upper) const
 {
   if (!mKeyAxis) { qDebug() << Q_FUNC_INFO << "invalid key axis"; return; }
-  if (mData->isEmpty())
+  if (data->isEmpty())
   {
-    lower = mData->constEnd();
-    upper = mData->constEnd();
+    lower = data->constEnd();
+    upper = data->constEnd();
     return;
   }
   
-  // get visible data range as QMap iterators
-  QCPDataMap::const_iterator lbound = mData->lowerBound(mKeyAxis.data()->range().lower);
-  QCPDataMap::const_iterator ubound = mData->upperBound(mKeyAxis.data()->range().upper);
-  bool lowoutlier = lbound != mData->constBegin(); // indicates whether there exist points below axis range
-  bool highoutlier = ubound != mData->constEnd(); // indicates whether there exist points above axis range
+  // get visible data range as iterators
+  typename DataContainer::const_iterator lbound = data->lowerBound(mKeyAxis.data()->range().lower);
+  typename DataContainer::const_iterator ubound = data->upperBound(mKeyAxis.data()->range().upper);
+  bool lowoutlier = lbound != data->constBegin(); // indicates whether there exist points below axis range
+  bool highoutlier = ubound != data->constEnd(); // indicates whether there exist points above axis range
   
   lower = (lowoutlier ? lbound-1 : lbound); // data point range that will be actually drawn
   upper = (highoutlier ? ubound : ubound-1); // data point range that will be actually drawn
@@ -1649,9 +2607,21 @@ void QCPGraph::getVisibleDataBounds(QCPDataMap::const_iterator &lower, QCPDataMa
 */
 int QCPGraph::countDataInBounds(const QCPDataMap::const_iterator &lower, const QCPDataMap::const_iterator &upper, int maxCount) const
 {
-  if (upper == mData->constEnd() && lower == mData->constEnd())
+  return countDataInBounds(mData, lower, upper, maxCount);
+}
+
+/*!  \internal
+  \overload
+  
+  Counts the data points between \a lower and \a upper in the data container \a data, which may
+  be either a \ref QCPDataMap or a \ref QCPCompactData.
+*/
+template <class DataContainer>
+int QCPGraph::countDataInBounds(const DataContainer *data, const typename DataContainer::const_iterator &lower, const typename DataContainer::const_iterator &upper, int maxCount) const
+{
+  if (upper == data->constEnd() && lower == data->constEnd())
     return 0;
-  QCPDataMap::const_iterator it = lower;
+  typename DataContainer::const_iterator it = lower;
   int count = 1;
   while (it != upper && count < maxCount)
   {
@@ -1837,36 +2807,36 @@ QPointF QCPGraph::upperFillBasePoint(double upperKey) const
   
   Generates the polygon needed for drawing channel fills between this graph (data passed via \a
   lineData) and the graph specified by mChannelFillGraph (data generated by calling its \ref
-  getPlotData function). May return an empty polygon if the key ranges have no overlap or fill
-  target graph and this graph don't have same orientation (i.e. both key axes horizontal or both
-  key axes vertical). For increased performance (due to implicit sharing), keep the returned
-  QPolygonF const.
+  getPlotData function) and stores it in \a polygon. The polygon may be left empty if the key
+  ranges have no overlap or fill target graph and this graph don't have same orientation (i.e. both
+  key axes horizontal or both key axes vertical). \a polygon is typically a scratch buffer (see
+  \ref QCPScratchPool), so its memory can be reused in the next replot.
 */
-const QPolygonF QCPGraph::getChannelFillPolygon(const QVector<QPointF> *lineData) const
+void QCPGraph::getChannelFillPolygon(const QVector<QPointF> *lineData, QVector<QPointF> *polygon) const
 {
+  polygon->resize(0);
   if (!mChannelFillGraph)
-    return QPolygonF();
+    return;
   
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
-  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return QPolygonF(); }
-  if (!mChannelFillGraph.data()->mKeyAxis) { qDebug() << Q_FUNC_INFO << "channel fill target key axis invalid"; return QPolygonF(); }
-  
-  if (mChannelFillGraph.data()->mKeyAxis.data()->orientation() != keyAxis->orientation())
-    return QPolygonF(); // don't have same axis orientation, can't fill that (Note: if keyAxis fits, valueAxis will fit too, because it's always orthogonal to keyAxis)
-  
-  if (lineData->isEmpty()) return QPolygonF();
-  QVector<QPointF> otherData;
-  mChannelFillGraph.data()->getPlotData(&otherData, 0);
-  if (otherData.isEmpty()) return QPolygonF();
-  QVector<QPointF> thisData;
-  thisData.reserve(lineData->size()+otherData.size()); // because we will join both vectors at end of this function
+  if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; polygon->resize(0); return; }
+  if (!mChannelFillGraph.data()->mKeyAxis) { qDebug() << Q_FUNC_INFO << "channel fill target key axis invalid"; polygon->resize(0); return; }
+  
+  if (mChannelFillGraph.data()->mKeyAxis.data()->orientation() != keyAxis->orientation()) { polygon->resize(0); return; } // don't have same axis orientation, can't fill that (Note: if keyAxis fits, valueAxis will fit too, because it's always orthogonal to keyAxis)
+  
+  if (lineData->isEmpty()) { polygon->resize(0); return; }
+  QCPScratchBuffer<QPointF> otherData(mPointScratch);
+  mChannelFillGraph.data()->getPlotData(otherData.data(), 0);
+  if (otherData->isEmpty()) { polygon->resize(0); return; }
+  QVector<QPointF> *thisData = polygon; // this graph's points are cropped in place and the other graph's points appended at the end
+  thisData->reserve(lineData->size()+otherData->size()); // because we will join both vectors at end of this function
   for (int i=0; i<lineData->size(); ++i) // don't use the vector<<(vector),  it squeezes internally, which ruins the performance tuning with reserve()
-    thisData << lineData->at(i);
+    *thisData << lineData->at(i);
   
   // pointers to be able to swap them, depending which data range needs cropping:
-  QVector<QPointF> *staticData = &thisData;
-  QVector<QPointF> *croppedData = &otherData;
+  QVector<QPointF> *staticData = thisData;
+  QVector<QPointF> *croppedData = otherData.data();
   
   // crop both vectors to ranges in which the keys overlap (which coord is key, depends on axisType):
   if (keyAxis->orientation() == Qt::Horizontal)
@@ -1889,11 +2859,11 @@ const QPolygonF QCPGraph::getChannelFillPolygon(const QVector<QPointF> *lineData
     if (staticData->first().x() < croppedData->first().x()) // other one must be cropped
       qSwap(staticData, croppedData);
     int lowBound = findIndexBelowX(croppedData, staticData->first().x());
-    if (lowBound == -1) return QPolygonF(); // key ranges have no overlap
+    if (lowBound == -1) { polygon->resize(0); return; } // key ranges have no overlap
     croppedData->remove(0, lowBound);
     // set lowest point of cropped data to fit exactly key position of first static data
     // point via linear interpolation:
-    if (croppedData->size() < 2) return QPolygonF(); // need at least two points for interpolation
+    if (croppedData->size() < 2) { polygon->resize(0); return; } // need at least two points for interpolation
     double slope;
     if (croppedData->at(1).x()-croppedData->at(0).x() != 0)
       slope = (croppedData->at(1).y()-croppedData->at(0).y())/(croppedData->at(1).x()-croppedData->at(0).x());
@@ -1906,11 +2876,11 @@ const QPolygonF QCPGraph::getChannelFillPolygon(const QVector<QPointF> *lineData
     if (staticData->last().x() > croppedData->last().x()) // other one must be cropped
       qSwap(staticData, croppedData);
     int highBound = findIndexAboveX(croppedData, staticData->last().x());
-    if (highBound == -1) return QPolygonF(); // key ranges have no overlap
+    if (highBound == -1) { polygon->resize(0); return; } // key ranges have no overlap
     croppedData->remove(highBound+1, croppedData->size()-(highBound+1));
     // set highest point of cropped data to fit exactly key position of last static data
     // point via linear interpolation:
-    if (croppedData->size() < 2) return QPolygonF(); // need at least two points for interpolation
+    if (croppedData->size() < 2) { polygon->resize(0); return; } // need at least two points for interpolation
     int li = croppedData->size()-1; // last index
     if (croppedData->at(li).x()-croppedData->at(li-1).x() != 0)
       slope = (croppedData->at(li).y()-croppedData->at(li-1).y())/(croppedData->at(li).x()-croppedData->at(li-1).x());
@@ -1940,11 +2910,11 @@ const QPolygonF QCPGraph::getChannelFillPolygon(const QVector<QPointF> *lineData
     if (staticData->first().y() > croppedData->first().y()) // other one must be cropped
       qSwap(staticData, croppedData);
     int lowBound = findIndexAboveY(croppedData, staticData->first().y());
-    if (lowBound == -1) return QPolygonF(); // key ranges have no overlap
+    if (lowBound == -1) { polygon->resize(0); return; } // key ranges have no overlap
     croppedData->remove(0, lowBound);
     // set lowest point of cropped data to fit exactly key position of first static data
     // point via linear interpolation:
-    if (croppedData->size() < 2) return QPolygonF(); // need at least two points for interpolation
+    if (croppedData->size() < 2) { polygon->resize(0); return; } // need at least two points for interpolation
     double slope;
     if (croppedData->at(1).y()-croppedData->at(0).y() != 0) // avoid division by zero in step plots
       slope = (croppedData->at(1).x()-croppedData->at(0).x())/(croppedData->at(1).y()-croppedData->at(0).y());
@@ -1957,11 +2927,11 @@ const QPolygonF QCPGraph::getChannelFillPolygon(const QVector<QPointF> *lineData
     if (staticData->last().y() < croppedData->last().y()) // other one must be cropped
       qSwap(staticData, croppedData);
     int highBound = findIndexBelowY(croppedData, staticData->last().y());
-    if (highBound == -1) return QPolygonF(); // key ranges have no overlap
+    if (highBound == -1) { polygon->resize(0); return; } // key ranges have no overlap
     croppedData->remove(highBound+1, croppedData->size()-(highBound+1));
     // set highest point of cropped data to fit exactly key position of last static data
     // point via linear interpolation:
-    if (croppedData->size() < 2) return QPolygonF(); // need at least two points for interpolation
+    if (croppedData->size() < 2) { polygon->resize(0); return; } // need at least two points for interpolation
     int li = croppedData->size()-1; // last index
     if (croppedData->at(li).y()-croppedData->at(li-1).y() != 0) // avoid division by zero in step plots
       slope = (croppedData->at(li).x()-croppedData->at(li-1).x())/(croppedData->at(li).y()-croppedData->at(li-1).y());
@@ -1971,10 +2941,9 @@ const QPolygonF QCPGraph::getChannelFillPolygon(const QVector<QPointF> *lineData
     (*croppedData)[li].setY(staticData->last().y());
   }
   
-  // return joined:
-  for (int i=otherData.size()-1; i>=0; --i) // insert reversed, otherwise the polygon will be twisted
-    thisData << otherData.at(i);
-  return QPolygonF(thisData);
+  // join both:
+  for (int i=otherData->size()-1; i>=0; --i) // insert reversed, otherwise the polygon will be twisted
+    *thisData << otherData->at(i);
 }
 
 /*! \internal
@@ -2054,7 +3023,7 @@ int QCPGraph::findIndexAboveY(const QVector<QPointF> *data, double y) const
 */
 double QCPGraph::pointDistance(const QPointF &pixelPoint) const
 {
-  if (mData->isEmpty())
+  if (dataCount() == 0)
     return -1.0;
   if (mLineStyle == lsNone && mScatterStyle.isNone())
     return -1.0;
@@ -2063,14 +3032,14 @@ double QCPGraph::pointDistance(const QPointF &pixelPoint) const
   if (mLineStyle == lsNone)
   {
     // no line displayed, only calculate distance to scatter points:
-    QVector<QCPData> scatterData;
-    getScatterPlotData(&scatterData);
-    if (scatterData.size() > 0)
+    QCPScratchBuffer<QCPData> scatterData(mDataScratch);
+    getScatterPlotData(scatterData.data());
+    if (scatterData->size() > 0)
     {
       double minDistSqr = std::numeric_limits<double>::max();
-      for (int i=0; i<scatterData.size(); ++i)
+      for (int i=0; i<scatterData->size(); ++i)
       {
-        double currentDistSqr = QVector2D(coordsToPixels(scatterData.at(i).key, scatterData.at(i).value)-pixelPoint).lengthSquared();
+        double currentDistSqr = QVector2D(coordsToPixels(scatterData->at(i).key, scatterData->at(i).value)-pixelPoint).lengthSquared();
         if (currentDistSqr < minDistSqr)
           minDistSqr = currentDistSqr;
       }
@@ -2080,34 +3049,34 @@ double QCPGraph::pointDistance(const QPointF &pixelPoint) const
   } else
   {
     // line displayed, calculate distance to line segments:
-    QVector<QPointF> lineData;
-    getPlotData(&lineData, 0); // unlike with getScatterPlotData we get pixel coordinates here
-    if (lineData.size() > 1) // at least one line segment, compare distance to line segments
+    QCPScratchBuffer<QPointF> lineData(mPointScratch);
+    getPlotData(lineData.data(), 0); // unlike with getScatterPlotData we get pixel coordinates here
+    if (lineData->size() > 1) // at least one line segment, compare distance to line segments
     {
       double minDistSqr = std::numeric_limits<double>::max();
       if (mLineStyle == lsImpulse)
       {
         // impulse plot differs from other line styles in that the lineData points are only pairwise connected:
-        for (int i=0; i<lineData.size()-1; i+=2) // iterate pairs
+        for (int i=0; i<lineData->size()-1; i+=2) // iterate pairs
         {
-          double currentDistSqr = distSqrToLine(lineData.at(i), lineData.at(i+1), pixelPoint);
+          double currentDistSqr = distSqrToLine(lineData->at(i), lineData->at(i+1), pixelPoint);
           if (currentDistSqr < minDistSqr)
             minDistSqr = currentDistSqr;
         }
       } else
       {
         // all other line plots (line and step) connect points directly:
-        for (int i=0; i<lineData.size()-1; ++i)
+        for (int i=0; i<lineData->size()-1; ++i)
         {
-          double currentDistSqr = distSqrToLine(lineData.at(i), lineData.at(i+1), pixelPoint);
+          double currentDistSqr = distSqrToLine(lineData->at(i), lineData->at(i+1), pixelPoint);
           if (currentDistSqr < minDistSqr)
             minDistSqr = currentDistSqr;
         }
       }
       return qSqrt(minDistSqr);
-    } else if (lineData.size() > 0) // only single data point, calculate distance to that point
+    } else if (lineData->size() > 0) // only single data point, calculate distance to that point
     {
-      return QVector2D(lineData.at(0)-pixelPoint).length();
+      return QVector2D(lineData->at(0)-pixelPoint).length();
     } else // no data available in view to calculate distance to
       return -1.0;
   }
@@ -2159,6 +3128,20 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain) cons
   \see getKeyRange(bool &foundRange, SignDomain inSignDomain)
 */
 QCPRange QCPGraph::getKeyRange(bool &foundRange, SignDomain inSignDomain, bool includeErrors) const
+{
+  if (mDataLayout == dlMap)
+    return findKeyRange(mData, foundRange, inSignDomain, includeErrors);
+  else
+    return findKeyRange(mCompactData, foundRange, inSignDomain, includeErrors);
+}
+
+/*! \internal
+  
+  Calculates the key range of the data points in \a data, which may be either a \ref QCPDataMap or
+  a \ref QCPCompactData. See \ref getKeyRange(bool &foundRange, SignDomain inSignDomain, bool includeErrors).
+*/
+template <class DataContainer>
+QCPRange QCPGraph::findKeyRange(const DataContainer *data, bool &foundRange, SignDomain inSignDomain, bool includeErrors) const
 {
   QCPRange range;
   bool haveLower = false;
@@ -2168,8 +3151,8 @@ QCPRange QCPGraph::getKeyRange(bool &foundRange, SignDomain inSignDomain, bool i
   
   if (inSignDomain == sdBoth) // range may be anywhere
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    typename DataContainer::const_iterator it = data->constBegin();
+    while (it != data->constEnd())
     {
       if (!qIsNaN(it.value().value))
       {
@@ -2191,8 +3174,8 @@ QCPRange QCPGraph::getKeyRange(bool &foundRange, SignDomain inSignDomain, bool i
     }
   } else if (inSignDomain == sdNegative) // range may only be in the negative sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    typename DataContainer::const_iterator it = data->constBegin();
+    while (it != data->constEnd())
     {
       if (!qIsNaN(it.value().value))
       {
@@ -2227,8 +3210,8 @@ QCPRange QCPGraph::getKeyRange(bool &foundRange, SignDomain inSignDomain, bool i
     }
   } else if (inSignDomain == sdPositive) // range may only be in the positive sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    typename DataContainer::const_iterator it = data->constBegin();
+    while (it != data->constEnd())
     {
       if (!qIsNaN(it.value().value))
       {
@@ -2274,6 +3257,20 @@ QCPRange QCPGraph::getKeyRange(bool &foundRange, SignDomain inSignDomain, bool i
   \see getValueRange(bool &foundRange, SignDomain inSignDomain)
 */
 QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain, bool includeErrors) const
+{
+  if (mDataLayout == dlMap)
+    return findValueRange(mData, foundRange, inSignDomain, includeErrors);
+  else
+    return findValueRange(mCompactData, foundRange, inSignDomain, includeErrors);
+}
+
+/*! \internal
+  
+  Calculates the value range of the data points in \a data, which may be either a \ref QCPDataMap or
+  a \ref QCPCompactData. See \ref getValueRange(bool &foundRange, SignDomain inSignDomain, bool includeErrors).
+*/
+template <class DataContainer>
+QCPRange QCPGraph::findValueRange(const DataContainer *data, bool &foundRange, SignDomain inSignDomain, bool includeErrors) const
 {
   QCPRange range;
   bool haveLower = false;
@@ -2283,8 +3280,8 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain, bool
   
   if (inSignDomain == sdBoth) // range may be anywhere
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    typename DataContainer::const_iterator it = data->constBegin();
+    while (it != data->constEnd())
     {
       current = it.value().value;
       if (!qIsNaN(current))
@@ -2306,8 +3303,8 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain, bool
     }
   } else if (inSignDomain == sdNegative) // range may only be in the negative sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    typename DataContainer::const_iterator it = data->constBegin();
+    while (it != data->constEnd())
     {
       current = it.value().value;
       if (!qIsNaN(current))
@@ -2342,8 +3339,8 @@ QCPRange QCPGraph::getValueRange(bool &foundRange, SignDomain inSignDomain, bool
     }
   } else if (inSignDomain == sdPositive) // range may only be in the positive sign domain
   {
-    QCPDataMap::const_iterator it = mData->constBegin();
-    while (it != mData->constEnd())
+    typename DataContainer::const_iterator it = data->constBegin();
+    while (it != data->constEnd())
     {
       current = it.value().value;
       if (!qIsNaN(current))
@@ -57,6 +57,105 @@ typedef QMapIterator<double, QCPData> QCPDataMapIterator;
 typedef QMutableMapIterator<double, QCPData> QCPDataMutableMapIterator;
 
 
+class QCP_LIB_DECL QCPCompactData
+{
+public:
+  /*!
+    Defines the floating point precision with which the values (not the keys) are stored.
+    
+    \see setValuePrecision
+  */
+  enum ValuePrecision { vpDouble ///< values are stored as 64 bit double precision numbers
+                        ,vpFloat ///< values are stored as 32 bit single precision numbers, halving their memory footprint
+                      };
+  
+  class const_iterator
+  {
+  public:
+    const_iterator() : mData(0), mIndex(0) {}
+    const_iterator(const QCPCompactData *data, int index) : mData(data), mIndex(index) {}
+    double key() const { return mData->key(mIndex); }
+    QCPData value() const { return mData->at(mIndex); }
+    int index() const { return mIndex; }
+    const_iterator &operator++() { ++mIndex; return *this; }
+    const_iterator &operator--() { --mIndex; return *this; }
+    const_iterator operator+(int j) const { return const_iterator(mData, mIndex+j); }
+    const_iterator operator-(int j) const { return const_iterator(mData, mIndex-j); }
+    int operator-(const const_iterator &other) const { return mIndex-other.mIndex; }
+    bool operator==(const const_iterator &other) const { return mIndex == other.mIndex && mData == other.mData; }
+    bool operator!=(const const_iterator &other) const { return !(*this == other); }
+  private:
+    const QCPCompactData *mData;
+    int mIndex;
+  };
+  
+  explicit QCPCompactData(ValuePrecision precision=vpDouble);
+  
+  // getters:
+  ValuePrecision valuePrecision() const { return mValuePrecision; }
+  int size() const { return mExternalKeys ? mExternalSize : mKeys.size(); }
+  bool isEmpty() const { return size() == 0; }
+  bool isExternal() const { return mExternalKeys != 0; }
+  bool hasKeyErrors() const { return mHasKeyErrors; }
+  bool hasValueErrors() const { return mHasValueErrors; }
+  double key(int index) const { return mExternalKeys ? mExternalKeys[index] : mKeys.at(index); }
+  double value(int index) const { return mExternalKeys ? mExternalValues[index] : (mValuePrecision == vpFloat ? double(mFloatValues.at(index)) : mValues.at(index)); }
+  QCPData at(int index) const;
+  qint64 memoryUsage() const;
+  
+  // setters:
+  void setValuePrecision(ValuePrecision precision);
+  
+  // non-property methods:
+  const_iterator constBegin() const { return const_iterator(this, 0); }
+  const_iterator constEnd() const { return const_iterator(this, size()); }
+  const_iterator lowerBound(double key) const;
+  const_iterator upperBound(double key) const;
+  int lowerBoundIndex(double key) const;
+  int upperBoundIndex(double key) const;
+  void set(const QVector<double> &keys, const QVector<double> &values);
+  void set(const QVector<double> &keys, const QVector<double> &values, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus, const QVector<double> &valueErrorMinus, const QVector<double> &valueErrorPlus);
+  void set(const QCPDataMap &dataMap);
+  void adopt(QVector<double> &keys, QVector<double> &values);
+  void setExternal(const double *keys, const double *values, int count);
+  void add(const QCPData &data);
+  void add(double key, double value);
+  void add(const QVector<double> &keys, const QVector<double> &values);
+  void add(const QCPDataMap &dataMap);
+  void removeBefore(double key);
+  void removeAfter(double key);
+  void remove(double fromKey, double toKey);
+  void remove(double key);
+  void clear();
+  void squeeze();
+  void toDataMap(QCPDataMap *dataMap) const;
+  
+protected:
+  // property members:
+  ValuePrecision mValuePrecision;
+  
+  // non-property members:
+  QVector<double> mKeys;
+  QVector<double> mValues; // used with vpDouble
+  QVector<float> mFloatValues; // used with vpFloat
+  QVector<double> mKeyErrorMinus, mKeyErrorPlus; // only allocated if mHasKeyErrors
+  QVector<double> mValueErrorMinus, mValueErrorPlus; // only allocated if mHasValueErrors
+  bool mHasKeyErrors, mHasValueErrors;
+  const double *mExternalKeys, *mExternalValues; // only non-zero while referencing external arrays, see setExternal
+  int mExternalSize;
+  
+  // non-virtual methods:
+  void detach();
+  void insertPoint(int index, const QCPData &data);
+  void appendValues(const QVector<double> &values, int count);
+  void removeRange(int fromIndex, int toIndex);
+  void ensureKeyErrors();
+  void ensureValueErrors();
+  void sortByKey();
+  bool isSortedFrom(int index) const;
+};
+
+
 class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable
 {
   Q_OBJECT
@@ -69,6 +168,7 @@ class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable
   Q_PROPERTY(bool errorBarSkipSymbol READ errorBarSkipSymbol WRITE setErrorBarSkipSymbol)
   Q_PROPERTY(QCPGraph* channelFillGraph READ channelFillGraph WRITE setChannelFillGraph)
   Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
+  Q_PROPERTY(DataLayout dataLayout READ dataLayout WRITE setDataLayout)
   /// \endcond
 public:
   /*!
@@ -94,6 +194,16 @@ public:
                    ,etBoth  ///< Error bars for both key and value dimensions of the data point are shown
                  };
   Q_ENUMS(ErrorType)
+  /*!
+    Defines in which kind of container the graph stores its data points.
+    
+    \see setDataLayout
+  */
+  enum DataLayout { dlMap           ///< data is stored in the \ref QCPDataMap accessible via \ref data (default)
+                    ,dlCompact      ///< data is stored column-wise in the \ref QCPCompactData accessible via \ref compactData
+                    ,dlCompactFloat ///< like \ref dlCompact, but values are stored with single precision (keys remain double precision)
+                  };
+  Q_ENUMS(DataLayout)
   
   explicit QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis);
   virtual ~QCPGraph();
@@ -108,10 +218,15 @@ public:
   bool errorBarSkipSymbol() const { return mErrorBarSkipSymbol; }
   QCPGraph *channelFillGraph() const { return mChannelFillGraph.data(); }
   bool adaptiveSampling() const { return mAdaptiveSampling; }
+  DataLayout dataLayout() const { return mDataLayout; }
+  QCPCompactData *compactData() const { return mCompactData; }
+  QCPDataQueue<QCPData> *dataQueue() const { return mDataQueue; }
   
   // setters:
   void setData(QCPDataMap *data, bool copy=false);
   void setData(const QVector<double> &key, const QVector<double> &value);
+  void adoptData(QVector<double> &keys, QVector<double> &values);
+  void setExternalData(const double *keys, const double *values, int count);
   void setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError);
   void setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus);
   void setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueError);
@@ -126,8 +241,11 @@ public:
   void setErrorBarSkipSymbol(bool enabled);
   void setChannelFillGraph(QCPGraph *targetGraph);
   void setAdaptiveSampling(bool enabled);
+  void setDataLayout(DataLayout layout);
+  void setDataQueueCapacity(int capacity);
   
   // non-property methods:
+  int dataCount() const { return mDataLayout == dlMap ? mData->size() : mCompactData->size(); }
   void addData(const QCPDataMap &dataMap);
   void addData(const QCPData &data);
   void addData(double key, double value);
@@ -136,6 +254,8 @@ public:
   void removeDataAfter(double key);
   void removeData(double fromKey, double toKey);
   void removeData(double key);
+  qint64 scratchPeakBytes() const;
+  void squeezeScratchBuffers();
   
   // reimplemented virtual methods:
   virtual void clearData();
@@ -158,6 +278,15 @@ protected:
   bool mErrorBarSkipSymbol;
   QPointer<QCPGraph> mChannelFillGraph;
   bool mAdaptiveSampling;
+  DataLayout mDataLayout;
+  
+  // non-property members:
+  QCPCompactData *mCompactData;
+  QCPDataQueue<QCPData> *mDataQueue;
+  mutable QCPScratchPool<QPointF> mPointScratch;
+  mutable QCPScratchPool<QCPData> mDataScratch;
+  mutable QCPScratchPool<QLineF> mLineScratch;
+  mutable int mPreparedVisibleCount, mPreparedCount; // point counts of the last getPreparedData call, only set in profiled replots
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter);
@@ -166,6 +295,7 @@ protected:
   virtual QCPRange getValueRange(bool &foundRange, SignDomain inSignDomain=sdBoth) const;
   virtual QCPRange getKeyRange(bool &foundRange, SignDomain inSignDomain, bool includeErrors) const; // overloads base class interface
   virtual QCPRange getValueRange(bool &foundRange, SignDomain inSignDomain, bool includeErrors) const; // overloads base class interface
+  virtual int applyQueuedData();
   
   // introduced virtual methods:
   virtual void drawFill(QCPPainter *painter, QVector<QPointF> *lineData) const;
@@ -182,20 +312,32 @@ protected:
   void getStepRightPlotData(QVector<QPointF> *linePixelData, QVector<QCPData> *scatterData) const;
   void getStepCenterPlotData(QVector<QPointF> *linePixelData, QVector<QCPData> *scatterData) const;
   void getImpulsePlotData(QVector<QPointF> *linePixelData, QVector<QCPData> *scatterData) const;
-  void drawError(QCPPainter *painter, double x, double y, const QCPData &data) const;
+  void getErrorBarLines(QVector<QLineF> *errorLines, double x, double y, const QCPData &data) const;
   void getVisibleDataBounds(QCPDataMap::const_iterator &lower, QCPDataMap::const_iterator &upper) const;
   int countDataInBounds(const QCPDataMap::const_iterator &lower, const QCPDataMap::const_iterator &upper, int maxCount) const;
   void addFillBasePoints(QVector<QPointF> *lineData) const;
   void removeFillBasePoints(QVector<QPointF> *lineData) const;
   QPointF lowerFillBasePoint(double lowerKey) const;
   QPointF upperFillBasePoint(double upperKey) const;
-  const QPolygonF getChannelFillPolygon(const QVector<QPointF> *lineData) const;
+  void getChannelFillPolygon(const QVector<QPointF> *lineData, QVector<QPointF> *polygon) const;
   int findIndexBelowX(const QVector<QPointF> *data, double x) const;
   int findIndexAboveX(const QVector<QPointF> *data, double x) const;
   int findIndexBelowY(const QVector<QPointF> *data, double y) const;
   int findIndexAboveY(const QVector<QPointF> *data, double y) const;
   double pointDistance(const QPointF &pixelPoint) const;
   
+  // data container templates (instantiated for QCPDataMap and QCPCompactData):
+  template <class DataContainer>
+  void getPreparedData(const DataContainer *data, QVector<QCPData> *lineData, QVector<QCPData> *scatterData) const;
+  template <class DataContainer>
+  void getVisibleDataBounds(const DataContainer *data, typename DataContainer::const_iterator &lower, typename DataContainer::const_iterator &upper) const;
+  template <class DataContainer>
+  int countDataInBounds(const DataContainer *data, const typename DataContainer::const_iterator &lower, const typename DataContainer::const_iterator &upper, int maxCount) const;
+  template <class DataContainer>
+  QCPRange findKeyRange(const DataContainer *data, bool &foundRange, SignDomain inSignDomain, bool includeErrors) const;
+  template <class DataContainer>
+  QCPRange findValueRange(const DataContainer *data, bool &foundRange, SignDomain inSignDomain, bool includeErrors) const;
+  
   friend class QCustomPlot;
   friend class QCPLegend;
 };
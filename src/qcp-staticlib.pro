@@ -35,12 +35,15 @@ axis.h \
 plottable.h \
 item.h \
 lineending.h \
+replotprofile.h \
 core.h \
+batchexporter.h \
 layout.h \
 plottables/plottable-graph.h \
 plottables/plottable-curve.h \
 plottables/plottable-bars.h \
 plottables/plottable-statisticalbox.h \
+plottables/plottable-boxplot.h \
 plottables/plottable-colormap.h \
 plottables/plottable-financial.h \
 items/item-straightline.h \
@@ -66,12 +69,15 @@ axis.cpp \
 plottable.cpp \
 item.cpp \
 lineending.cpp \
+replotprofile.cpp \
 core.cpp \
+batchexporter.cpp \
 layout.cpp \
 plottables/plottable-graph.cpp \
 plottables/plottable-curve.cpp \
 plottables/plottable-bars.cpp \
 plottables/plottable-statisticalbox.cpp \
+plottables/plottable-boxplot.cpp \
 plottables/plottable-colormap.cpp \
 plottables/plottable-financial.cpp \
 items/item-straightline.cpp \
@@ -35,12 +35,15 @@
 #include "plottable.h"
 #include "item.h"
 #include "lineending.h"
+#include "replotprofile.h"
 #include "core.h"
+#include "batchexporter.h"
 #include "colorgradient.h"
 #include "plottables/plottable-graph.h"
 #include "plottables/plottable-curve.h"
 #include "plottables/plottable-bars.h"
 #include "plottables/plottable-statisticalbox.h"
+#include "plottables/plottable-boxplot.h"
 #include "plottables/plottable-colormap.h"
 #include "plottables/plottable-financial.h"
 #include "items/item-straightline.h"
@@ -0,0 +1,131 @@
+/***************************************************************************
+**                                                                        **
+**  QCustomPlot, an easy to use, modern plotting widget for Qt            **
+**  Copyright (C) 2011-2015 Emanuel Eichhammer                            **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Emanuel Eichhammer                                   **
+**  Website/Contact: http://www.qcustomplot.com/                          **
+**             Date: 25.04.15                                             **
+**          Version: 1.3.1                                                **
+****************************************************************************/
+
+#include "replotprofile.h"
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPReplotProfile
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPReplotProfile
+  \brief Timings and counters recorded during a profiled replot
+  
+  If profiling is enabled with \ref QCustomPlot::setProfiling, each \ref QCustomPlot::replot
+  records where its time was spent into an instance of this class. It is available after the
+  replot via \ref QCustomPlot::replotProfile and is passed to the signal \ref
+  QCustomPlot::replotProfiled, which is emitted right after \ref QCustomPlot::afterReplot. This
+  allows finding out whether a slow frame is caused by the layout, by the tick and label
+  generation of axes, by the data preparation of a plottable or by the rasterization of what it
+  draws, and sending these numbers to an application's own telemetry.
+  
+  All times are given in milliseconds:
+  \li \a totalTime from the start of the replot until the plot surface was refreshed
+  \li \a preparationTime for the preparation phase of the layout, excluding the tick generation
+  \li \a tickTime for the tick generation of all axes (see \ref QCPAxis::setupTickVectors),
+  which runs during the preparation phase but is measured separately
+  \li \a marginsTime and \a layoutTime for the margin and layout phases. These are zero if the
+  layout didn't need to be recalculated.
+  \li \a backgroundTime for the viewport background
+  \li \a layersTime for drawing all layers. This is broken down further into \a layerTimes (one
+  entry per layer, from bottom to top) and \a layerableTimes (one entry per drawn layerable). The
+  draw time of a layerable is split into the \a preparationTime of its data (e.g. adaptive
+  sampling and the transformation to pixel coordinates of a graph) and the \a rasterizationTime
+  spent painting with QPainter. Layerables that don't report a data preparation (see \ref
+  QCPAbstractPlottable::addProfilePreparationTime) have all their time counted as rasterization.
+  \li \a refreshTime for refreshing the widget surface. This is only meaningful if the replot uses
+  an immediate repaint, see \ref QCustomPlot::RefreshPriority.
+  
+  The counters are:
+  \li \a pointsDrawn, the number of data points the plottables passed on to the painter
+  \li \a pointsSampledAway, the number of data points in the visible range that were left out
+  by adaptive sampling (see \ref QCPGraph::setAdaptiveSampling) or similar reductions
+  \li \a cacheHits and \a cacheMisses of the pixmap caches, e.g. the tick label cache of axes
+  
+  Custom plottables and layerables may add their own counts to the profile of the current replot,
+  which is returned by \ref QCustomPlot::currentReplotProfile during a profiled replot.
+  
+  \ref summary returns a human readable text of the most important values. It is also what is
+  displayed by the overlay, see \ref QCustomPlot::setProfilingOverlay.
+*/
+
+/*!
+  Creates an empty profile, with all times and counters set to zero.
+*/
+QCPReplotProfile::QCPReplotProfile()
+{
+  clear();
+}
+
+/*!
+  Sets all times and counters to zero and removes all layer and layerable timings.
+*/
+void QCPReplotProfile::clear()
+{
+  totalTime = 0;
+  preparationTime = 0;
+  tickTime = 0;
+  marginsTime = 0;
+  layoutTime = 0;
+  backgroundTime = 0;
+  layersTime = 0;
+  refreshTime = 0;
+  layerTimes.clear();
+  layerableTimes.clear();
+  pointsDrawn = 0;
+  pointsSampledAway = 0;
+  cacheHits = 0;
+  cacheMisses = 0;
+}
+
+/*!
+  Returns a human readable, multi-line summary of this profile. It contains the times of all
+  phases, the counters and the \a layerableCount layerables that took the longest to draw.
+*/
+QString QCPReplotProfile::summary(int layerableCount) const
+{
+  QString result = QString("replot %1 ms: preparation %2, ticks %8, margins %3, layout %4, background %5, layers %6, refresh %7")
+      .arg(totalTime, 0, 'f', 2).arg(preparationTime, 0, 'f', 2).arg(marginsTime, 0, 'f', 2).arg(layoutTime, 0, 'f', 2)
+      .arg(backgroundTime, 0, 'f', 2).arg(layersTime, 0, 'f', 2).arg(refreshTime, 0, 'f', 2).arg(tickTime, 0, 'f', 2);
+  result += QString("\npoints: %1 drawn, %2 sampled away; cache: %3 hits, %4 misses")
+      .arg(pointsDrawn).arg(pointsSampledAway).arg(cacheHits).arg(cacheMisses);
+  
+  // append the slowest layerables, by repeatedly picking the slowest one not yet listed:
+  QVector<bool> listed(layerableTimes.size(), false);
+  for (int n=0; n<qMin(layerableCount, layerableTimes.size()); ++n)
+  {
+    int slowest = -1;
+    for (int i=0; i<layerableTimes.size(); ++i)
+    {
+      if (!listed.at(i) && (slowest < 0 || layerableTimes.at(i).drawTime > layerableTimes.at(slowest).drawTime))
+        slowest = i;
+    }
+    listed[slowest] = true;
+    const LayerableTiming &timing = layerableTimes.at(slowest);
+    result += QString("\n  %1 (%2): %3 ms (data %4, painting %5)").arg(timing.name).arg(timing.layer).arg(timing.drawTime, 0, 'f', 2)
+        .arg(timing.preparationTime, 0, 'f', 2).arg(timing.rasterizationTime, 0, 'f', 2);
+  }
+  return result;
+}
@@ -0,0 +1,78 @@
+/***************************************************************************
+**                                                                        **
+**  QCustomPlot, an easy to use, modern plotting widget for Qt            **
+**  Copyright (C) 2011-2015 Emanuel Eichhammer                            **
+**                                                                        **
+**  This program is free software: you can redistribute it and/or modify  **
+**  it under the terms of the GNU General Public License as published by  **
+**  the Free Software Foundation, either version 3 of the License, or     **
+**  (at your option) any later version.                                   **
+**                                                                        **
+**  This program is distributed in the hope that it will be useful,       **
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of        **
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         **
+**  GNU General Public License for more details.                          **
+**                                                                        **
+**  You should have received a copy of the GNU General Public License     **
+**  along with this program.  If not, see http://www.gnu.org/licenses/.   **
+**                                                                        **
+****************************************************************************
+**           Author: Emanuel Eichhammer                                   **
+**  Website/Contact: http://www.qcustomplot.com/                          **
+**             Date: 25.04.15                                             **
+**          Version: 1.3.1                                                **
+****************************************************************************/
+
+#ifndef QCP_REPLOTPROFILE_H
+#define QCP_REPLOTPROFILE_H
+
+#include "global.h"
+
+class QCPLayerable;
+
+class QCP_LIB_DECL QCPReplotProfile
+{
+public:
+  /*!
+    Holds the time spent in the \ref QCPLayerable::draw "draw" method of one layerable during a
+    profiled replot.
+  */
+  class LayerableTiming
+  {
+  public:
+    LayerableTiming() : layerable(0), drawTime(0), preparationTime(0), rasterizationTime(0) {}
+    const QCPLayerable *layerable; ///< only for identification, the layerable may be deleted after the replot
+    QString name;   ///< class name, followed by the name of the plottable (if applicable)
+    QString layer;  ///< name of the layer the layerable was drawn on
+    double drawTime; ///< in milliseconds, the sum of preparationTime and rasterizationTime
+    double preparationTime; ///< in milliseconds, the part of drawTime a plottable spent preparing its data
+    double rasterizationTime; ///< in milliseconds, the remaining part of drawTime, spent painting with QPainter
+  };
+  
+  QCPReplotProfile();
+  
+  void clear();
+  QString summary(int layerableCount=3) const;
+  
+  // times in milliseconds:
+  double totalTime;
+  double preparationTime;
+  double tickTime;
+  double marginsTime;
+  double layoutTime;
+  double backgroundTime;
+  double layersTime;
+  double refreshTime;
+  QList<QPair<QString, double> > layerTimes;
+  QList<LayerableTiming> layerableTimes;
+  
+  // counters:
+  int pointsDrawn;
+  int pointsSampledAway;
+  int cacheHits;
+  int cacheMisses;
+};
+Q_DECLARE_TYPEINFO(QCPReplotProfile::LayerableTiming, Q_MOVABLE_TYPE);
+Q_DECLARE_METATYPE(QCPReplotProfile)
+
+#endif // QCP_REPLOTPROFILE_H
@@ -1,5 +1,9 @@
 #include "test-qcustomplot/test-qcustomplot.h"
 #include "test-qcpgraph/test-qcpgraph.h"
+#include "test-qcpcurve/test-qcpcurve.h"
+#include "test-qcpbars/test-qcpbars.h"
+#include "test-qcpfinancial/test-qcpfinancial.h"
+#include "test-qcpboxplot/test-qcpboxplot.h"
 #include "test-colormap/test-colormap.h"
 #include "test-qcplayout/test-qcplayout.h"
 #include "test-qcpaxisrect/test-qcpaxisrect.h"
@@ -12,6 +16,10 @@ int main(int argc, char **argv)
   
   QCPTEST(TestQCustomPlot);
   QCPTEST(TestQCPGraph);
+  QCPTEST(TestQCPCurve);
+  QCPTEST(TestQCPBars);
+  QCPTEST(TestQCPFinancial);
+  QCPTEST(TestQCPBoxPlot);
   QCPTEST(TestColorMap);
   QCPTEST(TestQCPLayout);
   QCPTEST(TestQCPAxisRect);
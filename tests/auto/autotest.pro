@@ -9,6 +9,10 @@ INCLUDEPATH = .
 HEADERS += ../../qcustomplot.h \
     test-qcustomplot/test-qcustomplot.h\
     test-qcpgraph/test-qcpgraph.h \
+    test-qcpcurve/test-qcpcurve.h \
+    test-qcpbars/test-qcpbars.h \
+    test-qcpfinancial/test-qcpfinancial.h \
+    test-qcpboxplot/test-qcpboxplot.h \
     test-qcplayout/test-qcplayout.h \
     test-qcpaxisrect/test-qcpaxisrect.h \
     test-colormap/test-colormap.h
@@ -17,6 +21,10 @@ SOURCES += ../../qcustomplot.cpp \
            autotest.cpp \
     test-qcustomplot/test-qcustomplot.cpp\
     test-qcpgraph/test-qcpgraph.cpp \
+    test-qcpcurve/test-qcpcurve.cpp \
+    test-qcpbars/test-qcpbars.cpp \
+    test-qcpfinancial/test-qcpfinancial.cpp \
+    test-qcpboxplot/test-qcpboxplot.cpp \
     test-qcplayout/test-qcplayout.cpp \
     test-qcpaxisrect/test-qcpaxisrect.cpp \
     test-colormap/test-colormap.cpp
@@ -1,5 +1,72 @@
 #include "test-qcpaxisrect.h"
 
+// gives access to the tick label rendering paths of the axis painter:
+class GlyphTestAxisPainter : public QCPAxisPainterPrivate
+{
+public:
+  GlyphTestAxisPainter(QCustomPlot *parentPlot) : QCPAxisPainterPrivate(parentPlot) {}
+  
+  bool composable(const QString &text) const { return isGlyphComposable(text); }
+  QSize maxTickLabelSize(const QFont &font, const QString &text) const
+  {
+    QSize size;
+    getMaxTickLabelSize(font, text, &size);
+    return size;
+  }
+  QSize exactTickLabelSize(const QFont &font, const QString &text) const
+  {
+    return getTickLabelData(font, text).rotatedTotalBounds.size();
+  }
+  QImage renderLabel(const QFont &font, const QString &text, bool composed)
+  {
+    QImage image(200, 50, QImage::Format_ARGB32_Premultiplied);
+    image.fill(0);
+    QCPPainter painter(&image);
+    painter.setFont(font);
+    painter.setPen(Qt::black);
+    if (composed)
+    {
+      updateGlyphAtlas(font, Qt::black, text);
+      drawGlyphLabel(&painter, 10, 10, text);
+    } else
+      drawTickLabel(&painter, 10, 10, getTickLabelData(font, text));
+    painter.end();
+    return image;
+  }
+};
+
+// axis with a custom tick generation that depends on a parameter unknown to QCPAxis:
+class FixedTicksAxis : public QCPAxis
+{
+public:
+  FixedTicksAxis(QCPAxisRect *parent, AxisType type) : QCPAxis(parent, type), tickCount(3) {}
+  int tickCount;
+protected:
+  virtual void generateAutoTicks()
+  {
+    mTickVector.resize(tickCount);
+    for (int i=0; i<tickCount; ++i)
+      mTickVector[i] = mRange.lower+i*mRange.size()/(tickCount-1);
+    mTickStep = mRange.size()/(tickCount-1);
+    mSubTickCount = 0;
+  }
+};
+
+// returns the bounding rect of all pixels in image that aren't fully transparent:
+static QRect inkedRect(const QImage &image)
+{
+  QRect result;
+  for (int y=0; y<image.height(); ++y)
+  {
+    for (int x=0; x<image.width(); ++x)
+    {
+      if (qAlpha(image.pixel(x, y)) > 0)
+        result |= QRect(x, y, 1, 1);
+    }
+  }
+  return result;
+}
+
 void TestQCPAxisRect::init()
 {
   mPlot = new QCustomPlot(0);
@@ -195,15 +262,149 @@ void TestQCPAxisRect::axisRectRemovalConsequencesToItems()
   mPlot->replot();
 }
 
+void TestQCPAxisRect::smallMultiples()
+{
+  mPlot->setGeometry(50, 50, 400, 400);
+  mPlot->plotLayout()->clear();
+  for (int i=0; i<2*2; ++i)
+  {
+    QCPAxisRect *r = new QCPAxisRect(mPlot);
+    r->axis(QCPAxis::atBottom)->setRange(0, 10);
+    r->axis(QCPAxis::atLeft)->setRange(0, 10);
+    mPlot->plotLayout()->addElement(i/2, i%2, r);
+  }
+  QCPAxisRect *differentRect = mPlot->axisRect(3);
+  differentRect->axis(QCPAxis::atBottom)->setRange(-5, 1e4);
+  
+  // reference ticks and margins without sharing:
+  mPlot->replot();
+  QVector<double> referenceTicks = mPlot->axisRect(0)->axis(QCPAxis::atBottom)->tickVector();
+  QVector<double> differentTicks = differentRect->axis(QCPAxis::atBottom)->tickVector();
+  QMargins referenceMargins = mPlot->axisRect(0)->margins();
+  QMargins differentMargins = differentRect->margins();
+  QVERIFY(referenceTicks != differentTicks);
+  
+  // with shared ticks and label measurements, results must be identical:
+  mPlot->setPlottingHint(QCP::phSmallMultiples, true);
+  for (int i=0; i<mPlot->axisRectCount(); ++i)
+    mPlot->axisRect(i)->axis(QCPAxis::atBottom)->setRange(0, 20);
+  differentRect->axis(QCPAxis::atBottom)->setRange(-5, 1e4);
+  mPlot->replot();
+  for (int i=0; i<mPlot->axisRectCount(); ++i)
+    mPlot->axisRect(i)->axis(QCPAxis::atBottom)->setRange(0, 10);
+  differentRect->axis(QCPAxis::atBottom)->setRange(-5, 1e4);
+  mPlot->replot();
+  for (int i=0; i<3; ++i)
+  {
+    QCOMPARE(mPlot->axisRect(i)->axis(QCPAxis::atBottom)->tickVector(), referenceTicks);
+    QCOMPARE(mPlot->axisRect(i)->margins(), referenceMargins);
+  }
+  QCOMPARE(differentRect->axis(QCPAxis::atBottom)->tickVector(), differentTicks);
+  QCOMPARE(differentRect->margins(), differentMargins);
+}
 
+void TestQCPAxisRect::smallMultiplesVisibleRegion()
+{
+  // a tall grid of axis rects in a scroll area, only the top cells are visible at first:
+  QScrollArea scrollArea;
+  scrollArea.setGeometry(50, 50, 420, 300);
+  QCustomPlot *plot = new QCustomPlot;
+  plot->setFixedSize(400, 2000);
+  scrollArea.setWidget(plot);
+  plot->plotLayout()->clear();
+  for (int i=0; i<10; ++i)
+  {
+    QCPAxisRect *r = new QCPAxisRect(plot);
+    plot->plotLayout()->addElement(i, 0, r);
+  }
+  plot->setPlottingHint(QCP::phSmallMultiples, true);
+  plot->setProfiling(true);
+  scrollArea.show();
+  QTest::qWait(150);
+  
+  plot->replot();
+  QSet<const QCPLayerable*> drawn;
+  foreach (const QCPReplotProfile::LayerableTiming &timing, plot->replotProfile().layerableTimes)
+    drawn.insert(timing.layerable);
+  QVERIFY(drawn.contains(plot->axisRect(0)->axis(QCPAxis::atBottom)));
+  QVERIFY(!drawn.contains(plot->axisRect(9)->axis(QCPAxis::atBottom)));
+  
+  // scrolling exposes the bottom cells, which are then drawn by a replot:
+  scrollArea.ensureVisible(0, 2000);
+  QTest::qWait(150);
+  drawn.clear();
+  foreach (const QCPReplotProfile::LayerableTiming &timing, plot->replotProfile().layerableTimes)
+    drawn.insert(timing.layerable);
+  QVERIFY(drawn.contains(plot->axisRect(9)->axis(QCPAxis::atBottom)));
+  QVERIFY(!drawn.contains(plot->axisRect(0)->axis(QCPAxis::atBottom)));
+  
+  // without the hint, all cells are drawn:
+  plot->setPlottingHint(QCP::phSmallMultiples, false);
+  plot->replot();
+  drawn.clear();
+  foreach (const QCPReplotProfile::LayerableTiming &timing, plot->replotProfile().layerableTimes)
+    drawn.insert(timing.layerable);
+  QVERIFY(drawn.contains(plot->axisRect(0)->axis(QCPAxis::atBottom)));
+  QVERIFY(drawn.contains(plot->axisRect(9)->axis(QCPAxis::atBottom)));
+}
 
+void TestQCPAxisRect::glyphTickLabels()
+{
+  GlyphTestAxisPainter axisPainter(mPlot);
+  QFont font = mPlot->xAxis->tickLabelFont();
+  QStringList labels;
+  labels << "0" << "-12.5" << "3,141" << "2015-03-07" << "12:30:45" << "+0.001";
+  
+  mPlot->setPlottingHint(QCP::phCacheLabels, true);
+  foreach (const QString &text, labels)
+  {
+    QVERIFY(axisPainter.composable(text));
+    // the measured size of composed labels matches the exact measurement of the text as a whole:
+    QCOMPARE(axisPainter.maxTickLabelSize(font, text), axisPainter.exactTickLabelSize(font, text));
+    // composed labels cover the same pixels as labels drawn with drawText, allowing a pixel for anti-aliasing:
+    QRect composedRect = inkedRect(axisPainter.renderLabel(font, text, true));
+    QRect textRect = inkedRect(axisPainter.renderLabel(font, text, false));
+    QVERIFY(!textRect.isEmpty());
+    QVERIFY(qAbs(composedRect.left()-textRect.left()) <= 1);
+    QVERIFY(qAbs(composedRect.right()-textRect.right()) <= 1);
+    QVERIFY(qAbs(composedRect.top()-textRect.top()) <= 1);
+    QVERIFY(qAbs(composedRect.bottom()-textRect.bottom()) <= 1);
+  }
+  
+  // rotated labels are rendered as a whole, so their size is the exact one:
+  axisPainter.tickLabelRotation = 30;
+  foreach (const QString &text, labels)
+  {
+    QVERIFY(!axisPainter.composable(text));
+    QCOMPARE(axisPainter.maxTickLabelSize(font, text), axisPainter.exactTickLabelSize(font, text));
+  }
+}
 
-
-
-
-
-
-
-
-
-
+void TestQCPAxisRect::tickCacheInvalidation()
+{
+  FixedTicksAxis *axis = new FixedTicksAxis(mPlot->axisRect(), QCPAxis::atBottom);
+  mPlot->axisRect()->addAxis(QCPAxis::atBottom, axis);
+  axis->setRange(0, 10);
+  mPlot->replot();
+  QCOMPARE(axis->tickVector().size(), 3);
+  
+  // the override's own parameter isn't known to the tick cache, so the old ticks are reused:
+  axis->tickCount = 5;
+  mPlot->replot();
+  QCOMPARE(axis->tickVector().size(), 3);
+  
+  // after invalidation, the override takes effect:
+  axis->invalidateTickCache();
+  mPlot->replot();
+  QCOMPARE(axis->tickVector().size(), 5);
+  QCOMPARE(axis->tickVector().last(), 10.0);
+  
+  // in small multiples mode, the subclass doesn't share ticks with a regular axis of the same range:
+  mPlot->setPlottingHint(QCP::phSmallMultiples, true);
+  mPlot->xAxis->setRange(0, 10);
+  axis->tickCount = 7;
+  axis->invalidateTickCache();
+  mPlot->replot();
+  QCOMPARE(axis->tickVector().size(), 7);
+  QVERIFY(mPlot->xAxis->tickVector() != axis->tickVector());
+}
@@ -1,4 +1,5 @@
 #include <QtTest/QtTest>
+#include <QScrollArea>
 #include "../../../qcustomplot.h"
 
 class TestQCPAxisRect : public QObject
@@ -14,6 +15,10 @@ private slots:
   void axisRemovalConsequencesToItems();
   void axisRectRemovalConsequencesToPlottables();
   void axisRectRemovalConsequencesToItems();
+  void smallMultiples();
+  void smallMultiplesVisibleRegion();
+  void glyphTickLabels();
+  void tickCacheInvalidation();
   
 private:
   QCustomPlot *mPlot;
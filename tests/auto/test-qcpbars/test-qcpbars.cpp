@@ -0,0 +1,229 @@
+#include "test-qcpbars.h"
+
+void TestQCPBars::init()
+{
+  mPlot = new QCustomPlot(0);
+  mPlot->show();
+  QTest::qWait(150);
+}
+
+void TestQCPBars::cleanup()
+{
+  delete mPlot;
+}
+
+void TestQCPBars::stackBaseValues()
+{
+  QCPBars *bars1 = addBars(1);
+  QCPBars *bars2 = addBars(2);
+  QCPBars *bars3 = addBars(3);
+  bars2->moveAbove(bars1);
+  bars3->moveAbove(bars2);
+  bars3->rescaleValueAxis();
+  QCOMPARE(mPlot->yAxis->range().upper, 6.0);
+  
+  // changing data at the bottom of the stack must be reflected at the top:
+  bars1->setData(QVector<double>() << 1 << 2 << 3, QVector<double>() << 4 << 1 << 1);
+  bars3->rescaleValueAxis();
+  QCOMPARE(mPlot->yAxis->range().upper, 9.0);
+  bars1->removeData(1);
+  bars3->rescaleValueAxis();
+  QCOMPARE(mPlot->yAxis->range().upper, 6.0);
+  
+  // direct data manipulation requires explicit invalidation:
+  bars1->data()->insert(1, QCPBarData(1, 10));
+  bars1->invalidateStackCache();
+  bars3->rescaleValueAxis();
+  QCOMPARE(mPlot->yAxis->range().upper, 15.0);
+  
+  // negative bars are stacked separately:
+  bars2->addData(4, -2);
+  bars3->addData(4, -3);
+  bars3->rescaleValueAxis();
+  QCOMPARE(mPlot->yAxis->range().lower, -5.0);
+  
+  // taking the middle bars out of the stack:
+  bars2->moveAbove(0);
+  bars3->rescaleValueAxis();
+  QCOMPARE(mPlot->yAxis->range().upper, 13.0);
+  QCOMPARE(mPlot->yAxis->range().lower, -3.0);
+  
+  // the base value of the bottom bars shifts the whole stack:
+  bars1->setBaseValue(100);
+  bars3->rescaleValueAxis();
+  QCOMPARE(mPlot->yAxis->range().upper, 113.0);
+  
+  // deleting the bottom bars:
+  mPlot->removePlottable(bars1);
+  bars3->rescaleValueAxis();
+  QCOMPARE(mPlot->yAxis->range().upper, 3.0);
+}
+
+void TestQCPBars::groupKeyOffsets()
+{
+  mPlot->setGeometry(50, 50, 500, 500);
+  QCPBarsGroup *group = new QCPBarsGroup(mPlot);
+  QList<QCPBars*> bars;
+  for (int i=0; i<3; ++i)
+  {
+    bars << addBars(1);
+    bars.last()->setWidthType(QCPBars::wtAbsolute);
+    bars.last()->setWidth(10);
+    bars.last()->setBarsGroup(group);
+  }
+  group->setSpacingType(QCPBarsGroup::stAbsolute);
+  group->setSpacing(4);
+  mPlot->xAxis->setRange(0, 4);
+  mPlot->yAxis->setRange(0, 2);
+  mPlot->replot();
+  QVERIFY(hitsBarAt(bars.at(0), 2, -14));
+  QVERIFY(hitsBarAt(bars.at(1), 2, 0));
+  QVERIFY(hitsBarAt(bars.at(2), 2, 14));
+  
+  // changing the spacing and the width of one bars:
+  group->setSpacing(10);
+  bars.at(2)->setWidth(20);
+  QVERIFY(hitsBarAt(bars.at(0), 2, -20));
+  QVERIFY(!hitsBarAt(bars.at(0), 2, -14));
+  QVERIFY(hitsBarAt(bars.at(2), 2, 25));
+  
+  // offsets must follow key axis range changes:
+  mPlot->xAxis->setRange(1, 5);
+  mPlot->replot();
+  QVERIFY(hitsBarAt(bars.at(0), 3, -20));
+  
+  // stacking the last bars on the first leaves two stacks in the group:
+  bars.at(2)->moveAbove(bars.at(0));
+  QVERIFY(hitsBarAt(bars.at(0), 2, -10));
+  QVERIFY(hitsBarAt(bars.at(1), 2, 10));
+  
+  // spacing in plot coordinates keeps its pixel size when the key axis range is reversed:
+  group->setSpacingType(QCPBarsGroup::stPlotCoords);
+  group->setSpacing(mPlot->xAxis->pixelToCoord(20)-mPlot->xAxis->pixelToCoord(0));
+  QVERIFY(hitsBarAt(bars.at(0), 2, -15));
+  QVERIFY(hitsBarAt(bars.at(1), 2, 15));
+  mPlot->xAxis->setRangeReversed(true);
+  mPlot->replot();
+  QVERIFY(hitsBarAt(bars.at(0), 2, -15));
+  QVERIFY(hitsBarAt(bars.at(1), 2, 15));
+  QVERIFY(!hitsBarAt(bars.at(0), 2, -5));
+  mPlot->xAxis->setRangeReversed(false);
+  group->setSpacingType(QCPBarsGroup::stAbsolute);
+  
+  // removing bars from the group:
+  bars.at(1)->setBarsGroup(0);
+  QVERIFY(hitsBarAt(bars.at(0), 2, 0));
+}
+
+void TestQCPBars::vectorExportDecimation()
+{
+  const int n = 100000;
+  QVector<double> x(n), y(n);
+  for (int i=0; i<n; ++i)
+  {
+    x[i] = i;
+    y[i] = qSin(i*0.01)+(qrand()%1000)/1000.0;
+  }
+  QCPBars *bars = new QCPBars(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(bars);
+  bars->setData(x, y);
+  mPlot->rescaleAxes();
+  const QString fullFileName = QDir::temp().filePath("qcustomplot-test-bars-full.pdf");
+  const QString decimatedFileName = QDir::temp().filePath("qcustomplot-test-bars-decimated.pdf");
+  
+  QCOMPARE(mPlot->vectorResolution(), 0);
+  QVERIFY(mPlot->savePdf(fullFileName, false, 500, 300));
+  mPlot->setVectorResolution(72);
+  QVERIFY(mPlot->savePdf(decimatedFileName, false, 500, 300));
+  
+  // at 72 dpi, the 500 points wide plot has 500 dot columns in which the 100000 bars are merged:
+  QVERIFY(QFileInfo(decimatedFileName).size()*4 < QFileInfo(fullFileName).size());
+  
+  // without resolution, every bar is exported again:
+  mPlot->setVectorResolution(0);
+  QVERIFY(mPlot->savePdf(decimatedFileName, false, 500, 300));
+  QCOMPARE(QFileInfo(decimatedFileName).size(), QFileInfo(fullFileName).size());
+  QFile::remove(fullFileName);
+  QFile::remove(decimatedFileName);
+}
+
+void TestQCPBars::subPixelMerging()
+{
+  // many narrow bars, roughly twenty per pixel, drawn without anti-aliasing so pixel extents are exact:
+  const int n = 10000;
+  QVector<double> x(n), y(n);
+  for (int i=0; i<n; ++i)
+  {
+    x[i] = i;
+    y[i] = 1+(i*7)%13;
+  }
+  QCPBars *bars = new QCPBars(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(bars);
+  bars->setData(x, y);
+  bars->setWidth(0.5);
+  bars->setPen(QPen(Qt::black, 1));
+  bars->setBrush(Qt::black);
+  bars->setAntialiased(false);
+  bars->setAntialiasedFill(false);
+  mPlot->xAxis->setVisible(false);
+  mPlot->yAxis->setVisible(false);
+  mPlot->xAxis->grid()->setVisible(false);
+  mPlot->yAxis->grid()->setVisible(false);
+  mPlot->setGeometry(50, 50, 500, 300);
+  mPlot->xAxis->setRange(-1, n);
+  mPlot->yAxis->setRange(0, 15);
+  
+  // on screen, sub-pixel bars are merged to one bar per pixel column, all visible bars are accounted for:
+  mPlot->setProfiling(true);
+  mPlot->replot();
+  const int drawn = mPlot->replotProfile().pointsDrawn;
+  QVERIFY(drawn > 0);
+  QVERIFY(drawn <= mPlot->axisRect()->width()+1);
+  QCOMPARE(drawn+mPlot->replotProfile().pointsSampledAway, n);
+  
+  // the merged bars cover the same pixels as the unmerged drawing, which is used by vectorized painters:
+  QImage merged(mPlot->width(), mPlot->height(), QImage::Format_RGB32);
+  QImage unmerged(mPlot->width(), mPlot->height(), QImage::Format_RGB32);
+  merged.fill(qRgb(255, 255, 255));
+  unmerged.fill(qRgb(255, 255, 255));
+  {
+    QCPPainter painter(&merged);
+    mPlot->toPainter(&painter);
+  }
+  {
+    QCPPainter painter(&unmerged);
+    painter.setMode(QCPPainter::pmVectorized);
+    mPlot->toPainter(&painter);
+  }
+  for (int col=0; col<merged.width(); ++col)
+  {
+    int mergedTop = -1, unmergedTop = -1;
+    for (int row=0; row<merged.height() && (mergedTop < 0 || unmergedTop < 0); ++row)
+    {
+      if (mergedTop < 0 && merged.pixel(col, row) != qRgb(255, 255, 255))
+        mergedTop = row;
+      if (unmergedTop < 0 && unmerged.pixel(col, row) != qRgb(255, 255, 255))
+        unmergedTop = row;
+    }
+    QVERIFY(qAbs(mergedTop-unmergedTop) <= 1);
+  }
+  
+  // thicker outlines are drawn as polylines, the bars are merged the same way:
+  bars->setPen(QPen(Qt::black, 2));
+  mPlot->replot();
+  QCOMPARE(mPlot->replotProfile().pointsDrawn, drawn);
+}
+
+QCPBars *TestQCPBars::addBars(double value)
+{
+  QCPBars *bars = new QCPBars(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(bars);
+  bars->setData(QVector<double>() << 1 << 2 << 3, QVector<double>() << value << value << value);
+  return bars;
+}
+
+bool TestQCPBars::hitsBarAt(QCPBars *bars, double key, double pixelOffset)
+{
+  QPointF pos(mPlot->xAxis->coordToPixel(key)+pixelOffset, mPlot->yAxis->coordToPixel(0.5));
+  return bars->selectTest(pos, false) >= 0;
+}
@@ -0,0 +1,25 @@
+#include <QtTest/QtTest>
+#include "../../../qcustomplot.h"
+
+class TestQCPBars : public QObject
+{
+  Q_OBJECT
+private slots:
+  void init();
+  void cleanup();
+  
+  void stackBaseValues();
+  void groupKeyOffsets();
+  void vectorExportDecimation();
+  void subPixelMerging();
+  
+private:
+  QCustomPlot *mPlot;
+  
+  QCPBars *addBars(double value);
+  bool hitsBarAt(QCPBars *bars, double key, double pixelOffset);
+};
+
+
+
+
@@ -0,0 +1,132 @@
+#include "test-qcpboxplot.h"
+
+void TestQCPBoxPlot::init()
+{
+  mPlot = new QCustomPlot(0);
+  mPlot->setGeometry(50, 50, 500, 500);
+  mPlot->show();
+  QTest::qWait(150);
+  mBoxPlot = new QCPBoxPlot(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(mBoxPlot);
+}
+
+void TestQCPBoxPlot::cleanup()
+{
+  delete mPlot;
+}
+
+void TestQCPBoxPlot::samplesToBox()
+{
+  // quartiles are interpolated linearly between the sorted samples 1..9, 30 and -20 are beyond the whiskers:
+  QVector<double> samples;
+  samples << 7 << 3 << 30 << 1 << 9 << 5 << -20 << 2 << 8 << 4 << 6 << qQNaN();
+  QCPBoxPlotData box;
+  QVERIFY(QCPBoxPlot::samplesToBox(3, samples, 1.5, &box));
+  QCOMPARE(box.key, 3.0);
+  QCOMPARE(box.median, 5.0);
+  QCOMPARE(box.lowerQuartile, 2.5);
+  QCOMPARE(box.upperQuartile, 7.5);
+  QCOMPARE(box.minimum, 1.0);
+  QCOMPARE(box.maximum, 9.0);
+  QCOMPARE(box.outliers, QVector<double>() << -20 << 30);
+  
+  // without whisker factor, the whiskers reach the extremes:
+  QVERIFY(QCPBoxPlot::samplesToBox(3, samples, 0, &box));
+  QCOMPARE(box.minimum, -20.0);
+  QCOMPARE(box.maximum, 30.0);
+  QVERIFY(box.outliers.isEmpty());
+  
+  // even sample count, median between the two middle values:
+  samples.clear();
+  samples << 4 << 1 << 3 << 2;
+  QVERIFY(QCPBoxPlot::samplesToBox(0, samples, 1.5, &box));
+  QCOMPARE(box.median, 2.5);
+  QCOMPARE(box.lowerQuartile, 1.75);
+  QCOMPARE(box.upperQuartile, 3.25);
+  
+  // single and no valid samples:
+  QVERIFY(QCPBoxPlot::samplesToBox(0, QVector<double>() << 2, 1.5, &box));
+  QCOMPARE(box.minimum, 2.0);
+  QCOMPARE(box.median, 2.0);
+  QCOMPARE(box.maximum, 2.0);
+  QVERIFY(!QCPBoxPlot::samplesToBox(0, QVector<double>() << qQNaN(), 1.5, &box));
+  QVERIFY(!QCPBoxPlot::samplesToBox(0, QVector<double>(), 1.5, &box));
+}
+
+void TestQCPBoxPlot::parallelSamples()
+{
+  int n = 500;
+  QVector<double> keys(n);
+  QVector<QVector<double> > samples(n);
+  for (int i=0; i<n; ++i)
+  {
+    keys[i] = n-i; // unsorted keys
+    samples[i].resize(i%7 == 0 ? 0 : 50+(i*37)%300);
+    for (int k=0; k<samples[i].size(); ++k)
+      samples[i][k] = qSin(i*0.3+k*1.7)*(k%13)+i;
+  }
+  
+  // the parallel computation gives the same boxes as a single thread and as boxes computed one by one:
+  QCPBoxPlotDataMap single = QCPBoxPlot::samplesToBoxes(keys, samples, 1.5, 1);
+  QCPBoxPlotDataMap parallel = QCPBoxPlot::samplesToBoxes(keys, samples, 1.5, 4);
+  mBoxPlot->setSamples(keys, samples);
+  QCOMPARE(single.size(), n-(n+6)/7); // empty samples don't create boxes
+  QCOMPARE(parallel.size(), single.size());
+  QCOMPARE(mBoxPlot->data()->size(), single.size());
+  QCPBoxPlotDataMap::const_iterator it = single.constBegin();
+  QCPBoxPlotDataMap::const_iterator itParallel = parallel.constBegin();
+  for (; it != single.constEnd(); ++it, ++itParallel)
+  {
+    QCPBoxPlotData box;
+    QVERIFY(QCPBoxPlot::samplesToBox(it.key(), samples.at(n-int(it.key())), 1.5, &box));
+    QCOMPARE(itParallel.key(), it.key());
+    QCOMPARE(itParallel.value().median, box.median);
+    QCOMPARE(itParallel.value().lowerQuartile, box.lowerQuartile);
+    QCOMPARE(itParallel.value().upperQuartile, box.upperQuartile);
+    QCOMPARE(itParallel.value().minimum, box.minimum);
+    QCOMPARE(itParallel.value().maximum, box.maximum);
+    QCOMPARE(itParallel.value().outliers, box.outliers);
+    QCOMPARE(it.value().median, box.median);
+    QCOMPARE(it.value().outliers, box.outliers);
+  }
+  
+  // all boxes and outliers are drawn:
+  int outlierCount = 0;
+  for (it = single.constBegin(); it != single.constEnd(); ++it)
+    outlierCount += it.value().outliers.size();
+  mPlot->rescaleAxes();
+  mPlot->setProfiling(true);
+  mPlot->replot();
+  QCOMPARE(mPlot->replotProfile().pointsDrawn, single.size()+outlierCount);
+  
+  // added samples are appended to the existing boxes:
+  mBoxPlot->addSamples(n+1, QVector<double>() << 1 << 2 << 3);
+  QCOMPARE(mBoxPlot->data()->size(), single.size()+1);
+  QCOMPARE(mBoxPlot->data()->value(n+1).median, 2.0);
+}
+
+void TestQCPBoxPlot::selectTest()
+{
+  for (int i=0; i<10000; ++i)
+    mBoxPlot->addData(i, -2, -1, 0, 1, 2);
+  mBoxPlot->setWidth(0.5);
+  mPlot->xAxis->setRange(0, 20);
+  mPlot->yAxis->setRange(-3, 3);
+  mPlot->replot();
+  double tolerance = mPlot->selectionTolerance();
+  
+  // inside a box:
+  QPointF pos(mPlot->xAxis->coordToPixel(10.1), mPlot->yAxis->coordToPixel(0.5));
+  QVERIFY(mBoxPlot->selectTest(pos, false) < tolerance);
+  // on a whisker:
+  pos = QPointF(mPlot->xAxis->coordToPixel(5), mPlot->yAxis->coordToPixel(1.5));
+  QVERIFY(mBoxPlot->selectTest(pos, false) < 1);
+  // between boxes, the distance to the closest whisker is returned:
+  pos = QPointF(mPlot->xAxis->coordToPixel(10.5), mPlot->yAxis->coordToPixel(1.5));
+  double keyPixelDistance = mPlot->xAxis->coordToPixel(10.5)-mPlot->xAxis->coordToPixel(10);
+  QVERIFY(keyPixelDistance > tolerance);
+  QVERIFY(qAbs(mBoxPlot->selectTest(pos, false)-keyPixelDistance) < 1);
+  // above the whiskers:
+  pos = QPointF(mPlot->xAxis->coordToPixel(10), mPlot->yAxis->coordToPixel(2.5));
+  QCOMPARE(mBoxPlot->selectTest(pos, false), -1.0);
+}
@@ -0,0 +1,22 @@
+#include <QtTest/QtTest>
+#include "../../../qcustomplot.h"
+
+class TestQCPBoxPlot : public QObject
+{
+  Q_OBJECT
+private slots:
+  void init();
+  void cleanup();
+  
+  void samplesToBox();
+  void parallelSamples();
+  void selectTest();
+  
+private:
+  QCustomPlot *mPlot;
+  QCPBoxPlot *mBoxPlot;
+};
+
+
+
+
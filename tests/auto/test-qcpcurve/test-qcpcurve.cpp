@@ -0,0 +1,225 @@
+#include "test-qcpcurve.h"
+
+void TestQCPCurve::init()
+{
+  mPlot = new QCustomPlot(0);
+  mPlot->setGeometry(50, 50, 500, 500);
+  mPlot->show();
+  QTest::qWait(150);
+  mCurve = new QCPCurve(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(mCurve);
+}
+
+void TestQCPCurve::cleanup()
+{
+  delete mPlot;
+}
+
+void TestQCPCurve::compactDataLayout()
+{
+  QVector<double> t, x, y;
+  t << 2 << 0 << 1 << 3;
+  x << 1 << -1 << 0 << 2;
+  y << 3 <<  1 << 0 << 2;
+  mCurve->setData(t, x, y);
+  
+  // switching layout converts existing data, sorted by t:
+  mCurve->setDataLayout(QCPCurve::dlCompact);
+  QCOMPARE(mCurve->dataLayout(), QCPCurve::dlCompact);
+  QVERIFY(mCurve->data()->isEmpty());
+  QCOMPARE(mCurve->dataCount(), 4);
+  QCOMPARE(mCurve->compactData()->t(0), 0.0);
+  QCOMPARE(mCurve->compactData()->key(0), -1.0);
+  QCOMPARE(mCurve->compactData()->value(0), 1.0);
+  QCOMPARE(mCurve->compactData()->t(3), 3.0);
+  QCOMPARE(mCurve->compactData()->key(3), 2.0);
+  
+  // appending without t continues after the last curve parameter:
+  mCurve->addData(4, 4);
+  QCOMPARE(mCurve->dataCount(), 5);
+  QCOMPARE(mCurve->compactData()->t(4), 4.0);
+  QCOMPARE(mCurve->compactData()->value(4), 4.0);
+  // out of order points are inserted at the right position:
+  mCurve->addData(1.5, 5, 5);
+  QCOMPARE(mCurve->dataCount(), 6);
+  QCOMPARE(mCurve->compactData()->t(2), 1.5);
+  QCOMPARE(mCurve->compactData()->key(2), 5.0);
+  
+  // removing data in compact layout:
+  mCurve->removeData(1.5);
+  QCOMPARE(mCurve->dataCount(), 5);
+  QCOMPARE(mCurve->compactData()->t(2), 2.0);
+  mCurve->removeDataAfter(3);
+  QCOMPARE(mCurve->dataCount(), 4);
+  mCurve->removeDataBefore(1);
+  QCOMPARE(mCurve->dataCount(), 3);
+  QCOMPARE(mCurve->compactData()->t(0), 1.0);
+  mCurve->removeData(1.5, 2.5);
+  QCOMPARE(mCurve->dataCount(), 2);
+  QCOMPARE(mCurve->compactData()->t(1), 3.0);
+  
+  // rolling window, points removed from the front aren't visible anymore:
+  for (int i=0; i<1000; ++i)
+  {
+    mCurve->addData(i, -i);
+    mCurve->removeDataBefore(mCurve->compactData()->t(mCurve->dataCount()-1)-9);
+  }
+  QCOMPARE(mCurve->dataCount(), 10);
+  QCOMPARE(mCurve->compactData()->key(0), 990.0);
+  QCOMPARE(mCurve->compactData()->value(9), -999.0);
+  
+  // rescaling and replotting work with compact layout:
+  mCurve->rescaleAxes();
+  QCOMPARE(mPlot->xAxis->range(), QCPRange(990, 999));
+  QCOMPARE(mPlot->yAxis->range(), QCPRange(-999, -990));
+  mCurve->setScatterStyle(QCPScatterStyle::ssCircle);
+  mPlot->replot();
+  
+  // switching back restores the map:
+  mCurve->setDataLayout(QCPCurve::dlMap);
+  QCOMPARE(mCurve->data()->size(), 10);
+  QCOMPARE(mCurve->compactData()->size(), 0);
+  QCOMPARE(mCurve->data()->constBegin().value().key, 990.0);
+  QCOMPARE((mCurve->data()->constEnd()-1).value().value, -999.0);
+}
+
+void TestQCPCurve::adaptiveSampling()
+{
+  // dense spiral that is fully visible, consecutive points are much less than a pixel apart:
+  int n = 200000;
+  QVector<double> t(n), x(n), y(n);
+  for (int i=0; i<n; ++i)
+  {
+    t[i] = i;
+    double phi = i/(double)n*20*2*M_PI;
+    double r = 0.2+0.8*i/(double)n;
+    x[i] = r*qCos(phi);
+    y[i] = r*qSin(phi);
+  }
+  mCurve->setData(t, x, y);
+  mCurve->rescaleAxes();
+  mPlot->xAxis->scaleRange(1.1, 0);
+  mPlot->yAxis->scaleRange(1.1, 0);
+  mPlot->setProfiling(true);
+  
+  mCurve->setAdaptiveSampling(false);
+  mPlot->replot();
+  QCOMPARE(mPlot->replotProfile().pointsDrawn, n);
+  
+  mCurve->setAdaptiveSampling(true);
+  mPlot->replot();
+  int drawn = mPlot->replotProfile().pointsDrawn;
+  QVERIFY(drawn > 0);
+  QVERIFY(drawn < n/4);
+  QCOMPARE(drawn+mPlot->replotProfile().pointsSampledAway, n);
+  
+  // every data point stays within one pixel of the drawn line:
+  for (int i=0; i<n; i+=n/97)
+  {
+    QPointF pixel(mPlot->xAxis->coordToPixel(x.at(i)), mPlot->yAxis->coordToPixel(y.at(i)));
+    double distance = mCurve->selectTest(pixel, false);
+    QVERIFY(distance >= 0 && distance <= 1.0);
+  }
+  // the end points of the curve are kept:
+  QVERIFY(mCurve->selectTest(QPointF(mPlot->xAxis->coordToPixel(x.last()), mPlot->yAxis->coordToPixel(y.last())), false) < 1e-3);
+  QVERIFY(mCurve->selectTest(QPointF(mPlot->xAxis->coordToPixel(x.first()), mPlot->yAxis->coordToPixel(y.first())), false) < 1e-3);
+  
+  // points outside the visible rect aren't counted as sampled away:
+  mCurve->setAdaptiveSampling(false);
+  mPlot->xAxis->setRange(0, 2);
+  mPlot->replot();
+  QVERIFY(mPlot->replotProfile().pointsDrawn < n);
+  QCOMPARE(mPlot->replotProfile().pointsSampledAway, 0);
+}
+
+void TestQCPCurve::segmentIndex()
+{
+  // irregular closed Lissajous figure, drawn without sampling so the curve line consists of all points:
+  int n = 5000;
+  QVector<double> t(n), x(n), y(n);
+  for (int i=0; i<n; ++i)
+  {
+    t[i] = i;
+    double phi = i/(double)(n-1)*2*M_PI;
+    x[i] = qSin(3*phi)+0.05*qSin(41*phi);
+    y[i] = qSin(4*phi+0.5);
+  }
+  mCurve->setData(t, x, y);
+  mCurve->setAdaptiveSampling(false);
+  mPlot->xAxis->setRange(-1.5, 1.5);
+  mPlot->yAxis->setRange(-1.5, 1.5);
+  mPlot->replot();
+  
+  QVector<QPointF> polyline(n);
+  for (int i=0; i<n; ++i)
+    polyline[i] = QPointF(mPlot->xAxis->coordToPixel(x.at(i)), mPlot->yAxis->coordToPixel(y.at(i)));
+  
+  // indexed distances match the distance to the full polyline, close to the curve as well as far from it:
+  QRect rect = mPlot->axisRect()->rect();
+  for (int i=0; i<200; ++i)
+  {
+    QPointF pixel(rect.left()+1+(i*37)%(rect.width()-2), rect.top()+1+(i*91)%(rect.height()-2));
+    double expected = distanceToPolyline(polyline, pixel);
+    QVERIFY(qAbs(mCurve->selectTest(pixel, false)-expected) < 1e-3);
+  }
+  
+  // changing data invalidates the index:
+  QPointF center(mPlot->xAxis->coordToPixel(0), mPlot->yAxis->coordToPixel(1.4));
+  QVERIFY(mCurve->selectTest(center, false) > 1);
+  mCurve->addData(n, 0, 1.4);
+  QVERIFY(mCurve->selectTest(center, false) < 1e-3);
+  
+  // changing the axis range invalidates the index:
+  mPlot->yAxis->setRange(-1.5, 2.5);
+  center = QPointF(mPlot->xAxis->coordToPixel(0), mPlot->yAxis->coordToPixel(1.4));
+  QVERIFY(mCurve->selectTest(center, false) < 1e-3);
+}
+
+void TestQCPCurve::vectorExportDecimation()
+{
+  // dense spiral, exported without adaptive sampling for the screen:
+  const int n = 200000;
+  QVector<double> t(n), x(n), y(n);
+  for (int i=0; i<n; ++i)
+  {
+    t[i] = i;
+    double phi = i/(double)n*20*2*M_PI;
+    double r = 0.2+0.8*i/(double)n;
+    x[i] = r*qCos(phi);
+    y[i] = r*qSin(phi);
+  }
+  mCurve->setData(t, x, y);
+  mCurve->setAdaptiveSampling(false);
+  mCurve->rescaleAxes();
+  const QString fullFileName = QDir::temp().filePath("qcustomplot-test-curve-full.pdf");
+  const QString decimatedFileName = QDir::temp().filePath("qcustomplot-test-curve-decimated.pdf");
+  
+  QCOMPARE(mPlot->vectorResolution(), 0);
+  QVERIFY(mPlot->savePdf(fullFileName, false, 500, 300));
+  mPlot->setVectorResolution(72);
+  QVERIFY(mPlot->savePdf(decimatedFileName, false, 500, 300));
+  
+  // at 72 dpi, points closer than one point (1/72 inch) to the previous one are left out:
+  QVERIFY(QFileInfo(decimatedFileName).size()*4 < QFileInfo(fullFileName).size());
+  
+  // without resolution, every point is exported again:
+  mPlot->setVectorResolution(0);
+  QVERIFY(mPlot->savePdf(decimatedFileName, false, 500, 300));
+  QCOMPARE(QFileInfo(decimatedFileName).size(), QFileInfo(fullFileName).size());
+  QFile::remove(fullFileName);
+  QFile::remove(decimatedFileName);
+}
+
+double TestQCPCurve::distanceToPolyline(const QVector<QPointF> &polyline, const QPointF &point) const
+{
+  double minDistSqr = std::numeric_limits<double>::max();
+  for (int i=0; i<polyline.size()-1; ++i)
+  {
+    QVector2D a(polyline.at(i)), b(polyline.at(i+1)), p(point);
+    QVector2D v = b-a;
+    double lengthSqr = v.lengthSquared();
+    double mu = lengthSqr > 0 ? qBound(0.0, double(QVector2D::dotProduct(p-a, v))/lengthSqr, 1.0) : 0;
+    minDistSqr = qMin(minDistSqr, double(((a+mu*v)-p).lengthSquared()));
+  }
+  return qSqrt(minDistSqr);
+}
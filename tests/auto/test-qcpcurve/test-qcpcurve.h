@@ -0,0 +1,25 @@
+#include <QtTest/QtTest>
+#include "../../../qcustomplot.h"
+
+class TestQCPCurve : public QObject
+{
+  Q_OBJECT
+private slots:
+  void init();
+  void cleanup();
+  
+  void compactDataLayout();
+  void adaptiveSampling();
+  void segmentIndex();
+  void vectorExportDecimation();
+  
+private:
+  double distanceToPolyline(const QVector<QPointF> &polyline, const QPointF &point) const;
+  
+  QCustomPlot *mPlot;
+  QCPCurve *mCurve;
+};
+
+
+
+
@@ -0,0 +1,185 @@
+#include "test-qcpfinancial.h"
+
+void TestQCPFinancial::init()
+{
+  mPlot = new QCustomPlot(0);
+  mPlot->setGeometry(50, 50, 500, 500);
+  mPlot->show();
+  QTest::qWait(150);
+  mFinancial = new QCPFinancial(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(mFinancial);
+}
+
+void TestQCPFinancial::cleanup()
+{
+  delete mPlot;
+}
+
+void TestQCPFinancial::adaptiveBinning()
+{
+  int n = 100000;
+  QVector<double> time(n), value(n);
+  for (int i=0; i<n; ++i)
+  {
+    time[i] = i*60;
+    value[i] = qSin(i/1000.0)+i/50000.0;
+  }
+  QCPFinancialDataMap data = QCPFinancial::timeSeriesToOhlc(time, value, 60);
+  mFinancial->setData(&data, true);
+  mFinancial->setWidth(50);
+  mFinancial->setChartStyle(QCPFinancial::csCandlestick);
+  mPlot->rescaleAxes();
+  mPlot->setProfiling(true);
+  
+  // zoomed out, only a few candlesticks per pixel are drawn, all data points are accounted for:
+  mPlot->replot();
+  int drawn = mPlot->replotProfile().pointsDrawn;
+  QVERIFY(drawn > 0);
+  QVERIFY(drawn < 500);
+  QCOMPARE(drawn+mPlot->replotProfile().pointsSampledAway, n);
+  
+  // zoomed in, candlesticks are wide enough and all are drawn:
+  mPlot->xAxis->setRange(0, 100*60);
+  mPlot->replot();
+  QCOMPARE(mPlot->replotProfile().pointsSampledAway, 0);
+  QVERIFY(mPlot->replotProfile().pointsDrawn >= 100);
+  
+  // adding data discards the binned levels, the new data point is drawn in the zoomed out view:
+  mFinancial->addData(n*60, 0, 100, -100, 0);
+  mPlot->rescaleAxes();
+  mPlot->replot();
+  QCOMPARE(mPlot->replotProfile().pointsDrawn+mPlot->replotProfile().pointsSampledAway, n+1);
+  QCOMPARE(mPlot->yAxis->range().upper, 100.0);
+  
+  // without adaptive binning, everything is drawn:
+  mFinancial->setAdaptiveBinning(false);
+  mPlot->replot();
+  QCOMPARE(mPlot->replotProfile().pointsDrawn, n+1);
+  QCOMPARE(mPlot->replotProfile().pointsSampledAway, 0);
+}
+
+void TestQCPFinancial::adaptiveBinningSpacing()
+{
+  // thin candlesticks that are far apart on screen aren't combined, even though each is narrower than a pixel:
+  int n = 100;
+  QVector<double> time(n), value(n);
+  for (int i=0; i<n; ++i)
+  {
+    time[i] = i*60;
+    value[i] = qSin(i/10.0);
+  }
+  QCPFinancialDataMap data = QCPFinancial::timeSeriesToOhlc(time, value, 60);
+  mFinancial->setData(&data, true);
+  mFinancial->setWidth(0.1);
+  mFinancial->setChartStyle(QCPFinancial::csCandlestick);
+  mPlot->rescaleAxes();
+  mPlot->setProfiling(true);
+  mPlot->replot();
+  QCOMPARE(mPlot->replotProfile().pointsDrawn, n);
+  QCOMPARE(mPlot->replotProfile().pointsSampledAway, 0);
+  
+  // once the spacing drops below a few pixels, neighbouring candlesticks are combined:
+  mPlot->xAxis->setRange(0, n*60*100);
+  mPlot->replot();
+  QVERIFY(mPlot->replotProfile().pointsSampledAway > 0);
+  QCOMPARE(mPlot->replotProfile().pointsDrawn+mPlot->replotProfile().pointsSampledAway, n);
+}
+
+void TestQCPFinancial::tickAggregation()
+{
+  int n = 20000;
+  QVector<double> time(n), value(n);
+  for (int i=0; i<n; ++i)
+  {
+    time[i] = 1000+i*7;
+    value[i] = qSin(i/100.0)*10+qCos(i*0.7);
+  }
+  
+  // no bin size set, ticks are rejected:
+  mFinancial->addTick(0, 1);
+  QCOMPARE(mFinancial->data()->size(), 0);
+  
+  // streamed ticks produce the same bins as the batch conversion:
+  mFinancial->setTickBinSize(60);
+  mFinancial->setTickBinOffset(30);
+  mFinancial->setWidth(50);
+  mFinancial->addTicks(time.mid(0, n/2), value.mid(0, n/2));
+  mPlot->rescaleAxes();
+  mPlot->setProfiling(true);
+  mPlot->replot(); // calculates levels of adaptive binning, which are then updated by the following ticks
+  for (int i=n/2; i<n; ++i)
+    mFinancial->addTick(time.at(i), value.at(i));
+  QCPFinancialDataMap expected = QCPFinancial::timeSeriesToOhlc(time, value, 60, 30);
+  QCOMPARE(mFinancial->data()->size(), expected.size());
+  QCPFinancialDataMap::const_iterator it = mFinancial->data()->constBegin();
+  QCPFinancialDataMap::const_iterator itExpected = expected.constBegin();
+  for (; it != mFinancial->data()->constEnd(); ++it, ++itExpected)
+  {
+    QCOMPARE(it.key(), itExpected.key());
+    QCOMPARE(it.value().open, itExpected.value().open);
+    QCOMPARE(it.value().high, itExpected.value().high);
+    QCOMPARE(it.value().low, itExpected.value().low);
+    QCOMPARE(it.value().close, itExpected.value().close);
+  }
+  
+  // incrementally updated levels draw the same as recalculated ones:
+  mPlot->rescaleAxes();
+  mPlot->replot();
+  int drawn = mPlot->replotProfile().pointsDrawn;
+  QVERIFY(mPlot->replotProfile().pointsSampledAway > 0);
+  mFinancial->invalidateBinnedLevels();
+  mPlot->replot();
+  QCOMPARE(mPlot->replotProfile().pointsDrawn, drawn);
+  
+  // late ticks update high/low of older bins, but open/close only if they are outside the bin's tick times:
+  QCPFinancialData lateBin = (expected.constBegin()+5).value();
+  double lateKey = lateBin.key;
+  mFinancial->addTick(lateKey, 1000);
+  QCOMPARE(mFinancial->data()->value(lateKey).high, 1000.0);
+  QCOMPARE(mFinancial->data()->value(lateKey).open, lateBin.open);
+  QCOMPARE(mFinancial->data()->value(lateKey).close, lateBin.close);
+  mFinancial->addTick(lateKey-29, -1000);
+  QCOMPARE(mFinancial->data()->value(lateKey).low, -1000.0);
+  QCOMPARE(mFinancial->data()->value(lateKey).open, -1000.0);
+  QCOMPARE(mFinancial->data()->value(lateKey).close, lateBin.close);
+  mFinancial->addTick(lateKey+29, 5);
+  QCOMPARE(mFinancial->data()->value(lateKey).close, 5.0);
+  QCOMPARE(mFinancial->data()->size(), expected.size());
+  
+  // out-of-order tick inside the newest bin doesn't replace its close:
+  QCPFinancialData newestBin = (mFinancial->data()->constEnd()-1).value();
+  mFinancial->addTick(time.last()-1, 2000);
+  QCOMPARE((mFinancial->data()->constEnd()-1).value().high, 2000.0);
+  QCOMPARE((mFinancial->data()->constEnd()-1).value().close, newestBin.close);
+}
+
+void TestQCPFinancial::selectTest()
+{
+  for (int i=0; i<100000; ++i)
+    mFinancial->addData(i, 0, 2, -1, 1);
+  mFinancial->setWidth(0.5);
+  mPlot->xAxis->setRange(0, 20);
+  mPlot->yAxis->setRange(-2, 3);
+  mPlot->replot();
+  double tolerance = mPlot->selectionTolerance();
+  
+  // inside open-close box:
+  mFinancial->setChartStyle(QCPFinancial::csCandlestick);
+  QPointF pos(mPlot->xAxis->coordToPixel(10), mPlot->yAxis->coordToPixel(0.5));
+  QVERIFY(mFinancial->selectTest(pos, false) < tolerance);
+  // on high line:
+  pos = QPointF(mPlot->xAxis->coordToPixel(5), mPlot->yAxis->coordToPixel(1.5));
+  QVERIFY(mFinancial->selectTest(pos, false) < 1);
+  // between candlesticks, the distance to the closest one is returned:
+  pos = QPointF(mPlot->xAxis->coordToPixel(10.5), mPlot->yAxis->coordToPixel(1.5));
+  double keyPixelDistance = mPlot->xAxis->coordToPixel(10.5)-mPlot->xAxis->coordToPixel(10);
+  QVERIFY(keyPixelDistance > tolerance);
+  QVERIFY(qAbs(mFinancial->selectTest(pos, false)-keyPixelDistance) < 1);
+  
+  // on OHLC backbone:
+  mFinancial->setChartStyle(QCPFinancial::csOhlc);
+  pos = QPointF(mPlot->xAxis->coordToPixel(7), mPlot->yAxis->coordToPixel(-0.5));
+  QVERIFY(mFinancial->selectTest(pos, false) < 1);
+  pos = QPointF(mPlot->xAxis->coordToPixel(7.5), mPlot->yAxis->coordToPixel(-0.5));
+  QVERIFY(qAbs(mFinancial->selectTest(pos, false)-keyPixelDistance) < 1);
+}
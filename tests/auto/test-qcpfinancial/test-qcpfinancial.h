@@ -0,0 +1,23 @@
+#include <QtTest/QtTest>
+#include "../../../qcustomplot.h"
+
+class TestQCPFinancial : public QObject
+{
+  Q_OBJECT
+private slots:
+  void init();
+  void cleanup();
+  
+  void adaptiveBinning();
+  void adaptiveBinningSpacing();
+  void tickAggregation();
+  void selectTest();
+  
+private:
+  QCustomPlot *mPlot;
+  QCPFinancial *mFinancial;
+};
+
+
+
+
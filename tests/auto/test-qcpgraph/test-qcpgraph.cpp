@@ -152,6 +152,170 @@ void TestQCPGraph::dataManipulation()
   QCOMPARE((mGraph->data()->begin()+6).value().value, 6.0);
 }
 
+void TestQCPGraph::compactDataLayout()
+{
+  QVector<double> x, y;
+  x << -1 << 1 << -2 << 2;
+  y <<  1 << 2 <<  0 << 3;
+  mGraph->setData(x, y);
+  
+  // switching layout converts existing data:
+  mGraph->setDataLayout(QCPGraph::dlCompact);
+  QCOMPARE(mGraph->dataLayout(), QCPGraph::dlCompact);
+  QVERIFY(mGraph->data()->isEmpty());
+  QCOMPARE(mGraph->dataCount(), 4);
+  QCOMPARE(mGraph->compactData()->key(0), -2.0);
+  QCOMPARE(mGraph->compactData()->key(3), 2.0);
+  QCOMPARE(mGraph->compactData()->value(0), 0.0);
+  QCOMPARE(mGraph->compactData()->value(3), 3.0);
+  QVERIFY(!mGraph->compactData()->hasKeyErrors());
+  QVERIFY(!mGraph->compactData()->hasValueErrors());
+  
+  // data manipulation in compact layout (data should stay sorted by key):
+  mGraph->addData(0.5, 1.5);
+  QCOMPARE(mGraph->dataCount(), 5);
+  QCOMPARE(mGraph->compactData()->key(2), 0.5);
+  QCOMPARE(mGraph->compactData()->value(2), 1.5);
+  mGraph->addData(QVector<double>() << 3 << 4, QVector<double>() << 4 << 5);
+  QCOMPARE(mGraph->dataCount(), 7);
+  QCOMPARE(mGraph->compactData()->value(6), 5.0);
+  mGraph->removeDataBefore(0);
+  QCOMPARE(mGraph->dataCount(), 5);
+  QCOMPARE(mGraph->compactData()->key(0), 0.5);
+  mGraph->removeDataAfter(3);
+  QCOMPARE(mGraph->dataCount(), 4);
+  mGraph->removeData(0.9, 1.1);
+  QCOMPARE(mGraph->dataCount(), 3);
+  mGraph->removeData(2);
+  QCOMPARE(mGraph->dataCount(), 2);
+  QCOMPARE(mGraph->compactData()->key(0), 0.5);
+  QCOMPARE(mGraph->compactData()->key(1), 3.0);
+  
+  // error columns are only allocated when error data is passed:
+  mGraph->setDataValueError(x, y, QVector<double>() << 0.1 << 0.2 << 0.3 << 0.4);
+  QVERIFY(!mGraph->compactData()->hasKeyErrors());
+  QVERIFY(mGraph->compactData()->hasValueErrors());
+  QCOMPARE(mGraph->compactData()->at(0).valueErrorPlus, 0.3);
+  QCOMPARE(mGraph->compactData()->at(0).keyErrorPlus, 0.0);
+  
+  // single precision values:
+  mGraph->setDataLayout(QCPGraph::dlCompactFloat);
+  QCOMPARE(mGraph->compactData()->valuePrecision(), QCPCompactData::vpFloat);
+  QCOMPARE(mGraph->dataCount(), 4);
+  QCOMPARE(mGraph->compactData()->value(3), 3.0);
+  
+  // rescaling and replotting work with compact layout:
+  mGraph->rescaleAxes();
+  QCOMPARE(mPlot->xAxis->range(), QCPRange(-2, 2));
+  QCOMPARE(mPlot->yAxis->range(), QCPRange(0, 3));
+  mGraph->setErrorType(QCPGraph::etValue);
+  mGraph->setScatterStyle(QCPScatterStyle::ssCircle);
+  mPlot->replot();
+  
+  // switching back restores the map:
+  mGraph->setDataLayout(QCPGraph::dlMap);
+  QCOMPARE(mGraph->data()->size(), 4);
+  QCOMPARE(mGraph->compactData()->size(), 0);
+  QCOMPARE((mGraph->data()->begin()+0).value().key, -2.0);
+  QCOMPARE((mGraph->data()->begin()+0).value().valueErrorMinus, 0.3);
+}
+
+void TestQCPGraph::zeroCopyData()
+{
+  mGraph->setDataLayout(QCPGraph::dlCompact);
+  
+  // adopting vectors takes over their buffers:
+  QVector<double> x, y;
+  x << 1 << 2 << 3;
+  y << 4 << 5 << 6;
+  mGraph->adoptData(x, y);
+  QVERIFY(x.isEmpty());
+  QVERIFY(y.isEmpty());
+  QCOMPARE(mGraph->dataCount(), 3);
+  QCOMPARE(mGraph->compactData()->value(2), 6.0);
+  QCOMPARE(mGraph->compactData()->lowerBound(2).value().value, 5.0);
+  
+  // external arrays are referenced until the data is modified:
+  double keys[] = {-1, 0, 1, 2};
+  double values[] = {3, 2, 1, 0};
+  mGraph->setExternalData(keys, values, 4);
+  QVERIFY(mGraph->compactData()->isExternal());
+  QCOMPARE(mGraph->dataCount(), 4);
+  QCOMPARE(mGraph->compactData()->upperBoundIndex(0), 2);
+  values[1] = 7;
+  QCOMPARE(mGraph->compactData()->value(1), 7.0);
+  mPlot->rescaleAxes();
+  mPlot->replot();
+  mGraph->addData(3, 4);
+  QVERIFY(!mGraph->compactData()->isExternal());
+  QCOMPARE(mGraph->dataCount(), 5);
+  values[1] = 8;
+  QCOMPARE(mGraph->compactData()->value(1), 7.0);
+  
+  // unsorted external keys are copied and sorted:
+  double unsortedKeys[] = {2, 1, 3};
+  mGraph->setExternalData(unsortedKeys, values, 3);
+  QVERIFY(!mGraph->compactData()->isExternal());
+  QCOMPARE(mGraph->compactData()->key(0), 1.0);
+  QCOMPARE(mGraph->compactData()->value(0), 8.0);
+  
+  // map layout copies the data:
+  mGraph->setDataLayout(QCPGraph::dlMap);
+  mGraph->setExternalData(keys, values, 4);
+  QCOMPARE(mGraph->data()->size(), 4);
+}
+
+void TestQCPGraph::dataQueue()
+{
+  QVERIFY(!mGraph->dataQueue());
+  mGraph->setDataQueueCapacity(5);
+  QCPDataQueue<QCPData> *queue = mGraph->dataQueue();
+  QVERIFY(queue);
+  QVERIFY(queue->capacity() >= 5);
+  QVERIFY(queue->isEmpty());
+  
+  // queued points are applied on replot:
+  QVERIFY(queue->push(QCPData(1, 2)));
+  QVERIFY(queue->push(QCPData(2, 3)));
+  QCOMPARE(queue->size(), 2);
+  QVERIFY(mGraph->data()->isEmpty());
+  mPlot->replot();
+  QVERIFY(queue->isEmpty());
+  QCOMPARE(mGraph->data()->size(), 2);
+  QCOMPARE(mGraph->data()->value(2).value, 3.0);
+  
+  // points that don't fit are dropped and counted:
+  QVector<QCPData> batch;
+  for (int i=0; i<queue->capacity()+3; ++i)
+    batch.append(QCPData(10+i, i));
+  QCOMPARE(queue->push(batch.constData(), batch.size()), queue->capacity());
+  QCOMPARE(queue->freeSpace(), 0);
+  QCOMPARE(queue->droppedCount(), 3);
+  QVERIFY(!queue->push(QCPData(0, 0)));
+  QCOMPARE(queue->resetDroppedCount(), 4);
+  QCOMPARE(queue->droppedCount(), 0);
+  
+  // wrap around the ring buffer several times:
+  mPlot->replot();
+  QCOMPARE(mGraph->data()->size(), 2+queue->capacity());
+  mGraph->clearData();
+  for (int round=0; round<5; ++round)
+  {
+    for (int i=0; i<3; ++i)
+      QVERIFY(queue->push(QCPData(round*3+i, i)));
+    mPlot->replot();
+  }
+  QCOMPARE(mGraph->data()->size(), 15);
+  QCOMPARE(mGraph->data()->constBegin().key(), 0.0);
+  QCOMPARE((mGraph->data()->constEnd()-1).key(), 14.0);
+  
+  // removing the queue applies the remaining points:
+  queue->push(QCPData(20, 1));
+  mGraph->setDataQueueCapacity(0);
+  QVERIFY(!mGraph->dataQueue());
+  QCOMPARE(mGraph->data()->size(), 16);
+}
+
 void TestQCPGraph::channelFill()
 {
   QCPGraph *otherGraph = mPlot->addGraph();
@@ -174,3 +338,29 @@ void TestQCPGraph::channelFill()
   mPlot->replot();
 }
 
+void TestQCPGraph::vectorExportDecimation()
+{
+  const int n = 200000;
+  QVector<double> x(n), y(n);
+  for (int i=0; i<n; ++i)
+  {
+    x[i] = i;
+    y[i] = qSin(i*0.01)+(qrand()%1000)/1000.0;
+  }
+  mGraph->setData(x, y);
+  mGraph->setAdaptiveSampling(false);
+  mPlot->rescaleAxes();
+  const QString fullFileName = QDir::temp().filePath("qcustomplot-test-full.pdf");
+  const QString decimatedFileName = QDir::temp().filePath("qcustomplot-test-decimated.pdf");
+  
+  QCOMPARE(mPlot->vectorResolution(), 0);
+  QVERIFY(mPlot->savePdf(fullFileName, false, 500, 300));
+  mPlot->setVectorResolution(300);
+  QVERIFY(mPlot->savePdf(decimatedFileName, false, 500, 300));
+  
+  // at 300 dpi, the 500 points wide plot has about 2000 dot columns for the 200000 data points:
+  QVERIFY(QFileInfo(decimatedFileName).size()*4 < QFileInfo(fullFileName).size());
+  QFile::remove(fullFileName);
+  QFile::remove(decimatedFileName);
+}
+
@@ -10,7 +10,11 @@ private slots:
   
   void specializedGraphInterface();
   void dataManipulation();
+  void compactDataLayout();
+  void zeroCopyData();
+  void dataQueue();
   void channelFill();
+  void vectorExportDecimation();
   
 private:
   QCustomPlot *mPlot;
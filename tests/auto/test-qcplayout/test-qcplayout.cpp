@@ -335,20 +335,97 @@ void TestQCPLayout::marginGroup()
   QCOMPARE(ar0->margins().left(), 12);
 }
 
+void TestQCPLayout::layoutPassCaching()
+{
+  mPlot->setGeometry(50, 50, 500, 500);
+  QCPAxisRect *ar = mPlot->axisRect();
+  mPlot->replot();
+  const QRect rectWithoutTitle = ar->rect();
+  mPlot->plotLayout()->insertRow(0);
+  QCPPlotTitle *title = new QCPPlotTitle(mPlot, "Title");
+  mPlot->plotLayout()->addElement(0, 0, title);
+  mPlot->replot();
+  const QRect initialRect = ar->rect();
+  const int initialLeftMargin = ar->margins().left();
+  
+  // replot without changes keeps geometry:
+  mPlot->replot();
+  QCOMPARE(ar->rect(), initialRect);
+  
+  // axis label change must be picked up via the axis margin cache:
+  mPlot->yAxis->setLabel("y label");
+  mPlot->replot();
+  QVERIFY(ar->margins().left() > initialLeftMargin);
+  mPlot->yAxis->setLabel("");
+  mPlot->replot();
+  QCOMPARE(ar->margins().left(), initialLeftMargin);
+  
+  // content-sized element changing its size hint must be picked up:
+  const int initialTitleHeight = title->outerRect().height();
+  title->setFont(QFont(title->font().family(), title->font().pointSize()*3));
+  mPlot->replot();
+  QVERIFY(title->outerRect().height() > initialTitleHeight);
+  QVERIFY(ar->outerRect().top() > initialRect.top());
+  
+  // externally changed outer rects are reset by the next replot:
+  const QRect arOuterRect = ar->outerRect();
+  ar->setOuterRect(QRect(0, 0, 10, 10));
+  mPlot->replot();
+  QCOMPARE(ar->outerRect(), arOuterRect);
+  
+  // structural change:
+  mPlot->plotLayout()->remove(title);
+  mPlot->plotLayout()->simplify();
+  mPlot->replot();
+  QCOMPARE(ar->rect(), rectWithoutTitle);
+  
+  // viewport change:
+  mPlot->setGeometry(50, 50, 400, 300);
+  mPlot->replot();
+  QCOMPARE(ar->outerRect(), QRect(0, 0, 400, 300));
+}
 
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
+void TestQCPLayout::legendVirtualization()
+{
+  mPlot->setGeometry(50, 50, 500, 500);
+  QCPLegend *legend = mPlot->legend;
+  legend->setVisible(true);
+  for (int i=0; i<100; ++i)
+    mPlot->addGraph()->setName(QString("graph %1").arg(i));
+  legend->setVirtualized(true);
+  legend->setVisibleRowCount(5);
+  mPlot->replot();
+  
+  // only the visible rows are laid out:
+  for (int i=0; i<legend->itemCount(); ++i)
+    QCOMPARE(legend->item(i)->outerRect().isEmpty(), i >= 5);
+  QCOMPARE(legend->item(0)->outerRect().top(), legend->rect().top());
+  QVERIFY(legend->outerRect().height() < 10*legend->item(0)->outerRect().height());
+  
+  // scrolling:
+  legend->setScrollPosition(50);
+  mPlot->replot();
+  QVERIFY(legend->item(49)->outerRect().isEmpty());
+  QCOMPARE(legend->item(50)->outerRect().top(), legend->rect().top());
+  QVERIFY(!legend->item(54)->outerRect().isEmpty());
+  QVERIFY(legend->item(55)->outerRect().isEmpty());
+  
+  // scroll position is limited such that the last rows fill the legend:
+  legend->setScrollPosition(1000);
+  mPlot->replot();
+  QVERIFY(legend->item(94)->outerRect().isEmpty());
+  QCOMPARE(legend->item(95)->outerRect().top(), legend->rect().top());
+  QVERIFY(!legend->item(99)->outerRect().isEmpty());
+  
+  // cached item size follows a name change:
+  const int initialWidth = legend->outerRect().width();
+  mPlot->graph(99)->setName("graph with a considerably longer name than the others");
+  mPlot->replot();
+  QVERIFY(legend->outerRect().width() > initialWidth);
+  
+  // disabling virtualization lays out all items again:
+  legend->setVirtualized(false);
+  mPlot->replot();
+  for (int i=0; i<legend->itemCount(); ++i)
+    QVERIFY(!legend->item(i)->outerRect().isEmpty());
+}
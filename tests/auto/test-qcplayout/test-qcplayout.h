@@ -12,6 +12,8 @@ private slots:
   void layoutGridInsertion();
   void layoutGridLayout();
   void marginGroup();
+  void layoutPassCaching();
+  void legendVirtualization();
   
   
 private:
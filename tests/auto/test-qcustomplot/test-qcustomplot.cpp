@@ -78,16 +78,236 @@ void TestQCustomPlot::rescaleAxes_MultipleFlatGraphs()
   QCOMPARE(mPlot->yAxis->range().upper, 2.0);
 }
 
+void TestQCustomPlot::bulkRemoval()
+{
+  QCPLayer *mainLayer = mPlot->layer("main");
+  int initialLayerChildren = mainLayer->children().size();
+  int initialLegendItems = mPlot->legend->itemCount();
+  
+  // mix graphs, other plottables and items:
+  for (int i=0; i<1000; ++i)
+  {
+    if (i%2 == 0)
+      mPlot->addGraph();
+    else
+      mPlot->addPlottable(new QCPCurve(mPlot->xAxis, mPlot->yAxis));
+  }
+  for (int i=0; i<100; ++i)
+    mPlot->addItem(new QCPItemLine(mPlot));
+  QCOMPARE(mPlot->plottableCount(), 1000);
+  QCOMPARE(mPlot->graphCount(), 500);
+  QCOMPARE(mPlot->itemCount(), 100);
+  QCOMPARE(mPlot->legend->itemCount(), initialLegendItems+1000);
+  QCOMPARE(mainLayer->children().size(), initialLayerChildren+1100);
+  
+  // legend lookup and single removal:
+  QCPAbstractPlottable *curve = mPlot->plottable(1);
+  QVERIFY(mPlot->legend->hasItemWithPlottable(curve));
+  QVERIFY(mPlot->hasPlottable(curve));
+  QVERIFY(mPlot->removePlottable(curve));
+  QVERIFY(!mPlot->hasPlottable(curve));
+  QCOMPARE(mPlot->legend->itemCount(), initialLegendItems+999);
+  
+  // clearing graphs only removes graphs:
+  QCPGraph *graph = mPlot->graph(0);
+  QCOMPARE(mPlot->clearGraphs(), 500);
+  QVERIFY(!mPlot->hasPlottable(graph));
+  QCOMPARE(mPlot->plottableCount(), 499);
+  QCOMPARE(mPlot->graphCount(), 0);
+  QCOMPARE(mPlot->legend->itemCount(), initialLegendItems+499);
+  for (int i=0; i<mPlot->plottableCount(); ++i)
+    QVERIFY(mPlot->legend->hasItemWithPlottable(mPlot->plottable(i)));
+  QCOMPARE(mainLayer->children().size(), initialLayerChildren+599);
+  
+  QCOMPARE(mPlot->clearItems(), 100);
+  QCOMPARE(mPlot->itemCount(), 0);
+  QCOMPARE(mPlot->clearPlottables(), 499);
+  QCOMPARE(mPlot->plottableCount(), 0);
+  QCOMPARE(mPlot->legend->itemCount(), initialLegendItems);
+  QCOMPARE(mainLayer->children().size(), initialLayerChildren);
+  
+  // legend item taken out of its legend may outlive it:
+  QCPLegend *legend = new QCPLegend;
+  mPlot->axisRect()->insetLayout()->addElement(legend, Qt::AlignTop|Qt::AlignLeft);
+  QCPGraph *legendGraph = mPlot->addGraph();
+  QCPPlottableLegendItem *legendItem = new QCPPlottableLegendItem(legend, legendGraph);
+  QVERIFY(legend->addItem(legendItem));
+  QVERIFY(legend->hasItemWithPlottable(legendGraph));
+  QVERIFY(legend->take(legendItem));
+  QVERIFY(!legend->hasItemWithPlottable(legendGraph));
+  delete legend;
+  QVERIFY(!legendItem->parentLegend());
+  QCOMPARE(legendItem->selectTest(QPointF(0, 0), true), -1.0);
+  delete legendItem;
+  QVERIFY(mPlot->removeGraph(legendGraph));
+  
+  // plot must still be fully usable:
+  mPlot->addGraph()->setData(QVector<double>() << 1 << 2, QVector<double>() << 1 << 2);
+  QCOMPARE(mPlot->legend->itemCount(), initialLegendItems+1);
+  mPlot->replot();
+}
 
+void TestQCustomPlot::saveTiff()
+{
+  mPlot->addGraph();
+  mPlot->graph(0)->setData(QVector<double>()<<1<<2<<3<<4, QVector<double>()<<1<<-1<<2<<0);
+  mPlot->rescaleAxes();
+  mPlot->xAxis->setLabel("x");
+  const QString fileName = QDir::temp().filePath("qcustomplot-test-savetiff.tif");
+  
+  // strip height which doesn't divide the image height, so the last strip is shorter:
+  QVERIFY(mPlot->saveTiff(fileName, 300, 200, 1.0, 7));
+  QFile file(fileName);
+  QVERIFY(file.open(QIODevice::ReadOnly));
+  QCOMPARE(file.read(4), QByteArray("II*\0", 4));
+  file.close();
+  
+  // if Qt can read TIFF files, the result must equal the unstripped rendering:
+  QImage tiled;
+  if (tiled.load(fileName))
+  {
+    QImage reference = mPlot->toPixmap(300, 200).toImage().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    QCOMPARE(tiled.size(), QSize(300, 200));
+    QCOMPARE(tiled.convertToFormat(QImage::Format_ARGB32_Premultiplied), reference);
+  }
+  QFile::remove(fileName);
+  
+  QVERIFY(!mPlot->saveTiff(fileName, 300, 200, 1.0, 0));
+}
 
+void TestQCustomPlot::batchExport()
+{
+  mPlot->addGraph();
+  mPlot->graph(0)->setData(QVector<double>()<<1<<2<<3<<4, QVector<double>()<<1<<-1<<2<<0);
+  mPlot->rescaleAxes();
+  const QString fileName = QDir::temp().filePath("qcustomplot-test-batchexport-%1.png");
+  QVector<QImage> references;
+  
+  QCPBatchExporter exporter;
+  exporter.setMaxThreadCount(2);
+  exporter.setMaxPendingCount(1); // forces addPng to block while a file is written
+  QSignalSpy spy(&exporter, SIGNAL(fileExported(QString,bool)));
+  for (int i=0; i<4; ++i)
+  {
+    mPlot->yAxis->setRange(-1-i, 2+i);
+    references.append(mPlot->toPixmap(200, 100).toImage().convertToFormat(QImage::Format_ARGB32));
+    QVERIFY(exporter.addPng(mPlot, fileName.arg(i), 200, 100));
+    QVERIFY(exporter.pendingCount() <= 1);
+  }
+  QVERIFY(exporter.waitForFinished());
+  QCOMPARE(exporter.pendingCount(), 0);
+  QCOMPARE(exporter.exportedCount(), 4);
+  QCOMPARE(exporter.failedCount(), 0);
+  QCOMPARE(spy.count(), 4);
+  
+  // each file must show the plot as it was when it was added, not as it is when it's written:
+  for (int i=0; i<4; ++i)
+  {
+    QImage image;
+    QVERIFY(image.load(fileName.arg(i)));
+    QCOMPARE(image.convertToFormat(QImage::Format_ARGB32), references.at(i));
+    QFile::remove(fileName.arg(i));
+  }
+  
+  exporter.resetStatistics();
+  QVERIFY(exporter.addRastered(mPlot, fileName.arg(0), 200, 100, 1.0, "NOSUCHFORMAT"));
+  QVERIFY(!exporter.waitForFinished());
+  QCOMPARE(exporter.failedCount(), 1);
+  QFile::remove(fileName.arg(0));
+}
 
+void TestQCustomPlot::batchExportPdf()
+{
+  mPlot->addGraph();
+  mPlot->graph(0)->setData(QVector<double>()<<1<<2<<3<<4, QVector<double>()<<1<<-1<<2<<0);
+  mPlot->rescaleAxes();
+  const QString fileName = QDir::temp().filePath("qcustomplot-test-batchexport-%1.pdf");
+  
+  QCPBatchExporter exporter;
+  exporter.setMaxThreadCount(2);
+  QSignalSpy spy(&exporter, SIGNAL(fileExported(QString,bool)));
+  for (int i=0; i<4; ++i)
+  {
+    QFile::remove(fileName.arg(i));
+    mPlot->yAxis->setRange(-1-i, 2+i);
+    QVERIFY(exporter.addPdf(mPlot, fileName.arg(i), false, 300, 200));
+  }
+  QVERIFY(exporter.waitForFinished());
+  QCOMPARE(exporter.pendingCount(), 0);
+  QCOMPARE(exporter.exportedCount(), 4);
+  QCOMPARE(exporter.failedCount(), 0);
+  QCOMPARE(spy.count(), 4);
+  for (int i=0; i<4; ++i)
+  {
+    QFileInfo info(fileName.arg(i));
+    QVERIFY(info.exists());
+    QVERIFY(info.size() > 0);
+    QFile::remove(fileName.arg(i));
+  }
+}
 
-
-
-
-
-
-
-
-
-
+void TestQCustomPlot::replotProfiling()
+{
+  int n = 100000;
+  QVector<double> x(n), y(n);
+  for (int i=0; i<n; ++i)
+  {
+    x[i] = i;
+    y[i] = qSin(i/1000.0);
+  }
+  QCPGraph *graph = mPlot->addGraph();
+  graph->setName("sine");
+  graph->setData(x, y);
+  mPlot->rescaleAxes();
+  // the profile type is registered by QCustomPlot, so the signal can be queued (and spied on):
+  QVERIFY(QMetaType::type("QCPReplotProfile") != 0);
+  QSignalSpy spy(mPlot, SIGNAL(replotProfiled(QCPReplotProfile)));
+  
+  // nothing is recorded unless profiling is enabled:
+  mPlot->replot();
+  QCOMPARE(spy.count(), 0);
+  QCOMPARE(mPlot->replotProfile().layerableTimes.size(), 0);
+  
+  mPlot->setProfiling(true);
+  mPlot->replot();
+  QCOMPARE(spy.count(), 1);
+  QVERIFY(mPlot->currentReplotProfile() == 0);
+  const QCPReplotProfile &profile = mPlot->replotProfile();
+  QCOMPARE(profile.layerTimes.size(), mPlot->layerCount());
+  QVERIFY(profile.totalTime >= profile.layersTime);
+  bool foundGraph = false;
+  foreach (const QCPReplotProfile::LayerableTiming &timing, profile.layerableTimes)
+  {
+    if (timing.layerable == graph)
+    {
+      foundGraph = true;
+      QCOMPARE(timing.name, QString("QCPGraph \"sine\""));
+      QCOMPARE(timing.layer, graph->layer()->name());
+    }
+    // the draw time of each layerable is split into data preparation and rasterization:
+    QVERIFY(timing.preparationTime >= 0);
+    QVERIFY(timing.rasterizationTime >= 0);
+    QVERIFY(qAbs(timing.preparationTime+timing.rasterizationTime-timing.drawTime) < 1e-9);
+  }
+  QVERIFY(foundGraph);
+  QVERIFY(profile.tickTime >= 0);
+  QVERIFY(profile.preparationTime >= 0);
+  // adaptive sampling reduces the 100000 points to a few per pixel:
+  QVERIFY(profile.pointsDrawn > 0);
+  QCOMPARE(profile.pointsDrawn+profile.pointsSampledAway, n);
+  
+  // a graph that is the channel fill target of another graph is only counted once:
+  QCPGraph *fillGraph = mPlot->addGraph();
+  fillGraph->setData(QVector<double>() << 0 << n-1, QVector<double>() << 0 << 0);
+  fillGraph->setBrush(QBrush(Qt::red));
+  fillGraph->setChannelFillGraph(graph);
+  mPlot->replot();
+  QCOMPARE(mPlot->replotProfile().pointsDrawn+mPlot->replotProfile().pointsSampledAway, n+2);
+  mPlot->removeGraph(fillGraph);
+  
+  // with unchanged tick labels, the second replot draws them from the cache:
+  mPlot->replot();
+  QVERIFY(mPlot->replotProfile().cacheHits > 0);
+  QCOMPARE(mPlot->replotProfile().cacheMisses, 0);
+  QVERIFY(mPlot->replotProfile().summary().contains("QCPGraph"));
+}
@@ -11,6 +11,11 @@ private slots:
   void rescaleAxes_GraphVisibility();
   void rescaleAxes_FlatGraph();
   void rescaleAxes_MultipleFlatGraphs();
+  void bulkRemoval();
+  void saveTiff();
+  void batchExport();
+  void batchExportPdf();
+  void replotProfiling();
   
 private:
   QCustomPlot *mPlot;
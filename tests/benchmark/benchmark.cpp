@@ -17,12 +17,48 @@ private slots:
   void QCPGraph_RemoveDataAfter();
   void QCPGraph_RemoveDataBefore();
   void QCPGraph_AddData();
+  
+  void QCPCurve_Trajectory();
+  void QCPCurve_TrajectoryCompact();
+  void QCPCurve_ManyPoints();
+  void QCPCurve_ManyPointsNoSampling();
+  void QCPCurve_SelectTest();
+  
+  void QCPBars_ManyBars();
+  void QCPBars_Stacked();
+  void QCPBarsGroup_ManyKeys();
+  void QCPFinancial_ZoomedOut();
+  void QCPFinancial_ZoomedOutNoBinning();
+  void QCPFinancial_AddTick();
+  void QCPFinancial_SelectTest();
+  void QCPBoxPlot_SetSamples();
+  void QCPBoxPlot_SetSamplesSingleThread();
+  void QCPBoxPlot_Replot();
 
   void QCPAxis_TickLabels();
   void QCPAxis_TickLabelsCached();
   
+  void QCPAxisRect_SmallMultiples();
+  void QCPAxisRect_SmallMultiplesHint();
+  
+  void QCustomPlot_RebuildManyGraphs();
+  
+  void QCPBatchExporter_Serial();
+  void QCPBatchExporter_1Thread();
+  void QCPBatchExporter_2Threads();
+  void QCPBatchExporter_4Threads();
+  void QCPBatchExporter_IdealThreads();
+  
 private:
   QCustomPlot *mPlot;
+  
+  void setupSmallMultiples(int rows, int columns);
+  void setupBatchExport();
+  void setupFinancial(bool adaptiveBinning);
+  void runCurveTrajectory(QCPCurve::DataLayout layout);
+  void setupCurveSpiral(bool adaptiveSampling);
+  void createBoxPlotSamples(QVector<double> &keys, QVector<QVector<double> > &samples);
+  void runBatchExport(int threadCount);
 };
 
 QTEST_MAIN(Benchmark)
@@ -256,6 +292,206 @@ void Benchmark::QCPGraph_AddData()
   }
 }
 
+void Benchmark::QCPCurve_Trajectory()
+{
+  runCurveTrajectory(QCPCurve::dlMap);
+}
+
+void Benchmark::QCPCurve_TrajectoryCompact()
+{
+  runCurveTrajectory(QCPCurve::dlCompact);
+}
+
+void Benchmark::QCPCurve_ManyPoints()
+{
+  setupCurveSpiral(true);
+  QBENCHMARK
+  {
+    mPlot->replot();
+  }
+}
+
+void Benchmark::QCPCurve_ManyPointsNoSampling()
+{
+  setupCurveSpiral(false);
+  QBENCHMARK
+  {
+    mPlot->replot();
+  }
+}
+
+void Benchmark::QCPCurve_SelectTest()
+{
+  setupCurveSpiral(false);
+  mPlot->replot();
+  QCPCurve *curve = qobject_cast<QCPCurve*>(mPlot->plottable(0));
+  QRect rect = mPlot->axisRect()->rect();
+  QBENCHMARK
+  {
+    for (int x=rect.left(); x<rect.right(); x+=5)
+      curve->selectTest(QPointF(x, rect.center().y()), false);
+  }
+}
+
+void Benchmark::QCPBars_ManyBars()
+{
+  QCPBars *bars = new QCPBars(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(bars);
+  bars->setWidth(1.0);
+  int n = 500000;
+  QVector<double> x(n), y(n);
+  for (int i=0; i<n; ++i)
+  {
+    x[i] = i;
+    y[i] = qExp(-(i-n/2.0)*(i-n/2.0)/(2.0*n*n/36.0))*(1+qrand()/(double)RAND_MAX*0.3);
+  }
+  bars->setData(x, y);
+  mPlot->rescaleAxes();
+  
+  QBENCHMARK
+  {
+    mPlot->replot();
+  }
+}
+
+void Benchmark::QCPBars_Stacked()
+{
+  int n = 50000;
+  QVector<double> x(n), y(n);
+  for (int i=0; i<n; ++i)
+    x[i] = i;
+  QCPBars *below = 0;
+  for (int s=0; s<30; ++s)
+  {
+    QCPBars *bars = new QCPBars(mPlot->xAxis, mPlot->yAxis);
+    mPlot->addPlottable(bars);
+    for (int i=0; i<n; ++i)
+      y[i] = 1+qSin(i/1000.0+s);
+    bars->setData(x, y);
+    bars->setWidth(1.0);
+    bars->moveAbove(below);
+    below = bars;
+  }
+  mPlot->rescaleAxes();
+  
+  QBENCHMARK
+  {
+    mPlot->replot();
+  }
+}
+
+void Benchmark::QCPBarsGroup_ManyKeys()
+{
+  int n = 100000;
+  QVector<double> x(n), y(n);
+  for (int i=0; i<n; ++i)
+    x[i] = i;
+  QCPBarsGroup *group = new QCPBarsGroup(mPlot);
+  for (int s=0; s<12; ++s)
+  {
+    QCPBars *bars = new QCPBars(mPlot->xAxis, mPlot->yAxis);
+    mPlot->addPlottable(bars);
+    for (int i=0; i<n; ++i)
+      y[i] = 1+qSin(i/1000.0+s);
+    bars->setData(x, y);
+    bars->setWidth(1.0/12.0);
+    bars->setBarsGroup(group);
+  }
+  group->setSpacingType(QCPBarsGroup::stPlotCoords);
+  group->setSpacing(0.01);
+  mPlot->rescaleAxes();
+  
+  QBENCHMARK
+  {
+    mPlot->replot();
+  }
+}
+
+void Benchmark::QCPFinancial_ZoomedOut()
+{
+  setupFinancial(true);
+  QBENCHMARK
+  {
+    mPlot->replot();
+  }
+}
+
+void Benchmark::QCPFinancial_ZoomedOutNoBinning()
+{
+  setupFinancial(false);
+  QBENCHMARK
+  {
+    mPlot->replot();
+  }
+}
+
+void Benchmark::QCPFinancial_AddTick()
+{
+  setupFinancial(true);
+  QCPFinancial *financial = qobject_cast<QCPFinancial*>(mPlot->plottable(0));
+  financial->setTickBinSize(60);
+  double time = 525600*60;
+  QBENCHMARK
+  {
+    for (int i=0; i<10000; ++i)
+    {
+      time += 0.5;
+      financial->addTick(time, 100+qSin(time));
+    }
+  }
+}
+
+void Benchmark::QCPFinancial_SelectTest()
+{
+  setupFinancial(true);
+  QCPFinancial *financial = qobject_cast<QCPFinancial*>(mPlot->plottable(0));
+  QRect rect = mPlot->axisRect()->rect();
+  QBENCHMARK
+  {
+    for (int x=rect.left(); x<rect.right(); x+=5)
+      financial->selectTest(QPointF(x, rect.center().y()), false);
+  }
+}
+
+void Benchmark::QCPBoxPlot_SetSamples()
+{
+  QCPBoxPlot *boxPlot = new QCPBoxPlot(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(boxPlot);
+  QVector<double> keys;
+  QVector<QVector<double> > samples;
+  createBoxPlotSamples(keys, samples);
+  QBENCHMARK
+  {
+    boxPlot->setSamples(keys, samples);
+  }
+}
+
+void Benchmark::QCPBoxPlot_SetSamplesSingleThread()
+{
+  QVector<double> keys;
+  QVector<QVector<double> > samples;
+  createBoxPlotSamples(keys, samples);
+  QBENCHMARK
+  {
+    QCPBoxPlot::samplesToBoxes(keys, samples, 1.5, 1);
+  }
+}
+
+void Benchmark::QCPBoxPlot_Replot()
+{
+  QCPBoxPlot *boxPlot = new QCPBoxPlot(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(boxPlot);
+  QVector<double> keys;
+  QVector<QVector<double> > samples;
+  createBoxPlotSamples(keys, samples);
+  boxPlot->setSamples(keys, samples);
+  mPlot->rescaleAxes();
+  QBENCHMARK
+  {
+    mPlot->replot();
+  }
+}
+
 void Benchmark::QCPAxis_TickLabels()
 {
   mPlot->setPlottingHint(QCP::phCacheLabels, false);
@@ -287,3 +523,236 @@ void Benchmark::QCPAxis_TickLabelsCached()
     mPlot->replot();
   }
 }
+
+void Benchmark::QCPAxisRect_SmallMultiples()
+{
+  mPlot->setPlottingHint(QCP::phSmallMultiples, false);
+  mPlot->setGeometry(0, 0, 1600, 1200);
+  setupSmallMultiples(20, 20);
+  QList<QCPAxisRect*> rects = mPlot->axisRects();
+  double offset = 0;
+  QBENCHMARK
+  {
+    offset += 0.1;
+    foreach (QCPAxisRect *r, rects)
+      r->axis(QCPAxis::atBottom)->setRange(offset, offset+10);
+    mPlot->replot();
+  }
+}
+
+void Benchmark::QCPAxisRect_SmallMultiplesHint()
+{
+  mPlot->setPlottingHint(QCP::phSmallMultiples, true);
+  mPlot->setGeometry(0, 0, 1600, 1200);
+  setupSmallMultiples(20, 20);
+  QList<QCPAxisRect*> rects = mPlot->axisRects();
+  double offset = 0;
+  QBENCHMARK
+  {
+    offset += 0.1;
+    foreach (QCPAxisRect *r, rects)
+      r->axis(QCPAxis::atBottom)->setRange(offset, offset+10);
+    mPlot->replot();
+  }
+}
+
+void Benchmark::QCustomPlot_RebuildManyGraphs()
+{
+  QBENCHMARK
+  {
+    for (int i=0; i<10000; ++i)
+      mPlot->addGraph();
+    mPlot->clearGraphs();
+  }
+}
+
+void Benchmark::QCPBatchExporter_Serial()
+{
+  setupBatchExport();
+  QString fileNamePattern = QDir::temp().absoluteFilePath("qcp-benchmark-%1.png");
+  int n = 32;
+  QBENCHMARK
+  {
+    for (int i=0; i<n; ++i)
+    {
+      mPlot->graph(0)->setName(QString::number(i));
+      mPlot->savePng(fileNamePattern.arg(i), 800, 600);
+    }
+  }
+  for (int i=0; i<n; ++i)
+    QFile::remove(fileNamePattern.arg(i));
+}
+
+void Benchmark::QCPBatchExporter_1Thread()
+{
+  setupBatchExport();
+  runBatchExport(1);
+}
+
+void Benchmark::QCPBatchExporter_2Threads()
+{
+  setupBatchExport();
+  runBatchExport(2);
+}
+
+void Benchmark::QCPBatchExporter_4Threads()
+{
+  setupBatchExport();
+  runBatchExport(4);
+}
+
+void Benchmark::QCPBatchExporter_IdealThreads()
+{
+  setupBatchExport();
+  runBatchExport(QThread::idealThreadCount());
+}
+
+void Benchmark::setupSmallMultiples(int rows, int columns)
+{
+  mPlot->plotLayout()->clear();
+  mPlot->plotLayout()->setRowSpacing(0);
+  mPlot->plotLayout()->setColumnSpacing(0);
+  QCPMarginGroup *marginGroup = new QCPMarginGroup(mPlot);
+  int n = 50;
+  QVector<double> x(n), y(n);
+  for (int i=0; i<n; ++i)
+    x[i] = i/(double)(n-1)*20;
+  for (int row=0; row<rows; ++row)
+  {
+    for (int col=0; col<columns; ++col)
+    {
+      QCPAxisRect *r = new QCPAxisRect(mPlot);
+      r->setMarginGroup(QCP::msLeft|QCP::msBottom, marginGroup);
+      r->axis(QCPAxis::atBottom)->setRange(0, 10);
+      r->axis(QCPAxis::atLeft)->setRange(-1, 1);
+      mPlot->plotLayout()->addElement(row, col, r);
+      for (int i=0; i<n; ++i)
+        y[i] = qSin(x[i]*(1+row*columns+col)/50.0);
+      QCPGraph *graph = mPlot->addGraph(r->axis(QCPAxis::atBottom), r->axis(QCPAxis::atLeft));
+      graph->setData(x, y);
+    }
+  }
+  mPlot->replot();
+}
+
+void Benchmark::setupBatchExport()
+{
+  int n = 2000;
+  QVector<double> x(n), y(n);
+  for (int g=0; g<4; ++g)
+  {
+    for (int i=0; i<n; ++i)
+    {
+      x[i] = i/(double)(n-1)*10;
+      y[i] = qSin(x[i]*(g+1))+qrand()/(double)RAND_MAX*0.2;
+    }
+    QCPGraph *graph = mPlot->addGraph();
+    graph->setData(x, y);
+    graph->setPen(QPen(QColor::fromHsv(g*60, 255, 200)));
+  }
+  mPlot->legend->setVisible(true);
+  mPlot->rescaleAxes();
+}
+
+void Benchmark::runBatchExport(int threadCount)
+{
+  QString fileNamePattern = QDir::temp().absoluteFilePath("qcp-benchmark-%1.png");
+  int n = 32;
+  QCPBatchExporter exporter;
+  exporter.setMaxThreadCount(threadCount);
+  QBENCHMARK
+  {
+    for (int i=0; i<n; ++i)
+    {
+      mPlot->graph(0)->setName(QString::number(i));
+      exporter.addPng(mPlot, fileNamePattern.arg(i), 800, 600);
+    }
+    exporter.waitForFinished();
+  }
+  QVERIFY(exporter.failedCount() == 0);
+  for (int i=0; i<n; ++i)
+    QFile::remove(fileNamePattern.arg(i));
+}
+
+void Benchmark::setupFinancial(bool adaptiveBinning)
+{
+  // one year of minute candles:
+  int n = 525600;
+  QVector<double> time(n), value(n);
+  double current = 100;
+  for (int i=0; i<n; ++i)
+  {
+    time[i] = i*60;
+    current += qSin(i/997.0)*0.05+qCos(i*0.37)*0.1;
+    value[i] = current;
+  }
+  QCPFinancialDataMap data = QCPFinancial::timeSeriesToOhlc(time, value, 60);
+  QCPFinancial *financial = new QCPFinancial(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(financial);
+  financial->setData(&data, true);
+  financial->setWidth(50);
+  financial->setChartStyle(QCPFinancial::csCandlestick);
+  financial->setTwoColored(true);
+  financial->setAdaptiveBinning(adaptiveBinning);
+  mPlot->rescaleAxes();
+  mPlot->replot(); // builds the binned levels outside of the measurement
+}
+
+void Benchmark::runCurveTrajectory(QCPCurve::DataLayout layout)
+{
+  QCPCurve *curve = new QCPCurve(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(curve);
+  curve->setDataLayout(layout);
+  mPlot->xAxis->setRange(-1.5, 1.5);
+  mPlot->yAxis->setRange(-1.5, 1.5);
+  // record a trajectory point by point, keeping a rolling window of the latest points:
+  int n = 200000;
+  int window = 50000;
+  QBENCHMARK_ONCE
+  {
+    for (int i=0; i<n; ++i)
+    {
+      double phi = i/1000.0;
+      curve->addData(i, qCos(phi)*(1+0.3*qSin(phi*7.1)), qSin(phi)*(1+0.3*qCos(phi*5.3)));
+      curve->removeDataBefore(i-window);
+      if (i%20000 == 0)
+        mPlot->replot();
+    }
+  }
+}
+
+void Benchmark::setupCurveSpiral(bool adaptiveSampling)
+{
+  // fully visible spiral with far more points than pixels on its path:
+  int n = 2000000;
+  QVector<double> t(n), x(n), y(n);
+  for (int i=0; i<n; ++i)
+  {
+    t[i] = i;
+    double phi = i/(double)n*50*2*M_PI;
+    double r = 0.1+0.9*i/(double)n;
+    x[i] = r*qCos(phi);
+    y[i] = r*qSin(phi);
+  }
+  QCPCurve *curve = new QCPCurve(mPlot->xAxis, mPlot->yAxis);
+  mPlot->addPlottable(curve);
+  curve->setDataLayout(QCPCurve::dlCompact);
+  curve->setData(t, x, y);
+  curve->setAdaptiveSampling(adaptiveSampling);
+  mPlot->rescaleAxes();
+}
+
+void Benchmark::createBoxPlotSamples(QVector<double> &keys, QVector<QVector<double> > &samples)
+{
+  int n = 2000;
+  int sampleCount = 5000;
+  keys.resize(n);
+  samples.resize(n);
+  for (int i=0; i<n; ++i)
+  {
+    keys[i] = i;
+    samples[i].resize(sampleCount);
+    for (int k=0; k<sampleCount; ++k)
+      samples[i][k] = qSin(i/100.0)*10+(qrand()/(double)RAND_MAX-0.5)*(k%50 == 0 ? 40 : 5);
+  }
+}